@@ -0,0 +1,1026 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  nitf_bench synthesizes a matrix of NITFs (image mode, blocking, pixel
+ *  type, masks and compression) in a scratch directory and times the
+ *  common read and write paths against each of them.  Every measurement
+ *  is emitted as one JSON object per line (or one CSV row) so that runs
+ *  from different releases can be diffed or loaded by a script.
+ *
+ *  Compression and the TREs go through the plugins, so NITF_PLUGIN_PATH
+ *  (or --plugins) has to name the TRE plugins and the JPEG and JPEG 2000
+ *  ones.  A case whose plugin is missing is reported as skipped.
+ *
+ *  Throughput (mb_per_s) is computed from the number of image bytes an
+ *  operation covers: the whole image for writes and full reads, the
+ *  window for sub-window reads and the window before down-sampling for
+ *  down-sampled reads.  Header-only opens report ops_per_s only.
+ */
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <import/nitf.hpp>
+#include <import/cli.h>
+#include <nitf/ByteProvider.hpp>
+#include <io/FileOutputStream.h>
+#include <io/TempFile.h>
+#include <sys/Conf.h>
+#include <sys/StopWatch.h>
+
+/*
+ *  Allocation counting.  With glibc we can interpose the allocator from the
+ *  executable and forward to the __libc_* entry points, which also catches
+ *  the allocations made inside the C library.  Elsewhere the counts are
+ *  reported as null.
+ */
+#if defined(__GLIBC__) && defined(__GNUC__) && !defined(__SANITIZE_ADDRESS__)
+#define NITF_BENCH_COUNT_ALLOCS 1
+
+extern "C"
+{
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+static volatile size_t gNumAllocs = 0;
+static volatile size_t gNumAllocBytes = 0;
+
+static void countAlloc(size_t size)
+{
+    __sync_fetch_and_add(&gNumAllocs, 1);
+    __sync_fetch_and_add(&gNumAllocBytes, size);
+}
+
+void* malloc(size_t size) __THROW
+{
+    countAlloc(size);
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size) __THROW
+{
+    countAlloc(count * size);
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size) __THROW
+{
+    countAlloc(size);
+    return __libc_realloc(ptr, size);
+}
+}
+#endif
+
+namespace
+{
+struct AllocCount
+{
+    AllocCount() :
+        count(0),
+        bytes(0)
+    {
+    }
+
+    static AllocCount now()
+    {
+        AllocCount snapshot;
+#ifdef NITF_BENCH_COUNT_ALLOCS
+        snapshot.count = gNumAllocs;
+        snapshot.bytes = gNumAllocBytes;
+#endif
+        return snapshot;
+    }
+
+    size_t count;
+    size_t bytes;
+};
+
+struct Options
+{
+    size_t rows;
+    size_t cols;
+    size_t bands;
+    size_t blockSize;
+    size_t numTREs;
+    size_t minIterations;
+    double minSeconds;
+    std::string filter;
+    std::string format;
+    std::string directory;
+};
+
+//! One synthesized NITF
+struct CaseSpec
+{
+    std::string imode;
+    size_t rows;
+    size_t cols;
+    size_t bands;
+    //! 0 means a single block covering the whole image
+    size_t blockSize;
+    std::string pvtype;
+    size_t nbpp;
+    std::string compression;
+    size_t numTREs;
+
+    size_t bytesPerPixel() const
+    {
+        return NITF_NBPP_TO_BYTES(nbpp);
+    }
+
+    size_t bandBytes() const
+    {
+        return rows * cols * bytesPerPixel();
+    }
+
+    size_t imageBytes() const
+    {
+        return bandBytes() * bands;
+    }
+
+    size_t blockRows() const
+    {
+        return blockSize ? blockSize : rows;
+    }
+
+    size_t blockCols() const
+    {
+        return blockSize ? blockSize : cols;
+    }
+
+    bool masked() const
+    {
+        return compression == "NM";
+    }
+
+    bool compressed() const
+    {
+        return compression != "NC" && compression != "NM";
+    }
+
+    //! The JPEG plugin only takes three bands as RGB
+    bool rgb() const
+    {
+        return bands == 3 && (compression == "C3" || compression == "M3");
+    }
+
+    std::string name() const
+    {
+        std::ostringstream os;
+        os << imode << "_";
+        if (blockSize)
+            os << blockSize << "x" << blockSize;
+        else
+            os << "1blk";
+        os << "_" << pvtype << nbpp << "_" << compression;
+        if (numTREs)
+            os << "_" << numTREs << "tres";
+        return os.str();
+    }
+};
+
+struct Measurement
+{
+    Measurement() :
+        iterations(0),
+        seconds(0),
+        bytesPerOp(0),
+        allocs(0),
+        allocBytes(0)
+    {
+    }
+
+    std::string op;
+    std::string status;
+    std::string note;
+    size_t iterations;
+    double seconds;
+    size_t bytesPerOp;
+    size_t allocs;
+    size_t allocBytes;
+};
+
+class Operation
+{
+public:
+    virtual ~Operation()
+    {
+    }
+
+    virtual void run() = 0;
+};
+
+/*!
+ *  Runs the operation once untimed (page cache, plugin loading) and then
+ *  until both the minimum iteration count and minimum time are reached.
+ *  Allocations are only counted inside run() so the stopwatch does not
+ *  show up in them.
+ */
+void measure(Operation& op, const Options& options, Measurement& result)
+{
+    op.run();
+
+    sys::RealTimeStopWatch stopWatch;
+    stopWatch.start();
+    double elapsedMillis = 0;
+    do
+    {
+        const AllocCount before = AllocCount::now();
+        op.run();
+        const AllocCount after = AllocCount::now();
+        result.allocs += after.count - before.count;
+        result.allocBytes += after.bytes - before.bytes;
+        ++result.iterations;
+        elapsedMillis = stopWatch.stop();
+    }
+    while (result.iterations < options.minIterations ||
+           elapsedMillis < options.minSeconds * 1000.0);
+
+    result.seconds = elapsedMillis / 1000.0;
+    result.status = "ok";
+}
+
+/*!
+ *  The TRE-heavy case cycles through these so that opening the file parses
+ *  each one against its description, as it would for a real product.
+ */
+const char* const TRE_TAGS[] =
+{
+    "ACFTB", "AIMIDB", "BLOCKA", "EXOPTA", "PIAIMC", "STDIDC", "USE00A"
+};
+const size_t NUM_TRE_TAGS = sizeof(TRE_TAGS) / sizeof(TRE_TAGS[0]);
+
+nitf::Record makeRecord(const CaseSpec& spec)
+{
+    nitf::Record record(NITF_VER_21);
+    nitf::FileHeader header = record.getHeader();
+    header.getOriginStationID().set("nitf_bench");
+    header.getFileTitle().set(spec.name());
+
+    for (size_t ii = 0; ii < spec.numTREs; ++ii)
+    {
+        const std::string tag(TRE_TAGS[ii % NUM_TRE_TAGS]);
+        // Without the plugin the TRE would be written as raw data
+        if (!nitf::PluginRegistry::treHandlerExists(tag))
+        {
+            throw except::Exception(Ctxt("No TRE handler for " + tag));
+        }
+        nitf::TRE tre(tag);
+        header.getExtendedSection().appendTRE(tre);
+    }
+
+    nitf::ImageSegment segment = record.newImageSegment();
+    nitf::ImageSubheader subheader = segment.getSubheader();
+    subheader.getImageId().set("BENCH");
+
+    static const char* const RGB[] = { "R ", "G ", "B " };
+    std::vector<nitf::BandInfo> bands(spec.bands);
+    for (size_t ii = 0; ii < spec.bands; ++ii)
+    {
+        bands[ii].getRepresentation().set(
+                spec.bands == 1 ? "M " : spec.rgb() ? RGB[ii] : "  ");
+        bands[ii].getSubcategory().set("      ");
+        bands[ii].getImageFilterCondition().set("N");
+        bands[ii].getImageFilterCode().set("   ");
+        bands[ii].getNumLUTs().set(0);
+    }
+    subheader.setPixelInformation(spec.pvtype,
+                                  spec.nbpp,
+                                  spec.nbpp,
+                                  "R",
+                                  spec.bands == 1 ? "MONO" :
+                                          spec.rgb() ? "RGB" : "MULTI",
+                                  "VIS",
+                                  bands);
+    subheader.setBlocking(spec.rows,
+                          spec.cols,
+                          spec.blockRows(),
+                          spec.blockCols(),
+                          spec.imode);
+    subheader.getImageCompression().set(spec.compression);
+    subheader.getCompressionRate().set(spec.compressed() ? "N045" : "    ");
+    return record;
+}
+
+/*!
+ *  Band sequential pixel data.  For masked cases every other block is left
+ *  at the pad value (0) so the writer has blank blocks to drop.
+ */
+std::vector<nitf::Uint8> makePixels(const CaseSpec& spec)
+{
+    std::vector<nitf::Uint8> pixels(spec.imageBytes());
+    for (size_t ii = 0; ii < pixels.size(); ++ii)
+        pixels[ii] = static_cast<nitf::Uint8>((ii * 31 + ii / 4099) | 1);
+
+    if (spec.masked())
+    {
+        const size_t pixelBytes = spec.bytesPerPixel();
+        for (size_t band = 0; band < spec.bands; ++band)
+        {
+            nitf::Uint8* const bandPtr = &pixels[band * spec.bandBytes()];
+            for (size_t row = 0; row < spec.rows; ++row)
+            {
+                for (size_t col = 0; col < spec.cols; ++col)
+                {
+                    if ((row / spec.blockRows() + col / spec.blockCols()) % 2)
+                        continue;
+                    std::fill_n(bandPtr + (row * spec.cols + col) * pixelBytes,
+                                pixelBytes,
+                                0);
+                }
+            }
+        }
+    }
+    return pixels;
+}
+
+class WriteOp : public Operation
+{
+public:
+    WriteOp(const CaseSpec& spec,
+            const std::vector<nitf::Uint8>& pixels,
+            const std::string& pathname) :
+        mSpec(spec),
+        mPixels(pixels),
+        mPathname(pathname)
+    {
+    }
+
+    virtual void run()
+    {
+        nitf::Record record = makeRecord(mSpec);
+        nitf::IOHandle output(mPathname, NITF_ACCESS_WRITEONLY, NITF_CREATE);
+        nitf::Writer writer;
+        writer.prepare(output, record);
+
+        nitf::ImageWriter imageWriter = writer.newImageWriter(0);
+        if (mSpec.masked())
+            imageWriter.setWriteCaching(1);
+
+        nitf::ImageSource source;
+        for (size_t band = 0; band < mSpec.bands; ++band)
+        {
+            nitf::MemorySource bandSource(&mPixels[band * mSpec.bandBytes()],
+                                          mSpec.bandBytes(),
+                                          0,
+                                          0,
+                                          0);
+            source.addBand(bandSource);
+        }
+        imageWriter.attachSource(source);
+        writer.write();
+        output.close();
+    }
+
+private:
+    const CaseSpec& mSpec;
+    const std::vector<nitf::Uint8>& mPixels;
+    const std::string mPathname;
+};
+
+class OpenOp : public Operation
+{
+public:
+    OpenOp(const std::string& pathname) :
+        mPathname(pathname)
+    {
+    }
+
+    virtual void run()
+    {
+        nitf::IOHandle input(mPathname);
+        nitf::Reader reader;
+        reader.read(input);
+        input.close();
+    }
+
+private:
+    const std::string mPathname;
+};
+
+/*!
+ *  Reads a window of every band through one open reader.  The file is
+ *  opened once up front so only nitf_ImageReader_read is measured.  The
+ *  window is given in full resolution pixels and is read every "skip"
+ *  pixels in each direction.
+ */
+class ReadOp : public Operation
+{
+public:
+    ReadOp(const CaseSpec& spec,
+           const std::string& pathname,
+           size_t startRow,
+           size_t startCol,
+           size_t numRows,
+           size_t numCols,
+           size_t skip) :
+        mInput(pathname),
+        mRecord(mReader.read(mInput)),
+        mImageReader(mReader.newImageReader(0)),
+        mBandList(spec.bands),
+        mUser(spec.bands)
+    {
+        for (size_t band = 0; band < spec.bands; ++band)
+            mBandList[band] = static_cast<nitf::Uint32>(band);
+
+        mWindow.setStartRow(static_cast<nitf::Uint32>(startRow));
+        mWindow.setStartCol(static_cast<nitf::Uint32>(startCol));
+        // The window size is given in down-sampled pixels
+        mWindow.setNumRows(static_cast<nitf::Uint32>(numRows / skip));
+        mWindow.setNumCols(static_cast<nitf::Uint32>(numCols / skip));
+        mWindow.setBandList(&mBandList[0]);
+        mWindow.setNumBands(static_cast<nitf::Uint32>(spec.bands));
+        if (skip > 1)
+        {
+            mDownSampler.reset(new nitf::PixelSkip(
+                    static_cast<nitf::Uint32>(skip),
+                    static_cast<nitf::Uint32>(skip)));
+            mWindow.setDownSampler(mDownSampler.get());
+        }
+
+        const size_t bandBytes =
+                (numRows / skip) * (numCols / skip) * spec.bytesPerPixel();
+        mBuffer.resize(bandBytes * spec.bands);
+        for (size_t band = 0; band < spec.bands; ++band)
+            mUser[band] = &mBuffer[band * bandBytes];
+    }
+
+    ~ReadOp()
+    {
+        try
+        {
+            mInput.close();
+        }
+        catch (...)
+        {
+        }
+    }
+
+    virtual void run()
+    {
+        int padded = 0;
+        mImageReader.read(mWindow, &mUser[0], &padded);
+    }
+
+private:
+    nitf::IOHandle mInput;
+    nitf::Reader mReader;
+    nitf::Record mRecord;
+    nitf::ImageReader mImageReader;
+    nitf::SubWindow mWindow;
+    std::auto_ptr<nitf::PixelSkip> mDownSampler;
+    std::vector<nitf::Uint32> mBandList;
+    std::vector<nitf::Uint8> mBuffer;
+    std::vector<nitf::Uint8*> mUser;
+};
+
+/*!
+ *  Produces the whole file through nitf::ByteProvider and writes the
+ *  buffers out.  The pixels are converted to big endian, pixel interleaved
+ *  and blocked once beforehand since that is the caller's job.
+ */
+class ByteProviderOp : public Operation
+{
+    static const std::vector<nitf::ByteProvider::PtrAndLength> NO_DES_DATA;
+
+public:
+    ByteProviderOp(const CaseSpec& spec,
+                   const std::vector<nitf::Uint8>& pixels,
+                   const std::string& pathname) :
+        mSpec(spec),
+        mRecord(makeRecord(spec)),
+        mPathname(pathname)
+    {
+        const size_t pixelBytes = spec.bytesPerPixel();
+        std::vector<nitf::Uint8> interleaved(pixels.size());
+        for (size_t pixel = 0; pixel < spec.rows * spec.cols; ++pixel)
+        {
+            for (size_t band = 0; band < spec.bands; ++band)
+            {
+                std::copy(&pixels[band * spec.bandBytes() + pixel * pixelBytes],
+                          &pixels[band * spec.bandBytes() +
+                                  (pixel + 1) * pixelBytes],
+                          &interleaved[(pixel * spec.bands + band) *
+                                       pixelBytes]);
+            }
+        }
+        if (!sys::isBigEndianSystem())
+        {
+            const size_t elemSize =
+                    spec.pvtype == "C" ? pixelBytes / 2 : pixelBytes;
+            sys::byteSwap(&interleaved[0],
+                          static_cast<unsigned short>(elemSize),
+                          interleaved.size() / elemSize);
+        }
+
+        const nitf::ByteProvider provider(mRecord,
+                                          NO_DES_DATA,
+                                          spec.blockRows(),
+                                          spec.blockCols());
+        const std::auto_ptr<const nitf::ImageBlocker> blocker =
+                provider.getImageBlocker();
+        const size_t blockedPixelBytes = pixelBytes * spec.bands;
+        mBlocked.resize(blocker->getNumBytesRequired(0,
+                                                     spec.rows,
+                                                     blockedPixelBytes));
+        blocker->block(&interleaved[0],
+                       0,
+                       spec.rows,
+                       blockedPixelBytes,
+                       &mBlocked[0]);
+    }
+
+    virtual void run()
+    {
+        const nitf::ByteProvider provider(mRecord,
+                                          NO_DES_DATA,
+                                          mSpec.blockRows(),
+                                          mSpec.blockCols());
+        nitf::Off fileOffset(0);
+        nitf::NITFBufferList buffers;
+        provider.getBytes(&mBlocked[0], 0, mSpec.rows, fileOffset, buffers);
+
+        io::FileOutputStream output(mPathname);
+        output.seek(fileOffset, io::Seekable::START);
+        const std::vector<nitf::NITFBuffer>& toWrite(buffers.getBuffers());
+        for (size_t ii = 0; ii < toWrite.size(); ++ii)
+        {
+            output.write(static_cast<const sys::byte*>(toWrite[ii].mData),
+                         toWrite[ii].mNumBytes);
+        }
+        output.close();
+    }
+
+private:
+    const CaseSpec& mSpec;
+    nitf::Record mRecord;
+    std::vector<nitf::Uint8> mBlocked;
+    const std::string mPathname;
+};
+
+const std::vector<nitf::ByteProvider::PtrAndLength>
+ByteProviderOp::NO_DES_DATA;
+
+class Reporter
+{
+public:
+    Reporter(std::ostream& os, const std::string& format) :
+        mOS(os),
+        mCSV(format == "csv")
+    {
+        if (mCSV)
+        {
+            mOS << "case,op,status,imode,rows,cols,bands,block_rows,"
+                << "block_cols,pvtype,nbpp,compression,tres,iterations,"
+                << "seconds,bytes_per_op,mb_per_s,ops_per_s,allocs_per_op,"
+                << "alloc_bytes_per_op,note" << std::endl;
+        }
+    }
+
+    void report(const CaseSpec& spec, const Measurement& m)
+    {
+        const bool ok = m.status == "ok" && m.iterations && m.seconds > 0;
+        const double n = static_cast<double>(m.iterations);
+        std::string opsPerSec = "null";
+        std::string mbPerSec = "null";
+        std::string allocs = "null";
+        std::string allocBytes = "null";
+        std::string seconds = "null";
+        if (ok)
+        {
+            seconds = toString(m.seconds);
+            opsPerSec = toString(n / m.seconds);
+            if (m.bytesPerOp)
+                mbPerSec = toString(n * m.bytesPerOp / m.seconds / 1.0e6);
+#ifdef NITF_BENCH_COUNT_ALLOCS
+            allocs = toString(m.allocs / n);
+            allocBytes = toString(m.allocBytes / n);
+#endif
+        }
+
+        if (mCSV)
+        {
+            mOS << spec.name() << "," << m.op << "," << m.status << ","
+                << spec.imode << "," << spec.rows << "," << spec.cols << ","
+                << spec.bands << "," << spec.blockRows() << ","
+                << spec.blockCols() << "," << spec.pvtype << "," << spec.nbpp
+                << "," << spec.compression << "," << spec.numTREs << ","
+                << m.iterations << "," << csv(seconds) << ","
+                << m.bytesPerOp << "," << csv(mbPerSec) << ","
+                << csv(opsPerSec) << "," << csv(allocs) << ","
+                << csv(allocBytes) << ",\"" << escape(m.note, '"') << "\""
+                << std::endl;
+        }
+        else
+        {
+            mOS << "{\"case\":\"" << spec.name() << "\",\"op\":\"" << m.op
+                << "\",\"status\":\"" << m.status << "\",\"imode\":\""
+                << spec.imode << "\",\"rows\":" << spec.rows << ",\"cols\":"
+                << spec.cols << ",\"bands\":" << spec.bands
+                << ",\"block_rows\":" << spec.blockRows()
+                << ",\"block_cols\":" << spec.blockCols()
+                << ",\"pvtype\":\"" << spec.pvtype << "\",\"nbpp\":"
+                << spec.nbpp << ",\"compression\":\"" << spec.compression
+                << "\",\"tres\":" << spec.numTREs << ",\"iterations\":"
+                << m.iterations << ",\"seconds\":" << seconds
+                << ",\"bytes_per_op\":" << m.bytesPerOp << ",\"mb_per_s\":"
+                << mbPerSec << ",\"ops_per_s\":" << opsPerSec
+                << ",\"allocs_per_op\":" << allocs
+                << ",\"alloc_bytes_per_op\":" << allocBytes
+                << ",\"note\":\"" << escape(m.note, '\\') << "\"}"
+                << std::endl;
+        }
+    }
+
+private:
+    static std::string toString(double value)
+    {
+        char buf[64];
+        NITF_SNPRINTF(buf, sizeof(buf), "%.6g", value);
+        return buf;
+    }
+
+    static std::string csv(const std::string& value)
+    {
+        return value == "null" ? "" : value;
+    }
+
+    //! Escapes quotes (and backslashes for JSON) and flattens newlines
+    static std::string escape(const std::string& value, char escapeChar)
+    {
+        std::string escaped;
+        for (size_t ii = 0; ii < value.size(); ++ii)
+        {
+            const char ch = value[ii];
+            if (ch == '\n' || ch == '\r')
+            {
+                escaped += ' ';
+                continue;
+            }
+            if (ch == '"' || (escapeChar == '\\' && ch == '\\'))
+                escaped += escapeChar;
+            escaped += ch;
+        }
+        return escaped;
+    }
+
+    std::ostream& mOS;
+    const bool mCSV;
+};
+
+void runOp(Operation& op,
+           const std::string& name,
+           size_t bytesPerOp,
+           const CaseSpec& spec,
+           const Options& options,
+           Reporter& reporter)
+{
+    Measurement m;
+    m.op = name;
+    m.bytesPerOp = bytesPerOp;
+    try
+    {
+        measure(op, options, m);
+    }
+    catch (const except::Throwable& ex)
+    {
+        m.status = "error";
+        m.note = ex.getMessage();
+    }
+    reporter.report(spec, m);
+}
+
+void skipOp(const std::string& name,
+            const std::string& note,
+            const CaseSpec& spec,
+            Reporter& reporter)
+{
+    Measurement m;
+    m.op = name;
+    m.status = "skipped";
+    m.note = note;
+    reporter.report(spec, m);
+}
+
+void runCase(const CaseSpec& spec, const Options& options, Reporter& reporter)
+{
+    static const char* const READ_OPS[] =
+    {
+        "open", "read_full", "read_window", "read_downsample"
+    };
+    const size_t numReadOps = sizeof(READ_OPS) / sizeof(READ_OPS[0]);
+
+    const std::vector<nitf::Uint8> pixels = makePixels(spec);
+    const io::TempFile nitfFile(options.directory);
+
+    // The file the read operations use comes out of the write benchmark,
+    // so if that fails (e.g. no plugin for the compression) the rest of the
+    // case is skipped.
+    WriteOp write(spec, pixels, nitfFile.pathname());
+    Measurement written;
+    written.op = "write";
+    written.bytesPerOp = spec.imageBytes();
+    try
+    {
+        measure(write, options, written);
+    }
+    catch (const except::Throwable& ex)
+    {
+        written.status = "skipped";
+        written.note = ex.getMessage();
+    }
+    reporter.report(spec, written);
+    if (written.status != "ok")
+    {
+        for (size_t ii = 0; ii < numReadOps; ++ii)
+            skipOp(READ_OPS[ii], "write failed", spec, reporter);
+        skipOp("byte_provider", "write failed", spec, reporter);
+        return;
+    }
+
+    OpenOp open(nitfFile.pathname());
+    runOp(open, READ_OPS[0], 0, spec, options, reporter);
+
+    try
+    {
+        ReadOp readFull(spec, nitfFile.pathname(),
+                        0, 0, spec.rows, spec.cols, 1);
+        runOp(readFull, READ_OPS[1], spec.imageBytes(),
+              spec, options, reporter);
+
+        // A centered quarter-size window, which straddles blocks
+        const size_t windowRows = std::max<size_t>(spec.rows / 4, 1);
+        const size_t windowCols = std::max<size_t>(spec.cols / 4, 1);
+        ReadOp readWindow(spec, nitfFile.pathname(),
+                          (spec.rows - windowRows) / 2,
+                          (spec.cols - windowCols) / 2,
+                          windowRows, windowCols, 1);
+        runOp(readWindow, READ_OPS[2],
+              windowRows * windowCols * spec.bytesPerPixel() * spec.bands,
+              spec, options, reporter);
+
+        const size_t skip = 4;
+        const size_t skipRows = spec.rows - spec.rows % skip;
+        const size_t skipCols = spec.cols - spec.cols % skip;
+        ReadOp readDownsample(spec, nitfFile.pathname(),
+                              0, 0, skipRows, skipCols, skip);
+        runOp(readDownsample, READ_OPS[3],
+              skipRows * skipCols * spec.bytesPerPixel() * spec.bands,
+              spec, options, reporter);
+    }
+    catch (const except::Throwable& ex)
+    {
+        skipOp("read", ex.getMessage(), spec, reporter);
+    }
+
+    // ByteProvider hands back the caller's bytes verbatim, which only
+    // matches the file layout for uncompressed, unmasked, pixel interleaved
+    // (or single band) images with whole bytes per pixel.
+    if (spec.compression != "NC")
+    {
+        skipOp("byte_provider", "compressed or masked", spec, reporter);
+    }
+    else if (spec.nbpp % 8)
+    {
+        skipOp("byte_provider", "packed pixels", spec, reporter);
+    }
+    else if (spec.bands > 1 && spec.imode != "P")
+    {
+        skipOp("byte_provider", "needs IMODE P", spec, reporter);
+    }
+    else
+    {
+        const io::TempFile providerFile(options.directory);
+        ByteProviderOp provide(spec, pixels, providerFile.pathname());
+        runOp(provide, "byte_provider", spec.imageBytes(),
+              spec, options, reporter);
+    }
+}
+
+std::vector<CaseSpec> makeCases(const Options& options)
+{
+    struct PixelType
+    {
+        const char* pvtype;
+        size_t nbpp;
+    };
+    static const PixelType PIXEL_TYPES[] =
+    {
+        { "INT", 8 }, { "INT", 12 }, { "INT", 16 }, { "SI", 16 },
+        { "R", 32 }, { "C", 64 }
+    };
+    static const char* const IMODES[] = { "B", "P", "R", "S" };
+    const size_t numPixelTypes = sizeof(PIXEL_TYPES) / sizeof(PIXEL_TYPES[0]);
+    const size_t numModes = sizeof(IMODES) / sizeof(IMODES[0]);
+
+    CaseSpec base;
+    base.rows = options.rows;
+    base.cols = options.cols;
+    base.bands = options.bands;
+    base.blockSize = 0;
+    base.pvtype = "INT";
+    base.nbpp = 8;
+    base.compression = "NC";
+    base.numTREs = 0;
+
+    std::vector<CaseSpec> cases;
+    for (size_t mode = 0; mode < numModes; ++mode)
+    {
+        CaseSpec spec(base);
+        spec.imode = IMODES[mode];
+        for (size_t ii = 0; ii < numPixelTypes; ++ii)
+        {
+            // The 12 bit pixel packing doesn't handle IMODE S
+            if (PIXEL_TYPES[ii].nbpp % 8 && spec.imode == "S")
+                continue;
+
+            spec.pvtype = PIXEL_TYPES[ii].pvtype;
+            spec.nbpp = PIXEL_TYPES[ii].nbpp;
+
+            spec.blockSize = 0;
+            spec.compression = "NC";
+            cases.push_back(spec);
+
+            spec.blockSize = options.blockSize;
+            cases.push_back(spec);
+
+            // Masks only have something to do when there are blocks, and
+            // the writer doesn't support them with IMODE S
+            if (PIXEL_TYPES[ii].nbpp <= 16 && spec.imode != "S")
+            {
+                spec.compression = "NM";
+                cases.push_back(spec);
+            }
+        }
+    }
+
+    // Compression goes through the plugins, so these are skipped when the
+    // JPEG or JPEG 2000 plugin isn't available.  JPEG packs all the bands
+    // into one block except with IMODE S.
+    static const char* const COMPRESSIONS[][2] =
+    {
+        { "C3", "B" }, { "C3", "P" }, { "C3", "S" }, { "M3", "B" },
+        { "C8", "B" }
+    };
+    const size_t numCompressions =
+            sizeof(COMPRESSIONS) / sizeof(COMPRESSIONS[0]);
+    for (size_t ii = 0; ii < numCompressions; ++ii)
+    {
+        CaseSpec compressed(base);
+        compressed.compression = COMPRESSIONS[ii][0];
+        compressed.imode = COMPRESSIONS[ii][1];
+        compressed.blockSize = options.blockSize;
+        cases.push_back(compressed);
+    }
+
+    // A small image with a large extended header section, for open cost
+    CaseSpec tres(base);
+    tres.imode = "B";
+    tres.rows = tres.cols = 64;
+    tres.bands = 1;
+    tres.numTREs = options.numTREs;
+    cases.push_back(tres);
+
+    std::vector<CaseSpec> selected;
+    for (size_t ii = 0; ii < cases.size(); ++ii)
+    {
+        if (options.filter.empty() ||
+            cases[ii].name().find(options.filter) != std::string::npos)
+        {
+            selected.push_back(cases[ii]);
+        }
+    }
+    return selected;
+}
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        cli::ArgumentParser parser;
+        parser.setDescription(
+                "Synthesize NITFs across image modes, blocking, pixel types, "
+                "masks and compression and time reads and writes of them. "
+                "Results are written one per line as JSON (or CSV).");
+        parser.addArgument("-r --rows", "Image rows", cli::STORE,
+                           "rows", "ROWS")->setDefault(1024);
+        parser.addArgument("-c --cols", "Image columns", cli::STORE,
+                           "cols", "COLS")->setDefault(1024);
+        parser.addArgument("-b --bands", "Bands per image", cli::STORE,
+                           "bands", "BANDS")->setDefault(3);
+        parser.addArgument("--block", "Block size of the blocked cases",
+                           cli::STORE, "block", "SIZE")->setDefault(256);
+        parser.addArgument("--tres", "TREs in the TRE-heavy case",
+                           cli::STORE, "tres", "NUM")->setDefault(1000);
+        parser.addArgument("-i --iterations",
+                           "Minimum timed iterations per operation",
+                           cli::STORE, "iterations", "NUM")->setDefault(3);
+        parser.addArgument("-t --time",
+                           "Minimum seconds to time each operation for",
+                           cli::STORE, "time", "SECONDS")->setDefault(0.5);
+        parser.addArgument("-f --filter",
+                           "Only run cases whose name contains this",
+                           cli::STORE, "filter", "TEXT")->setDefault("");
+        parser.addArgument("--format", "Output format", cli::STORE,
+                           "format", "FORMAT")->addChoice("json")
+                ->addChoice("csv")->setDefault("json");
+        parser.addArgument("-d --dir", "Directory for the scratch NITFs",
+                           cli::STORE, "dir", "DIR")->setDefault(".");
+        parser.addArgument("-o --output", "Results file (default stdout)",
+                           cli::STORE, "output", "FILE")->setDefault("");
+        parser.addArgument("-p --plugins",
+                           "Plugin directories to load besides "
+                           "NITF_PLUGIN_PATH",
+                           cli::STORE, "plugins", "DIR", 1, -1);
+
+        const std::auto_ptr<cli::Results>
+                results(parser.parse(argc, argv));
+
+        Options options;
+        options.rows = results->get<size_t>("rows");
+        options.cols = results->get<size_t>("cols");
+        options.bands = results->get<size_t>("bands");
+        options.blockSize = results->get<size_t>("block");
+        options.numTREs = results->get<size_t>("tres");
+        options.minIterations = results->get<size_t>("iterations");
+        options.minSeconds = results->get<double>("time");
+        options.filter = results->get<std::string>("filter");
+        options.format = results->get<std::string>("format");
+        options.directory = results->get<std::string>("dir");
+        const std::string outputPathname = results->get<std::string>("output");
+
+        if (!options.rows || !options.cols || !options.bands ||
+            !options.blockSize || !options.minIterations)
+        {
+            throw except::Exception(Ctxt(
+                    "rows, cols, bands, block and iterations must be > 0"));
+        }
+
+        std::ofstream outputFile;
+        if (!outputPathname.empty())
+        {
+            outputFile.open(outputPathname.c_str());
+            if (!outputFile)
+            {
+                throw except::Exception(Ctxt(
+                        "Unable to open " + outputPathname));
+            }
+        }
+        Reporter reporter(outputPathname.empty() ? std::cout : outputFile,
+                          options.format);
+
+        if (results->hasValue("plugins"))
+        {
+            const cli::Value* const plugins = results->getValue("plugins");
+            for (size_t ii = 0; ii < plugins->size(); ++ii)
+            {
+                nitf::PluginRegistry::loadDir(
+                        plugins->get<std::string>(ii));
+            }
+        }
+
+        const std::vector<CaseSpec> cases = makeCases(options);
+        for (size_t ii = 0; ii < cases.size(); ++ii)
+            runCase(cases[ii], options, reporter);
+
+        return 0;
+    }
+    catch (const except::Throwable& t)
+    {
+        std::cerr << t.toString() << std::endl;
+    }
+    catch (...)
+    {
+        std::cerr << "An unknown exception occured" << std::endl;
+    }
+    return 1;
+}
@@ -57,6 +57,7 @@
 #include "nitf/List.hpp"
 #include "nitf/LookupTable.hpp"
 #include "nitf/MemoryIO.hpp"
+#include "nitf/MMapIO.hpp"
 #include "nitf/NITFException.hpp"
 #include "nitf/Object.hpp"
 #include "nitf/Pair.hpp"
@@ -64,6 +65,7 @@
 #include "nitf/RESegment.hpp"
 #include "nitf/RESubheader.hpp"
 #include "nitf/Reader.hpp"
+#include "nitf/ReaderOptions.hpp"
 #include "nitf/Record.hpp"
 #include "nitf/SegmentReader.hpp"
 #include "nitf/SegmentSource.hpp"
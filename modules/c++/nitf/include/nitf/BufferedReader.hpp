@@ -23,7 +23,14 @@
 #ifndef __NITF_BUFFERED_READER_HPP__
 #define __NITF_BUFFERED_READER_HPP__
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
 #include <nitf/CustomIO.hpp>
 
@@ -62,28 +69,43 @@ public:
                    size_t size,
                    bool adopt = false);
 
+    /*
+     *  \func Constructor
+     *  \brief Sets up a BufferedReader that reads ahead.
+     *
+     *  With more than one buffer, a background thread reads the chunks
+     *  following the one being consumed so that the next chunk is usually
+     *  already in memory when it's needed.  Chunks are aligned to multiples
+     *  of 'bufferSize' in the file.  About half of the buffers are used for
+     *  read-ahead; the rest hold recently read chunks so that seeking back
+     *  into them doesn't touch the file.
+     *
+     *  \param pathname The input pathname to read from.
+     *  \param bufferSize The size of each chunk that should be read.
+     *  \param numBuffers The number of chunks to hold in memory.  With one
+     *  buffer, this behaves the same as the other constructors.
+     */
+    BufferedReader(const std::string& pathname,
+                   size_t bufferSize,
+                   size_t numBuffers);
+
     virtual ~BufferedReader();
 
-    size_t getTotalRead() const
-    {
-        return mTotalRead;
-    }
+    size_t getTotalRead() const;
 
-    size_t getNumBlocksRead() const
-    {
-        return mBlocksRead;
-    }
+    size_t getNumBlocksRead() const;
 
-    size_t getNumPartialBlocksRead() const
-    {
-        return mPartialBlocks;
-    }
+    size_t getNumPartialBlocksRead() const;
 
     //! Time spent reading
-    double getTotalWriteTime()
-    {
-        return mElapsedTime;
-    }
+    double getTotalWriteTime() const;
+
+    /*!
+     * Time in seconds the caller spent waiting on the file.  With one
+     * buffer this is the same as the read time; when reading ahead it's
+     * only the time spent waiting for a chunk that wasn't in memory yet.
+     */
+    double getTotalStallTime() const;
 
 protected:
 
@@ -104,8 +126,51 @@ protected:
     virtual void closeImpl();
 
 private:
+    class PrefetchThread;
+
+    //! A chunk of the file held in one of the read-ahead buffers
+    struct Chunk
+    {
+        enum State
+        {
+            EMPTY,
+            PENDING,
+            READY,
+            FAILED
+        };
+
+        State state;
+        size_t index;
+        size_t size;
+        size_t lastUsed;
+        std::string error;
+    };
+
     void readNextBuffer();
 
+    bool isAsync() const
+    {
+        return (mChunks.size() > 1);
+    }
+
+    size_t getChunkSize(size_t index) const;
+
+    size_t findChunk(size_t index) const;
+
+    size_t findFreeChunk(size_t firstIndex, size_t lastIndex) const;
+
+    void requestChunk(size_t chunk, size_t index);
+
+    void prefetch(size_t index);
+
+    void dropRequests(size_t firstIndex, size_t lastIndex);
+
+    void useChunk(size_t index);
+
+    void stopThread();
+
+    void runPrefetchThread();
+
     const size_t mMaxBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
     char* const mBuffer;
@@ -116,8 +181,23 @@ private:
     size_t mBlocksRead;
     size_t mPartialBlocks;
     double mElapsedTime;
+    double mStallTime;
     mutable sys::File mFile;
     const sys::Off_T mFileLen;
+
+    // Read-ahead state, only used with multiple buffers.  mChunks and
+    // mRequests are shared with the prefetch thread and guarded by mMutex;
+    // a chunk's memory belongs to the thread while it's PENDING.
+    std::vector<Chunk> mChunks;
+    std::deque<size_t> mRequests;
+    size_t mNumReadAhead;
+    size_t mCurrentChunk;
+    size_t mUseCount;
+    nitf::Uint64 mOffset;
+    bool mStop;
+    mutable sys::Mutex mMutex;
+    sys::ConditionVar mCondition;
+    std::auto_ptr<sys::Thread> mThread;
 };
 
 }
@@ -23,7 +23,14 @@
 #ifndef __NITF_BUFFERED_WRITER_HPP__
 #define __NITF_BUFFERED_WRITER_HPP__
 
+#include <deque>
+#include <memory>
+#include <vector>
+
 #include <sys/File.h>
+#include <sys/Mutex.h>
+#include <sys/ConditionVar.h>
+#include <sys/Thread.h>
 #include <mem/ScopedArray.h>
 #include <nitf/CustomIO.hpp>
 
@@ -32,6 +39,19 @@ namespace nitf
 class BufferedWriter : public CustomIO
 {
 public:
+    //! When to force written data out to disk via fsync()
+    enum SyncPolicy
+    {
+        //! Leave it up to the OS
+        SYNC_NEVER,
+
+        //! Once when the file is closed
+        SYNC_ON_CLOSE,
+
+        //! After every buffer is written
+        SYNC_EVERY_BUFFER
+    };
+
     BufferedWriter(const std::string& file, size_t bufferSize);
 
     BufferedWriter(const std::string& file,
@@ -39,30 +59,52 @@ public:
                    size_t size,
                    bool adopt = false);
 
+    /*!
+     * Buffers writes across 'numBuffers' buffers.  With more than one
+     * buffer, full buffers are handed to a background thread which writes
+     * them to disk while the caller keeps filling the next one, so the
+     * caller only waits on the disk if every buffer is full.
+     *
+     * \param file The pathname of the file to write
+     * \param bufferSize The size of each buffer in bytes
+     * \param numBuffers The number of buffers.  With one buffer, writes
+     * happen on the calling thread just like the other constructors.
+     * \param syncPolicy When to fsync() the file
+     * \param directIO Whether to bypass the OS page cache (O_DIRECT).  Only
+     * writes of whole buffers at offsets that are a multiple of
+     * DIRECT_IO_ALIGNMENT go through uncached, so 'bufferSize' should be a
+     * multiple of it.  Ignored where O_DIRECT is unavailable or the
+     * filesystem doesn't support it.
+     */
+    BufferedWriter(const std::string& file,
+                   size_t bufferSize,
+                   size_t numBuffers,
+                   SyncPolicy syncPolicy = SYNC_ON_CLOSE,
+                   bool directIO = false);
+
     virtual ~BufferedWriter();
 
     void flushBuffer();
 
-    nitf::Uint64 getTotalWritten() const
-    {
-        return mTotalWritten;
-    }
+    nitf::Uint64 getTotalWritten() const;
 
-    nitf::Uint64 getNumBlocksWritten() const
-    {
-        return mBlocksWritten;
-    }
+    nitf::Uint64 getNumBlocksWritten() const;
 
-    nitf::Uint64 getNumPartialBlocksWritten() const
-    {
-        return mPartialBlocks;
-    }
+    nitf::Uint64 getNumPartialBlocksWritten() const;
 
     //! Time spent writing to disk in seconds
-    double getTotalWriteTime()
-    {
-        return mElapsedTime;
-    }
+    double getTotalWriteTime() const;
+
+    /*!
+     * Time in seconds the caller spent blocked on disk writes.  With a
+     * single buffer this is the same as the write time; with multiple
+     * buffers it's only the time spent waiting for a free buffer (or for
+     * pending writes to finish before a seek or close).
+     */
+    double getTotalStallTime() const;
+
+    //! Alignment of buffers and offsets needed for direct I/O
+    static const size_t DIRECT_IO_ALIGNMENT = 4096;
 
 protected:
 
@@ -83,21 +125,67 @@ protected:
     virtual void closeImpl();
 
 private:
+    class FlushThread;
+
     const size_t mBufferSize;
     const mem::ScopedArray<char> mScopedBuffer;
-    char* const mBuffer;
+    char* mBuffer;
 
     nitf::Uint64 mPosition;
     nitf::Uint64 mTotalWritten;
     nitf::Uint64 mBlocksWritten;
     nitf::Uint64 mPartialBlocks;
     double mElapsedTime;
+    double mStallTime;
+
+    const SyncPolicy mSyncPolicy;
+
+    // A second descriptor for the file, opened with O_DIRECT, that the
+    // aligned writes go through; -1 when not doing direct I/O
+    int mDirectHandle;
+
+    // Buffers we allocated ourselves.  With more than one, the rest of
+    // these are used to hand them off to the flush thread, and everything
+    // the flush thread touches is guarded by mMutex.
+    std::vector<char*> mBuffers;
+    std::vector<size_t> mBufferLengths;
+    std::vector<char*> mFreeBuffers;
+    std::deque<size_t> mFullBuffers;
+    bool mWriting;
+    bool mStop;
+    std::string mWriteError;
+    nitf::Uint64 mOffset;
+    mutable sys::Mutex mMutex;
+    mutable sys::ConditionVar mCondition;
 
     // NOTE: This is at the end to give us a chance to adopt the buffer
     //       in ScopedArray in case sys::File's constructor throws
     mutable sys::File mFile;
 
+    std::auto_ptr<sys::Thread> mThread;
+
+    bool isAsync() const
+    {
+        return (mBuffers.size() > 1);
+    }
+
     void flushBuffer(const char* buf);
+
+    void writeToFile(const char* buf, size_t size);
+
+    void closeDirectHandle();
+
+    void recordWrite(size_t size, double elapsedTime);
+
+    void submitBuffer();
+
+    void waitForWrites() const;
+
+    void checkWriteError() const;
+
+    void stopThread();
+
+    void runFlushThread();
 };
 
 }
@@ -23,6 +23,7 @@
 #ifndef __NITF_CUSTOM_IO_HPP__
 #define __NITF_CUSTOM_IO_HPP__
 
+#include <sys/Mutex.h>
 #include <nitf/IOInterface.hpp>
 
 namespace nitf
@@ -35,8 +36,24 @@ public:
     virtual ~CustomIO();
 
 protected:
+    /*!
+     *  \param positionalReads  Whether readAtImpl() reads without moving
+     *  the current position, so canReadAt() reports true and the library
+     *  may read concurrently.  Pass true only when readAtImpl() is
+     *  overridden to do so.
+     */
+    explicit CustomIO(bool positionalReads);
+
     virtual void readImpl(void* buf, size_t size) = 0;
 
+    /*!
+     *  Reads size bytes starting at offset.  With positionalReads this may
+     *  be called from several threads at once.  The default implementation
+     *  seeks, then reads, holding a lock so concurrent readAt calls do not
+     *  interleave (the current position is moved).
+     */
+    virtual void readAtImpl(nitf::Off offset, void* buf, size_t size);
+
     virtual void writeImpl(const void* buf, size_t size) = 0;
 
     virtual bool canSeekImpl() const = 0;
@@ -53,11 +70,15 @@ protected:
 
 private:
     static
-    nitf_IOInterface* createInterface(CustomIO* me);
+    nitf_IOInterface* createInterface(CustomIO* me, bool positionalReads);
 
     static
     NRT_BOOL adapterRead(NRT_DATA* data, void* buf, size_t size, nrt_Error* error);
 
+    static
+    NRT_BOOL adapterReadAt(NRT_DATA* data, nrt_Off offset, void* buf,
+                           size_t size, nrt_Error* error);
+
     static
     NRT_BOOL adapterWrite(NRT_DATA* data, const void* buf, size_t size, nrt_Error* error);
 
@@ -81,6 +102,8 @@ private:
 
     static
     void adapterDestruct(NRT_DATA* data);
+
+    sys::Mutex mReadAtMutex;
 };
 }
 
@@ -74,6 +74,16 @@ public:
 
     void read(void* buf, size_t size);
 
+    /*!
+     *  Reads size bytes starting at offset.  When the underlying interface
+     *  supports positional reads, the current position is left untouched
+     *  and concurrent calls are safe; otherwise this seeks, then reads.
+     */
+    void readAt(nitf::Off offset, void* buf, size_t size);
+
+    //! Does the underlying interface support positional reads natively?
+    bool canReadAt() const;
+
     void write(const void* buf, size_t size);
 
     bool canSeek() const;
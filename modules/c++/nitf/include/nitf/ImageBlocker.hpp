@@ -138,6 +138,53 @@ public:
         block(input, startRow, numRows, sizeof(DataT), output);
     }
 
+    /*!
+     * Same as above, but spreads the blocks across threads.  Each thread
+     * handles a contiguous run of blocks (in the row-major order they are
+     * laid out in 'output').
+     *
+     * \param input Input image of size 'numRows' x numCols (from constructor)
+     * \param startRow Start row in the global image that 'input' points to.
+     * This must start on a block boundary (within a segment).
+     * \param numRows Number of rows.  This must be a multiple of the block size
+     * unless it's at the end of a segment.
+     * \param numBytesPerPixel Number of bytes per pixel of 'input'
+     * \param numThreads Number of threads to use.  If 0, uses the number of
+     * CPUs.
+     * \param[out] output Blocked representation of 'input', including pad rows
+     * and columns
+     */
+    void block(const void* input,
+               size_t startRow,
+               size_t numRows,
+               size_t numBytesPerPixel,
+               size_t numThreads,
+               void* output) const;
+
+    /*!
+     * Same as above, but writes each block into its own buffer rather than
+     * one contiguous output.
+     *
+     * \param input Input image of size 'numRows' x numCols (from constructor)
+     * \param startRow Start row in the global image that 'input' points to.
+     * This must start on a block boundary (within a segment).
+     * \param numRows Number of rows.  This must be a multiple of the block size
+     * unless it's at the end of a segment.
+     * \param numBytesPerPixel Number of bytes per pixel of 'input'
+     * \param numThreads Number of threads to use.  If 0, uses the number of
+     * CPUs.
+     * \param[out] blockOutputs One buffer per block in the AOI, in row-major
+     * block order (getNumColsOfBlocks() per row of blocks).  Each must hold
+     * a full block (rows per block of the segment x getNumColsPerBlock()
+     * pixels), including pad rows and columns.
+     */
+    void block(const void* input,
+               size_t startRow,
+               size_t numRows,
+               size_t numBytesPerPixel,
+               size_t numThreads,
+               const std::vector<void*>& blockOutputs) const;
+
     /*!
      * \param input Input image of width 'numCols'
      * \param numBytesPerPixel Number of bytes/pixel in 'input' and 'output'
@@ -264,23 +311,28 @@ private:
                           size_t& lastSegIdx,
                           size_t& lastBlockWithinLastSeg) const;
 
-    void blockImpl(size_t seg,
-                   const sys::byte* input,
-                   size_t numValidRowsInBlock,
-                   size_t numValidColsInBlock,
-                   size_t numBytesPerPixel,
-                   sys::byte* output) const
+    //! A row of blocks within the AOI being blocked
+    struct RowOfBlocks
     {
-        block(input, numBytesPerPixel, mNumCols, mNumRowsPerBlock[seg],
-              mNumColsPerBlock, numValidRowsInBlock, numValidColsInBlock,
-              output);
-    }
+        size_t numRowsPerBlock;
+        size_t numValidRowsInBlock;
+        const sys::byte* input;
+        sys::byte* output;
+    };
 
-    void blockAcrossRow(size_t seg,
-                        const sys::byte*& input,
-                        size_t numValidRowsInBlock,
-                        size_t numBytesPerPixel,
-                        sys::byte*& output) const;
+    class BlockOp;
+
+    void findRowsOfBlocks(const void* input,
+                          size_t startRow,
+                          size_t numRows,
+                          size_t numBytesPerPixel,
+                          void* output,
+                          std::vector<RowOfBlocks>& rowsOfBlocks) const;
+
+    void blockImpl(const std::vector<RowOfBlocks>& rowsOfBlocks,
+                   size_t numBytesPerPixel,
+                   size_t numThreads,
+                   const std::vector<void*>* blockOutputs) const;
 
 private:
     // Vectors all indexed by segment
@@ -59,6 +59,8 @@ public:
 
     /*!
      *  Read a sub-window.  See ImageIO::read for more details.
+     *  Several threads may read disjoint or overlapping sub-windows through
+     *  the same ImageReader concurrently.
      *  \param  subWindow  The sub-window to read
      *  \param  user  User-defined data buffers for read
      *  \param  padded  Returns TRUE if pad pixels may have been read
@@ -71,6 +73,9 @@ public:
      *  \param blockSize  Returns block size
      *  \return The read block 
      *          (something must be done with buffer before next call)
+     *
+     *  With an MMapIO input, uncompressed blocks point straight into the
+     *  mapping and stay valid for the life of the MMapIO.
      */
     const nitf::Uint8* readBlock(nitf::Uint32 blockNumber, 
                                  nitf::Uint64* blockSize);
@@ -78,6 +83,30 @@ public:
     //!  Set read caching
     void setReadCaching();
 
+    /*!
+     *  Enable read caching with an LRU block cache bounded to maxBytes.
+     *  A budget of zero keeps a single block.
+     *  \param maxBytes  Cache budget in bytes
+     */
+    void setReadCaching(nitf::Uint64 maxBytes);
+
+    /*!
+     *  Decode power of two pixel skip reads at a reduced resolution, when
+     *  the decompressor supports it.  Off by default, since the result is
+     *  filtered rather than an exact skip.
+     *  \param enable  Enable reduced resolution reads
+     */
+    void setReducedResolution(bool enable);
+
+    //! Number of block requests satisfied from the read cache
+    nitf::Uint64 getReadCacheHits();
+
+    //! Number of block requests that read or decompressed a block
+    nitf::Uint64 getReadCacheMisses();
+
+    //! Number of bytes currently held by the read cache
+    nitf::Uint64 getReadCacheBytes();
+
 private:
     nitf_Error error;
     ImageReader(){}
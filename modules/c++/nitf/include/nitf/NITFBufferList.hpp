@@ -1,168 +1,256 @@
-/* =========================================================================
- * This file is part of NITRO
- * =========================================================================
- *
- * (C) Copyright 2004 - 2017, MDA Information Systems LLC
- *
- * NITRO is free software; you can redistribute it and/or modify
- * it under the terms of the GNU Lesser General Public License as published by
- * the Free Software Foundation; either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU Lesser General Public License for more details.
- *
- * You should have received a copy of the GNU Lesser General Public
- * License along with this program; if not, If not,
- * see <http://www.gnu.org/licenses/>.
- *
- */
-
-#ifndef __NITF_BUFFER_LIST_HPP__
-#define __NITF_BUFFER_LIST_HPP__
-
-#include <stddef.h>
-#include <vector>
-
-#include <sys/Conf.h>
-
-namespace nitf
-{
-/*!
- * \class NITFBuffer
- * \brief Represents a pointer to raw NITF bytes and its length
- */
-struct NITFBuffer
-{
-    /*!
-     * Initializes to an empty buffer
-     */
-    NITFBuffer();
-
-    /*!
-     * Initializes to the specified pointer and size.  No copy is made and
-     * this object does not take ownership.
-     *
-     * \param data The raw bytes of data
-     * \param numBytes The number of bytes of contiguous data this
-     * represents
-     */
-    NITFBuffer(const void* data, size_t numBytes);
-
-    const void* mData;
-    size_t mNumBytes;
-};
-
-/*!
- * \class NITFBufferList
- * \brief Represents a sequence of buffers which appear in contiguous order
- * in the NITF (the underlying pointers are not contiguous)
- */
-struct NITFBufferList
-{
-    //! The buffers
-    std::vector<NITFBuffer> mBuffers;
-
-    /*!
-     * \return The total number of bytes across all the buffers
-     */
-    size_t getTotalNumBytes() const;
-
-    /*!
-     * \return Whether or not the buffer list is empty
-     */
-    bool empty() const
-    {
-        return mBuffers.empty();
-    }
-
-    /*!
-     * Clear the buffers
-     */
-    void clear()
-    {
-        mBuffers.clear();
-    }
-
-    /*!
-     * Push data onto the buffer list
-     *
-     * \param data The raw bytes
-     * \param numBytes The number of bytes of data
-     */
-    void pushBack(const void* data, size_t numBytes)
-    {
-        mBuffers.push_back(NITFBuffer(data, numBytes));
-    }
-
-    /*!
-     * Push data onto the buffer list
-     *
-     * \tparam DataT The type of data
-     *
-     * \param data The raw bytes
-     */
-    template <typename DataT>
-    void pushBack(const std::vector<DataT>& data)
-    {
-        pushBack(data.empty() ? NULL : &data[0],
-                 data.size() * sizeof(DataT));
-    }
-
-    /*!
-     * Get the number of blocks of data of size 'blockSize'.  In cases
-     * where the block size is not an even multiple of the total number of
-     * bytes, the last block will be larger than the block size (rather
-     * than there being one more block which is smaller than the block
-     * size).  This is intentional in order to make this easily usable with
-     * Amazon's S3 storage with multipart uploads where there is a minimum
-     * part size (there may be multiple machines, all with their portion
-     * of the SICD, performing a multipart upload of their parts, and
-     * only the last overall part of the object can be less than the
-     * minimum part size).
-     *
-     * \param blockSize The desired block size
-     *
-     * \return The associated number of blocks
-     */
-    size_t getNumBlocks(size_t blockSize) const;
-
-    /*!
-     * Get the number of bytes in the specified block.  All blocks will be
-     * the same size except for the last block (see getNumBlocks() for
-     * details).
-     *
-     * \param blockSize The desired block size
-     * \param blockIdx The 0-based block index
-     *
-     * \return The number of bytes in this block
-     */
-    size_t getNumBytesInBlock(size_t blockSize, size_t blockIdx) const;
-
-    /*!
-     * Returns a pointer to contiguous memory associated with the desired
-     * block.  If this block lies entirely within a NITFBuffer, no copy
-     * is performed.  Otherwise, the scratch buffer is resized, the bytes
-     * are copied into this, and a pointer to the scratch buffer is
-     * returned.
-     *
-     * \param blockSize The desired block size.  See getNumBlocks() for a
-     * description on the behavior of the last block.
-     * \param blockIdx The 0-based block index
-     * \param[out] scratch Scratch buffer.  This will be resized and used
-     * if the underlying memory for this block is not contiguous (i.e. it
-     * spans NITFBuffers).
-     * \param[out] numBytes The number of bytes in this block
-     *
-     * \return A pointer to contiguous memory associated with this block
-     */
-    const void* getBlock(size_t blockSize,
-                         size_t blockIdx,
-                         std::vector<sys::byte>& scratch,
-                         size_t& numBytes) const;
-};
-}
-
-#endif
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_BUFFER_LIST_HPP__
+#define __NITF_BUFFER_LIST_HPP__
+
+#include <stddef.h>
+#include <vector>
+
+#include <sys/Conf.h>
+
+namespace nitf
+{
+/*!
+ * \class NITFBuffer
+ * \brief Represents a pointer to raw NITF bytes and its length
+ */
+struct NITFBuffer
+{
+    /*!
+     * Initializes to an empty buffer
+     */
+    NITFBuffer();
+
+    /*!
+     * Initializes to the specified pointer and size.  No copy is made and
+     * this object does not take ownership.
+     *
+     * \param data The raw bytes of data
+     * \param numBytes The number of bytes of contiguous data this
+     * represents
+     */
+    NITFBuffer(const void* data, size_t numBytes);
+
+    const void* mData;
+    size_t mNumBytes;
+};
+
+/*!
+ * \class NITFBufferList
+ * \brief Represents a sequence of buffers which appear in contiguous order
+ * in the NITF (the underlying pointers are not contiguous)
+ *
+ * A running byte offset is kept alongside the buffers so that block lookups
+ * are a binary search rather than a scan.  The buffers can only be changed
+ * through pushBack() and clear(), which keep the offsets current.
+ */
+class NITFBufferList
+{
+public:
+    NITFBufferList() :
+        mOffsets(1, 0)
+    {
+    }
+
+    /*!
+     * \return The buffers, in order
+     */
+    const std::vector<NITFBuffer>& getBuffers() const
+    {
+        return mBuffers;
+    }
+
+    /*!
+     * \return The total number of bytes across all the buffers
+     */
+    size_t getTotalNumBytes() const;
+
+    /*!
+     * \return Whether or not the buffer list is empty
+     */
+    bool empty() const
+    {
+        return mBuffers.empty();
+    }
+
+    /*!
+     * Clear the buffers
+     */
+    void clear()
+    {
+        mBuffers.clear();
+        mOffsets.assign(1, 0);
+    }
+
+    /*!
+     * Push data onto the buffer list
+     *
+     * \param data The raw bytes
+     * \param numBytes The number of bytes of data
+     */
+    void pushBack(const void* data, size_t numBytes)
+    {
+        mBuffers.push_back(NITFBuffer(data, numBytes));
+        mOffsets.push_back(mOffsets.back() + numBytes);
+    }
+
+    /*!
+     * Push data onto the buffer list
+     *
+     * \tparam DataT The type of data
+     *
+     * \param data The raw bytes
+     */
+    template <typename DataT>
+    void pushBack(const std::vector<DataT>& data)
+    {
+        pushBack(data.empty() ? NULL : &data[0],
+                 data.size() * sizeof(DataT));
+    }
+
+    /*!
+     * Get the number of blocks of data of size 'blockSize'.  In cases
+     * where the block size is not an even multiple of the total number of
+     * bytes, the last block will be larger than the block size (rather
+     * than there being one more block which is smaller than the block
+     * size).  This is intentional in order to make this easily usable with
+     * Amazon's S3 storage with multipart uploads where there is a minimum
+     * part size (there may be multiple machines, all with their portion
+     * of the SICD, performing a multipart upload of their parts, and
+     * only the last overall part of the object can be less than the
+     * minimum part size).
+     *
+     * \param blockSize The desired block size
+     *
+     * \return The associated number of blocks
+     */
+    size_t getNumBlocks(size_t blockSize) const;
+
+    /*!
+     * Get the number of bytes in the specified block.  All blocks will be
+     * the same size except for the last block (see getNumBlocks() for
+     * details).
+     *
+     * \param blockSize The desired block size
+     * \param blockIdx The 0-based block index
+     *
+     * \return The number of bytes in this block
+     */
+    size_t getNumBytesInBlock(size_t blockSize, size_t blockIdx) const;
+
+    /*!
+     * Returns a pointer to contiguous memory associated with the desired
+     * block.  If this block lies entirely within a NITFBuffer, no copy
+     * is performed.  Otherwise, the scratch buffer is resized, the bytes
+     * are copied into this, and a pointer to the scratch buffer is
+     * returned.
+     *
+     * \param blockSize The desired block size.  See getNumBlocks() for a
+     * description on the behavior of the last block.
+     * \param blockIdx The 0-based block index
+     * \param[out] scratch Scratch buffer.  This will be resized and used
+     * if the underlying memory for this block is not contiguous (i.e. it
+     * spans NITFBuffers).
+     * \param[out] numBytes The number of bytes in this block
+     *
+     * \return A pointer to contiguous memory associated with this block
+     */
+    const void* getBlock(size_t blockSize,
+                         size_t blockIdx,
+                         std::vector<sys::byte>& scratch,
+                         size_t& numBytes) const;
+
+private:
+    std::vector<NITFBuffer> mBuffers;
+
+    /*
+     * Byte offset of the start of each buffer, plus one trailing entry
+     * holding the total number of bytes
+     */
+    std::vector<size_t> mOffsets;
+};
+
+/*!
+ * \class NITFBlockIterator
+ * \brief Walks the blocks of a NITFBufferList in order
+ *
+ * This produces the same blocks as NITFBufferList::getBlock() but visits
+ * each buffer only once, so iterating all blocks is linear in the number of
+ * buffers plus the number of blocks.  Blocks that lie within one buffer are
+ * returned in place; only blocks that span buffers are copied into the
+ * iterator's scratch space.  The buffer list must outlive the iterator and
+ * not be modified while iterating.
+ */
+class NITFBlockIterator
+{
+public:
+    /*!
+     * \param bufferList The buffers to iterate over
+     * \param blockSize The desired block size.  See
+     * NITFBufferList::getNumBlocks() for the behavior of the last block.
+     */
+    NITFBlockIterator(const NITFBufferList& bufferList, size_t blockSize);
+
+    /*!
+     * \return The total number of blocks
+     */
+    size_t getNumBlocks() const
+    {
+        return mNumBlocks;
+    }
+
+    /*!
+     * \return The 0-based index of the block the next call to next() will
+     * return
+     */
+    size_t getBlockIndex() const
+    {
+        return mBlockIdx;
+    }
+
+    /*!
+     * Get the next block
+     *
+     * \param[out] data A pointer to contiguous memory for this block.  If
+     * the block was copied to scratch space, this is valid until the next
+     * call.
+     * \param[out] numBytes The number of bytes in this block
+     *
+     * \return True if a block was returned, false once all blocks have
+     * been visited
+     */
+    bool next(const void*& data, size_t& numBytes);
+
+private:
+    const NITFBufferList& mBufferList;
+    const size_t mBlockSize;
+    const size_t mNumBlocks;
+    const size_t mTotalNumBytes;
+    size_t mBlockIdx;
+    size_t mBufferIdx;
+    size_t mBufferOffset;
+    std::vector<sys::byte> mScratch;
+};
+}
+
+#endif
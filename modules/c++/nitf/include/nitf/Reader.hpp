@@ -76,6 +76,20 @@ public:
      */
     static nitf::Version getNITFVersion(const std::string& fileName);
 
+    /*!
+     *  Defer parsing of each TRE until one of its fields is accessed.
+     *  Applies to subsequent reads.
+     *  \param lazy  True to parse TREs on demand
+     */
+    void setLazyTREs(bool lazy);
+
+    /*!
+     *  Allocate the Fields of each Record read from an arena that the
+     *  Record releases in one go.  Applies to subsequent reads.
+     *  \param useArena  True to give each Record an arena
+     */
+    void setRecordArena(bool useArena);
+
     /*!
      *  This is the preferred method for reading a NITF 2.1 file.
      *  \param io  The IO handle
@@ -76,6 +76,9 @@ public:
     //! Returns the NITF version
     nitf::Version getVersion() const;
 
+    //! Returns the bytes used in the Record's arena, 0 if it has none
+    nitf::Uint64 getArenaBytes() const;
+
     //! Get the header
     nitf::FileHeader getHeader();
     //! Set the header
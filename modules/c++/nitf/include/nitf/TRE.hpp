@@ -265,6 +265,14 @@ typedef nitf::TREFieldIterator Iterator;
      */
     std::string getID() const;
 
+    /*!
+     *  False if the TRE was read lazily and none of its fields have been
+     *  accessed yet
+     */
+    bool isParsed() const;
+
+    //! Parse a lazily read TRE now, rather than on first access
+    void parse();
 
 private:
     nitf_Error error;
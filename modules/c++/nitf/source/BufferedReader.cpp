@@ -22,11 +22,41 @@
 
 
 #include <stdio.h>
+#include <algorithm>
+#include <limits>
 
+#if !defined(WIN32)
+#include <fcntl.h>
+#endif
+
+#include <mt/CriticalSection.h>
+#include <sys/Runnable.h>
 #include <nitf/BufferedReader.hpp>
 
+namespace
+{
+const size_t NO_CHUNK = std::numeric_limits<size_t>::max();
+}
+
 namespace nitf
 {
+class BufferedReader::PrefetchThread : public sys::Runnable
+{
+public:
+    PrefetchThread(BufferedReader& reader) :
+        mReader(reader)
+    {
+    }
+
+    virtual void run()
+    {
+        mReader.runPrefetchThread();
+    }
+
+private:
+    BufferedReader& mReader;
+};
+
 BufferedReader::BufferedReader(const std::string& file, size_t bufferSize) :
     mMaxBufferSize(bufferSize),
     mScopedBuffer(new char[bufferSize]),
@@ -37,8 +67,15 @@ BufferedReader::BufferedReader(const std::string& file, size_t bufferSize) :
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
     mFile(file, sys::File::READ_ONLY, sys::File::EXISTING),
-    mFileLen(mFile.length())
+    mFileLen(mFile.length()),
+    mNumReadAhead(0),
+    mCurrentChunk(NO_CHUNK),
+    mUseCount(0),
+    mOffset(0),
+    mStop(false),
+    mCondition(&mMutex)
 {
     if (mMaxBufferSize == 0)
     {
@@ -63,8 +100,15 @@ BufferedReader::BufferedReader(const std::string& file,
     mBlocksRead(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
     mFile(file, sys::File::READ_ONLY, sys::File::EXISTING),
-    mFileLen(mFile.length())
+    mFileLen(mFile.length()),
+    mNumReadAhead(0),
+    mCurrentChunk(NO_CHUNK),
+    mUseCount(0),
+    mOffset(0),
+    mStop(false),
+    mCondition(&mMutex)
 {
     if (mMaxBufferSize == 0)
     {
@@ -76,8 +120,106 @@ BufferedReader::BufferedReader(const std::string& file,
     readNextBuffer();
 }
 
+BufferedReader::BufferedReader(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers) :
+    mMaxBufferSize(bufferSize),
+    mScopedBuffer(new char[bufferSize * std::max<size_t>(numBuffers, 1)]),
+    mBuffer(mScopedBuffer.get()),
+    mPosition(0),
+    mBufferSize(0),
+    mTotalRead(0),
+    mBlocksRead(0),
+    mPartialBlocks(0),
+    mElapsedTime(0),
+    mStallTime(0),
+    mFile(file, sys::File::READ_ONLY, sys::File::EXISTING),
+    mFileLen(mFile.length()),
+    mNumReadAhead(0),
+    mCurrentChunk(NO_CHUNK),
+    mUseCount(0),
+    mOffset(0),
+    mStop(false),
+    mCondition(&mMutex)
+{
+    if (mMaxBufferSize == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedReaders must have a buffer size greater than zero"));
+    }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedReaders must have at least one buffer"));
+    }
+
+    if (numBuffers == 1)
+    {
+        //! Start off by reading a block
+        readNextBuffer();
+        return;
+    }
+
+#if defined(POSIX_FADV_SEQUENTIAL)
+    // Let the OS read further ahead on its own too.  This is only a hint.
+    ::posix_fadvise(mFile.getHandle(), 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+
+    Chunk emptyChunk;
+    emptyChunk.state = Chunk::EMPTY;
+    emptyChunk.index = 0;
+    emptyChunk.size = 0;
+    emptyChunk.lastUsed = 0;
+    mChunks.resize(numBuffers, emptyChunk);
+    mNumReadAhead = std::max<size_t>(numBuffers / 2, 1);
+
+    mThread.reset(new sys::Thread(new PrefetchThread(*this)));
+    mThread->start();
+
+    //! Start reading the first few chunks while the caller gets going
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    prefetch(0);
+}
+
 BufferedReader::~BufferedReader()
 {
+    try
+    {
+        stopThread();
+    }
+    catch (...)
+    {
+    }
+}
+
+size_t BufferedReader::getTotalRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mTotalRead;
+}
+
+size_t BufferedReader::getNumBlocksRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mBlocksRead;
+}
+
+size_t BufferedReader::getNumPartialBlocksRead() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mPartialBlocks;
+}
+
+double BufferedReader::getTotalWriteTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mElapsedTime;
+}
+
+double BufferedReader::getTotalStallTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mStallTime;
 }
 
 void BufferedReader::readNextBuffer()
@@ -93,8 +235,11 @@ void BufferedReader::readNextBuffer()
     sys::RealTimeStopWatch sw;
     sw.start();
     mFile.readInto(mBuffer, bufferSize);
-    mElapsedTime += (sw.stop() / 1000.0);
+    const double elapsedTime = sw.stop() / 1000.0;
 
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    mElapsedTime += elapsedTime;
+    mStallTime += elapsedTime;
     mPosition = 0;
     mBufferSize = bufferSize;
     mTotalRead += bufferSize;
@@ -105,6 +250,232 @@ void BufferedReader::readNextBuffer()
     }
 }
 
+size_t BufferedReader::getChunkSize(size_t index) const
+{
+    const nitf::Uint64 start =
+            static_cast<nitf::Uint64>(index) * mMaxBufferSize;
+    const nitf::Uint64 fileLen = static_cast<nitf::Uint64>(mFileLen);
+    return static_cast<size_t>(std::min<nitf::Uint64>(
+            mMaxBufferSize, fileLen - start));
+}
+
+size_t BufferedReader::findChunk(size_t index) const
+{
+    for (size_t ii = 0; ii < mChunks.size(); ++ii)
+    {
+        const Chunk& chunk(mChunks[ii]);
+        if ((chunk.state == Chunk::PENDING || chunk.state == Chunk::READY) &&
+            chunk.index == index)
+        {
+            return ii;
+        }
+    }
+    return NO_CHUNK;
+}
+
+size_t BufferedReader::findFreeChunk(size_t firstIndex,
+                                     size_t lastIndex) const
+{
+    // Prefer an unused buffer, then the least recently used one that isn't
+    // being read into and doesn't hold a chunk we're about to want
+    size_t bestChunk = NO_CHUNK;
+    for (size_t ii = 0; ii < mChunks.size(); ++ii)
+    {
+        const Chunk& chunk(mChunks[ii]);
+        if (chunk.state == Chunk::EMPTY || chunk.state == Chunk::FAILED)
+        {
+            return ii;
+        }
+
+        if (chunk.state == Chunk::READY &&
+            (chunk.index < firstIndex || chunk.index > lastIndex) &&
+            (bestChunk == NO_CHUNK ||
+             chunk.lastUsed < mChunks[bestChunk].lastUsed))
+        {
+            bestChunk = ii;
+        }
+    }
+    return bestChunk;
+}
+
+void BufferedReader::requestChunk(size_t chunk, size_t index)
+{
+    Chunk& request(mChunks[chunk]);
+    request.state = Chunk::PENDING;
+    request.index = index;
+    request.size = getChunkSize(index);
+    request.lastUsed = ++mUseCount;
+    request.error.clear();
+
+    mRequests.push_back(chunk);
+    mCondition.broadcast();
+}
+
+void BufferedReader::prefetch(size_t index)
+{
+    // Caller must hold mMutex
+    const size_t lastIndex = index + mNumReadAhead;
+    for (size_t ii = index; ii <= lastIndex; ++ii)
+    {
+        if (static_cast<nitf::Uint64>(ii) * mMaxBufferSize >=
+                static_cast<nitf::Uint64>(mFileLen))
+        {
+            break;
+        }
+
+        if (findChunk(ii) == NO_CHUNK)
+        {
+            const size_t chunk = findFreeChunk(index, lastIndex);
+            if (chunk == NO_CHUNK)
+            {
+                break;
+            }
+            requestChunk(chunk, ii);
+        }
+    }
+}
+
+void BufferedReader::dropRequests(size_t firstIndex, size_t lastIndex)
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+
+    // Requests the prefetch thread has already taken are left to finish
+    std::deque<size_t>::iterator it = mRequests.begin();
+    while (it != mRequests.end())
+    {
+        Chunk& chunk(mChunks[*it]);
+        if (chunk.index < firstIndex || chunk.index > lastIndex)
+        {
+            chunk.state = Chunk::EMPTY;
+            it = mRequests.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void BufferedReader::useChunk(size_t index)
+{
+    sys::RealTimeStopWatch sw;
+    sw.start();
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+
+    // Prefetching may hand the current buffer to another chunk, and if this
+    // one fails we have no current chunk at all
+    mCurrentChunk = NO_CHUNK;
+
+    // Queue up this chunk (if it isn't already) and the ones after it.  If
+    // every buffer is being read into, wait for one to free up.
+    size_t chunk;
+    while (true)
+    {
+        prefetch(index);
+        chunk = findChunk(index);
+        if (chunk != NO_CHUNK)
+        {
+            break;
+        }
+        mCondition.wait();
+    }
+
+    while (mChunks[chunk].state == Chunk::PENDING)
+    {
+        mCondition.wait();
+    }
+
+    if (mChunks[chunk].state == Chunk::FAILED)
+    {
+        const std::string error(mChunks[chunk].error);
+        mChunks[chunk].state = Chunk::EMPTY;
+        throw except::Exception(Ctxt(error));
+    }
+
+    mChunks[chunk].lastUsed = ++mUseCount;
+    mCurrentChunk = chunk;
+    mStallTime += (sw.stop() / 1000.0);
+}
+
+void BufferedReader::stopThread()
+{
+    if (mThread.get())
+    {
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
+        }
+        mThread->join();
+        mThread.reset();
+    }
+}
+
+void BufferedReader::runPrefetchThread()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (true)
+    {
+        while (mRequests.empty() && !mStop)
+        {
+            mCondition.wait();
+        }
+        if (mStop)
+        {
+            break;
+        }
+
+        const size_t chunk = mRequests.front();
+        mRequests.pop_front();
+        const nitf::Uint64 offset =
+                static_cast<nitf::Uint64>(mChunks[chunk].index) *
+                mMaxBufferSize;
+        const size_t size = mChunks[chunk].size;
+        char* const buffer = mBuffer + chunk * mMaxBufferSize;
+
+        // Don't hold the lock while we're on the disk
+        obtainLock.manualUnlock();
+        std::string error;
+        double elapsedTime(0);
+        try
+        {
+            sys::RealTimeStopWatch sw;
+            sw.start();
+            mFile.seekTo(offset, sys::File::FROM_START);
+            mFile.readInto(buffer, size);
+            elapsedTime = sw.stop() / 1000.0;
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+        catch (...)
+        {
+            error = "Unknown error reading buffer";
+        }
+        obtainLock.manualLock();
+
+        if (error.empty())
+        {
+            mChunks[chunk].state = Chunk::READY;
+            mElapsedTime += elapsedTime;
+            mTotalRead += size;
+            ++mBlocksRead;
+            if (size != mMaxBufferSize)
+            {
+                ++mPartialBlocks;
+            }
+        }
+        else
+        {
+            mChunks[chunk].state = Chunk::FAILED;
+            mChunks[chunk].error = error;
+        }
+        mCondition.broadcast();
+    }
+}
+
 void BufferedReader::readImpl(void* buf, size_t size)
 {
     //! Ensure there is enough data to read
@@ -118,6 +489,35 @@ void BufferedReader::readImpl(void* buf, size_t size)
     size_t amountLeftToRead = size;
     size_t offset = 0;
 
+    if (isAsync())
+    {
+        while (amountLeftToRead)
+        {
+            // Only this thread changes which chunk a buffer holds, so once
+            // it's READY we can read from it without the lock
+            const size_t index = static_cast<size_t>(mOffset / mMaxBufferSize);
+            if (mCurrentChunk == NO_CHUNK ||
+                mChunks[mCurrentChunk].index != index)
+            {
+                useChunk(index);
+            }
+
+            const Chunk& chunk(mChunks[mCurrentChunk]);
+            const size_t position =
+                    static_cast<size_t>(mOffset - index * mMaxBufferSize);
+            const size_t readSize =
+                    std::min(amountLeftToRead, chunk.size - position);
+
+            memcpy(bufPtr + offset,
+                   mBuffer + mCurrentChunk * mMaxBufferSize + position,
+                   readSize);
+            mOffset += readSize;
+            offset += readSize;
+            amountLeftToRead -= readSize;
+        }
+        return;
+    }
+
     while (amountLeftToRead)
     {
         const size_t readSize =
@@ -148,9 +548,6 @@ bool BufferedReader::canSeekImpl() const
 
 nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
 {
-    const nitf::Off bufferEnd = mFile.getCurrentOffset();
-    const nitf::Off bufferStart = bufferEnd - mBufferSize;
-
     nitf::Off desiredPos;
     switch (whence)
     {
@@ -158,7 +555,7 @@ nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
         desiredPos = offset;
         break;
     case sys::File::FROM_CURRENT:
-        desiredPos = bufferStart + mPosition + offset;
+        desiredPos = tellImpl() + offset;
         break;
     case sys::File::FROM_END:
         desiredPos = mFileLen + offset;
@@ -168,6 +565,33 @@ nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
                 "Invalid whence " + str::toString(whence)));
     }
 
+    if (isAsync())
+    {
+        // Chunks are fetched as they're read, and recently read ones are
+        // still in memory, so there's little to do here
+        if (desiredPos < 0)
+        {
+            throw except::Exception(Ctxt(
+                    "Attempting to seek before the start of a buffered "
+                    "reader."));
+        }
+
+        // Past the read-ahead window, whatever is still queued for the old
+        // position would only hold up the chunks we want next
+        const size_t oldIndex = static_cast<size_t>(mOffset / mMaxBufferSize);
+        const size_t newIndex =
+                static_cast<size_t>(desiredPos / mMaxBufferSize);
+        if (newIndex < oldIndex || newIndex > oldIndex + mNumReadAhead)
+        {
+            dropRequests(newIndex, newIndex + mNumReadAhead);
+        }
+
+        mOffset = desiredPos;
+        return desiredPos;
+    }
+
+    const nitf::Off bufferEnd = mFile.getCurrentOffset();
+    const nitf::Off bufferStart = bufferEnd - mBufferSize;
     if (desiredPos >= bufferStart && desiredPos < bufferEnd)
     {
         // We've already read this in - we don't really need to seek in the
@@ -178,7 +602,8 @@ nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
     else
     {
         // Need to do a legit read
-        const sys::Off_T newOffset = mFile.seekTo(offset, whence);
+        const sys::Off_T newOffset =
+                mFile.seekTo(desiredPos, sys::File::FROM_START);
         readNextBuffer();
         return newOffset;
     }
@@ -186,6 +611,10 @@ nitf::Off BufferedReader::seekImpl(nitf::Off offset, int whence)
 
 nitf::Off BufferedReader::tellImpl() const
 {
+    if (isAsync())
+    {
+        return mOffset;
+    }
     return (mFile.getCurrentOffset() - mBufferSize + mPosition);
 }
 
@@ -201,6 +630,7 @@ int BufferedReader::getModeImpl() const
 
 void BufferedReader::closeImpl()
 {
+    stopThread();
     mFile.close();
 }
 }
@@ -22,11 +22,49 @@
 
 
 #include <stdio.h>
+#include <algorithm>
+
+#if !defined(WIN32)
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+#include <mt/CriticalSection.h>
+#include <sys/Err.h>
+#include <sys/Runnable.h>
 
 #include "nitf/BufferedWriter.hpp"
 
+namespace
+{
+#if defined(O_DIRECT)
+bool isAligned(nitf::Uint64 value)
+{
+    return (value % nitf::BufferedWriter::DIRECT_IO_ALIGNMENT == 0);
+}
+#endif
+}
+
 namespace nitf
 {
+class BufferedWriter::FlushThread : public sys::Runnable
+{
+public:
+    FlushThread(BufferedWriter& writer) :
+        mWriter(writer)
+    {
+    }
+
+    virtual void run()
+    {
+        mWriter.runFlushThread();
+    }
+
+private:
+    BufferedWriter& mWriter;
+};
+
 BufferedWriter::BufferedWriter(const std::string& file, size_t bufferSize) :
     mBufferSize(bufferSize),
     mScopedBuffer(new char[bufferSize]),
@@ -36,6 +74,13 @@ BufferedWriter::BufferedWriter(const std::string& file, size_t bufferSize) :
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
+    mSyncPolicy(SYNC_ON_CLOSE),
+    mDirectHandle(-1),
+    mWriting(false),
+    mStop(false),
+    mOffset(0),
+    mCondition(&mMutex),
     mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE)
 {
     if (mBufferSize == 0)
@@ -57,6 +102,13 @@ BufferedWriter::BufferedWriter(const std::string& file,
     mBlocksWritten(0),
     mPartialBlocks(0),
     mElapsedTime(0),
+    mStallTime(0),
+    mSyncPolicy(SYNC_ON_CLOSE),
+    mDirectHandle(-1),
+    mWriting(false),
+    mStop(false),
+    mOffset(0),
+    mCondition(&mMutex),
     mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE)
 {
     if (mBufferSize == 0)
@@ -66,6 +118,80 @@ BufferedWriter::BufferedWriter(const std::string& file,
     }
 }
 
+BufferedWriter::BufferedWriter(const std::string& file,
+                               size_t bufferSize,
+                               size_t numBuffers,
+                               SyncPolicy syncPolicy,
+                               bool directIO) :
+    mBufferSize(bufferSize),
+    mScopedBuffer(NULL),
+    mBuffer(NULL),
+    mPosition(0),
+    mTotalWritten(0),
+    mBlocksWritten(0),
+    mPartialBlocks(0),
+    mElapsedTime(0),
+    mStallTime(0),
+    mSyncPolicy(syncPolicy),
+    mDirectHandle(-1),
+    mWriting(false),
+    mStop(false),
+    mOffset(0),
+    mCondition(&mMutex),
+    mFile(file, sys::File::WRITE_ONLY, sys::File::CREATE | sys::File::TRUNCATE)
+{
+    if (mBufferSize == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have a buffer size greater than zero"));
+    }
+    if (numBuffers == 0)
+    {
+        throw except::Exception(Ctxt(
+            "BufferedWriters must have at least one buffer"));
+    }
+
+#if defined(O_DIRECT)
+    // Unaligned writes still need the page cache, so rather than toggle
+    // O_DIRECT on mFile, the aligned ones go through a descriptor of their
+    // own.  Not every filesystem supports this (tmpfs for one), in which
+    // case we quietly stay buffered.
+    if (directIO)
+    {
+        mDirectHandle = ::open(file.c_str(), O_WRONLY | O_DIRECT);
+    }
+#endif
+
+    try
+    {
+        // Direct I/O needs aligned memory, so allocate these ourselves
+        // even in the single buffer case
+        for (size_t ii = 0; ii < numBuffers; ++ii)
+        {
+            mBuffers.push_back(static_cast<char*>(
+                    sys::alignedAlloc(mBufferSize, DIRECT_IO_ALIGNMENT)));
+        }
+        mBuffer = mBuffers[0];
+
+        if (isAsync())
+        {
+            mBufferLengths.resize(numBuffers);
+            mFreeBuffers.assign(mBuffers.begin() + 1, mBuffers.end());
+            mThread.reset(new sys::Thread(new FlushThread(*this)));
+            mThread->start();
+        }
+    }
+    catch (...)
+    {
+        for (size_t ii = 0; ii < mBuffers.size(); ++ii)
+        {
+            sys::alignedFree(mBuffers[ii]);
+        }
+        closeDirectHandle();
+        throw;
+    }
+}
+
 BufferedWriter::~BufferedWriter()
 {
     try
@@ -78,17 +204,75 @@ BufferedWriter::~BufferedWriter()
             // care of closing the file but wouldn't flush (i.e. fsync()) so
             // we call this too.
             flushBuffer();
-            mFile.flush();
+            if (isAsync())
+            {
+                waitForWrites();
+            }
+            if (mSyncPolicy != SYNC_NEVER)
+            {
+                mFile.flush();
+            }
         }
     }
     catch (...)
     {
     }
+
+    try
+    {
+        stopThread();
+    }
+    catch (...)
+    {
+    }
+    closeDirectHandle();
+
+    for (size_t ii = 0; ii < mBuffers.size(); ++ii)
+    {
+        sys::alignedFree(mBuffers[ii]);
+    }
+}
+
+nitf::Uint64 BufferedWriter::getTotalWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mTotalWritten;
+}
+
+nitf::Uint64 BufferedWriter::getNumBlocksWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mBlocksWritten;
+}
+
+nitf::Uint64 BufferedWriter::getNumPartialBlocksWritten() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mPartialBlocks;
+}
+
+double BufferedWriter::getTotalWriteTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mElapsedTime;
+}
+
+double BufferedWriter::getTotalStallTime() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    return mStallTime;
 }
 
 void BufferedWriter::flushBuffer()
 {
-    flushBuffer(mBuffer);
+    if (isAsync())
+    {
+        submitBuffer();
+    }
+    else
+    {
+        flushBuffer(mBuffer);
+    }
 }
 
 void BufferedWriter::flushBuffer(const char* buf)
@@ -97,19 +281,213 @@ void BufferedWriter::flushBuffer(const char* buf)
     {
         sys::RealTimeStopWatch sw;
         sw.start();
-        mFile.writeFrom(buf, mPosition);
-        mElapsedTime += (sw.stop() / 1000.);
+        writeToFile(buf, mPosition);
+        const double elapsedTime = sw.stop() / 1000.;
 
-        mTotalWritten += mPosition;
+        recordWrite(mPosition, elapsedTime);
+        mStallTime += elapsedTime;
 
-        ++mBlocksWritten;
+        mPosition = 0;
+    }
+}
 
-        if (mPosition != mBufferSize)
+void BufferedWriter::writeToFile(const char* buf, size_t size)
+{
+#if defined(O_DIRECT)
+    // O_DIRECT requires the memory, size, and file offset to all be aligned.
+    // Anything else (partial buffers, header rewrites after a seek, writes
+    // straight from the caller's memory) goes through mFile and the page
+    // cache.
+    const nitf::Off offset = mDirectHandle >= 0 ? mFile.getCurrentOffset() : 0;
+    if (mDirectHandle >= 0 &&
+        isAligned(reinterpret_cast<size_t>(buf)) && isAligned(size) &&
+        isAligned(offset))
+    {
+        size_t written = 0;
+        while (written < size)
         {
-            ++mPartialBlocks;
+            const ssize_t bytes = ::pwrite(mDirectHandle, buf + written,
+                                           size - written, offset + written);
+            if (bytes < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (bytes <= 0)
+            {
+                throw except::Exception(Ctxt(
+                        "Direct write failed: " + sys::Err().toString()));
+            }
+            written += static_cast<size_t>(bytes);
         }
+        mFile.seekTo(offset + size, sys::File::FROM_START);
+    }
+    else
+#endif
+    {
+        mFile.writeFrom(buf, size);
+    }
 
-        mPosition = 0;
+    if (mSyncPolicy == SYNC_EVERY_BUFFER)
+    {
+        mFile.flush();
+    }
+}
+
+void BufferedWriter::closeDirectHandle()
+{
+#if !defined(WIN32)
+    if (mDirectHandle >= 0)
+    {
+        ::close(mDirectHandle);
+        mDirectHandle = -1;
+    }
+#endif
+}
+
+void BufferedWriter::recordWrite(size_t size, double elapsedTime)
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    mElapsedTime += elapsedTime;
+    mTotalWritten += size;
+
+    ++mBlocksWritten;
+
+    if (size != mBufferSize)
+    {
+        ++mPartialBlocks;
+    }
+}
+
+void BufferedWriter::submitBuffer()
+{
+    if (mPosition == 0)
+    {
+        checkWriteError();
+        return;
+    }
+
+    sys::RealTimeStopWatch sw;
+    sw.start();
+
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    const size_t bufferIdx = std::find(mBuffers.begin(), mBuffers.end(),
+                                       mBuffer) - mBuffers.begin();
+    mBufferLengths[bufferIdx] = mPosition;
+    mFullBuffers.push_back(bufferIdx);
+    mOffset += mPosition;
+    mPosition = 0;
+    mCondition.broadcast();
+
+    while (mFreeBuffers.empty() && mWriteError.empty())
+    {
+        mCondition.wait();
+    }
+    if (!mWriteError.empty())
+    {
+        mBuffer = NULL;
+        throw except::Exception(Ctxt(mWriteError));
+    }
+
+    mBuffer = mFreeBuffers.back();
+    mFreeBuffers.pop_back();
+    mStallTime += (sw.stop() / 1000.);
+}
+
+void BufferedWriter::waitForWrites() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while ((!mFullBuffers.empty() || mWriting) && mWriteError.empty())
+    {
+        mCondition.wait();
+    }
+    if (!mWriteError.empty())
+    {
+        throw except::Exception(Ctxt(mWriteError));
+    }
+}
+
+void BufferedWriter::checkWriteError() const
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    if (!mWriteError.empty())
+    {
+        throw except::Exception(Ctxt(mWriteError));
+    }
+}
+
+void BufferedWriter::stopThread()
+{
+    if (mThread.get())
+    {
+        {
+            mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+            mStop = true;
+            mCondition.broadcast();
+        }
+        mThread->join();
+        mThread.reset();
+    }
+}
+
+void BufferedWriter::runFlushThread()
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+    while (true)
+    {
+        while (mFullBuffers.empty() && !mStop)
+        {
+            mCondition.wait();
+        }
+        if (mFullBuffers.empty())
+        {
+            break;
+        }
+
+        const size_t bufferIdx = mFullBuffers.front();
+        mFullBuffers.pop_front();
+        const size_t size = mBufferLengths[bufferIdx];
+        mWriting = true;
+
+        // Don't hold the lock while we're on the disk
+        obtainLock.manualUnlock();
+        std::string error;
+        double elapsedTime(0);
+        try
+        {
+            sys::RealTimeStopWatch sw;
+            sw.start();
+            writeToFile(mBuffers[bufferIdx], size);
+            elapsedTime = sw.stop() / 1000.;
+        }
+        catch (const except::Exception& ex)
+        {
+            error = ex.getMessage();
+        }
+        catch (...)
+        {
+            error = "Unknown error writing buffer";
+        }
+
+        if (error.empty())
+        {
+            recordWrite(size, elapsedTime);
+        }
+        obtainLock.manualLock();
+
+        if (!error.empty() && mWriteError.empty())
+        {
+            // Anything still queued is dropped; the error will surface on
+            // the caller's next write, seek, or close
+            mWriteError = error;
+            for (size_t ii = 0; ii < mFullBuffers.size(); ++ii)
+            {
+                mFreeBuffers.push_back(mBuffers[mFullBuffers[ii]]);
+            }
+            mFullBuffers.clear();
+        }
+        mFreeBuffers.push_back(mBuffers[bufferIdx]);
+        mWriting = false;
+        mCondition.broadcast();
     }
 }
 
@@ -134,9 +512,15 @@ void BufferedWriter::writeImpl(const void* buf, size_t size)
             bytes = mBufferSize - mPosition;
         }
 
-        // copy bytes to internal buffer
-        if (bytes < mBufferSize)
+        // copy bytes to internal buffer.  With multiple buffers we always
+        // copy so the write can happen in the background.
+        if (bytes < mBufferSize || isAsync())
         {
+            if (!mBuffer)
+            {
+                checkWriteError();
+            }
+
             // Copy over and subtract bytes from the size left
             memcpy(mBuffer + mPosition, bufPtr + from, bytes);
 
@@ -175,16 +559,38 @@ nitf::Off BufferedWriter::seekImpl(nitf::Off offset, int whence)
     // This is very unfortunate, since it creates a partial block
     flushBuffer();
 
-    return mFile.seekTo(offset, whence);
+    if (isAsync())
+    {
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        waitForWrites();
+        const double stallTime = sw.stop() / 1000.;
+
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        mStallTime += stallTime;
+    }
+
+    const nitf::Off newOffset = mFile.seekTo(offset, whence);
+    mOffset = newOffset;
+    return newOffset;
 }
 
 nitf::Off BufferedWriter::tellImpl() const
 {
+    if (isAsync())
+    {
+        // The file offset lags behind while writes are pending
+        return (mOffset + mPosition);
+    }
     return (mFile.getCurrentOffset() + mPosition);
 }
 
 nitf::Off BufferedWriter::getSizeImpl() const
 {
+    if (isAsync())
+    {
+        waitForWrites();
+    }
     return (mFile.length() + mPosition);
 }
 
@@ -201,12 +607,31 @@ void BufferedWriter::closeImpl()
     // just cached it)
     flushBuffer();
 
-    sys::RealTimeStopWatch sw;
-    sw.start();
-    mFile.flush();
-    mElapsedTime += (sw.stop() / 1000.);
+    if (isAsync())
+    {
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        waitForWrites();
+        stopThread();
+        const double stallTime = sw.stop() / 1000.;
+
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        mStallTime += stallTime;
+    }
+
+    if (mSyncPolicy != SYNC_NEVER)
+    {
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        mFile.flush();
+        const double elapsedTime = sw.stop() / 1000.;
 
+        mt::CriticalSection<sys::Mutex> obtainLock(&mMutex);
+        mElapsedTime += elapsedTime;
+        mStallTime += elapsedTime;
+    }
+
+    closeDirectHandle();
     mFile.close();
 }
 }
-
@@ -21,12 +21,19 @@
  */
 
 #include <string.h>
+#include <mt/CriticalSection.h>
 #include <nitf/CustomIO.hpp>
 
 namespace nitf
 {
 CustomIO::CustomIO() :
-    IOInterface(createInterface(this))
+    IOInterface(createInterface(this, false))
+{
+    setManaged(false);
+}
+
+CustomIO::CustomIO(bool positionalReads) :
+    IOInterface(createInterface(this, positionalReads))
 {
     setManaged(false);
 }
@@ -47,8 +54,24 @@ CustomIO::~CustomIO()
     mHandle->get()->data = NULL;
 }
 
-nitf_IOInterface* CustomIO::createInterface(CustomIO* me)
+nitf_IOInterface* CustomIO::createInterface(CustomIO* me,
+                                            bool positionalReads)
 {
+    // Without positional reads readAt is left to the library's seek and
+    // read fallback, which callers serialize since canReadAt() is false
+    static nrt_IIOInterface iIOHandleSeekRead = {
+        &CustomIO::adapterRead,
+        &CustomIO::adapterWrite,
+        &CustomIO::adapterCanSeek,
+        &CustomIO::adapterSeek,
+        &CustomIO::adapterTell,
+        &CustomIO::adapterGetSize,
+        &CustomIO::adapterGetMode,
+        &CustomIO::adapterClose,
+        &CustomIO::adapterDestruct,
+        NULL
+    };
+
     static nrt_IIOInterface iIOHandle = {
         &CustomIO::adapterRead,
         &CustomIO::adapterWrite,
@@ -58,7 +81,8 @@ nitf_IOInterface* CustomIO::createInterface(CustomIO* me)
         &CustomIO::adapterGetSize,
         &CustomIO::adapterGetMode,
         &CustomIO::adapterClose,
-        &CustomIO::adapterDestruct
+        &CustomIO::adapterDestruct,
+        &CustomIO::adapterReadAt
     };
 
     nitf_IOInterface* const impl =
@@ -70,7 +94,7 @@ nitf_IOInterface* CustomIO::createInterface(CustomIO* me)
     memset(impl, 0, sizeof(nitf_IOInterface));
 
     impl->data = me;
-    impl->iface = &iIOHandle;
+    impl->iface = positionalReads ? &iIOHandle : &iIOHandleSeekRead;
     return impl;
 }
 
@@ -104,6 +128,44 @@ NRT_BOOL CustomIO::adapterRead(NRT_DATA* data,
     }
 }
 
+void CustomIO::readAtImpl(nitf::Off offset, void* buf, size_t size)
+{
+    mt::CriticalSection<sys::Mutex> obtainLock(&mReadAtMutex);
+    seekImpl(offset, NRT_SEEK_SET);
+    readImpl(buf, size);
+}
+
+NRT_BOOL CustomIO::adapterReadAt(NRT_DATA* data,
+                                 nrt_Off offset,
+                                 void* buf,
+                                 size_t size,
+                                 nrt_Error* error)
+{
+    try
+    {
+        reinterpret_cast<CustomIO*>(data)->readAtImpl(offset, buf, size);
+        return NRT_SUCCESS;
+    }
+    catch (const except::Exception& ex)
+    {
+        nrt_Error_init(error, ex.getMessage().c_str(), NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+    catch (const std::exception& ex)
+    {
+        nrt_Error_init(error, ex.what(), NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+    catch (...)
+    {
+        nrt_Error_init(error, "Unknown error", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
+        return NRT_FAILURE;
+    }
+}
+
 NRT_BOOL CustomIO::adapterWrite(NRT_DATA* data,
                                 const void* buf,
                                 size_t size,
@@ -40,6 +40,20 @@ void nitf::IOInterface::read(void* buf, size_t size)
         throw nitf::NITFException(&error);
 }
 
+void nitf::IOInterface::readAt(nitf::Off offset, void* buf, size_t size)
+{
+    nitf_IOInterface *io = getNativeOrThrow();
+    nitf_Error readError;
+    if (!nitf_IOInterface_readAt(io, offset, buf, size, &readError))
+        throw nitf::NITFException(&readError);
+}
+
+bool nitf::IOInterface::canReadAt() const
+{
+    nitf_IOInterface *io = getNativeOrThrow();
+    return nitf_IOInterface_canReadAt(io) ? true : false;
+}
+
 void nitf::IOInterface::write(const void* buf, size_t size)
 {
     nitf_IOInterface *io = getNativeOrThrow();
@@ -20,12 +20,16 @@
  *
  */
 
+#include <string.h>
 #include <sstream>
 #include <numeric>
 #include <limits>
+#include <algorithm>
 
 #include <sys/Conf.h>
+#include <sys/OS.h>
 #include <except/Exception.h>
+#include <mt/Runnable1D.h>
 #include <nitf/ImageBlocker.hpp>
 
 namespace
@@ -48,6 +52,34 @@ void getBlockInfo(size_t numElements,
         ++numBlocks;
     }
 }
+
+// Below this many bytes, per-row memcpy() calls cost more than the copy
+// itself, so rows are copied a word at a time instead
+const size_t SMALL_ROW_NUM_BYTES = 64;
+
+void copyRow(sys::byte* output, const sys::byte* input, size_t numBytes)
+{
+    if (numBytes >= SMALL_ROW_NUM_BYTES)
+    {
+        ::memcpy(output, input, numBytes);
+        return;
+    }
+
+    for (; numBytes >= sizeof(sys::Uint64_T);
+         numBytes -= sizeof(sys::Uint64_T),
+         input += sizeof(sys::Uint64_T),
+         output += sizeof(sys::Uint64_T))
+    {
+        sys::Uint64_T word;
+        ::memcpy(&word, input, sizeof(word));
+        ::memcpy(output, &word, sizeof(word));
+    }
+
+    for (; numBytes > 0; --numBytes)
+    {
+        *output++ = *input++;
+    }
+}
 }
 
 namespace nitf
@@ -271,7 +303,7 @@ void ImageBlocker::block(const void* input,
              row < numValidRowsInBlock;
              ++row, inputPtr += inStride, outputPtr += outNumValidBytes)
         {
-            ::memcpy(outputPtr, inputPtr, outNumValidBytes);
+            copyRow(outputPtr, inputPtr, outNumValidBytes);
         }
     }
     else
@@ -284,7 +316,7 @@ void ImageBlocker::block(const void* input,
              row < numValidRowsInBlock;
              ++row, inputPtr += inStride)
         {
-            ::memcpy(outputPtr, inputPtr, outNumValidBytes);
+            copyRow(outputPtr, inputPtr, outNumValidBytes);
             outputPtr += outNumValidBytes;
 
             ::memset(outputPtr, 0, outNumInvalidBytes);
@@ -302,46 +334,75 @@ void ImageBlocker::block(const void* input,
     }
 }
 
-void ImageBlocker::blockAcrossRow(size_t seg,
-                                  const sys::byte*& input,
-                                  size_t numValidRowsInBlock,
-                                  size_t numBytesPerPixel,
-                                  sys::byte*& output) const
+class ImageBlocker::BlockOp
 {
-    const size_t outStride =
-            mNumRowsPerBlock[seg] * mNumColsPerBlock * numBytesPerPixel;
-    const size_t lastColBlock = mNumBlocksAcrossCols - 1;
+public:
+    BlockOp(const std::vector<RowOfBlocks>& rowsOfBlocks,
+            const std::vector<void*>* blockOutputs,
+            size_t numBytesPerPixel,
+            size_t numCols,
+            size_t numColsPerBlock,
+            size_t numBlocksAcrossCols,
+            size_t numPadColsInFinalBlock) :
+        mRowsOfBlocks(rowsOfBlocks),
+        mBlockOutputs(blockOutputs),
+        mNumBytesPerPixel(numBytesPerPixel),
+        mNumCols(numCols),
+        mNumColsPerBlock(numColsPerBlock),
+        mNumBlocksAcrossCols(numBlocksAcrossCols),
+        mNumPadColsInFinalBlock(numPadColsInFinalBlock)
+    {
+    }
 
-    for (size_t colBlock = 0;
-         colBlock < mNumBlocksAcrossCols;
-         ++colBlock, output += outStride)
+    // Blocks are numbered in row-major order across the whole AOI
+    void operator()(size_t blockIdx) const
     {
-        const size_t numPadColsInBlock = (colBlock == lastColBlock) ?
-                mNumPadColsInFinalBlock : 0;
+        const RowOfBlocks& rowOfBlocks(
+                mRowsOfBlocks[blockIdx / mNumBlocksAcrossCols]);
+        const size_t colBlock = blockIdx % mNumBlocksAcrossCols;
 
+        const size_t numPadColsInBlock =
+                (colBlock == mNumBlocksAcrossCols - 1) ?
+                        mNumPadColsInFinalBlock : 0;
         const size_t numValidColsInBlock = mNumColsPerBlock - numPadColsInBlock;
 
-        blockImpl(seg,
-                  input,
-                  numValidRowsInBlock,
-                  numValidColsInBlock,
-                  numBytesPerPixel,
-                  output);
-
-        input += numValidColsInBlock * numBytesPerPixel;
+        const size_t blockNumBytes = rowOfBlocks.numRowsPerBlock *
+                mNumColsPerBlock * mNumBytesPerPixel;
+        void* const output = mBlockOutputs ?
+                (*mBlockOutputs)[blockIdx] :
+                rowOfBlocks.output + colBlock * blockNumBytes;
+
+        ImageBlocker::block(rowOfBlocks.input +
+                                    colBlock * mNumColsPerBlock *
+                                    mNumBytesPerPixel,
+                            mNumBytesPerPixel,
+                            mNumCols,
+                            rowOfBlocks.numRowsPerBlock,
+                            mNumColsPerBlock,
+                            rowOfBlocks.numValidRowsInBlock,
+                            numValidColsInBlock,
+                            output);
     }
 
-    // At the end of this, we've incremented the input pointer an entire row
-    // We need to increment it the remaining rows in the block
-    input += mNumCols * numBytesPerPixel * (numValidRowsInBlock - 1);
-}
-
-void ImageBlocker::block(const void* input,
-                         size_t startRow,
-                         size_t numRows,
-                         size_t numBytesPerPixel,
-                         void* output) const
+private:
+    const std::vector<RowOfBlocks>& mRowsOfBlocks;
+    const std::vector<void*>* const mBlockOutputs;
+    const size_t mNumBytesPerPixel;
+    const size_t mNumCols;
+    const size_t mNumColsPerBlock;
+    const size_t mNumBlocksAcrossCols;
+    const size_t mNumPadColsInFinalBlock;
+};
+
+void ImageBlocker::findRowsOfBlocks(
+        const void* input,
+        size_t startRow,
+        size_t numRows,
+        size_t numBytesPerPixel,
+        void* output,
+        std::vector<RowOfBlocks>& rowsOfBlocks) const
 {
+    rowsOfBlocks.clear();
     if (numRows == 0)
     {
         return;
@@ -357,6 +418,7 @@ void ImageBlocker::block(const void* input,
 
     const sys::byte* inputPtr = static_cast<const sys::byte*>(input);
     sys::byte* outputPtr = static_cast<sys::byte*>(output);
+    const size_t inStride = mNumCols * numBytesPerPixel;
 
     for (size_t seg = firstSegIdx; seg <= lastSegIdx; ++seg)
     {
@@ -368,6 +430,9 @@ void ImageBlocker::block(const void* input,
         const size_t lastRowBlockOfSegment = (seg == lastSegIdx) ?
                 lastBlockWithinLastSeg : overallLastRowBlockOfSegment;
 
+        const size_t outStride = mNumBlocksAcrossCols * mNumRowsPerBlock[seg] *
+                mNumColsPerBlock * numBytesPerPixel;
+
         for (size_t rowBlock = startRowBlockOfSegment;
              rowBlock <= lastRowBlockOfSegment;
              ++rowBlock)
@@ -376,19 +441,90 @@ void ImageBlocker::block(const void* input,
                     (rowBlock == overallLastRowBlockOfSegment) ?
                             mNumPadRowsInFinalBlock[seg] : 0;
 
-            const size_t numValidRowsInBlock =
+            RowOfBlocks rowOfBlocks;
+            rowOfBlocks.numRowsPerBlock = mNumRowsPerBlock[seg];
+            rowOfBlocks.numValidRowsInBlock =
                     mNumRowsPerBlock[seg] - numPadRowsInBlock;
-
-            // This increments both pointers
-            blockAcrossRow(seg,
-                           inputPtr,
-                           numValidRowsInBlock,
-                           numBytesPerPixel,
-                           outputPtr);
+            rowOfBlocks.input = inputPtr;
+            rowOfBlocks.output = outputPtr;
+            rowsOfBlocks.push_back(rowOfBlocks);
+
+            inputPtr += rowOfBlocks.numValidRowsInBlock * inStride;
+            if (outputPtr)
+            {
+                outputPtr += outStride;
+            }
         }
     }
 }
 
+void ImageBlocker::blockImpl(const std::vector<RowOfBlocks>& rowsOfBlocks,
+                             size_t numBytesPerPixel,
+                             size_t numThreads,
+                             const std::vector<void*>* blockOutputs) const
+{
+    const size_t numBlocks = rowsOfBlocks.size() * mNumBlocksAcrossCols;
+    if (numBlocks == 0)
+    {
+        return;
+    }
+
+    if (blockOutputs && blockOutputs->size() != numBlocks)
+    {
+        std::ostringstream ostr;
+        ostr << "Got " << blockOutputs->size() << " output buffers but "
+             << "blocking " << numBlocks << " blocks";
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    if (numThreads == 0)
+    {
+        numThreads = sys::OS().getNumCPUs();
+    }
+
+    const BlockOp op(rowsOfBlocks, blockOutputs, numBytesPerPixel, mNumCols,
+                     mNumColsPerBlock, mNumBlocksAcrossCols,
+                     mNumPadColsInFinalBlock);
+    mt::run1D(numBlocks, std::min(numThreads, numBlocks), op);
+}
+
+void ImageBlocker::block(const void* input,
+                         size_t startRow,
+                         size_t numRows,
+                         size_t numBytesPerPixel,
+                         void* output) const
+{
+    block(input, startRow, numRows, numBytesPerPixel, 1, output);
+}
+
+void ImageBlocker::block(const void* input,
+                         size_t startRow,
+                         size_t numRows,
+                         size_t numBytesPerPixel,
+                         size_t numThreads,
+                         void* output) const
+{
+    std::vector<RowOfBlocks> rowsOfBlocks;
+    findRowsOfBlocks(input, startRow, numRows, numBytesPerPixel, output,
+                     rowsOfBlocks);
+
+    blockImpl(rowsOfBlocks, numBytesPerPixel, numThreads, NULL);
+}
+
+void ImageBlocker::block(const void* input,
+                         size_t startRow,
+                         size_t numRows,
+                         size_t numBytesPerPixel,
+                         size_t numThreads,
+                         const std::vector<void*>& blockOutputs) const
+{
+    std::vector<RowOfBlocks> rowsOfBlocks;
+    findRowsOfBlocks(input, startRow, numRows, numBytesPerPixel, NULL,
+                     rowsOfBlocks);
+
+    blockImpl(rowsOfBlocks, numBytesPerPixel, numThreads, &blockOutputs);
+}
+
 size_t ImageBlocker::getSegmentFromGlobalBlockRow(size_t blockRow) const
 {
     size_t startBlock = 0;
@@ -57,9 +57,11 @@ nitf::BlockingInfo ImageReader::getBlockingInfo()
 
 void ImageReader::read(nitf::SubWindow & subWindow, nitf::Uint8 ** user, int * padded)
 {
-    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &error);
+    // Local error so concurrent reads don't share it
+    nitf_Error readError;
+    NITF_BOOL x = nitf_ImageReader_read(getNativeOrThrow(), subWindow.getNative(), user, padded, &readError);
     if (!x)
-        throw nitf::NITFException(&error);
+        throw nitf::NITFException(&readError);
 }
 
 const nitf::Uint8* ImageReader::readBlock(nitf::Uint32 blockNumber, nitf::Uint64* blockSize)
@@ -75,3 +77,35 @@ void ImageReader::setReadCaching()
 {
     nitf_ImageReader_setReadCaching(getNativeOrThrow());
 }
+
+void ImageReader::setReadCaching(nitf::Uint64 maxBytes)
+{
+    nitf_ImageReader_setReadCacheSize(getNativeOrThrow(), maxBytes);
+}
+
+void ImageReader::setReducedResolution(bool enable)
+{
+    nitf_ImageReader_setReducedResolution(getNativeOrThrow(), enable ? 1 : 0);
+}
+
+nitf::Uint64 ImageReader::getReadCacheHits()
+{
+    nitf::Uint64 hits;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), &hits, NULL, NULL);
+    return hits;
+}
+
+nitf::Uint64 ImageReader::getReadCacheMisses()
+{
+    nitf::Uint64 misses;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), NULL, &misses, NULL);
+    return misses;
+}
+
+nitf::Uint64 ImageReader::getReadCacheBytes()
+{
+    nitf::Uint64 usedBytes;
+    nitf_ImageReader_getReadCacheStats(getNativeOrThrow(), NULL, NULL,
+                                       &usedBytes);
+    return usedBytes;
+}
@@ -1,146 +1,202 @@
-/* =========================================================================
- * This file is part of NITRO
- * =========================================================================
- *
- * (C) Copyright 2004 - 2017, MDA Information Systems LLC
- *
- * NITRO is free software; you can redistribute it and/or modify
- * it under the terms of the GNU Lesser General Public License as published by
- * the Free Software Foundation; either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU Lesser General Public License for more details.
- *
- * You should have received a copy of the GNU Lesser General Public
- * License along with this program; if not, If not,
- * see <http://www.gnu.org/licenses/>.
- *
- */
-
-#include <except/Exception.h>
-#include <nitf/NITFBufferList.hpp>
-
-namespace nitf
-{
-NITFBuffer::NITFBuffer() :
-    mData(NULL),
-    mNumBytes(0)
-{
-}
-
-NITFBuffer::NITFBuffer(const void* data, size_t numBytes) :
-    mData(data),
-    mNumBytes(numBytes)
-{
-}
-
-size_t NITFBufferList::getTotalNumBytes() const
-{
-    size_t numBytes(0);
-
-    for (size_t ii = 0; ii < mBuffers.size(); ++ii)
-    {
-        numBytes += mBuffers[ii].mNumBytes;
-    }
-
-    return numBytes;
-}
-
-size_t NITFBufferList::getNumBlocks(size_t blockSize) const
-{
-    if (blockSize == 0)
-    {
-        throw except::Exception(Ctxt("Block size must be positive"));
-    }
-
-    return getTotalNumBytes() / blockSize;
-}
-
-size_t NITFBufferList::getNumBytesInBlock(
-        size_t blockSize,
-        size_t blockIdx) const
-{
-    const size_t numBlocks(getNumBlocks(blockSize));
-    if (blockIdx >= numBlocks)
-    {
-        std::ostringstream ostr;
-        ostr << "Block index " << blockIdx << " is out of bounds - only "
-             << numBlocks << " blocks with a block size of " << blockSize;
-        throw except::Exception(Ctxt(ostr.str()));
-    }
-
-    const size_t numBytes = (blockIdx == numBlocks - 1) ?
-            getTotalNumBytes() - (numBlocks - 1) * blockSize :
-            blockSize;
-
-    return numBytes;
-}
-
-const void* NITFBufferList::getBlock(size_t blockSize,
-                                     size_t blockIdx,
-                                     std::vector<sys::byte>& scratch,
-                                     size_t& numBytes) const
-{
-    const size_t startByte = blockIdx * blockSize;
-    numBytes = getNumBytesInBlock(blockSize, blockIdx);
-
-    size_t byteCount(0);
-    for (size_t ii = 0; ii < mBuffers.size(); ++ii)
-    {
-        const NITFBuffer& buffer(mBuffers[ii]);
-        if (byteCount + buffer.mNumBytes >= startByte)
-        {
-            // We found our first buffer
-            const size_t numBytesToSkip = startByte - byteCount;
-            const size_t numBytesLeftInBuffer =
-                    buffer.mNumBytes - numBytesToSkip;
-
-            const sys::byte* const startPtr =
-                    static_cast<const sys::byte*>(buffer.mData) +
-                    numBytesToSkip;
-            if (numBytesLeftInBuffer >= numBytes)
-            {
-                // We have contiguous memory in this buffer - we don't need to
-                // copy anything
-                return startPtr;
-            }
-            else
-            {
-                // The bytes we want span 2+ buffers - we'll use scratch space
-                // and copy in the bytes we want to that
-                scratch.resize(numBytes);
-                size_t numBytesCopied(0);
-                memcpy(&scratch[0], startPtr, numBytesLeftInBuffer);
-                numBytesCopied += numBytesLeftInBuffer;
-
-                for (size_t jj = ii + 1; jj < mBuffers.size(); ++jj)
-                {
-                    const NITFBuffer& curBuffer(mBuffers[jj]);
-                    const size_t numBytesToCopy =
-                            std::min(curBuffer.mNumBytes,
-                                     numBytes - numBytesCopied);
-
-                    memcpy(&scratch[numBytesCopied],
-                           curBuffer.mData,
-                           numBytesToCopy);
-                    numBytesCopied += numBytesToCopy;
-                    if (numBytesCopied == numBytes)
-                    {
-                        break;
-                    }
-                }
-
-                return &scratch[0];
-            }
-        }
-
-        byteCount += buffer.mNumBytes;
-    }
-
-    // Should not be possible to get here
-    return NULL;
-}
-}
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2017, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <string.h>
+#include <algorithm>
+#include <sstream>
+
+#include <except/Exception.h>
+#include <nitf/NITFBufferList.hpp>
+
+namespace nitf
+{
+NITFBuffer::NITFBuffer() :
+    mData(NULL),
+    mNumBytes(0)
+{
+}
+
+NITFBuffer::NITFBuffer(const void* data, size_t numBytes) :
+    mData(data),
+    mNumBytes(numBytes)
+{
+}
+
+size_t NITFBufferList::getTotalNumBytes() const
+{
+    return mOffsets.back();
+}
+
+size_t NITFBufferList::getNumBlocks(size_t blockSize) const
+{
+    if (blockSize == 0)
+    {
+        throw except::Exception(Ctxt("Block size must be positive"));
+    }
+
+    return getTotalNumBytes() / blockSize;
+}
+
+size_t NITFBufferList::getNumBytesInBlock(
+        size_t blockSize,
+        size_t blockIdx) const
+{
+    const size_t numBlocks(getNumBlocks(blockSize));
+    if (blockIdx >= numBlocks)
+    {
+        std::ostringstream ostr;
+        ostr << "Block index " << blockIdx << " is out of bounds - only "
+             << numBlocks << " blocks with a block size of " << blockSize;
+        throw except::Exception(Ctxt(ostr.str()));
+    }
+
+    const size_t numBytes = (blockIdx == numBlocks - 1) ?
+            getTotalNumBytes() - (numBlocks - 1) * blockSize :
+            blockSize;
+
+    return numBytes;
+}
+
+const void* NITFBufferList::getBlock(size_t blockSize,
+                                     size_t blockIdx,
+                                     std::vector<sys::byte>& scratch,
+                                     size_t& numBytes) const
+{
+    const size_t startByte = blockIdx * blockSize;
+    numBytes = getNumBytesInBlock(blockSize, blockIdx);
+
+    // Find the last buffer starting at or before our first byte.  Since
+    // startByte is less than the total, this skips over any empty buffers
+    // and lands on the one that actually holds it.
+    const size_t ii = (std::upper_bound(mOffsets.begin(), mOffsets.end(),
+                                        startByte) - mOffsets.begin()) - 1;
+
+    const NITFBuffer& buffer(mBuffers[ii]);
+    const size_t numBytesToSkip = startByte - mOffsets[ii];
+    const size_t numBytesLeftInBuffer = buffer.mNumBytes - numBytesToSkip;
+
+    const sys::byte* const startPtr =
+            static_cast<const sys::byte*>(buffer.mData) + numBytesToSkip;
+    if (numBytesLeftInBuffer >= numBytes)
+    {
+        // We have contiguous memory in this buffer - we don't need to
+        // copy anything
+        return startPtr;
+    }
+
+    // The bytes we want span 2+ buffers - we'll use scratch space and copy
+    // in the bytes we want to that
+    scratch.resize(numBytes);
+    size_t numBytesCopied(0);
+    memcpy(&scratch[0], startPtr, numBytesLeftInBuffer);
+    numBytesCopied += numBytesLeftInBuffer;
+
+    for (size_t jj = ii + 1;
+         jj < mBuffers.size() && numBytesCopied < numBytes;
+         ++jj)
+    {
+        const NITFBuffer& curBuffer(mBuffers[jj]);
+        const size_t numBytesToCopy =
+                std::min(curBuffer.mNumBytes, numBytes - numBytesCopied);
+
+        if (numBytesToCopy > 0)
+        {
+            memcpy(&scratch[numBytesCopied], curBuffer.mData, numBytesToCopy);
+            numBytesCopied += numBytesToCopy;
+        }
+    }
+
+    return &scratch[0];
+}
+
+NITFBlockIterator::NITFBlockIterator(const NITFBufferList& bufferList,
+                                     size_t blockSize) :
+    mBufferList(bufferList),
+    mBlockSize(blockSize),
+    mNumBlocks(bufferList.getNumBlocks(blockSize)),
+    mTotalNumBytes(bufferList.getTotalNumBytes()),
+    mBlockIdx(0),
+    mBufferIdx(0),
+    mBufferOffset(0)
+{
+}
+
+bool NITFBlockIterator::next(const void*& data, size_t& numBytes)
+{
+    if (mBlockIdx >= mNumBlocks)
+    {
+        data = NULL;
+        numBytes = 0;
+        return false;
+    }
+
+    numBytes = (mBlockIdx == mNumBlocks - 1) ?
+            mTotalNumBytes - mBlockIdx * mBlockSize :
+            mBlockSize;
+    ++mBlockIdx;
+
+    const std::vector<NITFBuffer>& buffers(mBufferList.getBuffers());
+
+    // Move past any exhausted or empty buffers
+    while (mBufferOffset == buffers[mBufferIdx].mNumBytes)
+    {
+        ++mBufferIdx;
+        mBufferOffset = 0;
+    }
+
+    const NITFBuffer& buffer(buffers[mBufferIdx]);
+    const sys::byte* const startPtr =
+            static_cast<const sys::byte*>(buffer.mData) + mBufferOffset;
+    const size_t numBytesLeftInBuffer = buffer.mNumBytes - mBufferOffset;
+    if (numBytesLeftInBuffer >= numBytes)
+    {
+        mBufferOffset += numBytes;
+        data = startPtr;
+        return true;
+    }
+
+    // This block spans buffers
+    mScratch.resize(numBytes);
+    memcpy(&mScratch[0], startPtr, numBytesLeftInBuffer);
+    size_t numBytesCopied(numBytesLeftInBuffer);
+    mBufferOffset = buffer.mNumBytes;
+
+    while (numBytesCopied < numBytes)
+    {
+        ++mBufferIdx;
+        const NITFBuffer& curBuffer(buffers[mBufferIdx]);
+        const size_t numBytesToCopy =
+                std::min(curBuffer.mNumBytes, numBytes - numBytesCopied);
+
+        if (numBytesToCopy > 0)
+        {
+            memcpy(&mScratch[numBytesCopied], curBuffer.mData,
+                   numBytesToCopy);
+            numBytesCopied += numBytesToCopy;
+        }
+        mBufferOffset = numBytesToCopy;
+    }
+
+    data = &mScratch[0];
+    return true;
+}
+}
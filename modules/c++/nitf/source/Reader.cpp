@@ -78,6 +78,16 @@ nitf::Version Reader::getNITFVersion(const std::string& fileName)
     return nitf_Reader_getNITFVersion(fileName.c_str());
 }
 
+void Reader::setLazyTREs(bool lazy)
+{
+    nitf_Reader_setLazyTREs(getNativeOrThrow(), lazy ? 1 : 0);
+}
+
+void Reader::setRecordArena(bool useArena)
+{
+    nitf_Reader_setRecordArena(getNativeOrThrow(), useArena ? 1 : 0);
+}
+
 nitf::Record Reader::read(nitf::IOHandle & io)
 {
     return readIO(io);
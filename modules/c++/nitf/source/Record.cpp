@@ -68,6 +68,11 @@ nitf::Version Record::getVersion() const
     return nitf_Record_getVersion(getNativeOrThrow());
 }
 
+nitf::Uint64 Record::getArenaBytes() const
+{
+    return nitf_Record_getArenaBytes(getNativeOrThrow());
+}
+
 nitf::FileHeader Record::getHeader()
 {
     return nitf::FileHeader(getNativeOrThrow()->header);
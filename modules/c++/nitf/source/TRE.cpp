@@ -159,3 +159,14 @@ std::string TRE::getID() const
     const char* id = nitf_TRE_getID(getNativeOrThrow());
     return id ? std::string(id) : "";
 }
+
+bool TRE::isParsed() const
+{
+    return nitf_TRE_isParsed(getNativeOrThrow()) ? true : false;
+}
+
+void TRE::parse()
+{
+    if (!nitf_TRE_parse(getNativeOrThrow(), &error))
+        throw nitf::NITFException(&error);
+}
@@ -1119,11 +1119,12 @@ void writeNITF(nitf::Record& record, const std::string& filename)
     byteProvider.getBytes(NITRO_IMAGE.data, 0, NITRO_IMAGE.height,
             fileOffset, buffers);
     io::FileOutputStream outputStream(filename);
-    for (size_t ii = 0; ii < buffers.mBuffers.size(); ++ii)
+    const std::vector<nitf::NITFBuffer>& buffersToWrite(buffers.getBuffers());
+    for (size_t ii = 0; ii < buffersToWrite.size(); ++ii)
     {
         outputStream.write(
-                static_cast<const sys::byte*>(buffers.mBuffers[ii].mData),
-                buffers.mBuffers[ii].mNumBytes);
+                static_cast<const sys::byte*>(buffersToWrite[ii].mData),
+                buffersToWrite[ii].mNumBytes);
     }
 }
 
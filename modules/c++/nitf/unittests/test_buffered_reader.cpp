@@ -0,0 +1,214 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+
+#include <sys/File.h>
+#include <sys/OS.h>
+#include <io/TempFile.h>
+#include <nitf/BufferedReader.hpp>
+
+#include "TestCase.h"
+
+namespace
+{
+void writeFile(const std::string& pathname,
+               size_t numBytes,
+               std::vector<char>& contents)
+{
+    contents.resize(numBytes);
+    for (size_t ii = 0; ii < contents.size(); ++ii)
+    {
+        contents[ii] = static_cast<char>(rand() % 256);
+    }
+
+    sys::File file(pathname, sys::File::WRITE_ONLY,
+                   sys::File::CREATE | sys::File::TRUNCATE);
+    file.writeFrom(&contents[0], contents.size());
+    file.close();
+}
+
+TEST_CASE(testSequentialRead)
+{
+    const io::TempFile file;
+    std::vector<char> expected;
+    writeFile(file.pathname(), 10007, expected);
+
+    for (size_t numBuffers = 1; numBuffers <= 5; ++numBuffers)
+    {
+        std::ostringstream ostr;
+        ostr << numBuffers << " buffers";
+
+        nitf::BufferedReader reader(file.pathname(), 1000, numBuffers);
+        TEST_ASSERT_EQ_MSG(ostr.str(),
+                           static_cast<size_t>(reader.getSize()),
+                           expected.size());
+
+        // Read in odd sized pieces that straddle buffers
+        std::vector<char> contents(expected.size());
+        for (size_t offset = 0; offset < contents.size(); offset += 333)
+        {
+            const size_t numBytes =
+                    std::min<size_t>(333, contents.size() - offset);
+            reader.read(&contents[offset], numBytes);
+            TEST_ASSERT_EQ_MSG(ostr.str(),
+                               static_cast<size_t>(reader.tell()),
+                               offset + numBytes);
+        }
+        TEST_ASSERT_EQ_MSG(ostr.str(), contents == expected, true);
+        TEST_ASSERT_EQ_MSG(ostr.str(), reader.getTotalRead(), expected.size());
+
+        // Reading ahead stops at the end of the file.  A single buffer
+        // refills as soon as it's used up, so it also does an empty read.
+        const size_t numBlocks = (numBuffers == 1) ? 12 : 11;
+        TEST_ASSERT_EQ_MSG(ostr.str(), reader.getNumBlocksRead(), numBlocks);
+        TEST_ASSERT_EQ_MSG(ostr.str(), reader.getNumPartialBlocksRead(),
+                           numBlocks - 10);
+
+        char byte;
+        TEST_EXCEPTION(reader.read(&byte, 1));
+    }
+}
+
+TEST_CASE(testRandomAccess)
+{
+    const io::TempFile file;
+    std::vector<char> expected;
+    writeFile(file.pathname(), 20000, expected);
+
+    for (size_t numBuffers = 1; numBuffers <= 5; ++numBuffers)
+    {
+        std::ostringstream ostr;
+        ostr << numBuffers << " buffers";
+
+        nitf::BufferedReader reader(file.pathname(), 512, numBuffers);
+        std::vector<char> contents;
+        for (size_t ii = 0; ii < 200; ++ii)
+        {
+            const size_t offset = rand() % expected.size();
+            const size_t numBytes =
+                    std::min<size_t>(rand() % 2000, expected.size() - offset);
+
+            if (ii % 3 == 0)
+            {
+                reader.seek(offset, NITF_SEEK_SET);
+            }
+            else if (ii % 3 == 1)
+            {
+                reader.seek(static_cast<nitf::Off>(offset) - reader.tell(),
+                            NITF_SEEK_CUR);
+            }
+            else
+            {
+                reader.seek(static_cast<nitf::Off>(offset) - reader.getSize(),
+                            NITF_SEEK_END);
+            }
+            TEST_ASSERT_EQ_MSG(ostr.str(),
+                               static_cast<size_t>(reader.tell()), offset);
+
+            contents.resize(numBytes);
+            if (numBytes > 0)
+            {
+                reader.read(&contents[0], numBytes);
+                TEST_ASSERT_EQ_MSG(ostr.str(),
+                                   std::equal(contents.begin(),
+                                              contents.end(),
+                                              expected.begin() + offset),
+                                   true);
+            }
+        }
+    }
+}
+
+TEST_CASE(testBackwardSeekIsCached)
+{
+    // Enough buffers to hold the whole file
+    const io::TempFile file;
+    std::vector<char> expected;
+    writeFile(file.pathname(), 4000, expected);
+
+    nitf::BufferedReader reader(file.pathname(), 1000, 8);
+    std::vector<char> contents(expected.size());
+    reader.read(&contents[0], contents.size());
+    TEST_ASSERT_EQ(reader.getNumBlocksRead(), 4);
+
+    reader.seek(0, NITF_SEEK_SET);
+    reader.read(&contents[0], contents.size());
+    TEST_ASSERT_EQ(contents == expected, true);
+    TEST_ASSERT_EQ(reader.getNumBlocksRead(), 4);
+}
+
+TEST_CASE(testFailedChunkIsNotReused)
+{
+    const io::TempFile file;
+    std::vector<char> expected;
+    writeFile(file.pathname(), 8000, expected);
+
+    // Two buffers, so asking for chunk 5 queues 5 and 6 over chunks 0 and 1
+    nitf::BufferedReader reader(file.pathname(), 1000, 2);
+    std::vector<char> contents(1000);
+    reader.read(&contents[0], contents.size());
+    while (reader.getNumBlocksRead() < 2)
+    {
+        sys::OS().millisleep(1);
+    }
+
+    // Shrink the file out from under the reader so chunks 5 and 6 fail
+    writeFile(file.pathname(), 1000, expected);
+    reader.seek(5000, NITF_SEEK_SET);
+    TEST_EXCEPTION(reader.read(&contents[0], 1));
+
+    // Chunk 6 went into the buffer we were reading from.  It must not be
+    // mistaken for data just because it's for the right chunk.
+    reader.seek(6000, NITF_SEEK_SET);
+    TEST_EXCEPTION(reader.read(&contents[0], 1));
+}
+
+TEST_CASE(testReadAtIsSerialized)
+{
+    // Reads move the shared position, so concurrent reads are not offered
+    const io::TempFile file;
+    std::vector<char> expected;
+    writeFile(file.pathname(), 4000, expected);
+
+    nitf::BufferedReader reader(file.pathname(), 1000);
+    TEST_ASSERT_EQ(reader.canReadAt(), false);
+
+    std::vector<char> contents(500);
+    reader.readAt(2500, &contents[0], contents.size());
+    TEST_ASSERT_EQ(std::equal(contents.begin(), contents.end(),
+                              expected.begin() + 2500), true);
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testSequentialRead);
+    TEST_CHECK(testRandomAccess);
+    TEST_CHECK(testBackwardSeekIsCached);
+    TEST_CHECK(testFailedChunkIsNotReused);
+    TEST_CHECK(testReadAtIsSerialized);
+    return 0;
+}
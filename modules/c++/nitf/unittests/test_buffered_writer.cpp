@@ -0,0 +1,193 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <sstream>
+
+#include <sys/File.h>
+#include <sys/StopWatch.h>
+#include <io/TempFile.h>
+#include <nitf/BufferedWriter.hpp>
+
+#include "TestCase.h"
+
+namespace
+{
+void readFile(const std::string& pathname, std::vector<char>& contents)
+{
+    sys::File file(pathname);
+    contents.resize(static_cast<size_t>(file.length()));
+    if (!contents.empty())
+    {
+        file.readInto(&contents[0], contents.size());
+    }
+}
+
+// Writes a mix of small and large chunks, then goes back and patches a
+// few bytes near the start the way the NITF writer fixes up lengths
+void writeAndPatch(nitf::BufferedWriter& writer, std::vector<char>& expected)
+{
+    expected.resize(1000);
+    for (size_t ii = 0; ii < expected.size(); ++ii)
+    {
+        expected[ii] = static_cast<char>(ii * 13);
+    }
+
+    size_t offset = 0;
+    const size_t chunkSizes[] = { 1, 7, 64, 300, 2, 128, 498 };
+    for (size_t ii = 0; ii < sizeof(chunkSizes) / sizeof(chunkSizes[0]); ++ii)
+    {
+        writer.write(&expected[offset], chunkSizes[ii]);
+        offset += chunkSizes[ii];
+    }
+
+    const char patch[] = "PATCH";
+    writer.seek(10, NITF_SEEK_SET);
+    writer.write(patch, 5);
+    std::copy(patch, patch + 5, expected.begin() + 10);
+    writer.seek(0, NITF_SEEK_END);
+    writer.write(patch, 5);
+    expected.insert(expected.end(), patch, patch + 5);
+}
+
+TEST_CASE(testSingleBuffer)
+{
+    const io::TempFile file;
+    std::vector<char> expected;
+    {
+        sys::RealTimeStopWatch sw;
+        sw.start();
+        nitf::BufferedWriter writer(file.pathname(), 100);
+        writeAndPatch(writer, expected);
+        writer.close();
+        const double wallTime = sw.stop() / 1000.;
+
+        // The patched bytes get written twice
+        TEST_ASSERT_EQ(writer.getTotalWritten(), expected.size() + 5);
+
+        // Every write happens on the caller's thread, so all of it stalls
+        TEST_ASSERT_EQ(writer.getTotalStallTime(), writer.getTotalWriteTime());
+        TEST_ASSERT_LESSER_EQ(writer.getTotalWriteTime(), wallTime);
+    }
+
+    std::vector<char> contents;
+    readFile(file.pathname(), contents);
+    TEST_ASSERT(contents == expected);
+}
+
+TEST_CASE(testMultipleBuffers)
+{
+    for (size_t numBuffers = 1; numBuffers <= 4; ++numBuffers)
+    {
+        const io::TempFile file;
+        std::vector<char> expected;
+        {
+            sys::RealTimeStopWatch sw;
+            sw.start();
+            nitf::BufferedWriter writer(file.pathname(), 100, numBuffers,
+                                        nitf::BufferedWriter::SYNC_NEVER);
+            writeAndPatch(writer, expected);
+            TEST_ASSERT_EQ(static_cast<size_t>(writer.tell()),
+                           expected.size());
+            TEST_ASSERT_EQ(static_cast<size_t>(writer.getSize()),
+                           expected.size());
+            writer.close();
+            const double wallTime = sw.stop() / 1000.;
+
+            TEST_ASSERT_EQ(writer.getTotalWritten(), expected.size() + 5);
+
+            // The disk and the caller's waits on it both happened while we
+            // were timing.  With one buffer the caller waits on every write.
+            TEST_ASSERT_LESSER_EQ(writer.getTotalWriteTime(), wallTime);
+            TEST_ASSERT_LESSER_EQ(writer.getTotalStallTime(), wallTime);
+            if (numBuffers == 1)
+            {
+                TEST_ASSERT_EQ(writer.getTotalStallTime(),
+                               writer.getTotalWriteTime());
+            }
+        }
+
+        std::vector<char> contents;
+        readFile(file.pathname(), contents);
+        TEST_ASSERT(contents == expected);
+    }
+}
+
+TEST_CASE(testUnclosed)
+{
+    // The destructor has to drain anything still in flight
+    const io::TempFile file;
+    std::vector<char> expected;
+    {
+        nitf::BufferedWriter writer(file.pathname(), 100, 3,
+                                    nitf::BufferedWriter::SYNC_EVERY_BUFFER);
+        writeAndPatch(writer, expected);
+    }
+
+    std::vector<char> contents;
+    readFile(file.pathname(), contents);
+    TEST_ASSERT(contents == expected);
+}
+
+TEST_CASE(testDirectIO)
+{
+    // Whole aligned buffers can go uncached; the partial tail and the
+    // patches can't.  Either way the file should come out the same, and
+    // this still works if the filesystem doesn't do direct I/O.
+    const size_t bufferSize = nitf::BufferedWriter::DIRECT_IO_ALIGNMENT;
+    const io::TempFile file;
+    std::vector<char> expected;
+    {
+        nitf::BufferedWriter writer(file.pathname(), bufferSize, 2,
+                                    nitf::BufferedWriter::SYNC_ON_CLOSE,
+                                    true);
+        expected.resize(3 * bufferSize + 17);
+        for (size_t ii = 0; ii < expected.size(); ++ii)
+        {
+            expected[ii] = static_cast<char>(ii * 5);
+        }
+        writer.write(&expected[0], expected.size());
+
+        const char patch[] = "PATCH";
+        writer.seek(10, NITF_SEEK_SET);
+        writer.write(patch, 5);
+        std::copy(patch, patch + 5, expected.begin() + 10);
+        writer.seek(0, NITF_SEEK_END);
+        writer.write(patch, 5);
+        expected.insert(expected.end(), patch, patch + 5);
+        writer.close();
+    }
+
+    std::vector<char> contents;
+    readFile(file.pathname(), contents);
+    TEST_ASSERT(contents == expected);
+}
+}
+
+int main(int /*argc*/, char** /*argv*/)
+{
+    TEST_CHECK(testSingleBuffer);
+    TEST_CHECK(testMultipleBuffers);
+    TEST_CHECK(testUnclosed);
+    TEST_CHECK(testDirectIO);
+    return 0;
+}
@@ -475,6 +475,81 @@ TEST_CASE(testBlockPartialImage)
         }
     }
 }
+TEST_CASE(testMultithreaded)
+{
+    // Multiple segments with pad rows and pad cols, and a few pixel sizes
+    // so both short and long rows get copied
+    static const size_t NUM_COLS = 103;
+    static const size_t NUM_ROWS_PER_BLOCK = 8;
+    static const size_t NUM_COLS_PER_BLOCK = 20;
+
+    std::vector<size_t> numRowsPerSegment(3);
+    numRowsPerSegment[0] = 37;
+    numRowsPerSegment[1] = 16;
+    numRowsPerSegment[2] = 21;
+    static const size_t NUM_ROWS = 37 + 16 + 21;
+
+    const nitf::ImageBlocker blocker(numRowsPerSegment,
+                                     NUM_COLS,
+                                     NUM_ROWS_PER_BLOCK,
+                                     NUM_COLS_PER_BLOCK);
+
+    for (size_t numBytesPerPixel = 1; numBytesPerPixel <= 8;
+         numBytesPerPixel *= 2)
+    {
+        std::vector<sys::ubyte> input(NUM_ROWS * NUM_COLS * numBytesPerPixel);
+        for (size_t ii = 0; ii < input.size(); ++ii)
+        {
+            input[ii] = static_cast<sys::ubyte>(ii * 7 + 1);
+        }
+
+        const size_t numBytes =
+                blocker.getNumBytesRequired(0, NUM_ROWS, numBytesPerPixel);
+        std::vector<sys::ubyte> expected(numBytes, 0xFF);
+        blocker.block(&input[0], 0, NUM_ROWS, numBytesPerPixel,
+                      &expected[0]);
+
+        for (size_t numThreads = 0; numThreads <= 5; ++numThreads)
+        {
+            std::ostringstream ostr;
+            ostr << numBytesPerPixel << " bytes/pixel with " << numThreads
+                 << " threads";
+
+            std::vector<sys::ubyte> output(numBytes, 0xFF);
+            blocker.block(&input[0], 0, NUM_ROWS, numBytesPerPixel,
+                          numThreads, &output[0]);
+            TEST_ASSERT_EQ_MSG(ostr.str(), output == expected, true);
+
+            // Same thing but into a buffer per block
+            std::vector<sys::ubyte> perBlock(numBytes, 0xFF);
+            std::vector<void*> blockOutputs;
+            for (size_t seg = 0, offset = 0;
+                 seg < blocker.getNumSegments();
+                 ++seg)
+            {
+                const size_t blockNumBytes =
+                        blocker.getNumRowsPerBlock()[seg] *
+                        blocker.getNumColsPerBlock() * numBytesPerPixel;
+                const size_t numBlocksInSeg =
+                        blocker.getNumRowsOfBlocks(seg) *
+                        blocker.getNumColsOfBlocks();
+                for (size_t block = 0; block < numBlocksInSeg; ++block)
+                {
+                    blockOutputs.push_back(&perBlock[offset]);
+                    offset += blockNumBytes;
+                }
+            }
+            blocker.block(&input[0], 0, NUM_ROWS, numBytesPerPixel,
+                          numThreads, blockOutputs);
+            TEST_ASSERT_EQ_MSG(ostr.str(), perBlock == expected, true);
+
+            blockOutputs.pop_back();
+            TEST_EXCEPTION(blocker.block(&input[0], 0, NUM_ROWS,
+                                         numBytesPerPixel, numThreads,
+                                         blockOutputs));
+        }
+    }
+}
 }
 
 int main(int /*argc*/, char** /*argv*/)
@@ -486,6 +561,7 @@ int main(int /*argc*/, char** /*argv*/)
     TEST_CHECK(testMultipleSegmentsPartialRowsOnSegmentBoundaries);
     TEST_CHECK(testMultipleSegmentsPartialRowsOnSegmentBoundariesWithPadCols);
     TEST_CHECK(testBlockPartialImage);
+    TEST_CHECK(testMultithreaded);
 
     return 0;
 }
@@ -0,0 +1,559 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <vector>
+#include <string>
+
+#include <import/nitf.hpp>
+#include <io/TempFile.h>
+#include <sys/File.h>
+#include <mt/ThreadGroup.h>
+#include <sys/Runnable.h>
+
+#include "TestCase.h"
+
+namespace
+{
+// 4 x 4 blocks of 16 x 16 8-bit pixels
+static const nitf::Uint32 NUM_ROWS = 64;
+static const nitf::Uint32 NUM_COLS = 64;
+static const nitf::Uint32 BLOCK_LENGTH = 16;
+static const nitf::Uint32 BLOCK_BYTES = BLOCK_LENGTH * BLOCK_LENGTH;
+
+void writeImage(const std::string& pathname,
+                const std::vector<nitf::Uint8>& pixels)
+{
+    nitf::Record record(NITF_VER_21);
+    nitf::ImageSegment segment = record.newImageSegment();
+    nitf::ImageSubheader subheader = segment.getSubheader();
+
+    std::vector<nitf::BandInfo> bands(1);
+    bands[0].getRepresentation().set("M ");
+    subheader.setPixelInformation("INT", 8, 8, "R", "MONO", "VIS", bands);
+    subheader.setBlocking(NUM_ROWS, NUM_COLS, BLOCK_LENGTH, BLOCK_LENGTH, "B");
+
+    nitf::IOHandle output(pathname, NITF_ACCESS_WRITEONLY, NITF_CREATE);
+    nitf::Writer writer;
+    writer.prepare(output, record);
+
+    nitf::ImageWriter imageWriter = writer.newImageWriter(0);
+    nitf::ImageSource source;
+    nitf::MemorySource band(&pixels[0], pixels.size(), 0, 1, 0);
+    source.addBand(band);
+    imageWriter.attachSource(source);
+    writer.write();
+    output.close();
+}
+
+// Reads the full image one row at a time so every row visits each block
+// column once
+void readByRows(nitf::ImageReader& imageReader,
+                std::vector<nitf::Uint8>& pixels)
+{
+    pixels.resize(NUM_ROWS * NUM_COLS);
+
+    nitf::Uint32 bandList = 0;
+    nitf::SubWindow subWindow;
+    subWindow.setStartCol(0);
+    subWindow.setNumCols(NUM_COLS);
+    subWindow.setNumRows(1);
+    subWindow.setBandList(&bandList);
+    subWindow.setNumBands(1);
+
+    for (nitf::Uint32 row = 0; row < NUM_ROWS; ++row)
+    {
+        nitf::Uint8* buffer = &pixels[row * NUM_COLS];
+        int padded;
+        subWindow.setStartRow(row);
+        imageReader.read(subWindow, &buffer, &padded);
+    }
+}
+
+// Reads a band of rows, one block row at a time, many times over
+class ReadRows : public sys::Runnable
+{
+public:
+    ReadRows(nitf::ImageReader& imageReader,
+             nitf::Uint32 startRow,
+             nitf::Uint32 numRows,
+             std::vector<nitf::Uint8>& pixels) :
+        mImageReader(imageReader),
+        mStartRow(startRow),
+        mNumRows(numRows),
+        mPixels(pixels)
+    {
+    }
+
+    virtual void run()
+    {
+        nitf::Uint32 bandList = 0;
+        nitf::SubWindow subWindow;
+        subWindow.setStartCol(0);
+        subWindow.setNumCols(NUM_COLS);
+        subWindow.setNumRows(BLOCK_LENGTH);
+        subWindow.setBandList(&bandList);
+        subWindow.setNumBands(1);
+
+        for (size_t pass = 0; pass < 50; ++pass)
+        {
+            for (nitf::Uint32 row = mStartRow;
+                 row < mStartRow + mNumRows;
+                 row += BLOCK_LENGTH)
+            {
+                nitf::Uint8* buffer = &mPixels[row * NUM_COLS];
+                int padded;
+                subWindow.setStartRow(row);
+                mImageReader.read(subWindow, &buffer, &padded);
+            }
+        }
+    }
+
+private:
+    nitf::ImageReader& mImageReader;
+    const nitf::Uint32 mStartRow;
+    const nitf::Uint32 mNumRows;
+    std::vector<nitf::Uint8>& mPixels;
+};
+
+void readConcurrently(nitf::ImageReader& imageReader,
+                      std::vector<nitf::Uint8>& pixels)
+{
+    static const size_t NUM_THREADS = 4;
+    const nitf::Uint32 rowsPerThread = NUM_ROWS / NUM_THREADS;
+
+    pixels.assign(NUM_ROWS * NUM_COLS, 0);
+
+    mt::ThreadGroup threads(false);
+    for (size_t ii = 0; ii < NUM_THREADS; ++ii)
+    {
+        threads.createThread(new ReadRows(imageReader,
+                                          ii * rowsPerThread,
+                                          rowsPerThread,
+                                          pixels));
+    }
+    threads.joinAll();
+}
+
+struct TestImage
+{
+    TestImage() :
+        pixels(NUM_ROWS * NUM_COLS)
+    {
+        for (size_t ii = 0; ii < pixels.size(); ++ii)
+        {
+            pixels[ii] = static_cast<nitf::Uint8>(ii * 7);
+        }
+        writeImage(file.pathname(), pixels);
+    }
+
+    io::TempFile file;
+    std::vector<nitf::Uint8> pixels;
+};
+
+TEST_CASE(testSingleBlockCache)
+{
+    const TestImage image;
+
+    nitf::IOHandle input(image.file.pathname());
+    nitf::Reader reader;
+    reader.read(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+    imageReader.setReadCaching();
+
+    std::vector<nitf::Uint8> pixels;
+    readByRows(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+
+    // Every request switches blocks
+    const nitf::Uint64 numRequests = NUM_ROWS * (NUM_COLS / BLOCK_LENGTH);
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), numRequests);
+    TEST_ASSERT_EQ(imageReader.getReadCacheHits(), 0);
+    TEST_ASSERT_EQ(imageReader.getReadCacheBytes(), BLOCK_BYTES);
+}
+
+TEST_CASE(testBlockRowCache)
+{
+    const TestImage image;
+
+    nitf::IOHandle input(image.file.pathname());
+    nitf::Reader reader;
+    reader.read(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    // Room for one row of blocks
+    imageReader.setReadCaching(BLOCK_BYTES * (NUM_COLS / BLOCK_LENGTH));
+
+    std::vector<nitf::Uint8> pixels;
+    readByRows(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+
+    // Each block is read once
+    const nitf::Uint64 numBlocks =
+            (NUM_ROWS / BLOCK_LENGTH) * (NUM_COLS / BLOCK_LENGTH);
+    const nitf::Uint64 numRequests = NUM_ROWS * (NUM_COLS / BLOCK_LENGTH);
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), numBlocks);
+    TEST_ASSERT_EQ(imageReader.getReadCacheHits(), numRequests - numBlocks);
+    TEST_ASSERT_EQ(imageReader.getReadCacheBytes(),
+                   BLOCK_BYTES * (NUM_COLS / BLOCK_LENGTH));
+}
+
+TEST_CASE(testCacheEviction)
+{
+    const TestImage image;
+
+    nitf::IOHandle input(image.file.pathname());
+    nitf::Reader reader;
+    reader.read(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    // Fits the whole image
+    imageReader.setReadCaching(NUM_ROWS * NUM_COLS);
+    std::vector<nitf::Uint8> pixels;
+    readByRows(imageReader, pixels);
+    readByRows(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+
+    const nitf::Uint64 numBlocks =
+            (NUM_ROWS / BLOCK_LENGTH) * (NUM_COLS / BLOCK_LENGTH);
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), numBlocks);
+    TEST_ASSERT_EQ(imageReader.getReadCacheBytes(), NUM_ROWS * NUM_COLS);
+
+    // Shrinking the budget releases least recently used blocks
+    imageReader.setReadCaching(BLOCK_BYTES * 2);
+    TEST_ASSERT_EQ(imageReader.getReadCacheBytes(), BLOCK_BYTES * 2);
+
+    // The two most recently used blocks are the last two of the image
+    nitf::Uint64 blockSize;
+    const nitf::Uint8* block =
+            imageReader.readBlock(numBlocks - 1, &blockSize);
+    TEST_ASSERT_EQ(blockSize, BLOCK_BYTES);
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), numBlocks);
+    TEST_ASSERT_EQ(block[0],
+                   image.pixels[(NUM_ROWS - BLOCK_LENGTH) * NUM_COLS +
+                                NUM_COLS - BLOCK_LENGTH]);
+}
+
+TEST_CASE(testConcurrentReads)
+{
+    const TestImage image;
+
+    nitf::IOHandle input(image.file.pathname());
+    nitf::Reader reader;
+    reader.read(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    // Uncached
+    std::vector<nitf::Uint8> pixels;
+    readConcurrently(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+
+    // Cached, threads compete for a cache smaller than the image
+    imageReader.setReadCaching(BLOCK_BYTES * 3);
+    readConcurrently(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+    TEST_ASSERT_LESSER_EQ(imageReader.getReadCacheBytes(), BLOCK_BYTES * 3);
+}
+
+TEST_CASE(testBlockRowWrites)
+{
+    // Neither dimension is a whole number of blocks, so the last block row
+    // written is a partial one
+    static const nitf::Uint32 numRows = 45;
+    static const nitf::Uint32 numCols = 37;
+    static const nitf::Uint32 numBands = 2;
+
+    std::vector<std::vector<nitf::Uint8> > bandPixels(numBands);
+    for (nitf::Uint32 band = 0; band < numBands; ++band)
+    {
+        bandPixels[band].resize(numRows * numCols);
+        for (size_t ii = 0; ii < bandPixels[band].size(); ++ii)
+        {
+            bandPixels[band][ii] = static_cast<nitf::Uint8>(ii * 3 + band);
+        }
+    }
+
+    io::TempFile file;
+    {
+        nitf::Record record(NITF_VER_21);
+        nitf::ImageSegment segment = record.newImageSegment();
+        nitf::ImageSubheader subheader = segment.getSubheader();
+
+        std::vector<nitf::BandInfo> bands(numBands);
+        for (nitf::Uint32 band = 0; band < numBands; ++band)
+        {
+            bands[band].getRepresentation().set("M ");
+        }
+        subheader.setPixelInformation("INT", 8, 8, "R", "MULTI", "VIS", bands);
+        subheader.setBlocking(numRows, numCols, BLOCK_LENGTH, BLOCK_LENGTH,
+                              "B");
+
+        nitf::IOHandle output(file.pathname(), NITF_ACCESS_WRITEONLY,
+                              NITF_CREATE);
+        nitf::Writer writer;
+        writer.prepare(output, record);
+
+        nitf::ImageWriter imageWriter = writer.newImageWriter(0);
+        nitf::ImageSource source;
+        for (nitf::Uint32 band = 0; band < numBands; ++band)
+        {
+            nitf::MemorySource bandSource(&bandPixels[band][0],
+                                          bandPixels[band].size(), 0, 1, 0);
+            source.addBand(bandSource);
+        }
+        imageWriter.attachSource(source);
+        writer.write();
+        output.close();
+    }
+
+    nitf::IOHandle input(file.pathname());
+    nitf::Reader reader;
+    reader.read(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    std::vector<nitf::Uint32> bandList(numBands);
+    std::vector<std::vector<nitf::Uint8> > pixels(numBands);
+    std::vector<nitf::Uint8*> buffers(numBands);
+    for (nitf::Uint32 band = 0; band < numBands; ++band)
+    {
+        bandList[band] = band;
+        pixels[band].resize(numRows * numCols);
+        buffers[band] = &pixels[band][0];
+    }
+
+    nitf::SubWindow subWindow;
+    subWindow.setNumRows(numRows);
+    subWindow.setNumCols(numCols);
+    subWindow.setBandList(&bandList[0]);
+    subWindow.setNumBands(numBands);
+    int padded;
+    imageReader.read(subWindow, &buffers[0], &padded);
+
+    for (nitf::Uint32 band = 0; band < numBands; ++band)
+    {
+        TEST_ASSERT(pixels[band] == bandPixels[band]);
+    }
+}
+
+TEST_CASE(testMultiBandReads)
+{
+    // 16-bit pixels so reads are byte swapped, and a partial block row and
+    // column so some blocks are only partly image
+    static const nitf::Uint32 numRows = 45;
+    static const nitf::Uint32 numCols = 37;
+    static const nitf::Uint32 numBands = 3;
+    static const char* const modes[] = { "S", "B" };
+
+    std::vector<std::vector<nitf::Uint16> > bandPixels(numBands);
+    for (nitf::Uint32 band = 0; band < numBands; ++band)
+    {
+        bandPixels[band].resize(numRows * numCols);
+        for (size_t ii = 0; ii < bandPixels[band].size(); ++ii)
+        {
+            bandPixels[band][ii] =
+                    static_cast<nitf::Uint16>(ii * 257 + band * 1000);
+        }
+    }
+
+    for (size_t mode = 0; mode < sizeof(modes) / sizeof(modes[0]); ++mode)
+    {
+        io::TempFile file;
+        {
+            nitf::Record record(NITF_VER_21);
+            nitf::ImageSegment segment = record.newImageSegment();
+            nitf::ImageSubheader subheader = segment.getSubheader();
+
+            std::vector<nitf::BandInfo> bands(numBands);
+            for (nitf::Uint32 band = 0; band < numBands; ++band)
+            {
+                bands[band].getRepresentation().set("M ");
+            }
+            subheader.setPixelInformation("INT", 16, 16, "R", "MULTI", "VIS",
+                                          bands);
+            subheader.setBlocking(numRows, numCols, BLOCK_LENGTH,
+                                  BLOCK_LENGTH, modes[mode]);
+
+            nitf::IOHandle output(file.pathname(), NITF_ACCESS_WRITEONLY,
+                                  NITF_CREATE);
+            nitf::Writer writer;
+            writer.prepare(output, record);
+
+            nitf::ImageWriter imageWriter = writer.newImageWriter(0);
+            nitf::ImageSource source;
+            for (nitf::Uint32 band = 0; band < numBands; ++band)
+            {
+                nitf::MemorySource bandSource(&bandPixels[band][0],
+                                              bandPixels[band].size() * 2,
+                                              0, 2, 0);
+                source.addBand(bandSource);
+            }
+            imageWriter.attachSource(source);
+            writer.write();
+            output.close();
+        }
+
+        nitf::IOHandle input(file.pathname());
+        nitf::Reader reader;
+        reader.read(input);
+        nitf::ImageReader imageReader = reader.newImageReader(0);
+
+        // Whole image, block aligned, narrower than a block and straddling
+        // block boundaries, each with all bands and a reordered subset
+        static const nitf::Uint32 windows[][4] =
+        {
+            // startRow, numRows, startCol, numCols
+            { 0, numRows, 0, numCols },
+            { 16, 16, 16, 16 },
+            { 3, 40, 5, 7 },
+            { 10, 30, 12, 25 },
+            { 44, 1, 0, numCols }
+        };
+        static const nitf::Uint32 allBands[] = { 0, 1, 2 };
+        static const nitf::Uint32 someBands[] = { 2, 0 };
+
+        for (size_t ww = 0; ww < sizeof(windows) / sizeof(windows[0]); ++ww)
+        {
+            for (size_t subset = 0; subset < 2; ++subset)
+            {
+                const nitf::Uint32* const bandList =
+                        subset ? someBands : allBands;
+                const nitf::Uint32 numRead = subset ? 2 : numBands;
+                const nitf::Uint32* const window = windows[ww];
+
+                std::vector<std::vector<nitf::Uint16> > pixels(numRead);
+                std::vector<nitf::Uint8*> buffers(numRead);
+                for (nitf::Uint32 ii = 0; ii < numRead; ++ii)
+                {
+                    pixels[ii].resize(window[1] * window[3]);
+                    buffers[ii] =
+                            reinterpret_cast<nitf::Uint8*>(&pixels[ii][0]);
+                }
+
+                nitf::SubWindow subWindow;
+                subWindow.setStartRow(window[0]);
+                subWindow.setNumRows(window[1]);
+                subWindow.setStartCol(window[2]);
+                subWindow.setNumCols(window[3]);
+                subWindow.setBandList(const_cast<nitf::Uint32*>(bandList));
+                subWindow.setNumBands(numRead);
+                int padded;
+                imageReader.read(subWindow, &buffers[0], &padded);
+
+                for (nitf::Uint32 ii = 0; ii < numRead; ++ii)
+                {
+                    const std::vector<nitf::Uint16>& expected =
+                            bandPixels[bandList[ii]];
+                    for (nitf::Uint32 row = 0; row < window[1]; ++row)
+                    {
+                        for (nitf::Uint32 col = 0; col < window[3]; ++col)
+                        {
+                            TEST_ASSERT_EQ(
+                                    pixels[ii][row * window[3] + col],
+                                    expected[(window[0] + row) * numCols +
+                                             window[2] + col]);
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE(testMappedBlocks)
+{
+    const TestImage image;
+
+    nitf::MMapIO input(image.file.pathname());
+    nitf::Reader reader;
+    reader.readIO(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    std::vector<nitf::Uint8> pixels;
+    readByRows(imageReader, pixels);
+    TEST_ASSERT(pixels == image.pixels);
+
+    // Blocks come straight from the mapping, so earlier ones stay valid
+    nitf::Uint64 blockSize;
+    const nitf::Uint8* const first = imageReader.readBlock(0, &blockSize);
+    TEST_ASSERT_EQ(blockSize, BLOCK_BYTES);
+    const nitf::Uint8* const second = imageReader.readBlock(1, &blockSize);
+    TEST_ASSERT_EQ(blockSize, BLOCK_BYTES);
+    TEST_ASSERT_EQ(second - first, static_cast<ptrdiff_t>(BLOCK_BYTES));
+    for (nitf::Uint32 row = 0; row < BLOCK_LENGTH; ++row)
+    {
+        for (nitf::Uint32 col = 0; col < BLOCK_LENGTH; ++col)
+        {
+            TEST_ASSERT_EQ(first[row * BLOCK_LENGTH + col],
+                           image.pixels[row * NUM_COLS + col]);
+            TEST_ASSERT_EQ(second[row * BLOCK_LENGTH + col],
+                           image.pixels[row * NUM_COLS + BLOCK_LENGTH + col]);
+        }
+    }
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), 0);
+}
+
+TEST_CASE(testMemoryBlocksAreCopied)
+{
+    const TestImage image;
+
+    std::vector<nitf::Uint8> contents;
+    {
+        sys::File file(image.file.pathname());
+        contents.resize(static_cast<size_t>(file.length()));
+        file.readInto(reinterpret_cast<char*>(&contents[0]), contents.size());
+    }
+
+    // Only a memory map hands out blocks in place, a caller's buffer is
+    // never aliased
+    nitf::MemoryIO input(&contents[0], contents.size());
+    nitf::Reader reader;
+    reader.readIO(input);
+    nitf::ImageReader imageReader = reader.newImageReader(0);
+
+    nitf::Uint64 blockSize;
+    const nitf::Uint8* const block = imageReader.readBlock(0, &blockSize);
+    TEST_ASSERT_EQ(blockSize, BLOCK_BYTES);
+    TEST_ASSERT(block < &contents[0] ||
+                block >= &contents[0] + contents.size());
+    for (nitf::Uint32 row = 0; row < BLOCK_LENGTH; ++row)
+    {
+        for (nitf::Uint32 col = 0; col < BLOCK_LENGTH; ++col)
+        {
+            TEST_ASSERT_EQ(block[row * BLOCK_LENGTH + col],
+                           image.pixels[row * NUM_COLS + col]);
+        }
+    }
+    TEST_ASSERT_EQ(imageReader.getReadCacheMisses(), 1);
+}
+}
+
+int main(int, char**)
+{
+    TEST_CHECK(testSingleBlockCache);
+    TEST_CHECK(testBlockRowCache);
+    TEST_CHECK(testCacheEviction);
+    TEST_CHECK(testConcurrentReads);
+    TEST_CHECK(testBlockRowWrites);
+    TEST_CHECK(testMultiBandReads);
+    TEST_CHECK(testMappedBlocks);
+    TEST_CHECK(testMemoryBlocksAreCopied);
+    return 0;
+}
@@ -21,11 +21,27 @@
  */
 
 #include <import/nitf.hpp>
+#include <io/TempFile.h>
 #include <iostream>
 #include "TestCase.h"
 
 namespace
 {
+void writeRecord(const std::string& pathname, nitf::Record& record)
+{
+    nitf::IOHandle output(pathname, NITF_ACCESS_WRITEONLY, NITF_CREATE);
+    nitf::Writer writer;
+    writer.prepare(output, record);
+    writer.write();
+    output.close();
+}
+
+nitf::TRE firstTRE(nitf::Record& record)
+{
+    nitf::Extensions extensions = record.getHeader().getExtendedSection();
+    return *extensions.begin();
+}
+
 TEST_CASE(setFields)
 {
     //create an ACFTA TRE
@@ -114,6 +130,139 @@ TEST_CASE(populateWhileIterating)
     }
     TEST_ASSERT_EQ(numFields, 29);
 }
+
+TEST_CASE(lazyParsing)
+{
+    const io::TempFile original;
+    {
+        nitf::Record record(NITF_VER_21);
+        nitf::TRE tre("JITCID");
+        tre.setField("FILCMT", "fyi");
+        record.getHeader().getExtendedSection().appendTRE(tre);
+        writeRecord(original.pathname(), record);
+    }
+
+    // Nothing is parsed until a field is asked for
+    nitf::IOHandle input(original.pathname());
+    nitf::Reader reader;
+    reader.setLazyTREs(true);
+    nitf::Record record = reader.read(input);
+    nitf::TRE tre = firstTRE(record);
+    TEST_ASSERT_EQ(tre.getTag(), std::string("JITCID"));
+    TEST_ASSERT(!tre.isParsed());
+    const size_t size = tre.getCurrentSize();
+    TEST_ASSERT(!tre.isParsed());
+
+    // Untouched TREs are written back as they were read
+    const io::TempFile copy;
+    writeRecord(copy.pathname(), record);
+    nitf::IOHandle copyInput(copy.pathname());
+    nitf::Reader copyReader;
+    nitf::Record copyRecord = copyReader.read(copyInput);
+    nitf::TRE copyTRE = firstTRE(copyRecord);
+    TEST_ASSERT(copyTRE.isParsed());
+    TEST_ASSERT_EQ(copyTRE.getCurrentSize(), size);
+    TEST_ASSERT_EQ(copyTRE.getField("FILCMT").toString().substr(0, 3),
+                   std::string("fyi"));
+
+    TEST_ASSERT_EQ(tre.getField("FILCMT").toString(),
+                   copyTRE.getField("FILCMT").toString());
+    TEST_ASSERT(tre.isParsed());
+    TEST_ASSERT_EQ(tre.getID(), copyTRE.getID());
+    TEST_ASSERT_EQ(tre.getCurrentSize(), size);
+}
+
+TEST_CASE(lazyCursor)
+{
+    const io::TempFile original;
+    size_t size = 0;
+    {
+        nitf::Record record(NITF_VER_21);
+        nitf::TRE tre("JITCID");
+        tre.setField("FILCMT", "fyi");
+        size = tre.getCurrentSize();
+        nitf::TRE other = tre.clone();
+        record.getHeader().getExtendedSection().appendTRE(tre);
+        record.getHeader().getExtendedSection().appendTRE(other);
+        writeRecord(original.pathname(), record);
+    }
+
+    nitf::IOHandle input(original.pathname());
+    nitf::Reader reader;
+    reader.setLazyTREs(true);
+    nitf::Record record = reader.read(input);
+
+    // The C cursor and TREUtils calls parse an untouched TRE first
+    nitf::TRE tre = firstTRE(record);
+    TEST_ASSERT(!tre.isParsed());
+    nitf_TRECursor cursor = nitf_TRECursor_begin(tre.getNative());
+    TEST_ASSERT(tre.isParsed());
+    TEST_ASSERT(!nitf_TRECursor_isDone(&cursor));
+    nitf_TRECursor_cleanup(&cursor);
+
+    nitf::ExtensionsIterator it =
+            record.getHeader().getExtendedSection().begin();
+    ++it;
+    nitf::TRE other = *it;
+    TEST_ASSERT(!other.isParsed());
+    TEST_ASSERT_EQ(nitf_TREUtils_computeLength(other.getNative()),
+                   static_cast<int>(size));
+    TEST_ASSERT(other.isParsed());
+}
+
+TEST_CASE(recordArena)
+{
+    const io::TempFile original;
+    {
+        nitf::Record record(NITF_VER_21);
+        record.getHeader().getFileTitle().set("arena");
+        nitf::TRE tre("JITCID");
+        tre.setField("FILCMT", "fyi");
+        record.getHeader().getExtendedSection().appendTRE(tre);
+        writeRecord(original.pathname(), record);
+    }
+
+    nitf::IOHandle input(original.pathname());
+    nitf::Reader reader;
+    reader.setRecordArena(true);
+    nitf::Record record = reader.read(input);
+    TEST_ASSERT(record.getArenaBytes() > 0);
+    TEST_ASSERT_EQ(record.getHeader().getFileTitle().toString().substr(0, 5),
+                   std::string("arena"));
+    TEST_ASSERT_EQ(firstTRE(record).getField("FILCMT").toString().substr(0, 3),
+                   std::string("fyi"));
+
+    // Fields stay writable, and clones leave the arena behind
+    nitf::Record dolly = record.clone();
+    TEST_ASSERT_EQ(dolly.getArenaBytes(), 0);
+    record.getHeader().getFileTitle().set("changed");
+    TEST_ASSERT_EQ(dolly.getHeader().getFileTitle().toString().substr(0, 5),
+                   std::string("arena"));
+
+    // So do the lists and hashes holding them
+    nitf::TRE added("ACFTA");
+    added.setField("AC_MSN_ID", "added");
+    record.getHeader().getExtendedSection().appendTRE(added);
+    TEST_ASSERT(record.getHeader().getExtendedSection().exists("ACFTA"));
+
+    // Round trips like any other Record
+    const io::TempFile copy;
+    writeRecord(copy.pathname(), record);
+    nitf::IOHandle copyInput(copy.pathname());
+    nitf::Reader copyReader;
+    nitf::Record copyRecord = copyReader.read(copyInput);
+    TEST_ASSERT_EQ(copyRecord.getArenaBytes(), 0);
+    TEST_ASSERT_EQ(copyRecord.getHeader().getFileTitle().toString(),
+                   record.getHeader().getFileTitle().toString());
+    nitf::Extensions copyExtensions =
+            copyRecord.getHeader().getExtendedSection();
+    TEST_ASSERT(copyExtensions.exists("JITCID"));
+    TEST_ASSERT(copyExtensions.exists("ACFTA"));
+
+    // Taking a read TRE out of the Record leaves its memory in the arena
+    record.getHeader().getExtendedSection().removeTREsByName("JITCID");
+    TEST_ASSERT(!record.getHeader().getExtendedSection().exists("JITCID"));
+}
 }
 
 int main(int /*argc*/, char** /*argv*/)
@@ -122,5 +271,8 @@ int main(int /*argc*/, char** /*argv*/)
     TEST_CHECK(cloneTRE);
     TEST_CHECK(basicIteration);
     TEST_CHECK(populateWhileIterating);
+    TEST_CHECK(lazyParsing);
+    TEST_CHECK(lazyCursor);
+    TEST_CHECK(recordArena);
     return 0;
 }
@@ -37,6 +37,14 @@ typedef nrt_Uint64      (*J2K_IREADER_READ_REGION)(J2K_USER_DATA*, nrt_Uint32 x0
                                                   nrt_Error*);
 typedef j2k_Container*  (*J2K_IREADER_GET_CONTAINER)(J2K_USER_DATA*, nrt_Error*);
 typedef void            (*J2K_IREADER_DESTRUCT)(J2K_USER_DATA *);
+typedef nrt_Uint64      (*J2K_IREADER_READ_REGION_REDUCED)(J2K_USER_DATA*,
+                                                          nrt_Uint32 x0,
+                                                          nrt_Uint32 y0,
+                                                          nrt_Uint32 x1,
+                                                          nrt_Uint32 y1,
+                                                          nrt_Uint32 reduce,
+                                                          nrt_Uint8 **buf,
+                                                          nrt_Error*);
 
 typedef struct _j2k_IReader
 {
@@ -45,6 +53,7 @@ typedef struct _j2k_IReader
     J2K_IREADER_READ_REGION     readRegion;
     J2K_IREADER_GET_CONTAINER   getContainer;
     J2K_IREADER_DESTRUCT        destruct;
+    J2K_IREADER_READ_REGION_REDUCED readRegionReduced;
 } j2k_IReader;
 
 typedef struct _j2k_Reader
@@ -69,7 +78,10 @@ J2KAPI(j2k_Reader*) j2k_Reader_open(const char*, nrt_Error*);
 J2KAPI(J2K_BOOL) j2k_Reader_canReadTiles(j2k_Reader*, nrt_Error*);
 
 /**
- * Reads an individual tile at the given indices
+ * Reads an individual tile at the given indices.  The OpenJPEG reader may
+ * be shared between threads but decodes one tile at a time; other readers
+ * expect one caller at a time.  Open a reader per thread to decode tiles
+ * concurrently.
  */
 J2KAPI(nrt_Uint64) j2k_Reader_readTile(j2k_Reader*, nrt_Uint32 tileX,
                                           nrt_Uint32 tileY, nrt_Uint8 **buf,
@@ -83,6 +95,19 @@ J2KAPI(nrt_Uint64) j2k_Reader_readRegion(j2k_Reader*, nrt_Uint32 x0,
                                           nrt_Uint32 y1, nrt_Uint8 **buf,
                                           nrt_Error*);
 
+/**
+ * Reads image data from the desired region, discarding the given number of
+ * resolution levels. The region is in full resolution coordinates; the
+ * result is band sequential and each dimension is reduced by 2^reduce.
+ * Not every implementation supports this.
+ */
+J2KAPI(nrt_Uint64) j2k_Reader_readRegionReduced(j2k_Reader*, nrt_Uint32 x0,
+                                                 nrt_Uint32 y0, nrt_Uint32 x1,
+                                                 nrt_Uint32 y1,
+                                                 nrt_Uint32 reduce,
+                                                 nrt_Uint8 **buf,
+                                                 nrt_Error*);
+
 /**
  * Returns the associated container (the Reader will still own it)
  */
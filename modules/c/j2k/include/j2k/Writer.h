@@ -48,6 +48,11 @@ typedef struct _j2k_WriterOptions
     /* TODO add more options as we see fit */
     double compressionRatio;
     nrt_Uint32 numResolutions;
+
+    /* Tiles are encoded this many at a time, each on its own thread, and
+     * their tile-parts emitted in tile order.  0 or 1 encodes each tile as
+     * it is set. */
+    nrt_Uint32 numThreads;
 } j2k_WriterOptions;
 
 typedef struct _j2k_Writer
@@ -45,6 +45,20 @@ NITFPRIV(int) implFreeBlock(nitf_DecompressionControl* control,
                             nitf_Uint8* block,
                             nitf_Error* error);
 
+NITFPRIV(NITF_BOOL) implPrefetchBlocks(nitf_DecompressionControl* control,
+                                       const nitf_Uint32* blockNumbers,
+                                       nitf_Uint32 numBlocks,
+                                       nitf_Error* error);
+
+NITFPRIV(nitf_Uint8*) implReadReduced(nitf_DecompressionControl* control,
+                                      nitf_Uint32 startRow,
+                                      nitf_Uint32 startCol,
+                                      nitf_Uint32 numRows,
+                                      nitf_Uint32 numCols,
+                                      nitf_Uint32 reduce,
+                                      nitf_Uint64* bufferSize,
+                                      nitf_Error* error);
+
 NITFPRIV(void) implClose(nitf_DecompressionControl** control);
 
 NITFPRIV(void) implMemFree(void* p);
@@ -59,15 +73,65 @@ static nitf_DecompressionInterface interfaceTable =
     implOpen, implStart, implReadBlock, implFreeBlock, implClose, NULL
 };
 
+static nitf_DecompressionExtensions extensionsTable =
+{
+    sizeof(nitf_DecompressionExtensions), &interfaceTable,
+    implPrefetchBlocks, implReadReduced
+};
+
+/* A tile decoded ahead of its readBlock call */
+typedef struct _PrefetchedBlock
+{
+    nitf_Uint32 blockNumber;
+    nitf_Uint8 *buf;
+    nitf_Uint64 size;
+    nitf_Uint64 sequence;        /* Order decoded in, oldest are dropped */
+}
+PrefetchedBlock;
+
 typedef struct _ImplControl
 {
     nitf_BlockingInfo blockInfo; /* Kept for convenience */
     j2k_Reader *reader;          /* j2k Reader */
+    nitf_IOInterface *io;        /* Source of the compressed data */
     nitf_Uint64 offset;          /* File offset to data */
     nitf_Uint64 fileLength;      /* Length of compressed data in file */
+
+    /* Decode-ahead state, one reader (codec) per decoding thread.  The
+     * first reader is always the one above. */
+    j2k_Reader **workers;
+    nitf_Uint32 numWorkers;
+    nitf_Uint32 maxThreads;      /* C8_NUM_DECODE_THREADS_KEY, or CPUs */
+    PrefetchedBlock *prefetched;
+    nitf_Uint32 numPrefetched;
+    nitf_Uint32 prefetchedCapacity;
+    nitf_Uint64 sequence;        /* Tiles decoded ahead so far */
+
+    /* ImageIO calls readBlock concurrently when the file can be read
+     * positionally.  This guards the reader above and the state above. */
+    nitf_Mutex mutex;
 }
 ImplControl;
 
+/* The tiles of one prefetch call, shared by the decoding threads */
+typedef struct _DecodeJob
+{
+    ImplControl *implControl;
+    const nitf_Uint32 *blockNumbers;
+    nitf_Uint32 numBlocks;
+    nitf_Uint32 next;            /* Next entry of blockNumbers to decode */
+    nitf_Mutex mutex;            /* Guards next */
+}
+DecodeJob;
+
+/* What each decoding thread works with */
+typedef struct _DecodeWorker
+{
+    DecodeJob *job;
+    j2k_Reader *reader;
+}
+DecodeWorker;
+
 NITF_CXX_ENDGUARD
 
 
@@ -106,15 +170,34 @@ NITFAPI(void*) C8_construct(char *compressionType,
     return((void *) &interfaceTable);
 }
 
-NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
-                                    nitf_Uint32 blockNumber,
-                                    nitf_Uint64* blockSize,
-                                    nitf_Error* error)
+NITFAPI(void*) C8_getExtendedInterface(char *compressionType,
+                                       nitf_Error* error)
+{
+    return((void *) &extensionsTable);
+}
+
+NITFPRIV(nitf_Uint8*) readBlock(ImplControl *implControl,
+                                nitf_Uint32 blockNumber,
+                                nitf_Uint64* blockSize,
+                                nitf_Error* error)
 {
-    ImplControl *implControl = (ImplControl*)control;
     nrt_Uint8 *buf = NULL;
     nrt_Uint64 bufSize;
     j2k_Container* container = NULL;
+    nitf_Uint32 i;
+
+    /* Hand over the tile if it was decoded ahead */
+    for (i = 0; i < implControl->numPrefetched; ++i)
+    {
+        if (implControl->prefetched[i].blockNumber == blockNumber)
+        {
+            buf = implControl->prefetched[i].buf;
+            *blockSize = implControl->prefetched[i].size;
+            implControl->prefetched[i] =
+                implControl->prefetched[--implControl->numPrefetched];
+            return buf;
+        }
+    }
 
     if (j2k_Reader_canReadTiles(implControl->reader, error))
     {
@@ -169,6 +252,21 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
     return buf;
 }
 
+NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl *control,
+                                    nitf_Uint32 blockNumber,
+                                    nitf_Uint64* blockSize,
+                                    nitf_Error* error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    nitf_Uint8 *buf;
+
+    /* The reader has a single codec, so blocks are read one at a time */
+    nitf_Mutex_lock(&implControl->mutex);
+    buf = readBlock(implControl, blockNumber, blockSize, error);
+    nitf_Mutex_unlock(&implControl->mutex);
+    return buf;
+}
+
 NITFPRIV(void*) implMemAlloc(size_t size, nitf_Error* error)
 {
     void * p = NITF_MALLOC(size);
@@ -191,15 +289,300 @@ NITFPRIV(void) implMemFree(void* p)
     if (p) NITF_FREE(p);
 }
 
+NITFPRIV(void) implDecodeTiles(NITF_DATA* data)
+{
+    DecodeWorker *worker = (DecodeWorker*)data;
+    DecodeJob *job = worker->job;
+    ImplControl *implControl = job->implControl;
+    nitf_Uint32 blockNumber, tileX, tileY;
+    nitf_Uint8 *buf;
+    nitf_Uint64 size;
+    nitf_Error error;
+
+    for (;;)
+    {
+        nitf_Mutex_lock(&job->mutex);
+        if (job->next == job->numBlocks)
+        {
+            nitf_Mutex_unlock(&job->mutex);
+            break;
+        }
+        blockNumber = job->blockNumbers[job->next++];
+        nitf_Mutex_unlock(&job->mutex);
+
+        tileY = blockNumber / implControl->blockInfo.numBlocksPerRow;
+        tileX = blockNumber % implControl->blockInfo.numBlocksPerRow;
+
+        /* A tile that fails here is left to readBlock, which reports it.
+         * The main reader is shared with readBlock, so it is only used
+         * under the control's mutex. */
+        buf = NULL;
+        if (worker->reader == implControl->reader)
+            nitf_Mutex_lock(&implControl->mutex);
+        size = j2k_Reader_readTile(worker->reader, tileX, tileY, &buf,
+                                   &error);
+        if (worker->reader == implControl->reader)
+            nitf_Mutex_unlock(&implControl->mutex);
+        if (size == 0)
+        {
+            implMemFree(buf);
+            continue;
+        }
+
+        /* Other prefetch calls append here too, so the list grows as the
+         * tiles arrive rather than being sized up front */
+        nitf_Mutex_lock(&implControl->mutex);
+        if (implControl->numPrefetched == implControl->prefetchedCapacity)
+        {
+            const nitf_Uint32 capacity =
+                implControl->prefetchedCapacity ?
+                    2 * implControl->prefetchedCapacity : 16;
+            PrefetchedBlock *prefetched = (PrefetchedBlock*)NITF_REALLOC(
+                implControl->prefetched, capacity * sizeof(PrefetchedBlock));
+            if (!prefetched)
+            {
+                nitf_Mutex_unlock(&implControl->mutex);
+                implMemFree(buf);
+                continue;
+            }
+            implControl->prefetched = prefetched;
+            implControl->prefetchedCapacity = capacity;
+        }
+        implControl->prefetched[implControl->numPrefetched].blockNumber =
+            blockNumber;
+        implControl->prefetched[implControl->numPrefetched].buf = buf;
+        implControl->prefetched[implControl->numPrefetched].size = size;
+        implControl->prefetched[implControl->numPrefetched].sequence =
+            implControl->sequence++;
+        implControl->numPrefetched++;
+        nitf_Mutex_unlock(&implControl->mutex);
+    }
+}
+
+NITFPRIV(NITF_BOOL) implPrefetchBlocks(nitf_DecompressionControl* control,
+                                       const nitf_Uint32* blockNumbers,
+                                       nitf_Uint32 numBlocks,
+                                       nitf_Error* error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    nitf_Uint32 *toDecode = NULL;
+    nitf_Uint32 numToDecode = 0;
+    nitf_Uint32 numThreads, oldest, i, j;
+    DecodeJob job;
+    DecodeWorker *workers = NULL;
+    nitf_Thread **threads = NULL;
+    NITF_BOOL ret = NITF_SUCCESS;
+
+    /*
+     * Tiles are only decoded concurrently when every codec can read the
+     * compressed data without moving a shared file position
+     */
+    if (!nitf_IOInterface_canReadAt(implControl->io) ||
+        !j2k_Reader_canReadTiles(implControl->reader, error))
+        return NITF_SUCCESS;
+
+    numThreads = implControl->maxThreads;
+    if (numThreads < 2)
+        return NITF_SUCCESS;
+
+    if (!(toDecode = (nitf_Uint32*)implMemAlloc(
+              numBlocks * sizeof(nitf_Uint32), error)))
+        return NITF_FAILURE;
+
+    /* Everything up to starting the threads is bookkeeping shared with
+     * readBlock and other prefetch calls */
+    nitf_Mutex_lock(&implControl->mutex);
+
+    for (j = 0; j < numBlocks; ++j)
+    {
+        for (i = 0; i < implControl->numPrefetched; ++i)
+            if (blockNumbers[j] == implControl->prefetched[i].blockNumber)
+                break;
+        if (i == implControl->numPrefetched)
+            toDecode[numToDecode++] = blockNumbers[j];
+    }
+
+    if (numThreads > numToDecode)
+        numThreads = numToDecode;
+
+    /* Nothing to gain, readBlock decodes on demand */
+    if (numThreads < 2)
+    {
+        nitf_Mutex_unlock(&implControl->mutex);
+        goto CLEANUP;
+    }
+
+    /*
+     * Tiles of other requests, which may still be reading them, are kept
+     * while they fit in twice this request.  Past that the oldest go, so
+     * tiles that are never read do not pile up.
+     */
+    while (implControl->numPrefetched > 0 &&
+           implControl->numPrefetched + numToDecode > 2 * numBlocks)
+    {
+        oldest = 0;
+        for (i = 1; i < implControl->numPrefetched; ++i)
+            if (implControl->prefetched[i].sequence <
+                implControl->prefetched[oldest].sequence)
+                oldest = i;
+        implMemFree(implControl->prefetched[oldest].buf);
+        implControl->prefetched[oldest] =
+            implControl->prefetched[--implControl->numPrefetched];
+    }
+
+    /* Open the extra codecs here, opening reads the main header serially */
+    if (implControl->numWorkers < numThreads)
+    {
+        j2k_Reader **readers = (j2k_Reader**)NITF_REALLOC(
+            implControl->workers, numThreads * sizeof(j2k_Reader*));
+        if (!readers)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            nitf_Mutex_unlock(&implControl->mutex);
+            ret = NITF_FAILURE;
+            goto CLEANUP;
+        }
+        implControl->workers = readers;
+        if (implControl->numWorkers == 0)
+            implControl->workers[implControl->numWorkers++] =
+                implControl->reader;
+
+        while (implControl->numWorkers < numThreads)
+        {
+            j2k_Reader *reader;
+            nitf_Error openError;
+            if (nitf_IOInterface_seek(implControl->io, implControl->offset,
+                                      NITF_SEEK_SET, &openError) < 0 ||
+                !(reader = j2k_Reader_openIO(implControl->io, &openError)))
+            {
+                /* Make do with the codecs we have */
+                break;
+            }
+            implControl->workers[implControl->numWorkers++] = reader;
+        }
+    }
+    if (numThreads > implControl->numWorkers)
+        numThreads = implControl->numWorkers;
+    nitf_Mutex_unlock(&implControl->mutex);
+
+    workers = (DecodeWorker*)implMemAlloc(numThreads * sizeof(DecodeWorker),
+                                          error);
+    threads = (nitf_Thread**)implMemAlloc(numThreads * sizeof(nitf_Thread*),
+                                          error);
+    if (!workers || !threads)
+    {
+        ret = NITF_FAILURE;
+        goto CLEANUP;
+    }
+
+    job.implControl = implControl;
+    job.blockNumbers = toDecode;
+    job.numBlocks = numToDecode;
+    job.next = 0;
+    nitf_Mutex_init(&job.mutex);
+
+    /* The calling thread decodes too, with the first codec */
+    for (i = 0; i < numThreads; ++i)
+    {
+        workers[i].job = &job;
+        workers[i].reader = implControl->workers[i];
+    }
+    for (i = 1; i < numThreads; ++i)
+    {
+        /* With fewer threads, the remaining ones pick up the slack */
+        if (!(threads[i] = nitf_Thread_construct(implDecodeTiles,
+                                                 &workers[i], error)))
+            break;
+    }
+    implDecodeTiles(&workers[0]);
+    for (i = 1; i < numThreads; ++i)
+    {
+        if (threads[i])
+        {
+            nitf_Thread_join(threads[i], error);
+            nitf_Thread_destruct(&threads[i]);
+        }
+    }
+    nitf_Mutex_delete(&job.mutex);
+
+    CLEANUP:
+    implMemFree(threads);
+    implMemFree(workers);
+    implMemFree(toDecode);
+    return ret;
+}
+
+NITFPRIV(nitf_Uint8*) implReadReduced(nitf_DecompressionControl* control,
+                                      nitf_Uint32 startRow,
+                                      nitf_Uint32 startCol,
+                                      nitf_Uint32 numRows,
+                                      nitf_Uint32 numCols,
+                                      nitf_Uint32 reduce,
+                                      nitf_Uint64* bufferSize,
+                                      nitf_Error* error)
+{
+    ImplControl *implControl = (ImplControl*)control;
+    nrt_Uint8 *buf = NULL;
+    nrt_Uint64 bufSize;
+    j2k_Container* container = NULL;
+    nitf_Uint64 x1, y1;
+    nitf_Uint32 totalRows, totalCols;
+
+    container = j2k_Reader_getContainer(implControl->reader, error);
+    if (container == NULL)
+        return NULL;
+    totalRows = j2k_Container_getHeight(container, error);
+    totalCols = j2k_Container_getWidth(container, error);
+
+    /* The full resolution extent, which may run past the image edge */
+    x1 = startCol + ((nitf_Uint64)numCols << reduce);
+    y1 = startRow + ((nitf_Uint64)numRows << reduce);
+    if (x1 > totalCols)
+        x1 = totalCols;
+    if (y1 > totalRows)
+        y1 = totalRows;
+
+    nitf_Mutex_lock(&implControl->mutex);
+    bufSize = j2k_Reader_readRegionReduced(implControl->reader,
+                                           startCol, startRow,
+                                           (nitf_Uint32)x1, (nitf_Uint32)y1,
+                                           reduce, &buf, error);
+    nitf_Mutex_unlock(&implControl->mutex);
+    if (0 == bufSize)
+    {
+        implMemFree(buf);
+        return NULL;
+    }
+    *bufferSize = bufSize;
+    return buf;
+}
+
 NITFPRIV(void) implClose(nitf_DecompressionControl** control)
 {
     if (control && *control)
     {
         ImplControl *implControl = (ImplControl*)*control;
+        nitf_Uint32 i;
+
+        for (i = 0; i < implControl->numPrefetched; ++i)
+        {
+            implMemFree(implControl->prefetched[i].buf);
+        }
+        implMemFree(implControl->prefetched);
+
+        /* The first worker is the main reader */
+        for (i = 1; i < implControl->numWorkers; ++i)
+        {
+            j2k_Reader_destruct(&implControl->workers[i]);
+        }
+        implMemFree(implControl->workers);
+
         if (implControl->reader)
         {
             j2k_Reader_destruct(&implControl->reader);
         }
+        nitf_Mutex_delete(&implControl->mutex);
         implMemFree(implControl);
         *control = NULL;
     }
@@ -210,11 +593,19 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader * subheader,
                                               nitf_Error * error)
 {
     ImplControl *implControl = NULL;
+    nrt_Pair *pair;
     (void)subheader;
-    (void)options;
 
     if (!(implControl = (ImplControl*)implMemAlloc(sizeof(ImplControl), error)))
         goto CATCH_ERROR;
+    nitf_Mutex_init(&implControl->mutex);
+
+    /* Tiles of a request are decoded on up to this many threads */
+    if (options && (pair = nrt_HashTable_find(options,
+                                              C8_NUM_DECODE_THREADS_KEY)))
+        implControl->maxThreads = *((nitf_Uint32*)pair->data);
+    else
+        implControl->maxThreads = nitf_Thread_getNumCPUs();
 
     return((nitf_DecompressionControl*) implControl);
 
@@ -246,6 +637,7 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
     if (!(implControl->reader = j2k_Reader_openIO(io, error)))
         goto CATCH_ERROR;
 
+    implControl->io         = io;
     implControl->offset     = offset;
     implControl->fileLength = fileLength;
     implControl->blockInfo  = *blockInfo;
@@ -253,7 +645,7 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
 
     CATCH_ERROR:
     {
-        implMemFree(implControl);
+        implClose(&control);
         return NITF_FAILURE;
     }
 }
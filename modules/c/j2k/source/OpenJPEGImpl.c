@@ -39,11 +39,18 @@
 
 #define OPENJPEG_STREAM_SIZE 1024
 
+/* Upper bound on the number of tiles encoded at once */
+#define OPENJPEG_MAX_THREADS 16
+
+/* Room for the throwaway main header written ahead of each tile */
+#define OPENJPEG_TILE_HEADER_SIZE 4096
+
 typedef struct _IOControl
 {
     nrt_IOInterface *io;
     nrt_Off offset;
     nrt_Off length;
+    nrt_Off position; /* Read cursor, relative to offset */
     int isRead;
     nrt_Error error;
 } IOControl;
@@ -51,14 +58,40 @@ typedef struct _IOControl
 
 typedef struct _OpenJPEGReaderImpl
 {
-    opj_dparameters_t parameters;
     nrt_Off ioOffset;
     nrt_IOInterface *io;
     int ownIO;
     j2k_Container *container;
     IOControl userData;
+
+    /* Kept from opening to destruction, so that tiles are decoded without
+     * parsing the main header again.  There is one codec, so readTile
+     * decodes one tile at a time under the lock. */
+    opj_stream_t *stream;
+    opj_codec_t *codec;
+    opj_image_t *image;
+    nrt_Mutex lock;
 } OpenJPEGReaderImpl;
 
+/*
+ * A tile waiting to be encoded concurrently.  It is encoded by a codec of
+ * its own, after that codec's copy of the main header.
+ */
+typedef struct _OpenJPEGPendingTile
+{
+    nrt_Uint32 tileX;
+    nrt_Uint32 tileY;
+    nrt_Uint32 width;       /* Size of this (possibly partial) tile */
+    nrt_Uint32 height;
+    nrt_Uint8 *raw;         /* Uncompressed samples, owned */
+    nrt_Uint32 rawSize;
+    char *encoded;          /* Main header, then the tile's tile-parts */
+    size_t partsOffset;     /* Where its tile-parts start within it */
+    size_t partsLength;
+    NRT_BOOL encodedOK;
+    nrt_Error error;
+} OpenJPEGPendingTile;
+
 typedef struct _OpenJPEGWriterImpl
 {
     j2k_Container *container;
@@ -68,8 +101,25 @@ typedef struct _OpenJPEGWriterImpl
     nrt_IOInterface *compressed;
     opj_stream_t *stream;
     IOControl userData;
+
+    /* Concurrent encoding state, used when numThreads > 1.  The codec
+     * above then only writes the main header. */
+    nrt_Uint32 numThreads;
+    opj_cparameters_t encoderParams;
+    opj_image_cmptparm_t *cmptParams;
+    OPJ_COLOR_SPACE colorSpace;
+    OpenJPEGPendingTile *pending;
+    nrt_Uint32 numPending;
 } OpenJPEGWriterImpl;
 
+/* The tiles of one batch, shared by the encoding threads */
+typedef struct _OpenJPEGEncodeJob
+{
+    OpenJPEGWriterImpl *impl;
+    nrt_Uint32 next;        /* Next pending tile to encode */
+    nrt_Mutex mutex;        /* Guards next */
+} OpenJPEGEncodeJob;
+
 typedef struct _OpenJPEGError
 {
     nrt_Error *error;
@@ -92,12 +142,21 @@ J2KPRIV( nrt_Uint64)     OpenJPEGReader_readRegion(J2K_USER_DATA *, nrt_Uint32,
                                                    nrt_Error *);
 J2KPRIV( j2k_Container*) OpenJPEGReader_getContainer(J2K_USER_DATA *, nrt_Error *);
 J2KPRIV(void)            OpenJPEGReader_destruct(J2K_USER_DATA *);
+J2KPRIV( nrt_Uint64)     OpenJPEGReader_readRegionReduced(J2K_USER_DATA *,
+                                                          nrt_Uint32,
+                                                          nrt_Uint32,
+                                                          nrt_Uint32,
+                                                          nrt_Uint32,
+                                                          nrt_Uint32,
+                                                          nrt_Uint8 **,
+                                                          nrt_Error *);
 
 static j2k_IReader ReaderInterface = {&OpenJPEGReader_canReadTiles,
                                       &OpenJPEGReader_readTile,
                                       &OpenJPEGReader_readRegion,
                                       &OpenJPEGReader_getContainer,
-                                      &OpenJPEGReader_destruct };
+                                      &OpenJPEGReader_destruct,
+                                      &OpenJPEGReader_readRegionReduced };
 
 J2KPRIV( NRT_BOOL)       OpenJPEGWriter_setTile(J2K_USER_DATA *,
                                                 nrt_Uint32, nrt_Uint32,
@@ -117,6 +176,8 @@ static j2k_IWriter WriterInterface = {&OpenJPEGWriter_setTile,
 J2KPRIV(void) OpenJPEG_cleanup(opj_stream_t **, opj_codec_t **, opj_image_t **);
 J2KPRIV( J2K_BOOL) OpenJPEG_initImage(OpenJPEGWriterImpl *, j2k_WriterOptions *,
                                       nrt_Error *);
+J2KPRIV( NRT_BOOL) OpenJPEG_flushTiles(OpenJPEGWriterImpl *, nrt_Error *);
+J2KPRIV(void) OpenJPEG_freeTiles(OpenJPEGWriterImpl *);
 
 J2KPRIV(void) OpenJPEG_errorHandler(const char* msg, void* data)
 {
@@ -152,6 +213,8 @@ OpenJPEG_createIO(nrt_IOInterface* io,
     {
         ioControl->io = io;
         ioControl->offset = nrt_IOInterface_tell(io, error);
+        ioControl->position = 0;
+        ioControl->isRead = isInput;
         if (length > 0)
         {
             ioControl->length = length;
@@ -182,28 +245,31 @@ OpenJPEG_createIO(nrt_IOInterface* io,
 J2KPRIV(OPJ_SIZE_T) implStreamRead(void* buf, OPJ_SIZE_T bytes, void *data)
 {
     IOControl *ctrl = (IOControl*)data;
-    nrt_Off offset, alreadyRead;
     OPJ_SIZE_T bytesLeft;
     OPJ_SIZE_T toRead;
 
-    offset = nrt_IOInterface_tell(ctrl->io, &ctrl->error);
-    assert(offset >= ctrl->offset); /* probably not a good idea, but need it */
-
-    alreadyRead = offset - ctrl->offset;
-    bytesLeft = alreadyRead >= ctrl->length ?
-            0 : (OPJ_SIZE_T)(ctrl->length - alreadyRead);
+    /* Input streams keep their own cursor and read positionally */
+    bytesLeft = ctrl->position >= ctrl->length ?
+            0 : (OPJ_SIZE_T)(ctrl->length - ctrl->position);
     toRead = bytesLeft < bytes ? bytesLeft : bytes;
-    if (toRead <= 0 || !nrt_IOInterface_read(
-                    ctrl->io, (char*)buf, toRead, &ctrl->error))
+    if (toRead <= 0 || !nrt_IOInterface_readAt(
+                    ctrl->io, ctrl->offset + ctrl->position,
+                    (char*)buf, toRead, &ctrl->error))
     {
         return (OPJ_SIZE_T) -1;
     }
+    ctrl->position += (nrt_Off)toRead;
     return toRead;
 }
 
 J2KPRIV(OPJ_BOOL) implStreamSeek(OPJ_OFF_T bytes, void *data)
 {
     IOControl *ctrl = (IOControl*)data;
+    if (ctrl->isRead)
+    {
+        ctrl->position = bytes;
+        return 1;
+    }
     if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(ctrl->io,
                                              ctrl->offset + bytes,
                                              NRT_SEEK_SET,
@@ -221,6 +287,11 @@ J2KPRIV(OPJ_OFF_T) implStreamSkip(OPJ_OFF_T bytes, void *data)
     {
         return 0;
     }
+    if (ctrl->isRead)
+    {
+        ctrl->position += bytes;
+        return bytes;
+    }
     if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(ctrl->io,
                         bytes,
                         NRT_SEEK_CUR,
@@ -272,21 +343,30 @@ OpenJPEG_cleanup(opj_stream_t **stream, opj_codec_t **codec,
 /******************************************************************************/
 
 J2KPRIV( NRT_BOOL)
-OpenJPEG_setup(OpenJPEGReaderImpl *impl, opj_stream_t **stream,
-               opj_codec_t **codec, nrt_Error *error)
+OpenJPEG_setup(OpenJPEGReaderImpl *impl, IOControl *ioControl,
+               opj_stream_t **stream, opj_codec_t **codec, nrt_Error *error)
 {
-    if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(impl->io,
-                                             impl->ioOffset,
-                                             NRT_SEEK_SET,
-                                             error)))
+    opj_dparameters_t parameters;
+    const nrt_Off size = nrt_IOInterface_getSize(impl->io, error);
+
+    if (size <= impl->ioOffset)
     {
+        nrt_Error_init(error, "No J2K data to read", NRT_CTXT,
+                       NRT_ERR_READING_FROM_FILE);
         goto CATCH_ERROR;
     }
 
-    if (!(*stream = OpenJPEG_createIO(impl->io, &impl->userData, 0, 1, error)))
+    /*
+     * Input streams read positionally from their own cursor, so the
+     * stream is pointed at the codestream directly rather than through
+     * the shared file position, which other readers may be moving
+     */
+    if (!(*stream = OpenJPEG_createIO(impl->io, ioControl,
+                                      size - impl->ioOffset, 1, error)))
     {
         goto CATCH_ERROR;
     }
+    ioControl->offset = impl->ioOffset;
 
     if (!(*codec = opj_create_decompress(OPJ_CODEC_J2K)))
     {
@@ -305,9 +385,9 @@ OpenJPEG_setup(OpenJPEGReaderImpl *impl, opj_stream_t **stream,
         goto CATCH_ERROR;
     }
 
-    opj_set_default_decoder_parameters(&impl->parameters);
+    opj_set_default_decoder_parameters(&parameters);
 
-    if (!opj_setup_decoder(*codec, &impl->parameters))
+    if (!opj_setup_decoder(*codec, &parameters))
     {
         /*nrt_Error_init(error, "Error setting up openjpeg decoder", NRT_CTXT,
           NRT_ERR_UNK);*/
@@ -334,7 +414,7 @@ OpenJPEG_readHeader(OpenJPEGReaderImpl *impl, nrt_Error *error)
     OPJ_UINT32 tileWidth, tileHeight;
     OPJ_UINT32 imageWidth, imageHeight;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
+    if (!OpenJPEG_setup(impl, &impl->userData, &stream, &codec, error))
     {
         goto CATCH_ERROR;
     }
@@ -450,7 +530,17 @@ OpenJPEG_readHeader(OpenJPEGReaderImpl *impl, nrt_Error *error)
         {
             opj_destroy_cstr_info(&codeStreamInfo);
         }
-        OpenJPEG_cleanup(&stream, &codec, &image);
+        if (rc)
+        {
+            /* hang on to the parsed header for readTile */
+            impl->stream = stream;
+            impl->codec = codec;
+            impl->image = image;
+        }
+        else
+        {
+            OpenJPEG_cleanup(&stream, &codec, &image);
+        }
     }
     return rc;
 }
@@ -631,6 +721,32 @@ J2KPRIV( NRT_BOOL) OpenJPEG_initImage(OpenJPEGWriterImpl *impl,
         goto CATCH_ERROR;
     }
 
+    if (writerOps && writerOps->numThreads > 1)
+    {
+        impl->numThreads = writerOps->numThreads > OPENJPEG_MAX_THREADS ?
+                OPENJPEG_MAX_THREADS : writerOps->numThreads;
+        if (!(impl->pending = (OpenJPEGPendingTile*)J2K_MALLOC(
+                sizeof(OpenJPEGPendingTile) * impl->numThreads * 2)))
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+
+        /* The tiles are encoded by codecs of their own, so this one only
+         * writes the main header.  opj_flush() (from our OpenJPEG patch)
+         * pushes it out of the stream buffer. */
+        if (!opj_flush(impl->codec, impl->stream))
+        {
+            goto CATCH_ERROR;
+        }
+
+        impl->encoderParams = encoderParams;
+        impl->colorSpace = colorSpace;
+        impl->cmptParams = cmptParams;
+        cmptParams = NULL;
+    }
+
     goto CLEANUP;
 
     CATCH_ERROR:
@@ -647,6 +763,234 @@ J2KPRIV( NRT_BOOL) OpenJPEG_initImage(OpenJPEGWriterImpl *impl,
     return rc;
 }
 
+/*
+ * Encode a pending tile with a codec of its own, set up for the whole image
+ * exactly as the image's codec is.  The tile is written with its real index
+ * through our OpenJPEG patch, which lets opj_write_tile() take tiles in any
+ * order, so it codes (rate allocation included) just as it would serially.
+ * This uses nothing in impl that changes, so tiles can be encoded
+ * concurrently.
+ */
+J2KPRIV( NRT_BOOL) OpenJPEG_encodeTile(OpenJPEGWriterImpl *impl,
+                                       OpenJPEGPendingTile *tile)
+{
+    nrt_Error *error = &tile->error;
+    NRT_BOOL rc = NRT_SUCCESS;
+    opj_cparameters_t encoderParams = impl->encoderParams;
+    opj_image_t *image = NULL;
+    opj_codec_t *codec = NULL;
+    opj_stream_t *stream = NULL;
+    nrt_IOInterface *io = NULL;
+    IOControl ioControl;
+    const nrt_Uint32 xTiles = j2k_Container_getTilesX(impl->container, error);
+    const size_t capacity = (size_t)tile->rawSize + tile->rawSize / 2 +
+            OPENJPEG_TILE_HEADER_SIZE;
+    nrt_Off headerEnd;
+    nrt_Off length;
+
+    if (!(codec = opj_create_compress(OPJ_CODEC_J2K)))
+    {
+        nrt_Error_init(error, "Error creating OpenJPEG codec", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+    if (!(image = opj_image_tile_create(impl->image->numcomps,
+                                        impl->cmptParams, impl->colorSpace)))
+    {
+        nrt_Error_init(error, "Error creating OpenJPEG image", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+    image->numcomps = impl->image->numcomps;
+    image->x0 = impl->image->x0;
+    image->y0 = impl->image->y0;
+    image->x1 = impl->image->x1;
+    image->y1 = impl->image->y1;
+    image->color_space = impl->colorSpace;
+
+    memset(error->message, 0, NRT_MAX_EMESSAGE);
+    if (!opj_set_error_handler(codec, OpenJPEG_errorHandler, error))
+    {
+        nrt_Error_init(error, "Unable to set OpenJPEG error handler", NRT_CTXT,
+                       NRT_ERR_UNK);
+        goto CATCH_ERROR;
+    }
+    if (!opj_setup_encoder(codec, &encoderParams, image))
+    {
+        goto CATCH_ERROR;
+    }
+
+    if (!(tile->encoded = (char*)J2K_MALLOC(capacity)))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!(io = nrt_BufferAdapter_construct(tile->encoded, capacity, 0, error)))
+    {
+        goto CATCH_ERROR;
+    }
+    if (!(stream = OpenJPEG_createIO(io, &ioControl, 0, 0, error)))
+    {
+        goto CATCH_ERROR;
+    }
+
+    /* The main header comes first; everything after it is the tile */
+    if (!opj_start_compress(codec, image, stream) ||
+        !opj_flush(codec, stream))
+    {
+        if (strlen(error->message) == 0)
+            nrt_Error_init(error, "Error starting tile compression", NRT_CTXT,
+                           NRT_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+    headerEnd = nrt_IOInterface_tell(io, error);
+    if (!NRT_IO_SUCCESS(headerEnd))
+        goto CATCH_ERROR;
+
+    if (!opj_write_tile(codec, tile->tileY * xTiles + tile->tileX,
+                        (OPJ_BYTE*)tile->raw, tile->rawSize, stream) ||
+        !opj_flush(codec, stream))
+    {
+        if (strlen(error->message) == 0)
+            nrt_Error_init(error, "Error encoding tile", NRT_CTXT,
+                           NRT_ERR_INVALID_OBJECT);
+        goto CATCH_ERROR;
+    }
+    length = nrt_IOInterface_tell(io, error);
+    if (!NRT_IO_SUCCESS(length))
+        goto CATCH_ERROR;
+
+    tile->partsOffset = (size_t)headerEnd;
+    tile->partsLength = (size_t)(length - headerEnd);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        rc = NRT_FAILURE;
+    }
+
+    CLEANUP:
+    {
+        OpenJPEG_cleanup(&stream, &codec, &image);
+        if (io)
+            nrt_IOInterface_destruct(&io);
+    }
+    return rc;
+}
+
+J2KPRIV(void) OpenJPEG_encodeTiles(NRT_DATA *data)
+{
+    OpenJPEGEncodeJob *job = (OpenJPEGEncodeJob*)data;
+    OpenJPEGWriterImpl *impl = job->impl;
+    nrt_Uint32 index;
+
+    for (;;)
+    {
+        nrt_Mutex_lock(&job->mutex);
+        if (job->next == impl->numPending)
+        {
+            nrt_Mutex_unlock(&job->mutex);
+            break;
+        }
+        index = job->next++;
+        nrt_Mutex_unlock(&job->mutex);
+
+        impl->pending[index].encodedOK =
+                OpenJPEG_encodeTile(impl, &impl->pending[index]);
+    }
+}
+
+J2KPRIV(void) OpenJPEG_freeTiles(OpenJPEGWriterImpl *impl)
+{
+    nrt_Uint32 i;
+
+    for (i = 0; i < impl->numPending; ++i)
+    {
+        if (impl->pending[i].raw)
+            J2K_FREE(impl->pending[i].raw);
+        if (impl->pending[i].encoded)
+            J2K_FREE(impl->pending[i].encoded);
+    }
+    impl->numPending = 0;
+}
+
+/*
+ * Encode the pending tiles, on as many threads as there are tiles (up to
+ * numThreads), and append their tile-parts to the codestream in order
+ */
+J2KPRIV( NRT_BOOL) OpenJPEG_flushTiles(OpenJPEGWriterImpl *impl,
+                                       nrt_Error *error)
+{
+    OpenJPEGEncodeJob job;
+    nrt_Thread *threads[OPENJPEG_MAX_THREADS];
+    nrt_Uint32 numThreads = impl->numThreads;
+    NRT_BOOL rc = NRT_SUCCESS;
+    nrt_Uint32 i;
+
+    if (impl->numPending == 0)
+        return NRT_SUCCESS;
+
+    if (numThreads > impl->numPending)
+        numThreads = impl->numPending;
+
+    job.impl = impl;
+    job.next = 0;
+    nrt_Mutex_init(&job.mutex);
+
+    /* The calling thread encodes too */
+    for (i = 1; i < numThreads; ++i)
+    {
+        /* With fewer threads, the remaining ones pick up the slack */
+        threads[i] = nrt_Thread_construct(OpenJPEG_encodeTiles, &job, error);
+    }
+    OpenJPEG_encodeTiles(&job);
+    for (i = 1; i < numThreads; ++i)
+    {
+        if (threads[i])
+        {
+            nrt_Thread_join(threads[i], error);
+            nrt_Thread_destruct(&threads[i]);
+        }
+    }
+    nrt_Mutex_delete(&job.mutex);
+
+    for (i = 0; i < impl->numPending; ++i)
+    {
+        OpenJPEGPendingTile *tile = &impl->pending[i];
+
+        if (!tile->encodedOK)
+        {
+            *error = tile->error;
+            goto CATCH_ERROR;
+        }
+        if (!nrt_IOInterface_write(impl->compressed,
+                                   tile->encoded + tile->partsOffset,
+                                   tile->partsLength, error))
+        {
+            /* See OpenJPEGWriter_setTile() */
+            nrt_Error_init(error,
+                           "Error writing tile: Compressed image is larger "
+                           "than uncompressed image",
+                           NRT_CTXT, NRT_ERR_INVALID_OBJECT);
+            goto CATCH_ERROR;
+        }
+    }
+
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        rc = NRT_FAILURE;
+    }
+
+    CLEANUP:
+    {
+        OpenJPEG_freeTiles(impl);
+    }
+    return rc;
+}
+
 
 /******************************************************************************/
 /* READER                                                                     */
@@ -658,159 +1002,137 @@ OpenJPEGReader_canReadTiles(J2K_USER_DATA *data, nrt_Error *error)
     return NRT_SUCCESS;
 }
 
+/*
+ * The size OpenJPEG uses for one sample of the given precision when it
+ * hands back packed tile data
+ */
+J2KPRIV(size_t) OpenJPEG_sampleBytes(OPJ_UINT32 precision)
+{
+    const size_t bytes = (precision + 7) / 8;
+    return bytes == 3 ? 4 : bytes;
+}
+
 J2KPRIV( nrt_Uint64)
 OpenJPEGReader_readTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
                   nrt_Uint8 **buf, nrt_Error *error)
 {
     OpenJPEGReaderImpl *impl = (OpenJPEGReaderImpl*) data;
 
-    opj_stream_t *stream = NULL;
-    opj_image_t *image = NULL;
-    opj_codec_t *codec = NULL;
-    nrt_Uint32 bufSize;
+    opj_image_t *image = impl->image;
     const OPJ_UINT32 tileWidth = j2k_Container_getTileWidth(impl->container, error);
-    const OPJ_UINT32 tileHeight = j2k_Container_getTileHeight(impl->container, error);
-    size_t numBitsPerPixel = 0;
-    size_t numBytesPerPixel = 0;
+    const nrt_Uint32 tilesX = j2k_Container_getTilesX(impl->container, error);
     nrt_Uint64 fullBufSize = 0;
+    nrt_Uint8 *bufPtr;
+    OPJ_UINT32 idx;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
-    {
-        goto CATCH_ERROR;
-    }
+    /* The cached codec and its image are used by one caller at a time */
+    nrt_Mutex_lock(&impl->lock);
 
-    /* unfortunately, we need to read the header every time ... */
-    if (!opj_read_header(stream, codec, &image))
+    /* The cached codec reports through whatever error we are given now */
+    memset(error->message, 0, NRT_MAX_EMESSAGE);
+    if (!opj_set_error_handler(impl->codec, OpenJPEG_errorHandler, error))
     {
-        /*nrt_Error_init(error, "Error reading header", NRT_CTXT, NRT_ERR_UNK);*/
+        nrt_Error_init(error, "Unable to set OpenJPEG error handler", NRT_CTXT,
+                       NRT_ERR_UNK);
         goto CATCH_ERROR;
     }
 
-    /* only decode what we want */
-    if (!opj_set_decode_area(codec, image, tileWidth * tileX, tileHeight * tileY,
-                             tileWidth * (tileX + 1), tileHeight * (tileY + 1)))
+    /*
+     * The main header was parsed when the reader was opened.  OpenJPEG
+     * indexes tile-parts as it comes across them, so this seeks straight
+     * to the tile's data once the index reaches it, and otherwise only
+     * skips over the tile-part headers in between.
+     */
+    if (!opj_get_decoded_tile(impl->codec, impl->stream, image,
+                              tileY * tilesX + tileX))
     {
-        /*nrt_Error_init(error, "Error decoding area", NRT_CTXT, NRT_ERR_UNK);*/
+        /*nrt_Error_init(error, "Error decoding tile", NRT_CTXT,
+          NRT_ERR_UNK);*/
         goto CATCH_ERROR;
     }
 
+    /* TODO: The way blockIO->cntl->blockOffsetInc is currently
+     *       implemented in ImageIO.c corresponds with how a
+     *       non-compressed partial block would be laid out in a
+     *       NITF - the actual extra columns would have been read.
+     *       So whenever we get a partial tile that isn't at the full
+     *       width, we add in these extra columns of 0's ourselves.  We
+     *       don't need to pad out the extra rows for a partial block
+     *       that isn't the full height because ImageIO will never try
+     *       to memcpy these in - we only need to get the stride to
+     *       work out correctly.
+     */
+    for (idx = 0; idx < image->numcomps; ++idx)
     {
-        int keepGoing;
-        OPJ_UINT32 tileIndex, nComponents;
-        OPJ_INT32 tileX0, tileY0, tileX1, tileY1;
+        const opj_image_comp_t *comp = &image->comps[idx];
+        const OPJ_UINT32 destWidth = comp->w < tileWidth ? tileWidth : comp->w;
 
-        if (!opj_read_tile_header(codec, stream, &tileIndex, &bufSize, &tileX0,
-                                  &tileY0, &tileX1, &tileY1, &nComponents,
-                                  &keepGoing))
+        /* TODO: For RGB data the bands are stored one after the other, so
+         *       padding would have to be per band.
+         */
+        if (comp->w < tileWidth && image->numcomps != 1)
         {
-            /*nrt_Error_init(error, "Error reading tile header", NRT_CTXT,
-              NRT_ERR_UNK);*/
+            nrt_Error_init(error,
+                           "Partial tile width not implemented for multi-band",
+                           NRT_CTXT, NRT_ERR_UNK);
             goto CATCH_ERROR;
         }
+        fullBufSize += (nrt_Uint64)destWidth * comp->h *
+                OpenJPEG_sampleBytes(comp->prec);
+    }
 
-        if (keepGoing)
+    if (buf && !*buf)
+    {
+        *buf = (nrt_Uint8*)J2K_MALLOC(fullBufSize);
+        if (!*buf)
         {
-            /* TODO: The way blockIO->cntl->blockOffsetInc is currently
-             *       implemented in ImageIO.c corresponds with how a
-             *       non-compressed partial block would be laid out in a
-             *       NITF - the actual extra columns would have been read.
-             *       Not sure how the J2K data is laid out on disk but
-             *       OpenJPEG is hiding this from us if the extra columns are
-             *       present there.  So whenever we get a partial tile that
-             *       isn't at the full width, we need to add in these extra
-             *       columns of 0's ourselves.  Potentially we could update
-             *       ImageIO.c to not require this instead.  Note that we
-             *       don't need to pad out the extra rows for a partial block
-             *       that isn't the full height because ImageIO will never try
-             *       to memcpy these in - we only need to get the stride to
-             *       work out correctly.
-             */
-            const OPJ_UINT32 thisTileWidth = tileX1 - tileX0;
-            const OPJ_UINT32 thisTileHeight = tileY1 - tileY0;
-            if (thisTileWidth < tileWidth)
-            {
-                /* TODO: The current approach below only works for single band
-                 *       imagery.  For RGB data, I believe it is stored as all
-                 *       red, then all green, then all blue, so we would need
-                 *       a temp buffer rather than reusing the current buffer.
-                 */
-                if (nComponents != 1)
-                {
-                    nrt_Error_init(
-                        error,
-                        "Partial tile width not implemented for multi-band",
-                        NRT_CTXT, NRT_ERR_UNK);
-                    goto CATCH_ERROR;
-                }
-
-                numBitsPerPixel =
-                    j2k_Container_getPrecision(impl->container, error);
-                numBytesPerPixel =
-                    (numBitsPerPixel / 8) + (numBitsPerPixel % 8 != 0);
-                fullBufSize = tileWidth * thisTileHeight * numBytesPerPixel;
-            }
-            else
-            {
-                fullBufSize = bufSize;
-            }
-
-            if (buf && !*buf)
-            {
-                *buf = (nrt_Uint8*)J2K_MALLOC(fullBufSize);
-                if (!*buf)
-                {
-                    nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
-                                   NRT_ERR_MEMORY);
-                    goto CATCH_ERROR;
-                }
-            }
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+    }
 
-            if (!opj_decode_tile_data(codec, tileIndex, *buf, bufSize, stream))
-            {
-                /*nrt_Error_init(error, "Error decoding tile", NRT_CTXT,
-                  NRT_ERR_UNK);*/
-                goto CATCH_ERROR;
-            }
+    /* Pack the decoded samples, one component after the other */
+    bufPtr = *buf;
+    for (idx = 0; idx < image->numcomps; ++idx)
+    {
+        const opj_image_comp_t *comp = &image->comps[idx];
+        const size_t sampleBytes = OpenJPEG_sampleBytes(comp->prec);
+        const OPJ_UINT32 destWidth = comp->w < tileWidth ? tileWidth : comp->w;
+        const size_t numLeftoverBytes = (destWidth - comp->w) * sampleBytes;
+        const OPJ_INT32 *src = comp->data;
+        OPJ_UINT32 row, col;
 
-            if (thisTileWidth < tileWidth)
+        for (row = 0; row < comp->h; ++row, src += comp->w)
+        {
+            switch (sampleBytes)
             {
-                /* We have a tile that isn't as wide as it "should" be
-                 * Need to add in the extra columns ourselves.  By marching
-                 * through the rows backwards, we can do this in place.
-                 */
-                const size_t srcStride = thisTileWidth * numBytesPerPixel;
-                const size_t destStride = tileWidth * numBytesPerPixel;
-                const size_t numLeftoverBytes = destStride - srcStride;
-                OPJ_UINT32 lastRow = thisTileHeight - 1;
-                size_t srcOffset = lastRow * srcStride;
-                size_t destOffset = lastRow * destStride;
-                OPJ_UINT32 ii;
-                nrt_Uint8* bufPtr = *buf;
-
-                for (ii = 0;
-                     ii < thisTileHeight;
-                     ++ii, srcOffset -= srcStride, destOffset -= destStride)
-                {
-                    nrt_Uint8* const dest = bufPtr + destOffset;
-                    memmove(dest, bufPtr + srcOffset, srcStride);
-                    memset(dest + srcStride, 0, numLeftoverBytes);
-                }
+            case 1:
+                for (col = 0; col < comp->w; ++col)
+                    bufPtr[col] = (nrt_Uint8)src[col];
+                break;
+            case 2:
+                for (col = 0; col < comp->w; ++col)
+                    ((nrt_Uint16*)bufPtr)[col] = (nrt_Uint16)src[col];
+                break;
+            default:
+                for (col = 0; col < comp->w; ++col)
+                    ((nrt_Uint32*)bufPtr)[col] = (nrt_Uint32)src[col];
+                break;
             }
+            memset(bufPtr + comp->w * sampleBytes, 0, numLeftoverBytes);
+            bufPtr += destWidth * sampleBytes;
         }
     }
 
-    goto CLEANUP;
+    nrt_Mutex_unlock(&impl->lock);
+    return fullBufSize;
 
     CATCH_ERROR:
     {
-        fullBufSize = 0;
-    }
-
-    CLEANUP:
-    {
-        OpenJPEG_cleanup(&stream, &codec, &image);
+        nrt_Mutex_unlock(&impl->lock);
+        return 0;
     }
-    return fullBufSize;
 }
 
 J2KPRIV( nrt_Uint64)
@@ -826,8 +1148,11 @@ OpenJPEGReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
     nrt_Uint64 bufSize;
     nrt_Uint64 offset = 0;
     nrt_Uint32 componentBytes, nComponents;
+    IOControl ioControl;
 
-    if (!OpenJPEG_setup(impl, &stream, &codec, error))
+    /* A region is decoded with a codec of its own, which leaves the cached
+     * one used by readTile where it was */
+    if (!OpenJPEG_setup(impl, &ioControl, &stream, &codec, error))
     {
         goto CATCH_ERROR;
     }
@@ -910,6 +1235,121 @@ OpenJPEGReader_readRegion(J2K_USER_DATA *data, nrt_Uint32 x0, nrt_Uint32 y0,
     return bufSize;
 }
 
+J2KPRIV( nrt_Uint64)
+OpenJPEGReader_readRegionReduced(J2K_USER_DATA *data, nrt_Uint32 x0,
+                                 nrt_Uint32 y0, nrt_Uint32 x1, nrt_Uint32 y1,
+                                 nrt_Uint32 reduce, nrt_Uint8 **buf,
+                                 nrt_Error *error)
+{
+    OpenJPEGReaderImpl *impl = (OpenJPEGReaderImpl*) data;
+
+    opj_stream_t *stream = NULL;
+    opj_image_t *image = NULL;
+    opj_codec_t *codec = NULL;
+    nrt_Uint64 bufSize = 0;
+    nrt_Uint8 *bufPtr;
+    OPJ_UINT32 idx;
+    IOControl ioControl;
+
+    if (!OpenJPEG_setup(impl, &ioControl, &stream, &codec, error))
+    {
+        goto CATCH_ERROR;
+    }
+
+    if (!opj_read_header(stream, codec, &image))
+    {
+        /*nrt_Error_init(error, "Error reading header", NRT_CTXT, NRT_ERR_UNK);*/
+        goto CATCH_ERROR;
+    }
+
+    /* Only the first (numresolutions - reduce) levels of each tile get
+     * decoded, so the region comes back 2^reduce times smaller */
+    if (!opj_set_decoded_resolution_factor(codec, reduce))
+    {
+        nrt_Error_init(error, "Unable to reduce the decoded resolution",
+                       NRT_CTXT, NRT_ERR_INVALID_PARAMETER);
+        goto CATCH_ERROR;
+    }
+
+    if (x1 == 0)
+        x1 = j2k_Container_getWidth(impl->container, error);
+    if (y1 == 0)
+        y1 = j2k_Container_getHeight(impl->container, error);
+
+    if (!opj_set_decode_area(codec, image, x0, y0, x1, y1))
+    {
+        /*nrt_Error_init(error, "Error decoding area", NRT_CTXT, NRT_ERR_UNK);*/
+        goto CATCH_ERROR;
+    }
+
+    if (!opj_decode(codec, stream, image) ||
+        !opj_end_decompress(codec, stream))
+    {
+        /*nrt_Error_init(error, "Error decoding region", NRT_CTXT,
+          NRT_ERR_UNK);*/
+        goto CATCH_ERROR;
+    }
+
+    for (idx = 0; idx < image->numcomps; ++idx)
+    {
+        const opj_image_comp_t *comp = &image->comps[idx];
+        bufSize += (nrt_Uint64)comp->w * comp->h *
+                OpenJPEG_sampleBytes(comp->prec);
+    }
+
+    if (buf && !*buf)
+    {
+        *buf = (nrt_Uint8*)J2K_MALLOC(bufSize);
+        if (!*buf)
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+    }
+
+    /* Pack the decoded samples, one component after the other */
+    bufPtr = *buf;
+    for (idx = 0; idx < image->numcomps; ++idx)
+    {
+        const opj_image_comp_t *comp = &image->comps[idx];
+        const size_t sampleBytes = OpenJPEG_sampleBytes(comp->prec);
+        const size_t count = (size_t)comp->w * comp->h;
+        const OPJ_INT32 *src = comp->data;
+        size_t i;
+
+        switch (sampleBytes)
+        {
+        case 1:
+            for (i = 0; i < count; ++i)
+                bufPtr[i] = (nrt_Uint8)src[i];
+            break;
+        case 2:
+            for (i = 0; i < count; ++i)
+                ((nrt_Uint16*)bufPtr)[i] = (nrt_Uint16)src[i];
+            break;
+        default:
+            for (i = 0; i < count; ++i)
+                ((nrt_Uint32*)bufPtr)[i] = (nrt_Uint32)src[i];
+            break;
+        }
+        bufPtr += count * sampleBytes;
+    }
+
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        bufSize = 0;
+    }
+
+    CLEANUP:
+    {
+        OpenJPEG_cleanup(&stream, &codec, &image);
+    }
+    return bufSize;
+}
+
 J2KPRIV( j2k_Container*)
 OpenJPEGReader_getContainer(J2K_USER_DATA *data, nrt_Error *error)
 {
@@ -923,6 +1363,8 @@ OpenJPEGReader_destruct(J2K_USER_DATA * data)
     if (data)
     {
         OpenJPEGReaderImpl* const impl = (OpenJPEGReaderImpl*) data;
+        OpenJPEG_cleanup(&impl->stream, &impl->codec, &impl->image);
+        nrt_Mutex_delete(&impl->lock);
         if (impl->io && impl->ownIO)
         {
             nrt_IOInterface_destruct(&impl->io);
@@ -1025,6 +1467,41 @@ OpenJPEGWriter_setTile(J2K_USER_DATA *data, nrt_Uint32 tileX, nrt_Uint32 tileY,
         }
     }
 
+    if (impl->numThreads > 1)
+    {
+        OpenJPEGPendingTile *tile = &impl->pending[impl->numPending];
+
+        memset(tile, 0, sizeof(OpenJPEGPendingTile));
+        if (newTileBuf)
+        {
+            tile->raw = newTileBuf;
+            newTileBuf = NULL;
+        }
+        else
+        {
+            if (!(tile->raw = (nrt_Uint8*)J2K_MALLOC(tileSize)))
+            {
+                nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                               NRT_ERR_MEMORY);
+                goto CATCH_ERROR;
+            }
+            memcpy(tile->raw, buf, tileSize);
+        }
+        tile->tileX = tileX;
+        tile->tileY = tileY;
+        tile->width = thisTileWidth;
+        tile->height = thisTileHeight;
+        tile->rawSize = tileSize;
+        impl->numPending++;
+
+        if (impl->numPending == impl->numThreads * 2 &&
+            !OpenJPEG_flushTiles(impl, error))
+        {
+            goto CATCH_ERROR;
+        }
+        goto CLEANUP;
+    }
+
     if (!opj_write_tile(impl->codec,
                         tileIndex,
                         (OPJ_BYTE* )buf,
@@ -1083,21 +1560,34 @@ OpenJPEGWriter_write(J2K_USER_DATA *data, nrt_IOInterface *io, nrt_Error *error)
     NRT_BOOL rc = NRT_SUCCESS;
     size_t compressedSize;
 
-    memset(error->message, 0, NRT_MAX_EMESSAGE);
-    if(!opj_set_error_handler(impl->codec,
-                              OpenJPEG_errorHandler,
-                              error))
+    if (impl->numThreads > 1)
     {
-        nrt_Error_init(error, "Unable to set OpenJPEG error handler", NRT_CTXT,
-                       NRT_ERR_UNK);
-        goto CATCH_ERROR;
-    }
+        static const char eoc[] = { (char)0xFF, (char)0xD9 };
 
-    if (!opj_end_compress(impl->codec, impl->stream))
+        if (!OpenJPEG_flushTiles(impl, error) ||
+            !nrt_IOInterface_write(impl->compressed, eoc, sizeof(eoc), error))
+        {
+            goto CATCH_ERROR;
+        }
+    }
+    else
     {
-        /*nrt_Error_init(error, "Error ending compression", NRT_CTXT,
-          NRT_ERR_INVALID_OBJECT);*/
-        goto CATCH_ERROR;
+        memset(error->message, 0, NRT_MAX_EMESSAGE);
+        if(!opj_set_error_handler(impl->codec,
+                                  OpenJPEG_errorHandler,
+                                  error))
+        {
+            nrt_Error_init(error, "Unable to set OpenJPEG error handler",
+                           NRT_CTXT, NRT_ERR_UNK);
+            goto CATCH_ERROR;
+        }
+
+        if (!opj_end_compress(impl->codec, impl->stream))
+        {
+            /*nrt_Error_init(error, "Error ending compression", NRT_CTXT,
+              NRT_ERR_INVALID_OBJECT);*/
+            goto CATCH_ERROR;
+        }
     }
 
     /* just copy/write the compressed data to the output IO */
@@ -1138,6 +1628,13 @@ OpenJPEGWriter_destruct(J2K_USER_DATA * data)
         OpenJPEGWriterImpl* const impl = (OpenJPEGWriterImpl*) data;
         OpenJPEG_cleanup(&impl->stream, &impl->codec, &impl->image);
         nrt_IOInterface_destruct(&impl->compressed);
+        if (impl->pending)
+        {
+            OpenJPEG_freeTiles(impl);
+            J2K_FREE(impl->pending);
+        }
+        if (impl->cmptParams)
+            J2K_FREE(impl->cmptParams);
         J2K_FREE(data);
     }
 }
@@ -1194,6 +1691,7 @@ J2KAPI(j2k_Reader*) j2k_Reader_openIO(nrt_IOInterface *io, nrt_Error *error)
         goto CATCH_ERROR;
     }
     memset(impl, 0, sizeof(OpenJPEGReaderImpl));
+    nrt_Mutex_init(&impl->lock);
 
     reader = (j2k_Reader *) J2K_MALLOC(sizeof(j2k_Reader));
     if (!reader)
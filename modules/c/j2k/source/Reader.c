@@ -44,6 +44,20 @@ J2KAPI(nrt_Uint64) j2k_Reader_readRegion(j2k_Reader *reader,
     return reader->iface->readRegion(reader->data, x0, y0, x1, y1, buf, error);
 }
 
+J2KAPI(nrt_Uint64) j2k_Reader_readRegionReduced(j2k_Reader *reader,
+        nrt_Uint32 x0, nrt_Uint32 y0, nrt_Uint32 x1, nrt_Uint32 y1,
+        nrt_Uint32 reduce, nrt_Uint8 **buf, nrt_Error *error)
+{
+    if (!reader->iface->readRegionReduced)
+    {
+        nrt_Error_init(error, "Reduced resolution reads are not supported",
+                       NRT_CTXT, NRT_ERR_INVALID_OBJECT);
+        return 0;
+    }
+    return reader->iface->readRegionReduced(reader->data, x0, y0, x1, y1,
+                                            reduce, buf, error);
+}
+
 J2KAPI(j2k_Container*) j2k_Reader_getContainer(j2k_Reader *reader,
                                                nrt_Error *error)
 {
@@ -29,10 +29,12 @@ J2KAPI(NRT_BOOL) j2k_Writer_setOptions(j2k_WriterOptions* options,
 {
     nrt_Pair* compressionRatio;
     nrt_Pair* numResolutions;
+    nrt_Pair* numThreads;
     if(options && userOptions)
     {
         compressionRatio = nrt_HashTable_find(userOptions, C8_COMPRESSION_RATIO_KEY);
         numResolutions = nrt_HashTable_find(userOptions, C8_NUM_RESOLUTIONS_KEY);
+        numThreads = nrt_HashTable_find(userOptions, C8_NUM_THREADS_KEY);
 
         if(compressionRatio)
         {
@@ -42,6 +44,10 @@ J2KAPI(NRT_BOOL) j2k_Writer_setOptions(j2k_WriterOptions* options,
         {
             options->numResolutions = *((nrt_Uint32*)numResolutions->data);
         }
+        if(numThreads)
+        {
+            options->numThreads = *((nrt_Uint32*)numThreads->data);
+        }
     }
 
     return NRT_SUCCESS;
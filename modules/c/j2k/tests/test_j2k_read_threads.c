@@ -0,0 +1,249 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Decodes the tiles of one j2k_Reader from several threads at once and
+ * checks that each thread gets the same pixels as a serial read.
+ */
+
+#include <import/nrt.h>
+#include <import/j2k.h>
+
+#define TILE_SIZE 64
+#define TILES_PER_SIDE 3
+#define NUM_TILES (TILES_PER_SIDE * TILES_PER_SIDE)
+#define NUM_THREADS 4
+#define NUM_PASSES 5
+
+typedef struct _ReadJob
+{
+    j2k_Reader *reader;
+    nrt_Uint8 **expected;
+    nrt_Uint64 *expectedSize;
+    nrt_Uint32 first;       /* Tile each thread starts on, so they collide */
+    int mismatches;
+} ReadJob;
+
+static nrt_Uint8 pixel(nrt_Uint32 row, nrt_Uint32 col)
+{
+    return (nrt_Uint8)((row * 7 + col * 3) ^ (row >> 2));
+}
+
+/* Encode a tiled mono image into memory */
+static char *encode(nrt_Uint64 *size, nrt_Error *error)
+{
+    const nrt_Uint32 width = TILE_SIZE * TILES_PER_SIDE;
+    j2k_Component *component = NULL;
+    j2k_Container *container = NULL;
+    j2k_Writer *writer = NULL;
+    j2k_WriterOptions options;
+    nrt_IOInterface *io = NULL;
+    char *out = NULL;
+    nrt_Uint8 tile[TILE_SIZE * TILE_SIZE];
+    nrt_Uint32 tileX, tileY, row, col;
+    const size_t outSize = (size_t)width * width * 2;
+
+    if (!(component = j2k_Component_construct(width, width, 8,
+                                              0, 0, 0, 1, 1, error)))
+        goto CATCH_ERROR;
+    if (!(container = j2k_Container_construct(width, width, 1, &component,
+                                              TILE_SIZE, TILE_SIZE,
+                                              J2K_TYPE_MONO, error)))
+        goto CATCH_ERROR;
+
+    memset(&options, 0, sizeof(j2k_WriterOptions));
+    if (!(writer = j2k_Writer_construct(container, &options, error)))
+        goto CATCH_ERROR;
+
+    for (tileY = 0; tileY < TILES_PER_SIDE; ++tileY)
+    {
+        for (tileX = 0; tileX < TILES_PER_SIDE; ++tileX)
+        {
+            for (row = 0; row < TILE_SIZE; ++row)
+                for (col = 0; col < TILE_SIZE; ++col)
+                    tile[row * TILE_SIZE + col] =
+                        pixel(tileY * TILE_SIZE + row,
+                              tileX * TILE_SIZE + col);
+            if (!j2k_Writer_setTile(writer, tileX, tileY, tile,
+                                    sizeof(tile), error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    if (!(out = (char*)J2K_MALLOC(outSize)))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!(io = nrt_BufferAdapter_construct(out, outSize, 0, error)))
+        goto CATCH_ERROR;
+    if (!j2k_Writer_write(writer, io, error))
+        goto CATCH_ERROR;
+    *size = (nrt_Uint64)nrt_IOInterface_tell(io, error);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        if (out)
+            J2K_FREE(out);
+        out = NULL;
+    }
+    CLEANUP:
+    {
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (writer)
+            j2k_Writer_destruct(&writer);
+        if (container)
+            j2k_Container_destruct(&container);
+    }
+    return out;
+}
+
+static void readTiles(NRT_DATA *data)
+{
+    ReadJob *job = (ReadJob*)data;
+    nrt_Uint32 pass, i;
+    nrt_Error error;
+
+    for (pass = 0; pass < NUM_PASSES; ++pass)
+    {
+        for (i = 0; i < NUM_TILES; ++i)
+        {
+            const nrt_Uint32 tile = (job->first + i) % NUM_TILES;
+            nrt_Uint8 *buf = NULL;
+            const nrt_Uint64 size =
+                j2k_Reader_readTile(job->reader, tile % TILES_PER_SIDE,
+                                    tile / TILES_PER_SIDE, &buf, &error);
+            if (size != job->expectedSize[tile] ||
+                memcmp(buf, job->expected[tile], (size_t)size) != 0)
+            {
+                ++job->mismatches;
+            }
+            if (buf)
+                J2K_FREE(buf);
+        }
+    }
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nrt_Error error;
+    char *encoded = NULL;
+    nrt_Uint64 encodedSize = 0;
+    nrt_IOInterface *io = NULL;
+    j2k_Reader *reader = NULL;
+    nrt_Uint8 *expected[NUM_TILES];
+    nrt_Uint64 expectedSize[NUM_TILES];
+    ReadJob jobs[NUM_THREADS];
+    nrt_Thread *threads[NUM_THREADS];
+    nrt_Uint32 i, row, col;
+
+    (void)argc;
+    (void)argv;
+    memset(expected, 0, sizeof(expected));
+    memset(threads, 0, sizeof(threads));
+
+    if (!(encoded = encode(&encodedSize, &error)))
+        goto CATCH_ERROR;
+    if (!(io = nrt_BufferAdapter_construct(encoded, (size_t)encodedSize, 0,
+                                           &error)))
+        goto CATCH_ERROR;
+    if (!(reader = j2k_Reader_openIO(io, &error)))
+        goto CATCH_ERROR;
+
+    /* The serial read is the reference, and must match what was written */
+    for (i = 0; i < NUM_TILES; ++i)
+    {
+        const nrt_Uint32 tileX = i % TILES_PER_SIDE;
+        const nrt_Uint32 tileY = i / TILES_PER_SIDE;
+        expectedSize[i] = j2k_Reader_readTile(reader, tileX, tileY,
+                                              &expected[i], &error);
+        if (expectedSize[i] != TILE_SIZE * TILE_SIZE)
+            goto CATCH_ERROR;
+        for (row = 0; row < TILE_SIZE; ++row)
+            for (col = 0; col < TILE_SIZE; ++col)
+                if (expected[i][row * TILE_SIZE + col] !=
+                    pixel(tileY * TILE_SIZE + row, tileX * TILE_SIZE + col))
+                {
+                    nrt_Error_init(&error, "Tile does not round trip",
+                                   NRT_CTXT, NRT_ERR_INVALID_OBJECT);
+                    goto CATCH_ERROR;
+                }
+    }
+
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        jobs[i].reader = reader;
+        jobs[i].expected = expected;
+        jobs[i].expectedSize = expectedSize;
+        jobs[i].first = i * NUM_TILES / NUM_THREADS;
+        jobs[i].mismatches = 0;
+        if (!(threads[i] = nrt_Thread_construct(readTiles, &jobs[i],
+                                                &error)))
+            goto CATCH_ERROR;
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        nrt_Thread_join(threads[i], &error);
+        nrt_Thread_destruct(&threads[i]);
+        if (jobs[i].mismatches)
+        {
+            nrt_Error_initf(&error, NRT_CTXT, NRT_ERR_INVALID_OBJECT,
+                            "Thread %d read %d bad tiles", (int)i,
+                            jobs[i].mismatches);
+            goto CATCH_ERROR;
+        }
+    }
+    printf("Read %d tiles from %d threads\n",
+           NUM_TILES * NUM_PASSES * NUM_THREADS, NUM_THREADS);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nrt_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        for (i = 0; i < NUM_THREADS; ++i)
+        {
+            if (threads[i])
+            {
+                nrt_Thread_join(threads[i], &error);
+                nrt_Thread_destruct(&threads[i]);
+            }
+        }
+        for (i = 0; i < NUM_TILES; ++i)
+            if (expected[i])
+                J2K_FREE(expected[i]);
+        if (reader)
+            j2k_Reader_destruct(&reader);
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (encoded)
+            J2K_FREE(encoded);
+    }
+    return rc;
+}
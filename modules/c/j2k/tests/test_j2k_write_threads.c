@@ -0,0 +1,185 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Encodes the same tiled image serially and on several threads, checks that
+ * the codestreams are identical, and reads every tile back.
+ */
+
+#include <import/nrt.h>
+#include <import/j2k.h>
+
+#define TILE_SIZE 64
+#define TILES_X 5
+#define TILES_Y 3
+#define NUM_THREADS 2
+
+static nrt_Uint8 pixel(nrt_Uint32 row, nrt_Uint32 col)
+{
+    return (nrt_Uint8)((row * 5 + col * 9) ^ (col >> 3));
+}
+
+/* Encode a tiled mono image into memory, with the given number of threads */
+static char *encode(nrt_Uint32 numThreads, nrt_Uint64 *size,
+                    nrt_Error *error)
+{
+    const nrt_Uint32 width = TILE_SIZE * TILES_X;
+    const nrt_Uint32 height = TILE_SIZE * TILES_Y;
+    j2k_Component *component = NULL;
+    j2k_Container *container = NULL;
+    j2k_Writer *writer = NULL;
+    j2k_WriterOptions options;
+    nrt_IOInterface *io = NULL;
+    char *out = NULL;
+    nrt_Uint8 tile[TILE_SIZE * TILE_SIZE];
+    nrt_Uint32 tileX, tileY, row, col;
+    const size_t outSize = (size_t)width * height * 2;
+
+    if (!(component = j2k_Component_construct(width, height, 8,
+                                              0, 0, 0, 1, 1, error)))
+        goto CATCH_ERROR;
+    if (!(container = j2k_Container_construct(width, height, 1, &component,
+                                              TILE_SIZE, TILE_SIZE,
+                                              J2K_TYPE_MONO, error)))
+        goto CATCH_ERROR;
+
+    memset(&options, 0, sizeof(j2k_WriterOptions));
+    options.numThreads = numThreads;
+    if (!(writer = j2k_Writer_construct(container, &options, error)))
+        goto CATCH_ERROR;
+
+    for (tileY = 0; tileY < TILES_Y; ++tileY)
+    {
+        for (tileX = 0; tileX < TILES_X; ++tileX)
+        {
+            for (row = 0; row < TILE_SIZE; ++row)
+                for (col = 0; col < TILE_SIZE; ++col)
+                    tile[row * TILE_SIZE + col] =
+                        pixel(tileY * TILE_SIZE + row,
+                              tileX * TILE_SIZE + col);
+            if (!j2k_Writer_setTile(writer, tileX, tileY, tile,
+                                    sizeof(tile), error))
+                goto CATCH_ERROR;
+        }
+    }
+
+    if (!(out = (char*)J2K_MALLOC(outSize)))
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    if (!(io = nrt_BufferAdapter_construct(out, outSize, 0, error)))
+        goto CATCH_ERROR;
+    if (!j2k_Writer_write(writer, io, error))
+        goto CATCH_ERROR;
+    *size = (nrt_Uint64)nrt_IOInterface_tell(io, error);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        if (out)
+            J2K_FREE(out);
+        out = NULL;
+    }
+    CLEANUP:
+    {
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (writer)
+            j2k_Writer_destruct(&writer);
+        if (container)
+            j2k_Container_destruct(&container);
+    }
+    return out;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nrt_Error error;
+    char *serial = NULL;
+    char *threaded = NULL;
+    nrt_Uint64 serialSize = 0;
+    nrt_Uint64 threadedSize = 0;
+    nrt_IOInterface *io = NULL;
+    j2k_Reader *reader = NULL;
+    nrt_Uint8 *buf = NULL;
+    nrt_Uint32 i;
+
+    (void)argc;
+    (void)argv;
+
+    if (!(serial = encode(1, &serialSize, &error)) ||
+        !(threaded = encode(NUM_THREADS, &threadedSize, &error)))
+        goto CATCH_ERROR;
+
+    /* Every tile is coded as it would be serially, so nothing may differ */
+    if (serialSize != threadedSize ||
+        memcmp(serial, threaded, (size_t)serialSize) != 0)
+    {
+        nrt_Error_initf(&error, NRT_CTXT, NRT_ERR_INVALID_OBJECT,
+                        "Threaded codestream (%d bytes) differs from the "
+                        "serial one (%d bytes)", (int)threadedSize,
+                        (int)serialSize);
+        goto CATCH_ERROR;
+    }
+
+    if (!(io = nrt_BufferAdapter_construct(threaded, (size_t)threadedSize, 0,
+                                           &error)))
+        goto CATCH_ERROR;
+    if (!(reader = j2k_Reader_openIO(io, &error)))
+        goto CATCH_ERROR;
+    for (i = 0; i < TILES_X * TILES_Y; ++i)
+    {
+        const nrt_Uint64 size =
+            j2k_Reader_readTile(reader, i % TILES_X, i / TILES_X, &buf,
+                                &error);
+        if (size != TILE_SIZE * TILE_SIZE)
+            goto CATCH_ERROR;
+        J2K_FREE(buf);
+        buf = NULL;
+    }
+    printf("Encoded %d tiles on %d threads\n", TILES_X * TILES_Y,
+           NUM_THREADS);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nrt_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        if (buf)
+            J2K_FREE(buf);
+        if (reader)
+            j2k_Reader_destruct(&reader);
+        if (io)
+            nrt_IOInterface_destruct(&io);
+        if (serial)
+            J2K_FREE(serial);
+        if (threaded)
+            J2K_FREE(threaded);
+    }
+    return rc;
+}
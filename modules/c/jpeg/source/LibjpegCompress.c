@@ -0,0 +1,984 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include <jpeglib.h>
+#include <jerror.h>
+#include <setjmp.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+
+/* borrowed from ImageIO.c */
+#ifndef NITF_IMAGE_IO_NO_BLOCK
+#   define NITF_IMAGE_IO_NO_BLOCK             ((nitf_Uint32) 0xffffffff)
+#endif
+
+/*  Upper bound on the number of blocks encoded at once  */
+#define JPEG_COMPRESS_MAX_THREADS 16
+
+/*  Blocks queued per encoding thread before a batch is encoded  */
+#define JPEG_COMPRESS_BLOCKS_PER_THREAD 2
+
+/*  libjpeg's own default  */
+#define JPEG_COMPRESS_DEFAULT_QUALITY 75
+
+/*  COMRAT code for quantization tables embedded in the blocks  */
+#define JPEG_COMPRESS_COMRAT "00.0"
+
+/*!
+ *  This static array of strings describes the contract of our
+ *  plugin.  We agree to handle compression of type C3 and M3,
+ *  representing (8-bit, lossy) JPEG imagery.  We terminate with a NULL.
+ */
+static const char *ident[] =
+    {
+        NITF_PLUGIN_COMPRESSION_KEY,
+        "C3",
+        "M3",
+        NULL
+    };
+
+/*!
+ *  \struct JPEGEncodedBlock
+ *  \brief A block queued by implWriteBlock() and its compressed form
+ *
+ *  Both buffers are kept from batch to batch, the compressed one grows
+ *  as needed.  The index is the block's place in the file.
+ */
+typedef struct _JPEGEncodedBlock
+{
+    nitf_Uint8* raw;
+    nitf_Uint8* data;
+    size_t      length;
+    size_t      capacity;
+    nitf_Uint32 index;
+}
+JPEGEncodedBlock;
+
+/*!
+ *  \struct JPEGMemoryDest
+ *  \brief A libjpeg destination manager that fills a JPEGEncodedBlock
+ */
+typedef struct _JPEGMemoryDest
+{
+    struct jpeg_destination_mgr pub;
+    JPEGEncodedBlock* block;
+}
+JPEGMemoryDest;
+
+/*!
+ *  \struct JPEGErrorManager
+ *  \brief A libjpeg error manager that returns to the failing call
+ *
+ *  libjpeg's own error_exit calls exit(), from whichever encoding thread
+ *  hit the error.  This one formats the message and longjmps back to the
+ *  setjmp() around the libjpeg calls, which turn it into a nitf_Error.
+ */
+typedef struct _JPEGErrorManager
+{
+    struct jpeg_error_mgr pub;
+    jmp_buf setjmpBuffer;
+    char message[JMSG_LENGTH_MAX];
+}
+JPEGErrorManager;
+
+/*!
+ *  \struct JPEGEncoder
+ *  \brief A libjpeg compressor that is reused from block to block
+ *
+ *  Each encoding thread owns one.  The compression parameters are set
+ *  once, when the encoder is created, and survive each compression cycle.
+ *
+ *  \ar row Scanline buffer used to interleave multi-band blocks
+ */
+typedef struct _JPEGEncoder
+{
+    struct jpeg_compress_struct cinfo;
+    JPEGErrorManager jerr;
+    JPEGMemoryDest dest;
+    JSAMPLE* row;
+}
+JPEGEncoder;
+
+/*!
+ *  \struct JPEGCompressControl
+ *  \brief The actual implementation beneath the opaque control pointer
+ *
+ *  \ar rows The number of rows per block
+ *  \ar cols The number of columns per block
+ *  \ar bands The number of bands per block (JPEG components)
+ *  \ar inColorSpace The libjpeg color space of the block data
+ *  \ar outColorSpace The libjpeg color space of the compressed data
+ *  \ar quality The libjpeg quality factor (1 - 100)
+ *  \ar restartInterval The restart interval in MCUs (0 for none)
+ *  \ar numThreads The number of threads used to encode a batch
+ *  \ar blockSize The size of an uncompressed block in bytes
+ *  \ar nBlocksTotal The number of blocks in the image
+ *  \ar blocksPerRow The number of blocks per row
+ *  \ar blocksPerBand The number of blocks per band
+ *  \ar sequentialBands The number of bands in separate blocks (S mode)
+ *  \ar offset The file offset of the compressed data
+ *  \ar blockMask The block mask to update (NULL for C3)
+ *  \ar padMask The pad mask to update (NULL for C3)
+ *  \ar blockOffsets The offset of each written block from offset
+ *  \ar numReceived The number of blocks handed to implWriteBlock()
+ *  \ar numWritten The number of blocks written
+ *  \ar written The number of compressed bytes written
+ *  \ar pending The blocks of the current batch
+ *  \ar numPending The number of queued blocks in the current batch
+ *  \ar maxPending The number of blocks in a full batch
+ *  \ar held Compressed S mode blocks waiting for the blocks before them
+ *  \ar encoders The compressors, one per encoding thread
+ *  \ar numEncoders The number of compressors
+ *  \ar comratField The subheader COMRAT field, updated when done
+ */
+typedef struct _JPEGCompressControl
+{
+    nitf_Uint32       rows;
+    nitf_Uint32       cols;
+    nitf_Uint32       bands;
+    J_COLOR_SPACE     inColorSpace;
+    J_COLOR_SPACE     outColorSpace;
+    int               quality;
+    unsigned int      restartInterval;
+    nitf_Uint32       numThreads;
+    size_t            blockSize;
+    nitf_Uint32       nBlocksTotal;
+    nitf_Uint32       blocksPerRow;
+    nitf_Uint32       blocksPerBand;
+    nitf_Uint32       sequentialBands;
+    nitf_Uint64       offset;
+    nitf_Uint64*      blockMask;
+    nitf_Uint64*      padMask;
+    nitf_Uint64*      blockOffsets;
+    nitf_Uint32       numReceived;
+    nitf_Uint32       numWritten;
+    nitf_Uint64       written;
+    JPEGEncodedBlock* pending;
+    nitf_Uint32       numPending;
+    nitf_Uint32       maxPending;
+    JPEGEncodedBlock* held;
+    JPEGEncoder**     encoders;
+    nitf_Uint32       numEncoders;
+    nitf_Field*       comratField;
+}
+JPEGCompressControl;
+
+/*!
+ *  \struct JPEGEncodeJob
+ *  \brief The batch shared by the encoding threads
+ */
+typedef struct _JPEGEncodeJob
+{
+    JPEGCompressControl* implControl;
+    nitf_Uint32          next;     /* Next pending block to encode */
+    NITF_BOOL            failed;   /* A block could not be encoded */
+    char                 message[JMSG_LENGTH_MAX]; /* The first failure */
+    nitf_Mutex           mutex;    /* Guards next, failed and message */
+}
+JPEGEncodeJob;
+
+/*!
+ *  \struct JPEGEncodeWorker
+ *  \brief What each encoding thread works with
+ */
+typedef struct _JPEGEncodeWorker
+{
+    JPEGEncodeJob* job;
+    JPEGEncoder*   encoder;
+}
+JPEGEncodeWorker;
+
+NITF_CXX_GUARD
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader* subheader,
+                                            nrt_HashTable* options,
+                                            nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl* control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64* blockMask,
+                              nitf_Uint64* padMask,
+                              nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl* control,
+                                   nitf_IOInterface* io,
+                                   const nitf_Uint8* data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error* error);
+
+NITFPRIV(NITF_BOOL) implEnd(nitf_CompressionControl* control,
+                            nitf_IOInterface* io,
+                            nitf_Error* error);
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl** control);
+
+static nitf_CompressionInterface interfaceTable =
+{
+    implOpen, implStart, implWriteBlock, implEnd, implDestroy, NULL
+};
+
+NITF_CXX_ENDGUARD
+
+
+NITFAPI(const char**) LibjpegCompress_init(nitf_Error *error)
+{
+    /*  Return the identifier structure  */
+    return ident;
+}
+
+NITFAPI(void) C3_cleanup(void)
+{
+}
+
+NITFAPI(void*) C3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    if (strcmp(compressionType, "C3") != 0)
+    {
+        nitf_Error_init(error,
+                        "Unsupported compression type",
+                        NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+
+        return NULL;
+    }
+    return((void *) &interfaceTable);
+}
+
+NITFAPI(void) M3_cleanup(void)
+{
+}
+
+NITFAPI(void*) M3_construct(char *compressionType,
+                            nitf_Error* error)
+{
+    if (strcmp(compressionType, "M3") != 0)
+    {
+        nitf_Error_init(error,
+                        "Unsupported compression type",
+                        NITF_CTXT,
+                        NITF_ERR_COMPRESSION);
+
+        return NULL;
+    }
+    return((void *) &interfaceTable);
+}
+
+/*
+ *  Destination manager callbacks.  The output starts at the beginning of
+ *  the block's buffer and doubles it whenever it fills up.
+ */
+static void JPEGInitDestination(j_compress_ptr cinfo)
+{
+    JPEGMemoryDest* dest = (JPEGMemoryDest*)cinfo->dest;
+
+    dest->pub.next_output_byte = dest->block->data;
+    dest->pub.free_in_buffer = dest->block->capacity;
+}
+
+static boolean JPEGEmptyOutputBuffer(j_compress_ptr cinfo)
+{
+    JPEGMemoryDest* dest = (JPEGMemoryDest*)cinfo->dest;
+    JPEGEncodedBlock* block = dest->block;
+    size_t used = block->capacity;
+    nitf_Uint8* data = (nitf_Uint8*)NITF_REALLOC(block->data, used * 2);
+
+    if (!data)
+        ERREXIT1(cinfo, JERR_OUT_OF_MEMORY, 0);
+
+    block->data = data;
+    block->capacity = used * 2;
+    dest->pub.next_output_byte = data + used;
+    dest->pub.free_in_buffer = block->capacity - used;
+    return TRUE;
+}
+
+static void JPEGTermDestination(j_compress_ptr cinfo)
+{
+    JPEGMemoryDest* dest = (JPEGMemoryDest*)cinfo->dest;
+
+    dest->block->length = dest->block->capacity - dest->pub.free_in_buffer;
+}
+
+static void JPEGErrorExit(j_common_ptr cinfo)
+{
+    JPEGErrorManager* err = (JPEGErrorManager*)cinfo->err;
+
+    (*err->pub.format_message)(cinfo, err->message);
+    longjmp(err->setjmpBuffer, 1);
+}
+
+/*!
+ *  Get compressor number index, creating the compressors up to it as needed
+ */
+NITFPRIV(JPEGEncoder*) getEncoder(JPEGCompressControl* implControl,
+                                  nitf_Uint32 index,
+                                  nitf_Error* error)
+{
+    if (index >= implControl->numEncoders)
+    {
+        JPEGEncoder** encoders = (JPEGEncoder**)NITF_REALLOC(
+            implControl->encoders, sizeof(JPEGEncoder*) * (index + 1));
+        if (!encoders)
+        {
+            nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NULL;
+        }
+        implControl->encoders = encoders;
+
+        while (implControl->numEncoders <= index)
+        {
+            JPEGEncoder* encoder =
+                (JPEGEncoder*)NITF_MALLOC(sizeof(JPEGEncoder));
+            if (!encoder)
+            {
+                nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                return NULL;
+            }
+            encoder->row = (JSAMPLE*)NITF_MALLOC(
+                sizeof(JSAMPLE) * implControl->cols * implControl->bands);
+            if (!encoder->row)
+            {
+                NITF_FREE(encoder);
+                nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                                NITF_CTXT, NITF_ERR_MEMORY);
+                return NULL;
+            }
+
+            encoder->cinfo.err = jpeg_std_error(&encoder->jerr.pub);
+            encoder->jerr.pub.error_exit = JPEGErrorExit;
+            if (setjmp(encoder->jerr.setjmpBuffer))
+            {
+                nitf_Error_init(error, encoder->jerr.message, NITF_CTXT,
+                                NITF_ERR_COMPRESSION);
+                jpeg_destroy_compress(&encoder->cinfo);
+                NITF_FREE(encoder->row);
+                NITF_FREE(encoder);
+                return NULL;
+            }
+            jpeg_create_compress(&encoder->cinfo);
+
+            encoder->dest.pub.init_destination = JPEGInitDestination;
+            encoder->dest.pub.empty_output_buffer = JPEGEmptyOutputBuffer;
+            encoder->dest.pub.term_destination = JPEGTermDestination;
+            encoder->dest.block = NULL;
+            encoder->cinfo.dest = &encoder->dest.pub;
+
+            encoder->cinfo.image_width = implControl->cols;
+            encoder->cinfo.image_height = implControl->rows;
+            encoder->cinfo.input_components = implControl->bands;
+            encoder->cinfo.in_color_space = implControl->inColorSpace;
+            jpeg_set_defaults(&encoder->cinfo);
+            jpeg_set_colorspace(&encoder->cinfo, implControl->outColorSpace);
+            jpeg_set_quality(&encoder->cinfo, implControl->quality, TRUE);
+            encoder->cinfo.restart_interval = implControl->restartInterval;
+            /*  NITF JPEG blocks do not carry a JFIF APP0 marker  */
+            encoder->cinfo.write_JFIF_header = FALSE;
+
+            encoders[implControl->numEncoders++] = encoder;
+        }
+    }
+    return implControl->encoders[index];
+}
+
+/*!
+ *  Compress one block into its own SOI ... EOI stream
+ *
+ *  The block data is band sequential (ImageIO treats compressed P mode
+ *  as B mode), so multi-band blocks are interleaved a scanline at a time.
+ *  On failure the encoder is reset for the next block and libjpeg's
+ *  message is left in encoder->jerr.message.
+ */
+NITFPRIV(NITF_BOOL) encodeBlock(JPEGCompressControl* implControl,
+                                JPEGEncoder* encoder,
+                                JPEGEncodedBlock* block)
+{
+    j_compress_ptr cinfo = &encoder->cinfo;
+    size_t bandSize = (size_t)implControl->rows * implControl->cols;
+    JSAMPROW row;
+    nitf_Uint32 r, c, b;
+
+    if (setjmp(encoder->jerr.setjmpBuffer))
+    {
+        jpeg_abort_compress(cinfo);
+        return NITF_FAILURE;
+    }
+
+    encoder->dest.block = block;
+    jpeg_start_compress(cinfo, TRUE);
+
+    for (r = 0; r < implControl->rows; ++r)
+    {
+        const nitf_Uint8* src = block->raw + (size_t)r * implControl->cols;
+        if (implControl->bands == 1)
+        {
+            row = (JSAMPROW)src;
+        }
+        else
+        {
+            row = encoder->row;
+            for (b = 0; b < implControl->bands; ++b)
+            {
+                for (c = 0; c < implControl->cols; ++c)
+                    row[c * implControl->bands + b] = src[c];
+                src += bandSize;
+            }
+        }
+        jpeg_write_scanlines(cinfo, &row, 1);
+    }
+
+    jpeg_finish_compress(cinfo);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) encodeBlocks(NITF_DATA* data)
+{
+    JPEGEncodeWorker* worker = (JPEGEncodeWorker*)data;
+    JPEGEncodeJob* job = worker->job;
+    JPEGCompressControl* implControl = job->implControl;
+    nitf_Uint32 index;
+
+    for (;;)
+    {
+        nitf_Mutex_lock(&job->mutex);
+        if (job->failed || job->next == implControl->numPending)
+        {
+            nitf_Mutex_unlock(&job->mutex);
+            break;
+        }
+        index = job->next++;
+        nitf_Mutex_unlock(&job->mutex);
+
+        if (!encodeBlock(implControl, worker->encoder,
+                         &implControl->pending[index]))
+        {
+            nitf_Mutex_lock(&job->mutex);
+            if (!job->failed)
+            {
+                job->failed = 1;
+                strcpy(job->message, worker->encoder->jerr.message);
+            }
+            nitf_Mutex_unlock(&job->mutex);
+            break;
+        }
+    }
+}
+
+/*!
+ *  Append one compressed block to the compressed data
+ */
+NITFPRIV(NITF_BOOL) writeEncoded(JPEGCompressControl* implControl,
+                                 nitf_IOInterface* io,
+                                 const nitf_Uint8* data,
+                                 size_t length,
+                                 nitf_Error* error)
+{
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
+            (nitf_Off)(implControl->offset + implControl->written),
+            NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+    if (!nitf_IOInterface_write(io, (const char*)data, length, error))
+        return NITF_FAILURE;
+
+    implControl->blockOffsets[implControl->numWritten++] =
+        implControl->written;
+    implControl->written += length;
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Append a compressed block, or hold on to it until the blocks before it
+ *  in the file have been written
+ *
+ *  In S mode the blocks of all bands arrive a block row at a time, but the
+ *  file has all the blocks of the first band before those of the second.
+ *  A held block keeps the compressed buffer, the pending block gets a new
+ *  one when it is reused.
+ */
+NITFPRIV(NITF_BOOL) placeBlock(JPEGCompressControl* implControl,
+                               nitf_IOInterface* io,
+                               JPEGEncodedBlock* block,
+                               nitf_Error* error)
+{
+    JPEGEncodedBlock* held;
+
+    if (block->index != implControl->numWritten)
+    {
+        held = &implControl->held[block->index];
+        held->data = block->data;
+        held->length = block->length;
+        held->capacity = block->capacity;
+        block->data = NULL;
+        block->capacity = 0;
+        return NITF_SUCCESS;
+    }
+
+    if (!writeEncoded(implControl, io, block->data, block->length, error))
+        return NITF_FAILURE;
+
+    while (implControl->held &&
+           implControl->numWritten < implControl->nBlocksTotal &&
+           implControl->held[implControl->numWritten].data)
+    {
+        held = &implControl->held[implControl->numWritten];
+        if (!writeEncoded(implControl, io, held->data, held->length, error))
+            return NITF_FAILURE;
+        NITF_FREE(held->data);
+        held->data = NULL;
+    }
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Encode the queued blocks, on as many threads as there are blocks (up to
+ *  numThreads), and append them to the compressed data in file order
+ */
+NITFPRIV(NITF_BOOL) flushBlocks(JPEGCompressControl* implControl,
+                                nitf_IOInterface* io,
+                                nitf_Error* error)
+{
+    JPEGEncodeJob job;
+    JPEGEncodeWorker workers[JPEG_COMPRESS_MAX_THREADS];
+    nitf_Thread* threads[JPEG_COMPRESS_MAX_THREADS];
+    nitf_Uint32 numThreads = implControl->numThreads;
+    nitf_Uint32 i;
+
+    if (implControl->numPending == 0)
+        return NITF_SUCCESS;
+
+    if (numThreads > implControl->numPending)
+        numThreads = implControl->numPending;
+    if (!getEncoder(implControl, numThreads - 1, error))
+        return NITF_FAILURE;
+
+    job.implControl = implControl;
+    job.next = 0;
+    job.failed = 0;
+    nitf_Mutex_init(&job.mutex);
+
+    /*  The calling thread encodes too, with the first compressor  */
+    for (i = 0; i < numThreads; ++i)
+    {
+        workers[i].job = &job;
+        workers[i].encoder = implControl->encoders[i];
+        threads[i] = NULL;
+    }
+    for (i = 1; i < numThreads; ++i)
+    {
+        /*  With fewer threads, the remaining ones pick up the slack  */
+        if (!(threads[i] = nitf_Thread_construct(encodeBlocks,
+                                                 &workers[i], error)))
+            break;
+    }
+    encodeBlocks(&workers[0]);
+    for (i = 1; i < numThreads; ++i)
+    {
+        if (threads[i])
+        {
+            nitf_Thread_join(threads[i], error);
+            nitf_Thread_destruct(&threads[i]);
+        }
+    }
+    nitf_Mutex_delete(&job.mutex);
+
+    if (job.failed)
+    {
+        /*  The batch is dropped, the image can not be written anyway  */
+        implControl->numPending = 0;
+        nitf_Error_init(error, job.message, NITF_CTXT, NITF_ERR_COMPRESSION);
+        return NITF_FAILURE;
+    }
+
+    for (i = 0; i < implControl->numPending; ++i)
+    {
+        if (!placeBlock(implControl, io, &implControl->pending[i], error))
+            return NITF_FAILURE;
+    }
+    implControl->numPending = 0;
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Get an unsigned option out of the options hash, if it is there
+ */
+NITFPRIV(NITF_BOOL) getOption(nrt_HashTable* options,
+                              const char* key,
+                              nitf_Uint32* value)
+{
+    nrt_Pair* pair;
+
+    if (!options || !(pair = nrt_HashTable_find(options, key)))
+        return NITF_FAILURE;
+    *value = *((nitf_Uint32*)pair->data);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_CompressionControl*) implOpen(nitf_ImageSubheader* subheader,
+                                            nrt_HashTable* options,
+                                            nitf_Error* error)
+{
+    JPEGCompressControl* implControl = NULL;
+    nitf_Uint32 nBands;
+    nitf_Uint32 nbpp;
+    nitf_Uint32 nbpr;
+    nitf_Uint32 nbpc;
+    nitf_Uint32 nppbh;
+    nitf_Uint32 nppbv;
+    nitf_Uint32 value;
+    char pvtype[NITF_PVTYPE_SZ+1];
+    char imode[NITF_IMODE_SZ+1];
+    char irep[NITF_IREP_SZ+1];
+
+    if (!nitf_Field_get(subheader->NITF_NBPP, &nbpp,
+                        NITF_CONV_INT, sizeof(nitf_Uint32), error) ||
+        !nitf_Field_get(subheader->NITF_NPPBH, &nppbh,
+                        NITF_CONV_INT, sizeof(nitf_Uint32), error) ||
+        !nitf_Field_get(subheader->NITF_NPPBV, &nppbv,
+                        NITF_CONV_INT, sizeof(nitf_Uint32), error) ||
+        !nitf_Field_get(subheader->NITF_NBPR, &nbpr,
+                        NITF_CONV_INT, sizeof(nitf_Uint32), error) ||
+        !nitf_Field_get(subheader->NITF_NBPC, &nbpc,
+                        NITF_CONV_INT, sizeof(nitf_Uint32), error) ||
+        !nitf_Field_get(subheader->NITF_PVTYPE, pvtype, NITF_CONV_STRING,
+                        NITF_PVTYPE_SZ+1, error) ||
+        !nitf_Field_get(subheader->NITF_IMODE, imode, NITF_CONV_STRING,
+                        NITF_IMODE_SZ+1, error) ||
+        !nitf_Field_get(subheader->NITF_IREP, irep, NITF_CONV_STRING,
+                        NITF_IREP_SZ+1, error))
+    {
+        goto CATCH_ERROR;
+    }
+
+    if (0 == (nBands = nitf_ImageSubheader_getBandCount(subheader, error)))
+        goto CATCH_ERROR;
+
+    nitf_Field_trimString(pvtype);
+    if (strcmp(pvtype, "INT") != 0 || nbpp != BITS_IN_JSAMPLE)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "For JPEG compression, PVTYPE must be INT and "
+                         "NBPP must be %d", BITS_IN_JSAMPLE);
+        goto CATCH_ERROR;
+    }
+
+    if (!(implControl = (JPEGCompressControl*)NITF_MALLOC(
+              sizeof(JPEGCompressControl))))
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(implControl, 0, sizeof(JPEGCompressControl));
+
+    implControl->rows = nppbv;
+    implControl->cols = nppbh;
+    implControl->nBlocksTotal = nbpr * nbpc;
+    implControl->blocksPerRow = nbpr;
+    implControl->blocksPerBand = nbpr * nbpc;
+    implControl->sequentialBands = 1;
+    implControl->comratField = subheader->NITF_COMRAT;
+
+    /*  Band sequential blocks hold a single band each  */
+    nitf_Field_trimString(imode);
+    nitf_Field_trimString(irep);
+    if (strcmp(imode, "S") == 0 || nBands == 1)
+    {
+        implControl->bands = 1;
+        implControl->inColorSpace = JCS_GRAYSCALE;
+        implControl->outColorSpace = JCS_GRAYSCALE;
+        if (nBands > 1)
+        {
+            implControl->nBlocksTotal *= nBands;
+            implControl->sequentialBands = nBands;
+        }
+    }
+    else if (nBands == 3 && strcmp(irep, "RGB") == 0)
+    {
+        implControl->bands = 3;
+        implControl->inColorSpace = JCS_RGB;
+        implControl->outColorSpace = JCS_YCbCr;
+    }
+    else if (nBands == 3 && strcmp(irep, "YCbCr601") == 0)
+    {
+        implControl->bands = 3;
+        implControl->inColorSpace = JCS_YCbCr;
+        implControl->outColorSpace = JCS_YCbCr;
+    }
+    else
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "JPEG compression of %d bands with IREP %s "
+                         "is not supported", nBands, irep);
+        goto CATCH_ERROR;
+    }
+    implControl->blockSize = (size_t)implControl->rows * implControl->cols *
+        implControl->bands;
+
+    implControl->quality = JPEG_COMPRESS_DEFAULT_QUALITY;
+    if (getOption(options, C3_QUALITY_KEY, &value))
+    {
+        if (value < 1 || value > 100)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                             "JPEG quality must be 1 - 100, not %d", value);
+            goto CATCH_ERROR;
+        }
+        implControl->quality = (int)value;
+    }
+    if (getOption(options, C3_RESTART_INTERVAL_KEY, &value))
+        implControl->restartInterval = value;
+
+    implControl->numThreads = nitf_Thread_getNumCPUs();
+    if (getOption(options, C3_NUM_THREADS_KEY, &value))
+        implControl->numThreads = value;
+    if (implControl->numThreads < 1)
+        implControl->numThreads = 1;
+    if (implControl->numThreads > JPEG_COMPRESS_MAX_THREADS)
+        implControl->numThreads = JPEG_COMPRESS_MAX_THREADS;
+
+    implControl->maxPending =
+        implControl->numThreads * JPEG_COMPRESS_BLOCKS_PER_THREAD;
+    if (implControl->maxPending > implControl->nBlocksTotal)
+        implControl->maxPending = implControl->nBlocksTotal;
+
+    implControl->pending = (JPEGEncodedBlock*)NITF_MALLOC(
+        sizeof(JPEGEncodedBlock) * implControl->maxPending);
+    implControl->blockOffsets = (nitf_Uint64*)NITF_MALLOC(
+        sizeof(nitf_Uint64) * implControl->nBlocksTotal);
+    if (!implControl->pending || !implControl->blockOffsets)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(implControl->pending, 0,
+           sizeof(JPEGEncodedBlock) * implControl->maxPending);
+
+    if (implControl->sequentialBands > 1)
+    {
+        implControl->held = (JPEGEncodedBlock*)NITF_MALLOC(
+            sizeof(JPEGEncodedBlock) * implControl->nBlocksTotal);
+        if (!implControl->held)
+        {
+            nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+        memset(implControl->held, 0,
+               sizeof(JPEGEncodedBlock) * implControl->nBlocksTotal);
+    }
+
+    return (nitf_CompressionControl*)implControl;
+
+CATCH_ERROR:
+    implDestroy((nitf_CompressionControl**)&implControl);
+    return NULL;
+}
+
+NITFPRIV(NITF_BOOL) implStart(nitf_CompressionControl* control,
+                              nitf_Uint64 offset,
+                              nitf_Uint64 dataLength,
+                              nitf_Uint64* blockMask,
+                              nitf_Uint64* padMask,
+                              nitf_Error* error)
+{
+    JPEGCompressControl* implControl = (JPEGCompressControl*)control;
+
+    implControl->offset = offset;
+    implControl->blockMask = blockMask;
+    implControl->padMask = padMask;
+    implControl->numReceived = 0;
+    implControl->numWritten = 0;
+    implControl->written = 0;
+    implControl->numPending = 0;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implWriteBlock(nitf_CompressionControl* control,
+                                   nitf_IOInterface* io,
+                                   const nitf_Uint8* data,
+                                   NITF_BOOL pad,
+                                   NITF_BOOL noData,
+                                   nitf_Error* error)
+{
+    JPEGCompressControl* implControl = (JPEGCompressControl*)control;
+    JPEGEncodedBlock* block;
+    nitf_Uint32 received;
+    nitf_Uint32 blockRow;
+
+    if (implControl->numReceived == implControl->nBlocksTotal)
+    {
+        nitf_Error_init(error, "More blocks written than the image has",
+                        NITF_CTXT, NITF_ERR_COMPRESSION);
+        return NITF_FAILURE;
+    }
+
+    if (implControl->numPending == implControl->maxPending &&
+        !flushBlocks(implControl, io, error))
+        return NITF_FAILURE;
+
+    block = &implControl->pending[implControl->numPending];
+    if (!block->raw)
+    {
+        block->raw = (nitf_Uint8*)NITF_MALLOC(implControl->blockSize);
+        if (!block->raw)
+        {
+            nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+    }
+    if (!block->data)
+    {
+        /*  Start the output at half the raw size, it grows if need be  */
+        block->capacity = implControl->blockSize / 2 + 1024;
+        block->data = (nitf_Uint8*)NITF_MALLOC(block->capacity);
+        if (!block->data)
+        {
+            nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            block->capacity = 0;
+            return NITF_FAILURE;
+        }
+    }
+    memcpy(block->raw, data, implControl->blockSize);
+
+    /*
+     *  ImageIO hands over every band of a block column before moving on,
+     *  so in S mode the n-th block is band n % bands of its block column
+     */
+    received = implControl->numReceived++;
+    block->index = received;
+    if (implControl->sequentialBands > 1)
+    {
+        blockRow = received /
+            (implControl->blocksPerRow * implControl->sequentialBands);
+        received %= implControl->blocksPerRow * implControl->sequentialBands;
+        block->index = (received % implControl->sequentialBands) *
+            implControl->blocksPerBand +
+            blockRow * implControl->blocksPerRow +
+            received / implControl->sequentialBands;
+    }
+    implControl->numPending++;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) implEnd(nitf_CompressionControl* control,
+                            nitf_IOInterface* io,
+                            nitf_Error* error)
+{
+    JPEGCompressControl* implControl = (JPEGCompressControl*)control;
+    nitf_Uint32 i, k;
+
+    if (!flushBlocks(implControl, io, error))
+        return NITF_FAILURE;
+    if (implControl->numWritten != implControl->numReceived)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_COMPRESSION,
+                         "Only %d of %d band sequential blocks were written",
+                         implControl->numWritten, implControl->numReceived);
+        return NITF_FAILURE;
+    }
+
+    /*
+     *  Blocks that were not written (pad only) are already marked in the
+     *  mask, the written ones get their compressed offsets in order
+     */
+    if (implControl->blockMask)
+    {
+        for (i = 0, k = 0; i < implControl->nBlocksTotal &&
+                 k < implControl->numWritten; ++i)
+        {
+            if (implControl->blockMask[i] == NITF_IMAGE_IO_NO_BLOCK)
+                continue;
+            implControl->blockMask[i] = implControl->blockOffsets[k++];
+            if (implControl->padMask &&
+                implControl->padMask[i] != NITF_IMAGE_IO_NO_BLOCK)
+                implControl->padMask[i] = implControl->blockMask[i];
+        }
+    }
+
+    /*  Leave the io at the end of the compressed data  */
+    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
+            (nitf_Off)(implControl->offset + implControl->written),
+            NITF_SEEK_SET, error)))
+        return NITF_FAILURE;
+
+    /*
+     *  For C3 and M3, COMRAT names the quantization tables rather than a
+     *  bit rate.  The libjpeg tables scaled by the quality factor are none
+     *  of the standard ones (00.1 - 00.5), so they are user defined (00.0)
+     */
+    return nitf_Field_setString(implControl->comratField,
+                                JPEG_COMPRESS_COMRAT, error);
+}
+
+NITFPRIV(void) implDestroy(nitf_CompressionControl** control)
+{
+    JPEGCompressControl* implControl;
+    nitf_Uint32 i;
+
+    if (!control || !*control)
+        return;
+
+    implControl = (JPEGCompressControl*)*control;
+    for (i = 0; i < implControl->numEncoders; ++i)
+    {
+        jpeg_destroy_compress(&implControl->encoders[i]->cinfo);
+        NITF_FREE(implControl->encoders[i]->row);
+        NITF_FREE(implControl->encoders[i]);
+    }
+    if (implControl->encoders)
+        NITF_FREE(implControl->encoders);
+
+    if (implControl->pending)
+    {
+        for (i = 0; i < implControl->maxPending; ++i)
+        {
+            if (implControl->pending[i].raw)
+                NITF_FREE(implControl->pending[i].raw);
+            if (implControl->pending[i].data)
+                NITF_FREE(implControl->pending[i].data);
+        }
+        NITF_FREE(implControl->pending);
+    }
+    if (implControl->held)
+    {
+        for (i = 0; i < implControl->nBlocksTotal; ++i)
+        {
+            if (implControl->held[i].data)
+                NITF_FREE(implControl->held[i].data);
+        }
+        NITF_FREE(implControl->held);
+    }
+    if (implControl->blockOffsets)
+        NITF_FREE(implControl->blockOffsets);
+
+    NITF_FREE(implControl);
+    *control = NULL;
+}
@@ -40,6 +40,8 @@
 #endif
 
 #define INPUT_BUF_SIZE  4096
+#define SCAN_BUF_SIZE   (1024 * 1024)
+#define JPEG_SOI_TABLE_CACHE_SIZE 16
 
 /*
       Zero Block enable
@@ -142,69 +144,134 @@ static int Q5[] =
         16,  14,  20,  21,  20,  27,  27,  36
     };
 
-typedef struct _JPEGMarkerItem
+/*!
+ *  \struct JPEGScanner
+ *  \brief Walks the compressed data for the marker scan
+ *
+ *  The scan looks at (nearly) every byte of the image segment, so the
+ *  bytes are taken from a large window rather than one IO read apiece.
+ *  If the IO keeps the data in memory (e.g. a mapped file), the window is
+ *  the data itself.
+ *
+ *  \ar io The io handle
+ *  \ar data The current window
+ *  \ar buffer Storage for the window, NULL if the data is in memory
+ *  \ar dataStart The file offset of the first byte of the window
+ *  \ar dataLength The number of bytes in the window
+ *  \ar pos The next byte in the window
+ *  \ar end The file offset past the last byte that may be scanned, the
+ *  end of the image data (not of the file, other segments may follow)
+ */
+typedef struct _JPEGScanner
 {
-    char name[4];
-    nitf_Off off;
-    nitf_Uint32 block;
-
+    nitf_IOInterface* io;
+    const nitf_Uint8* data;
+    nitf_Uint8*       buffer;
+    nitf_Off          dataStart;
+    size_t            dataLength;
+    size_t            pos;
+    nitf_Off          end;
 }
-JPEGMarkerItem;
+JPEGScanner;
 
-NITFPRIV(JPEGMarkerItem*) JPEGMarkerItem_construct(nitf_Error* error)
+NITFPRIV(NITF_BOOL) JPEGScanner_init(JPEGScanner* scanner,
+                                     nitf_IOInterface* io,
+                                     nitf_Off offset,
+                                     nitf_Off length,
+                                     nitf_Error* error)
 {
-    JPEGMarkerItem* item = (JPEGMarkerItem*)NITF_MALLOC(sizeof(JPEGMarkerItem));
-    if (! item )
+    nitf_Off end = nitf_IOInterface_getSize(io, error);
+    if (!NITF_IO_SUCCESS(end))
+        return NITF_FAILURE;
+    if (offset + length < end)
+        end = offset + length;
+    if (end < offset)
+        end = offset;
+
+    scanner->io = io;
+    scanner->dataStart = offset;
+    scanner->pos = 0;
+    scanner->end = end;
+    scanner->buffer = NULL;
+    scanner->data = (const nitf_Uint8*)nitf_IOInterface_getBuffer(
+        io, offset, (size_t)(end - offset), error);
+    if (scanner->data)
+    {
+        scanner->dataLength = (size_t)(end - offset);
+        return NITF_SUCCESS;
+    }
+
+    scanner->dataLength = 0;
+    scanner->buffer = (nitf_Uint8*)NITF_MALLOC(SCAN_BUF_SIZE);
+    if (!scanner->buffer)
     {
         nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
-                NITF_CTXT, NITF_ERR_DECOMPRESSION);
-        return NULL;
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
     }
-    memset(item->name, 0, 4);
-    item->off = 0;
-    return item;
+    scanner->data = scanner->buffer;
+    return NITF_SUCCESS;
 }
 
-/* not used - the list destructor will NITF_FREE these */
-NITFPRIV(void) JPEGMarkerItem_destruct(JPEGMarkerItem** item)
+NITFPRIV(void) JPEGScanner_cleanup(JPEGScanner* scanner)
 {
-    if (*item)
+    if (scanner->buffer)
     {
-        NITF_FREE( *item );
-        *item = NULL;
+        NITF_FREE(scanner->buffer);
+        scanner->buffer = NULL;
     }
 }
 
-/* Added for diagnostics */
+/*  The file offset of the next byte to be scanned  */
+NITFPRIV(nitf_Off) JPEGScanner_tell(JPEGScanner* scanner)
+{
+    return scanner->dataStart + (nitf_Off)scanner->pos;
+}
 
-NITFPRIV(void) JPEGMarkerItem_print(
-        JPEGMarkerItem* item, FILE *file)
+/*  Move the window up to the next byte to be scanned  */
+NITFPRIV(NITF_BOOL) JPEGScanner_fill(JPEGScanner* scanner, nitf_Error* error)
 {
-    if (file == NULL)
+    size_t toRead;
+
+    scanner->dataStart += (nitf_Off)scanner->pos;
+    scanner->dataLength = 0;
+    scanner->pos = 0;
+
+    toRead = SCAN_BUF_SIZE;
+    if (scanner->dataStart + (nitf_Off)toRead > scanner->end)
+        toRead = scanner->dataStart < scanner->end ?
+            (size_t)(scanner->end - scanner->dataStart) : 0;
+    if (!scanner->buffer || toRead == 0)
     {
-        file = stdout;
+        nitf_Error_init(error, "Unexpected end of JPEG data",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
     }
 
-    fprintf(file, "JPEG Marker: %s %lld\n", item->name, (long long)item->off);
-    return;
+    if (!nitf_IOInterface_readAt(scanner->io, scanner->dataStart,
+                                 scanner->buffer, toRead, error))
+        return NITF_FAILURE;
+    scanner->dataLength = toRead;
+    return NITF_SUCCESS;
 }
 
-NITFPRIV(void) JPEGMarkerItem_printList(
-        nitf_List* markerList, FILE *file)
+NITFPRIV(NITF_BOOL) JPEGScanner_skip(JPEGScanner* scanner,
+                                     nitf_Off count,
+                                     nitf_Error* error)
 {
-    nitf_ListIterator x; /* Iterator for walking list */
-    nitf_ListIterator end; /* End of list iterator */
-    JPEGMarkerItem* item; /* Current marker */
-
-    end = nitf_List_end(markerList);
-    for (x = nitf_List_begin(markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
+    (void)error;
+    if ((nitf_Off)(scanner->dataLength - scanner->pos) >= count)
+    {
+        scanner->pos += (size_t)count;
+    }
+    else
     {
-        item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        JPEGMarkerItem_print(item, file);
+        /*  Start the next window past the skipped bytes  */
+        scanner->dataStart = JPEGScanner_tell(scanner) + count;
+        scanner->dataLength = 0;
+        scanner->pos = 0;
     }
-    return;
+    return NITF_SUCCESS;
 }
 
 /*!
@@ -280,6 +347,25 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
                                     nitf_Uint64* blockSize,
                                     nitf_Error* error);
 
+/*!
+ *  Decode the listed blocks ahead of their implReadBlock() calls.  The
+ *  blocks are spread over a pool of threads, each with its own
+ *  decompressor, when the io handle supports concurrent positional
+ *  reads.  Otherwise this does nothing and blocks are decoded on demand.
+ *  The number of threads is the C3_NUM_DECODE_THREADS_KEY reader option,
+ *  or the number of CPUs.
+ *
+ *  \param control  The control object
+ *  \param blockNumbers  The blocks about to be read
+ *  \param numBlocks  The number of blocks
+ *  \param error  An error to populate on failure
+ *  \return One on success, zero on failure
+ */
+NITFPRIV(NITF_BOOL) implPrefetchBlocks(nitf_DecompressionControl* control,
+                                       const nitf_Uint32* blockNumbers,
+                                       nitf_Uint32 numBlocks,
+                                       nitf_Error* error);
+
 
 /*!
  *  This static array of strings describes the contract of our
@@ -299,6 +385,65 @@ static const char *ident[] =
 /*! Simple little typedef to make life easier for me  */
 typedef nitf_Uint8* DATA_BUFFER;
 
+/*!
+ *  \struct JPEGDecoder
+ *  \brief A libjpeg decompressor that is reused from block to block
+ *
+ *  A decoding thread checks one out for each block, so that blocks are
+ *  decoded without building a new decompress object (and its memory
+ *  pools) every time.
+ */
+typedef struct _JPEGDecoder
+{
+    struct jpeg_decompress_struct cinfo;
+    struct jpeg_error_mgr jerr;
+}
+JPEGDecoder;
+
+/*!
+ *  \struct JPEGPrefetchedBlock
+ *  \brief A block decoded ahead of its implReadBlock() call
+ */
+/*!
+ *  \struct JPEGSOITable
+ *  \brief The SOI offsets of the blocks of one image segment
+ *
+ *  Scanning for the offsets reads the whole segment, so the table is
+ *  shared by every control started on the same data (e.g. each
+ *  ImageReader of a segment), see acquireSOITable().  A table no control
+ *  uses is kept for the next one until JPEG_SOI_TABLE_CACHE_SIZE others
+ *  have been released after it.
+ *
+ *  \ar io The io handle the offsets were scanned from
+ *  \ar offset The offset of the image data
+ *  \ar fileLength The length of the image data
+ *  \ar blockSOI The offset of the SOI marker of each block (-1 if the
+ *  block is not present), in block mask order
+ *  \ar numBlocks The number of entries in blockSOI
+ *  \ar refCount The number of controls using the table
+ *  \ar lastUsed When the table was last released, for eviction
+ */
+typedef struct _JPEGSOITable
+{
+    nitf_IOInterface* io;
+    nitf_Uint64       offset;
+    nitf_Uint64       fileLength;
+    nitf_Off*         blockSOI;
+    nitf_Uint32       numBlocks;
+    nitf_Uint32       refCount;
+    nitf_Uint64       lastUsed;
+}
+JPEGSOITable;
+
+typedef struct _JPEGPrefetchedBlock
+{
+    nitf_Uint32 blockNumber;
+    nitf_Uint8* buf;
+    nitf_Uint64 size;
+    nitf_Uint64 sequence;       /* Order decoded in, oldest are dropped */
+}
+JPEGPrefetchedBlock;
+
 /*!
  *  \struct ImplControl
  *  \brief The actual implementation beneath the opaque control pointer
@@ -308,8 +453,22 @@ typedef nitf_Uint8* DATA_BUFFER;
  *  the decompression control.
  *
  *  \ar io The io handle (provided when we opened the interface)
- *  \ar markerList A list of SOI markers which we need to read blocks out
- *  of order
+ *  \ar soiTable The offset of the SOI marker of each block, which we
+ *  need to read blocks out of order
+ *  \ar ioSize The end of the image data, where block reads stop
+ *  \ar sequentialBands The number of bands in separate blocks (S mode)
+ *  \ar decoders All of the decompressors created so far
+ *  \ar numDecoders The number of decompressors
+ *  \ar idle The decompressors not in use by any thread
+ *  \ar numIdle The number of idle decompressors
+ *  \ar prefetched Blocks decoded by implPrefetchBlocks() but not yet read
+ *  \ar numPrefetched The number of prefetched blocks
+ *  \ar allocPrefetched The number of entries allocated in prefetched
+ *  \ar sequence The number of blocks decoded ahead so far
+ *  \ar maxThreads The number of threads implPrefetchBlocks() decodes
+ *  with, C3_NUM_DECODE_THREADS_KEY or the number of CPUs
+ *  \ar mutex Guards the decompressor and prefetched lists, blocks may be
+ *  read from several threads at once
  *  \ar quantTable  Quantization table (currently not used)
  *  \ar length  The length of the block in bytes
  *
@@ -320,7 +479,19 @@ typedef nitf_Uint8* DATA_BUFFER;
 typedef struct _JPEGImplControl
 {
     nitf_IOInterface* ioInterface;
-    nitf_List*        markerList;
+    JPEGSOITable*     soiTable;
+    nitf_Off          ioSize;
+    nitf_Uint32       sequentialBands;
+    JPEGDecoder**     decoders;
+    nitf_Uint32       numDecoders;
+    JPEGDecoder**     idle;
+    nitf_Uint32       numIdle;
+    JPEGPrefetchedBlock* prefetched;
+    nitf_Uint32       numPrefetched;
+    nitf_Uint32       allocPrefetched;
+    nitf_Uint64       sequence;
+    nitf_Uint32       maxThreads;
+    nitf_Mutex        mutex;
     int*              quantTable;
     nitf_Uint32       length;       /* Total length of the block in bytes */
 }
@@ -479,6 +650,14 @@ static nitf_DecompressionInterface interfaceTable =
     NULL
 };
 
+static nitf_DecompressionExtensions extensionsTable =
+{
+    sizeof(nitf_DecompressionExtensions),
+    &interfaceTable,
+    implPrefetchBlocks,
+    NULL
+};
+
 NITFPRIV(int) implFreeBlock(nitf_DecompressionControl* control,
                             nitf_Uint8* block,
                             nitf_Error* error)
@@ -505,31 +684,37 @@ typedef enum _JPEGMarker
     JPEG_MARKER_DONT_CARE,
 } JPEGMarker;
 
-NITFPRIV(NITF_BOOL) readByte(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readByte(JPEGScanner* scanner,
         unsigned char* b,
         nitf_Error* error)
 {
-    return nitf_IOInterface_read(io, (NITF_DATA *) b, 1, error);
+    if (scanner->pos == scanner->dataLength &&
+        !JPEGScanner_fill(scanner, error))
+    {
+        return NITF_FAILURE;
+    }
+    *b = scanner->data[scanner->pos++];
+    return NITF_SUCCESS;
 }
 
-NITFPRIV(NITF_BOOL) readShort(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readShort(JPEGScanner* scanner,
         nitf_Uint16* native,
         nitf_Error* error)
 {
-    nitf_Uint16 raw;
-    if (!nitf_IOInterface_read(io, (char*)&raw, 2, error))
+    unsigned char hi, lo;
+    if (!readByte(scanner, &hi, error) || !readByte(scanner, &lo, error))
     {
         return NITF_FAILURE;
     }
-    *native = ntohs(raw);
+    *native = (nitf_Uint16)((hi << 8) | lo);
     return NITF_SUCCESS;
 }
 
-NITFPRIV(int) readMarker(nitf_IOInterface* io, nitf_Error* error)
+NITFPRIV(int) readMarker(JPEGScanner* scanner, nitf_Error* error)
 {
     int markerEnum = JPEG_MARKER_ERROR;
     unsigned char native = 0x0000;
-    if (readByte(io, &native, error) )
+    if (readByte(scanner, &native, error) )
     {
         switch (native)
         {
@@ -586,14 +771,14 @@ NITFPRIV(int) readMarker(nitf_IOInterface* io, nitf_Error* error)
 }
 
 
-NITFPRIV(NITF_BOOL) readSOI(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readSOI(JPEGScanner* scanner,
         nitf_Uint64* bytesRead,
         nitf_Error* error)
 {
     unsigned char needFF;
     int tokenType;
 
-    if (! readByte(io, &needFF, error) ) return NITF_FAILURE;
+    if (! readByte(scanner, &needFF, error) ) return NITF_FAILURE;
     (*bytesRead)++;
 
     if ( needFF != 0xFF )
@@ -605,7 +790,7 @@ NITFPRIV(NITF_BOOL) readSOI(nitf_IOInterface* io,
 
         return NITF_FAILURE;
     }
-    tokenType = readMarker(io, error);
+    tokenType = readMarker(scanner, error);
     (*bytesRead)++;
 
     if (tokenType == JPEG_MARKER_ERROR)
@@ -682,7 +867,7 @@ NITFPRIV(NITF_BOOL) readSOF(nitf_IOInterface* io,
     In order to get here, we must have read:
     SOI, APP6, DQT, SOF0, DHT
 */
-NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readSOS(JPEGScanner* scanner,
                             nitf_Uint64* bytesRead,
                             nitf_Error* error)
 {
@@ -690,7 +875,7 @@ NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
     /*  Need to read bytes in header  */
     nitf_Uint16 numBytesInHdr;
     /*  If this isnt happening, throw up  */
-    if (! readShort(io, &numBytesInHdr, error) )
+    if (! readShort(scanner, &numBytesInHdr, error) )
         return NITF_FAILURE;
     /*  Print  now     */
     DPRINTA1("SOS: Header length: [%d]\n", numBytesInHdr);
@@ -699,10 +884,7 @@ NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
     /*  Normalize now  */
     numBytesInHdr -= 2;
     /*  Skip for now   */
-    if (!  NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                 numBytesInHdr,
-                                                 NITF_SEEK_CUR,
-                                                 error)))
+    if (!  JPEGScanner_skip(scanner, numBytesInHdr, error))
         return NITF_FAILURE;
     /*  Be happy now   */
     DPRINT("Successful SOS read!\n");
@@ -715,14 +897,14 @@ NITFPRIV(NITF_BOOL) readSOS(nitf_IOInterface* io,
 */
 
 
-NITFPRIV(NITF_BOOL) readHuffTable(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readHuffTable(JPEGScanner* scanner,
                                   nitf_Uint64* bytesRead,
                                   nitf_Error* error)
 {
     /*  Need to read a header length */
     nitf_Uint16 numBytesInHdr;
     /*  Read it or die  */
-    if (! readShort(io, &numBytesInHdr, error) )
+    if (! readShort(scanner, &numBytesInHdr, error) )
         return NITF_FAILURE;
     /*  Print now  */
     DPRINTA1("Huff Table: Header length: [%d]\n", numBytesInHdr);
@@ -731,10 +913,7 @@ NITFPRIV(NITF_BOOL) readHuffTable(nitf_IOInterface* io,
     /*  Adjust for what we have read already  */
     numBytesInHdr -= 2;
 
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
+    if (! JPEGScanner_skip(scanner, numBytesInHdr, error))
         return NITF_FAILURE;
 
     /*  Rejoice!  */
@@ -743,14 +922,14 @@ NITFPRIV(NITF_BOOL) readHuffTable(nitf_IOInterface* io,
     return NITF_SUCCESS;
 }
 
-NITFPRIV(NITF_BOOL) readQuantTable(nitf_IOInterface* io,
+NITFPRIV(NITF_BOOL) readQuantTable(JPEGScanner* scanner,
                                    nitf_Uint64* bytesRead,
                                    nitf_Error* error)
 {
     /*  Declare something to read into  */
     nitf_Uint16 numBytesInHdr;
     /*  Now start reading... */
-    if (! readShort(io, &numBytesInHdr, error) )
+    if (! readShort(scanner, &numBytesInHdr, error) )
         return NITF_FAILURE;
 
     /*  Print now   */
@@ -761,10 +940,7 @@ NITFPRIV(NITF_BOOL) readQuantTable(nitf_IOInterface* io,
     /*  Adjust now  */
     numBytesInHdr -= 2;
 
-    if (! NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                                numBytesInHdr,
-                                                NITF_SEEK_CUR,
-                                                error)))
+    if (! JPEGScanner_skip(scanner, numBytesInHdr, error))
         return NITF_FAILURE;
 
     /*  Celebrate  */
@@ -774,50 +950,39 @@ NITFPRIV(NITF_BOOL) readQuantTable(nitf_IOInterface* io,
 }
 
 /*
-   This method is currently used to push a marker and its
-   respective offset onto our list.
-*/
-
-NITFPRIV(NITF_BOOL) pushMarker(nitf_List* markerList,
-                               const char* name,
-                               off_t where,
-                               nitf_Error* error)
-{
-    JPEGMarkerItem* item = JPEGMarkerItem_construct(error);
-    strcpy(item->name,  name);
-    item->off = where;
-    if (!item) return NITF_FAILURE;
-    if (!nitf_List_pushBack(markerList, item, error) )
-        return NITF_FAILURE;
-    return  NITF_SUCCESS;
-}
-
-/*
-  This gets called (for now) when we open the interface.
-  We then begin to apply that information later.
-
-  This is basically a book-keeping function (and not a
-  terribly efficient one at that...)
+  This gets called when we start the interface, it records the offset of
+  the SOI marker of each block (in the order of the block mask) so that
+  blocks can be read in any order.
 
+  The scan goes through the JPEG data a window at a time (see JPEGScanner)
 */
 NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
-                                nitf_List* markerList,
+                                nitf_Uint64 offset,
                                 nitf_Uint64 fileLength,
+                                nitf_Uint64* blockMask,
+                                nitf_Off* blockSOI,
+                                nitf_Uint32 numBlocks,
                                 nitf_Error* error)
 {
 
     nitf_Uint64 bytesRead = 0;
+    nitf_Uint32 nextBlock = 0;
+    nitf_Uint32 i;
+    JPEGScanner scanner;
+
+    for (i = 0; i < numBlocks; ++i)
+        blockSOI[i] = -1;
+
+    if (!JPEGScanner_init(&scanner, io, (nitf_Off)offset,
+                          (nitf_Off)fileLength, error))
+        return NITF_FAILURE;
 
-    /*  Book keeping block  */
-    nitf_Uint64 origin = nitf_IOInterface_tell(io, error);
-    assert(NITF_IO_SUCCESS(origin));
-    /*  End book keeping block  */
     DPRINTA1("File length: %ld\n",  fileLength);
     while (bytesRead < fileLength)
     {
 
         unsigned char b;
-        if (! readByte(io, &b, error) )
+        if (! readByte(&scanner, &b, error) )
         {
 
             DPRINTA1("Read byte failed on byte %ld!\n", bytesRead);
@@ -829,7 +994,7 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
         if (b == 0xFF )
         {
             int tokenType;
-            tokenType = readMarker(io, error);
+            tokenType = readMarker(&scanner, error);
             ++bytesRead;
 
             if (tokenType == JPEG_MARKER_ERROR)
@@ -844,20 +1009,13 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
             }
             else
             {
-                off_t where = nitf_IOInterface_tell(io, error);
+                nitf_Off where = JPEGScanner_tell(&scanner);
 
-                nitf_Uint64 totalBytes = (fileLength - bytesRead) +
-                    (where - origin);
-                assert( fileLength == totalBytes);
+                assert(fileLength == (fileLength - bytesRead) +
+                       (nitf_Uint64)(where - (nitf_Off)offset));
                 switch (tokenType)
                 {
                 case JPEG_MARKER_EOI:
-                    if (! pushMarker(markerList, "EOI", where, error) )
-                    {
-                        DPRINT("Failure EOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
                     DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
                     DPRINT("Successful EOI!\n");
                     DPRINT("~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~\n");
@@ -869,13 +1027,14 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
 
                     /*  If it is the start of image, I want to read an APP6  */
                 case JPEG_MARKER_SOI:
-                    if (! pushMarker(markerList, "SOI", where, error) )
-                    {
-                        DPRINT("Failure SOI (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOI(io, &bytesRead, error))
+                    /*  The next block present in the mask starts here  */
+                    while (nextBlock < numBlocks &&
+                           blockMask[nextBlock] == NITF_IMAGE_IO_NO_BLOCK)
+                        ++nextBlock;
+                    if (nextBlock < numBlocks)
+                        blockSOI[nextBlock++] = where - 2;
+
+                    if (!readSOI(&scanner, &bytesRead, error))
                     {
                         DPRINT("Failure SOF (readSOI)\n");
                         goto CATCH_ERROR;
@@ -884,13 +1043,7 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
                     break;
 
                 case JPEG_MARKER_SOS:
-                    if (! pushMarker(markerList, "SOS", where, error) )
-                    {
-                        DPRINT("Failure SOS (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readSOS(io, &bytesRead, error))
+                    if (!readSOS(&scanner, &bytesRead, error))
                     {
                         DPRINT("Failure SOS (readSOS)\n");
                         goto CATCH_ERROR;
@@ -899,13 +1052,7 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
 
 
                 case JPEG_MARKER_DECL_QUANT_TABLE:
-                    if (! pushMarker(markerList, "DQT", where, error) )
-                    {
-                        DPRINT("Failure DQT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readQuantTable(io, &bytesRead, error))
+                    if (!readQuantTable(&scanner, &bytesRead, error))
                     {
                         DPRINT("Failure DQT (readQuantTable)\n");
                         goto CATCH_ERROR;
@@ -913,13 +1060,7 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
                     break;
 
                 case JPEG_MARKER_DECL_HUFF_TABLE:
-                    if (! pushMarker(markerList, "DHT", where, error) )
-                    {
-                        DPRINT("Failure DHT (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
-                    if (!readHuffTable(io, &bytesRead, error))
+                    if (!readHuffTable(&scanner, &bytesRead, error))
                     {
                         DPRINT("Failure DHT (readHuffTable)\n");
                         goto CATCH_ERROR;
@@ -928,12 +1069,6 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
                     break;
 
                 case JPEG_MARKER_SOF:
-                    if (! pushMarker(markerList, "SOF", where, error) )
-                    {
-                        DPRINT("Failure SOF (pushMarker)\n");
-                        goto CATCH_ERROR;
-                    }
-
                     /* if (!readSOF(io, error)) */
                     /*       goto CATCH_ERROR; */
                     break;
@@ -950,21 +1085,227 @@ NITFPRIV(NITF_BOOL) scanOffsets(nitf_IOInterface* io,
     {
         DPRINT("Warning: couldnt equalize the number of bytes desired and those read\n");
     }
+    JPEGScanner_cleanup(&scanner);
     return NITF_SUCCESS;
 
 CATCH_ERROR:
+    JPEGScanner_cleanup(&scanner);
     nitf_Error_print(error, stdout, "While scanning offsets!");
     return NITF_FAILURE;
 }
 
+#ifndef WIN32
+static nitf_Mutex __SOITablesLock = NITF_MUTEX_INIT;
+#else
+static nitf_Mutex __SOITablesLock = NULL;
+static long __SOITablesInitLock = 0;
+#endif
+static JPEGSOITable* __SOITables[JPEG_SOI_TABLE_CACHE_SIZE];
+static nitf_Uint32 __numSOITables = 0;
+static nitf_Uint64 __SOITablesClock = 0;
+
+/*
+ *  The lock for the shared SOI tables, set up the same way as the plugin
+ *  registry's
+ */
+#ifdef WIN32
+NITFPRIV(nitf_Mutex*) getSOITablesLock(void)
+{
+    if (__SOITablesLock == NULL)
+    {
+        while (InterlockedExchange(&__SOITablesInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (__SOITablesLock == NULL)
+            nitf_Mutex_init(&__SOITablesLock);
+        InterlockedExchange(&__SOITablesInitLock, 0);
+    }
+    return &__SOITablesLock;
+}
+#else
+#define getSOITablesLock() &__SOITablesLock
+#endif
+
+NITFPRIV(void) SOITable_destruct(JPEGSOITable** soiTable)
+{
+    if (*soiTable)
+    {
+        if ((*soiTable)->blockSOI)
+            NITF_FREE((*soiTable)->blockSOI);
+        NITF_FREE(*soiTable);
+        *soiTable = NULL;
+    }
+}
+
+/*
+ *  A table nobody uses may be left over from an io handle that was
+ *  destroyed, with a new one at the same address.  It is only taken if
+ *  every block it lists starts with an SOI marker in the new io, which
+ *  costs a two byte read per block instead of a read of all of the data.
+ */
+NITFPRIV(NITF_BOOL) SOITable_isValid(JPEGSOITable* soiTable,
+                                     nitf_IOInterface* io)
+{
+    nitf_Uint32 i;
+    nitf_Uint8 marker[2];
+    nitf_Error error;
+
+    for (i = 0; i < soiTable->numBlocks; ++i)
+    {
+        if (soiTable->blockSOI[i] < 0)
+            continue;
+        if (!nitf_IOInterface_readAt(io, soiTable->blockSOI[i],
+                                     marker, 2, &error) ||
+            marker[0] != 0xFF || marker[1] != 0xD8)
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*!
+ *  Get the SOI table of an image segment, scanning the data for it unless
+ *  a control started on the same data already has.  The table is given
+ *  back with releaseSOITable().
+ */
+NITFPRIV(JPEGSOITable*) acquireSOITable(nitf_IOInterface* io,
+                                        nitf_Uint64 offset,
+                                        nitf_Uint64 fileLength,
+                                        nitf_Uint32 numBlocks,
+                                        nitf_Uint64* blockMask,
+                                        nitf_Error* error)
+{
+    JPEGSOITable* soiTable = NULL;
+    nitf_Mutex* lock = getSOITablesLock();
+    nitf_Uint32 i;
+
+    nitf_Mutex_lock(lock);
+    for (i = 0; i < __numSOITables; ++i)
+    {
+        soiTable = __SOITables[i];
+        if (soiTable->io == io && soiTable->offset == offset &&
+            soiTable->fileLength == fileLength &&
+            soiTable->numBlocks == numBlocks &&
+            (soiTable->refCount > 0 || SOITable_isValid(soiTable, io)))
+        {
+            soiTable->refCount++;
+            nitf_Mutex_unlock(lock);
+            return soiTable;
+        }
+    }
+    nitf_Mutex_unlock(lock);
+
+    /*  The scan runs unlocked, two controls may both do it the first time  */
+    soiTable = (JPEGSOITable*)NITF_MALLOC(sizeof(JPEGSOITable));
+    if (!soiTable)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    soiTable->io = io;
+    soiTable->offset = offset;
+    soiTable->fileLength = fileLength;
+    soiTable->numBlocks = numBlocks;
+    soiTable->refCount = 1;
+    soiTable->lastUsed = 0;
+    soiTable->blockSOI =
+        (nitf_Off*)NITF_MALLOC(sizeof(nitf_Off) * (numBlocks + 1));
+    if (!soiTable->blockSOI)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        SOITable_destruct(&soiTable);
+        return NULL;
+    }
+    if (!scanOffsets(io, offset, fileLength, blockMask,
+                     soiTable->blockSOI, numBlocks, error))
+    {
+        SOITable_destruct(&soiTable);
+        return NULL;
+    }
+
+    nitf_Mutex_lock(lock);
+    if (__numSOITables < JPEG_SOI_TABLE_CACHE_SIZE)
+    {
+        __SOITables[__numSOITables++] = soiTable;
+    }
+    else
+    {
+        /*  Replace the table released longest ago, if any is unused  */
+        nitf_Uint32 oldest = JPEG_SOI_TABLE_CACHE_SIZE;
+        for (i = 0; i < __numSOITables; ++i)
+            if (__SOITables[i]->refCount == 0 &&
+                (oldest == JPEG_SOI_TABLE_CACHE_SIZE ||
+                 __SOITables[i]->lastUsed < __SOITables[oldest]->lastUsed))
+                oldest = i;
+        if (oldest < JPEG_SOI_TABLE_CACHE_SIZE)
+        {
+            SOITable_destruct(&__SOITables[oldest]);
+            __SOITables[oldest] = soiTable;
+        }
+        /*  Otherwise the table is private to this control  */
+    }
+    nitf_Mutex_unlock(lock);
+    return soiTable;
+}
+
+/*!
+ *  Give back a table from acquireSOITable().  Shared tables stay cached,
+ *  a table that did not fit in the cache is freed.
+ */
+NITFPRIV(void) releaseSOITable(JPEGSOITable* soiTable)
+{
+    nitf_Mutex* lock = getSOITablesLock();
+    nitf_Uint32 i;
+
+    if (!soiTable)
+        return;
+
+    nitf_Mutex_lock(lock);
+    soiTable->refCount--;
+    soiTable->lastUsed = ++__SOITablesClock;
+    for (i = 0; i < __numSOITables; ++i)
+        if (__SOITables[i] == soiTable)
+            break;
+    if (i == __numSOITables && soiTable->refCount == 0)
+        SOITable_destruct(&soiTable);
+    nitf_Mutex_unlock(lock);
+}
+
+/*!
+ *  Free the cached tables no control is using
+ */
+NITFPRIV(void) freeIdleSOITables(void)
+{
+    nitf_Mutex* lock = getSOITablesLock();
+    nitf_Uint32 i;
+
+    nitf_Mutex_lock(lock);
+    for (i = 0; i < __numSOITables; )
+    {
+        if (__SOITables[i]->refCount == 0)
+        {
+            SOITable_destruct(&__SOITables[i]);
+            __SOITables[i] = __SOITables[--__numSOITables];
+        }
+        else
+            ++i;
+    }
+    nitf_Mutex_unlock(lock);
+}
+
 NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
                                               nrt_HashTable* options,
                                               nitf_Error* error)
 {
     JPEGImplControl* implControl; /* This is our local storage  */
+    nrt_Pair* pair;
+    char imode[NITF_IMODE_SZ+1];
+    nitf_Uint32 nBands;
 
-    (void)options;
-    (void)error;
+    if (!nitf_Field_get(subheader->NITF_IMODE, imode, NITF_CONV_STRING,
+                        NITF_IMODE_SZ+1, error) ||
+        0 == (nBands = nitf_ImageSubheader_getBandCount(subheader, error)))
+        return NULL;
 
     implControl = (JPEGImplControl*)NITF_MALLOC(sizeof(JPEGImplControl));
 
@@ -977,9 +1318,26 @@ NITFPRIV(nitf_DecompressionControl*) implOpen(nitf_ImageSubheader* subheader,
         return NULL;
     }
     implControl->ioInterface = NULL;
-    implControl->markerList = NULL;
+    implControl->soiTable = NULL;
+    implControl->ioSize = 0;
+    /*  Each band of an S mode image has its own blocks  */
+    implControl->sequentialBands = (imode[0] == 'S') ? nBands : 1;
+    implControl->decoders = NULL;
+    implControl->numDecoders = 0;
+    implControl->idle = NULL;
+    implControl->numIdle = 0;
+    implControl->prefetched = NULL;
+    implControl->numPrefetched = 0;
+    implControl->allocPrefetched = 0;
+    implControl->sequence = 0;
+    if (options &&
+        (pair = nrt_HashTable_find(options, C3_NUM_DECODE_THREADS_KEY)))
+        implControl->maxThreads = *((nitf_Uint32*)pair->data);
+    else
+        implControl->maxThreads = nitf_Thread_getNumCPUs();
     implControl->quantTable = NULL;
     implControl->length = 0;
+    nitf_Mutex_init(&implControl->mutex);
     return (nitf_DecompressionControl*)implControl;
 }
 
@@ -1010,58 +1368,17 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
     DPRINTA1("[%d] blockInfo->numColsPerBlock\n", blockInfo->numColsPerBlock);
     DPRINTA1("[%d] blockInfo->length\n", blockInfo->length);
 
-    /*  For right now, we are storing this silly markerList.  I think
-     this will prove to be a useless mechanism  */
-    implControl->markerList = nitf_List_construct(error);
-    if (!implControl->markerList)
-    {
-        /*  If this fails, the error is already set  */
-        return NITF_FAILURE;
-    }
-
-    /*  Seek to our start point, just in case... */
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               offset,
-                                               NITF_SEEK_SET,
-                                               error)))
-    {
-        nitf_Error_initf(error,
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION,
-                "Error seeking to offset for JPEG block [%ld]",
-                offset);
-        return NITF_FAILURE;
-    }
-
-    /*  Find all marker offsets!!!!  */
-    if (!scanOffsets(io, implControl->markerList, fileLength, error))
-    {
-        return NITF_FAILURE;
-    }
-
+    /*  Find all SOI offsets!!!! (or reuse them, see JPEGSOITable)  */
     {
-        nitf_Uint32 nextBlock = 0;
-        nitf_ListIterator x = nitf_List_begin((implControl->markerList));
-        nitf_ListIterator e = nitf_List_end((implControl->markerList));
-        while (nitf_ListIterator_notEqualTo(&x, &e))
-
-        {
-            JPEGMarkerItem *item = nitf_ListIterator_get(&x);
-            DPRINTA2("[%s:%d]", item->name, item->off );
-
-            if (strcmp(item->name, "SOI") == 0)
-            {
-                while(blockMask[nextBlock++] == NITF_IMAGE_IO_NO_BLOCK);
-                item->block = nextBlock - 1;
-            }
-            else
-            {
-                item->block = NITF_IMAGE_IO_NO_BLOCK;
-            }
-
-            nitf_ListIterator_increment(&x);
-        }
-        DPRINT("\n");
+        JPEGSOITable* soiTable = acquireSOITable(
+            io, offset, fileLength,
+            blockInfo->numBlocksPerRow * blockInfo->numBlocksPerCol *
+            implControl->sequentialBands,
+            blockMask, error);
+        if (!soiTable)
+            return NITF_FAILURE;
+        releaseSOITable(implControl->soiTable);
+        implControl->soiTable = soiTable;
     }
 
     /*  Seek to our start point, just in case... */
@@ -1077,6 +1394,12 @@ NITFPRIV(NITF_BOOL) implStart(nitf_DecompressionControl* control,
         return NITF_FAILURE;
     }
 
+    implControl->ioSize = nitf_IOInterface_getSize(io, error);
+    if (!NITF_IO_SUCCESS(implControl->ioSize))
+        return NITF_FAILURE;
+    if ((nitf_Off)(offset + fileLength) < implControl->ioSize)
+        implControl->ioSize = (nitf_Off)(offset + fileLength);
+
     implControl->ioInterface = io;
     implControl->length = blockInfo->length;
     return NITF_SUCCESS;
@@ -1088,7 +1411,7 @@ typedef struct _JPEGIOManager
     nitf_Uint8 buffer[INPUT_BUF_SIZE];  /* start of buffer */
     boolean start_of_file;              /* have we gotten any data yet? */
     nitf_IOInterface* ioInterface;      /* source IO */
-    nitf_Off ioStart;                   /* the io interface start offset (tell) */
+    nitf_Off ioStart;                   /* the io interface start offset (SOI) */
     nitf_Off ioEnd;                     /* the io interface end offset (size) */
     nitf_Uint32 blockLength;            /* the length of the block */
     nitf_Uint32 bytesRead;              /* the number of bytes read so far */
@@ -1163,8 +1486,8 @@ NITFPRIV(boolean) JPEGFillInputBuffer (j_decompress_ptr cinfo)
     }
     else
     {
-        if (!nitf_IOInterface_read(src->ioInterface, src->buffer,
-                                   toRead, src->error))
+        if (!nitf_IOInterface_readAt(src->ioInterface, ioOff, src->buffer,
+                                     toRead, src->error))
         {
             return FALSE;
         }
@@ -1198,6 +1521,7 @@ NITFPRIV(void) JPEGSkipInputData(j_decompress_ptr cinfo, long num_bytes)
 
 NITFPRIV(NITF_BOOL) JPEGCreateIOSource(j_decompress_ptr cinfo,
                                        JPEGImplControl* implControl,
+                                       nitf_Off ioStart,
                                        nitf_Error* error)
 {
     JPEGIOManager* src = NULL;
@@ -1239,8 +1563,8 @@ NITFPRIV(NITF_BOOL) JPEGCreateIOSource(j_decompress_ptr cinfo,
     src->ioInterface = implControl->ioInterface;
     src->blockLength = implControl->length;
     src->bytesRead = 0;
-    src->ioStart = nitf_IOInterface_tell(src->ioInterface, error);
-    src->ioEnd = nitf_IOInterface_getSize(src->ioInterface, error);
+    src->ioStart = ioStart;
+    src->ioEnd = implControl->ioSize;
     src->error = error;
 
     return NITF_SUCCESS;
@@ -1257,29 +1581,8 @@ NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                                  off_t* soi,
                                  nitf_Error* error)
 {
-    nitf_ListIterator x = nitf_List_begin(control->markerList);
-    nitf_ListIterator end = nitf_List_end(control->markerList);
-    int j = -1;
-
-    for (x = nitf_List_begin(control->markerList);
-            nitf_ListIterator_notEqualTo(&x, &end);
-            nitf_ListIterator_increment(&x))
-    {
-        JPEGMarkerItem* item = (JPEGMarkerItem*)nitf_ListIterator_get(&x);
-        if (strcmp(item->name, "SOI") == 0 &&
-            ((j = item->block) == blockNumber))
-        {
-            *soi = item->off - 2;
-            break;
-        }
-        /*++j;
-        if (j == blockNumber)
-        {
-            *soi = item->off - 2;
-            break;
-        } */
-    }
-    if (j != blockNumber)
+    if (blockNumber >= control->soiTable->numBlocks ||
+        control->soiTable->blockSOI[blockNumber] < 0)
     {
         nitf_Error_initf(error,
                          NITF_CTXT,
@@ -1287,26 +1590,25 @@ NITFPRIV(NITF_BOOL) findBlockSOI(JPEGImplControl* control,
                          "Invalid block (no offset found) [%d]", blockNumber);
         return NITF_FAILURE;
     }
+    *soi = (off_t)control->soiTable->blockSOI[blockNumber];
     return NITF_SUCCESS;
 }
 
-NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
-                                    nitf_Uint32 blockNumber,
-                                    nitf_Uint64* blockSize,
-                                    nitf_Error* error)
+/*!
+ *  Decode one block with the given decompressor.  This is implReadBlock()
+ *  without the prefetched blocks, it may be called from several threads
+ *  at once as long as each uses its own decoder.
+ */
+NITFPRIV(nitf_Uint8*) decodeBlock(JPEGImplControl* implControl,
+                                  JPEGDecoder* decoder,
+                                  nitf_Uint32 blockNumber,
+                                  nitf_Uint64* blockSize,
+                                  nitf_Error* error)
 {
-    /*
-     *  For now, do as I say (to test that you dont break anything in
-     *  the trivial case
-     */
-    NITF_BOOL separateBands = 0;
+    NITF_BOOL separateBands;
 
-    /*  Get out the read object from the opaque handle  */
-    JPEGImplControl* implControl = (JPEGImplControl*)control;
     off_t soi = 0;
-
-    struct jpeg_error_mgr jerr;
-    struct jpeg_decompress_struct cinfo;
+    j_decompress_ptr cinfo = &decoder->cinfo;
 
     JSAMPARRAY buffer;
     int row_stride;
@@ -1314,7 +1616,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     JPEGBlock* block;
     NITF_DATA *uncompressed;
 
-    if (!findBlockSOI(control, blockNumber, &soi, error))
+    if (!findBlockSOI(implControl, blockNumber, &soi, error))
 #ifdef ZERO_BLOCK
     {
         nitf_Uint8 *zeros; /* Buffer of zeros */
@@ -1343,34 +1645,22 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
 #endif
 
     DPRINTA2("Found SOI [%d] for block # %d\n", (int)soi, (int)blockNumber);
-    /*  We need to locate our block offset!! */
-    if (nitf_IOInterface_seek(implControl->ioInterface, soi,
-                    NITF_SEEK_SET, error) == (nitf_Off)-1)
-    {
-        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
-                NITF_CTXT,
-                NITF_ERR_DECOMPRESSION);
-    }
-
-    /*  Set up the error handler  */
-    cinfo.err = jpeg_std_error(&jerr);
-    DPRINT("Creating decompression struct!\n");
-    /*  Tell our info struct to be decompression  */
-    jpeg_create_decompress(&cinfo);
 
     /*  Bind up our source location */
-    /*jpeg_stdio_src(&cinfo, jstream);*/
-    JPEGCreateIOSource(&cinfo, implControl, error);
+    /*jpeg_stdio_src(cinfo, jstream);*/
+    /*  Reads are positional from the block's SOI  */
+    JPEGCreateIOSource(cinfo, implControl, (nitf_Off)soi, error);
 
     /*  Read the header  */
     DPRINT("Reading header... ");
-    ret = jpeg_read_header(&cinfo, 0);
-    DPRINTA2("success! [%dx%d]\n", cinfo.image_width, cinfo.image_height);
+    ret = jpeg_read_header(cinfo, 0);
+    DPRINTA2("success! [%dx%d]\n", cinfo->image_width, cinfo->image_height);
     if (ret != JPEG_HEADER_OK)
 #ifdef ZERO_BLOCK
     {
         nitf_Uint8 *zeros; /* Buffer of zeros */
 
+        jpeg_abort_decompress(cinfo);
         zeros = NITF_MALLOC(implControl->length);
         if (zeros == NULL)
         {
@@ -1389,6 +1679,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     }
 #else
     {
+        jpeg_abort_decompress(cinfo);
         nitf_Error_initf(error,
                 NITF_CTXT,
                 NITF_ERR_READING_FROM_FILE,
@@ -1398,12 +1689,12 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     }
 #endif
 
-    jpeg_start_decompress(&cinfo);
+    jpeg_start_decompress(cinfo);
     DPRINT("Started decompress... \n");
     block =
-    JPEGBlock_construct(cinfo.output_height,
-            cinfo.output_width,
-            cinfo.output_components,
+    JPEGBlock_construct(cinfo->output_height,
+            cinfo->output_width,
+            cinfo->output_components,
             error);
 
     if (!block)
@@ -1411,6 +1702,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     {
         nitf_Uint8 *zeros; /* Buffer of zeros */
 
+        jpeg_abort_decompress(cinfo);
         zeros = NITF_MALLOC(implControl->length);
         if (zeros == NULL)
         {
@@ -1429,6 +1721,7 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     }
 #else
     {
+        jpeg_abort_decompress(cinfo);
         nitf_Error_initf(error,
                 NITF_CTXT,
                 NITF_ERR_DECOMPRESSION,
@@ -1438,22 +1731,28 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
     }
 #endif
 
-    row_stride = cinfo.output_width *
-    cinfo.output_components;
-    buffer = (cinfo.mem->alloc_sarray)
-    ((j_common_ptr) & cinfo,
+    /*
+     *  ImageIO reads compressed P mode as B mode, so the components of a
+     *  multi-band block come back band sequential
+     */
+    separateBands = cinfo->output_components > 1;
+
+    row_stride = cinfo->output_width *
+    cinfo->output_components;
+    buffer = (cinfo->mem->alloc_sarray)
+    ((j_common_ptr) cinfo,
             JPOOL_IMAGE, row_stride, 1);
 
-    while (cinfo.output_scanline <
-            cinfo.output_height)
+    while (cinfo->output_scanline <
+            cinfo->output_height)
     {
-        jpeg_read_scanlines(&cinfo, buffer, 1);
+        jpeg_read_scanlines(cinfo, buffer, 1);
         /* Clobbering each time  */
         JPEGBlock_append(block, buffer[0], row_stride);
     }
 
-    jpeg_finish_decompress(&cinfo);
-    jpeg_destroy_decompress(&cinfo);
+    /*  Leaves the decompressor ready for the next block  */
+    jpeg_finish_decompress(cinfo);
     DPRINT("JPEG decompression complete\n");
     DPRINT("=============================================================\n");
 
@@ -1473,16 +1772,369 @@ NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
 }
 
 
+/*!
+ *  Check out an idle decompressor, creating one if they are all in use
+ */
+NITFPRIV(JPEGDecoder*) acquireDecoder(JPEGImplControl* implControl,
+                                      nitf_Error* error)
+{
+    JPEGDecoder* decoder = NULL;
+    JPEGDecoder** decoders;
+    JPEGDecoder** idle;
+
+    nitf_Mutex_lock(&implControl->mutex);
+    if (implControl->numIdle > 0)
+    {
+        decoder = implControl->idle[--implControl->numIdle];
+        nitf_Mutex_unlock(&implControl->mutex);
+        return decoder;
+    }
+
+    /*  Both lists have room for every decompressor  */
+    decoders = (JPEGDecoder**)NITF_REALLOC(
+        implControl->decoders,
+        sizeof(JPEGDecoder*) * (implControl->numDecoders + 1));
+    if (decoders)
+    {
+        implControl->decoders = decoders;
+        idle = (JPEGDecoder**)NITF_REALLOC(
+            implControl->idle,
+            sizeof(JPEGDecoder*) * (implControl->numDecoders + 1));
+        if (idle)
+        {
+            implControl->idle = idle;
+            decoder = (JPEGDecoder*)NITF_MALLOC(sizeof(JPEGDecoder));
+        }
+    }
+    if (!decoder)
+    {
+        nitf_Mutex_unlock(&implControl->mutex);
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    /*  Set up the error handler  */
+    decoder->cinfo.err = jpeg_std_error(&decoder->jerr);
+    DPRINT("Creating decompression struct!\n");
+    /*  Tell our info struct to be decompression  */
+    jpeg_create_decompress(&decoder->cinfo);
+    implControl->decoders[implControl->numDecoders++] = decoder;
+    nitf_Mutex_unlock(&implControl->mutex);
+    return decoder;
+}
+
+/*!
+ *  Return a decompressor checked out by acquireDecoder()
+ */
+NITFPRIV(void) releaseDecoder(JPEGImplControl* implControl,
+                              JPEGDecoder* decoder)
+{
+    nitf_Mutex_lock(&implControl->mutex);
+    implControl->idle[implControl->numIdle++] = decoder;
+    nitf_Mutex_unlock(&implControl->mutex);
+}
+
+/*!
+ *  Take the block out of the prefetched list, if it was decoded ahead
+ */
+NITFPRIV(nitf_Uint8*) takePrefetched(JPEGImplControl* implControl,
+                                     nitf_Uint32 blockNumber,
+                                     nitf_Uint64* blockSize)
+{
+    nitf_Uint8* buf = NULL;
+    nitf_Uint32 i;
+
+    nitf_Mutex_lock(&implControl->mutex);
+    for (i = 0; i < implControl->numPrefetched; ++i)
+    {
+        if (implControl->prefetched[i].blockNumber == blockNumber)
+        {
+            buf = implControl->prefetched[i].buf;
+            *blockSize = implControl->prefetched[i].size;
+            implControl->prefetched[i] =
+                implControl->prefetched[--implControl->numPrefetched];
+            break;
+        }
+    }
+    nitf_Mutex_unlock(&implControl->mutex);
+    return buf;
+}
+
+/*!
+ *  Add a block to the prefetched list, returns false if there is no room
+ */
+NITFPRIV(NITF_BOOL) addPrefetched(JPEGImplControl* implControl,
+                                  nitf_Uint32 blockNumber,
+                                  nitf_Uint8* buf,
+                                  nitf_Uint64 size)
+{
+    JPEGPrefetchedBlock* block;
+
+    nitf_Mutex_lock(&implControl->mutex);
+    if (implControl->numPrefetched == implControl->allocPrefetched)
+    {
+        nitf_Uint32 allocPrefetched = implControl->allocPrefetched == 0 ?
+            16 : 2 * implControl->allocPrefetched;
+        JPEGPrefetchedBlock* prefetched = (JPEGPrefetchedBlock*)NITF_REALLOC(
+            implControl->prefetched,
+            sizeof(JPEGPrefetchedBlock) * allocPrefetched);
+        if (!prefetched)
+        {
+            nitf_Mutex_unlock(&implControl->mutex);
+            return NITF_FAILURE;
+        }
+        implControl->prefetched = prefetched;
+        implControl->allocPrefetched = allocPrefetched;
+    }
+    block = &implControl->prefetched[implControl->numPrefetched++];
+    block->blockNumber = blockNumber;
+    block->buf = buf;
+    block->size = size;
+    block->sequence = implControl->sequence++;
+    nitf_Mutex_unlock(&implControl->mutex);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Uint8*) implReadBlock(nitf_DecompressionControl* control,
+                                    nitf_Uint32 blockNumber,
+                                    nitf_Uint64* blockSize,
+                                    nitf_Error* error)
+{
+    /*  Get out the read object from the opaque handle  */
+    JPEGImplControl* implControl = (JPEGImplControl*)control;
+    JPEGDecoder* decoder;
+    nitf_Uint8* buf;
+
+    /*  Hand over the block if it was decoded ahead  */
+    if ((buf = takePrefetched(implControl, blockNumber, blockSize)))
+        return buf;
+
+    if (!(decoder = acquireDecoder(implControl, error)))
+        return NULL;
+    buf = decodeBlock(implControl, decoder, blockNumber, blockSize, error);
+    releaseDecoder(implControl, decoder);
+    return buf;
+}
+
+/*!
+ *  \struct JPEGDecodeJob
+ *  \brief The blocks of one implPrefetchBlocks() call, shared by the
+ *  decoding threads
+ */
+typedef struct _JPEGDecodeJob
+{
+    JPEGImplControl*   implControl;
+    const nitf_Uint32* blockNumbers;
+    nitf_Uint32        numBlocks;
+    nitf_Uint32        next;     /* Next entry of blockNumbers to decode */
+    nitf_Mutex         mutex;    /* Guards next */
+}
+JPEGDecodeJob;
+
+/*!
+ *  \struct JPEGDecodeWorker
+ *  \brief What each decoding thread works with
+ */
+typedef struct _JPEGDecodeWorker
+{
+    JPEGDecodeJob* job;
+    JPEGDecoder*   decoder;
+}
+JPEGDecodeWorker;
+
+NITFPRIV(void) decodeBlocks(NITF_DATA* data)
+{
+    JPEGDecodeWorker* worker = (JPEGDecodeWorker*)data;
+    JPEGDecodeJob* job = worker->job;
+    JPEGImplControl* implControl = job->implControl;
+    nitf_Uint32 blockNumber;
+    nitf_Uint8* buf;
+    nitf_Uint64 size;
+    nitf_Error error;
+
+    for (;;)
+    {
+        nitf_Mutex_lock(&job->mutex);
+        if (job->next == job->numBlocks)
+        {
+            nitf_Mutex_unlock(&job->mutex);
+            break;
+        }
+        blockNumber = job->blockNumbers[job->next++];
+        nitf_Mutex_unlock(&job->mutex);
+
+        /*  A block that fails here is left to implReadBlock to report  */
+        buf = decodeBlock(implControl, worker->decoder, blockNumber, &size,
+                          &error);
+        if (buf && !addPrefetched(implControl, blockNumber, buf, size))
+            NITF_FREE(buf);
+    }
+}
+
+NITFPRIV(NITF_BOOL) implPrefetchBlocks(nitf_DecompressionControl* control,
+                                       const nitf_Uint32* blockNumbers,
+                                       nitf_Uint32 numBlocks,
+                                       nitf_Error* error)
+{
+    JPEGImplControl* implControl = (JPEGImplControl*)control;
+    nitf_Uint32* toDecode = NULL;
+    nitf_Uint32 numToDecode = 0;
+    nitf_Uint32 numThreads, oldest, i, j;
+    JPEGDecodeJob job;
+    JPEGDecodeWorker* workers = NULL;
+    nitf_Thread** threads = NULL;
+    NITF_BOOL ret = NITF_SUCCESS;
+
+    /*  Block reads may only overlap if they leave the io position alone  */
+    if (!nitf_IOInterface_canReadAt(implControl->ioInterface) ||
+        implControl->maxThreads < 2)
+        return NITF_SUCCESS;
+
+    toDecode = (nitf_Uint32*)NITF_MALLOC(sizeof(nitf_Uint32) * numBlocks);
+    if (!toDecode)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+
+    nitf_Mutex_lock(&implControl->mutex);
+
+    for (j = 0; j < numBlocks; ++j)
+    {
+        for (i = 0; i < implControl->numPrefetched; ++i)
+            if (blockNumbers[j] == implControl->prefetched[i].blockNumber)
+                break;
+        if (i == implControl->numPrefetched)
+            toDecode[numToDecode++] = blockNumbers[j];
+    }
+
+    /*
+     *  Blocks of other requests, which may still be reading them, are kept
+     *  while they fit in twice this request.  Past that the oldest go, so
+     *  blocks that are never read do not pile up.
+     */
+    while (implControl->numPrefetched > 0 &&
+           implControl->numPrefetched + numToDecode > 2 * numBlocks)
+    {
+        oldest = 0;
+        for (i = 1; i < implControl->numPrefetched; ++i)
+            if (implControl->prefetched[i].sequence <
+                implControl->prefetched[oldest].sequence)
+                oldest = i;
+        NITF_FREE(implControl->prefetched[oldest].buf);
+        implControl->prefetched[oldest] =
+            implControl->prefetched[--implControl->numPrefetched];
+    }
+    nitf_Mutex_unlock(&implControl->mutex);
+
+    numThreads = implControl->maxThreads;
+    if (numThreads > numToDecode)
+        numThreads = numToDecode;
+
+    /*  Nothing to gain, implReadBlock decodes on demand  */
+    if (numThreads < 2)
+        goto CLEANUP;
+
+    workers = (JPEGDecodeWorker*)NITF_MALLOC(
+        sizeof(JPEGDecodeWorker) * numThreads);
+    threads = (nitf_Thread**)NITF_MALLOC(sizeof(nitf_Thread*) * numThreads);
+    if (!workers || !threads)
+    {
+        nitf_Error_init(error, NITF_STRERROR( NITF_ERRNO ),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        ret = NITF_FAILURE;
+        goto CLEANUP;
+    }
+
+    for (i = 0; i < numThreads; ++i)
+    {
+        if (!(workers[i].decoder = acquireDecoder(implControl, error)))
+        {
+            while (i > 0)
+                releaseDecoder(implControl, workers[--i].decoder);
+            ret = NITF_FAILURE;
+            goto CLEANUP;
+        }
+    }
+
+    job.implControl = implControl;
+    job.blockNumbers = toDecode;
+    job.numBlocks = numToDecode;
+    job.next = 0;
+    nitf_Mutex_init(&job.mutex);
+
+    /*  The calling thread decodes too, with the first decompressor  */
+    for (i = 0; i < numThreads; ++i)
+    {
+        workers[i].job = &job;
+        threads[i] = NULL;
+    }
+    for (i = 1; i < numThreads; ++i)
+    {
+        /*  With fewer threads, the remaining ones pick up the slack  */
+        if (!(threads[i] = nitf_Thread_construct(decodeBlocks,
+                                                 &workers[i], error)))
+            break;
+    }
+    decodeBlocks(&workers[0]);
+    for (i = 1; i < numThreads; ++i)
+    {
+        if (threads[i])
+        {
+            nitf_Thread_join(threads[i], error);
+            nitf_Thread_destruct(&threads[i]);
+        }
+    }
+    nitf_Mutex_delete(&job.mutex);
+
+    for (i = 0; i < numThreads; ++i)
+        releaseDecoder(implControl, workers[i].decoder);
+
+CLEANUP:
+    if (threads)
+        NITF_FREE(threads);
+    if (workers)
+        NITF_FREE(workers);
+    NITF_FREE(toDecode);
+    return ret;
+}
+
 NITFPRIV(void) implClose(nitf_DecompressionControl** control)
 {
     JPEGImplControl* implControl;
     DPRINT("Destroying compression object in JPEG plugin\n");
     implControl = (JPEGImplControl*) * control;
 
-    /* delete marker list */
-    if (implControl && implControl->markerList)
+    /* let go of block offsets */
+    if (implControl)
     {
-        nitf_List_destruct(&implControl->markerList);
+        releaseSOITable(implControl->soiTable);
+    }
+    /* delete decompressors and blocks decoded ahead */
+    if (implControl)
+    {
+        nitf_Uint32 i;
+        for (i = 0; i < implControl->numDecoders; ++i)
+        {
+            /*  A block abandoned on error leaves its source behind  */
+            JPEGTerminateSource(&implControl->decoders[i]->cinfo);
+            jpeg_destroy_decompress(&implControl->decoders[i]->cinfo);
+            NITF_FREE(implControl->decoders[i]);
+        }
+        if (implControl->decoders)
+            NITF_FREE(implControl->decoders);
+        if (implControl->idle)
+            NITF_FREE(implControl->idle);
+
+        for (i = 0; i < implControl->numPrefetched; ++i)
+        {
+            NITF_FREE(implControl->prefetched[i].buf);
+        }
+        if (implControl->prefetched)
+            NITF_FREE(implControl->prefetched);
+        nitf_Mutex_delete(&implControl->mutex);
     }
     /* delete quant table */
     if (implControl && implControl->quantTable)
@@ -1504,6 +2156,7 @@ NITFAPI(const char**) LibjpegDecompress_init(nitf_Error *error)
 
 NITFAPI(void) C3_cleanup(void)
 {
+    freeIdleSOITables();
 }
 NITFAPI(void*) C3_construct(char *compressionType,
                             nitf_Error* error)
@@ -1520,8 +2173,15 @@ NITFAPI(void*) C3_construct(char *compressionType,
     return((void *) &interfaceTable);
 }
 
+NITFAPI(void*) C3_getExtendedInterface(char *compressionType,
+                                       nitf_Error* error)
+{
+    return((void *) &extensionsTable);
+}
+
 NITFAPI(void) M3_cleanup(void)
 {
+    freeIdleSOITables();
 }
 
 NITFAPI(void*) M3_construct(char *compressionType,
@@ -1539,6 +2199,12 @@ NITFAPI(void*) M3_construct(char *compressionType,
     return((void *) &interfaceTable);
 }
 
+NITFAPI(void*) M3_getExtendedInterface(char *compressionType,
+                                       nitf_Error* error)
+{
+    return((void *) &extensionsTable);
+}
+
 
 /*!
  *  \struct JPEGQuantTable
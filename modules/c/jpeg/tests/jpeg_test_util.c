@@ -0,0 +1,166 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "jpeg_test_util.h"
+
+nitf_Uint8 JPEGTest_pixel(nitf_Uint32 band, nitf_Uint32 row,
+                          nitf_Uint32 col)
+{
+    switch (band)
+    {
+        case 0:
+            return (nitf_Uint8)(row + col);
+        case 1:
+            return (nitf_Uint8)(255 - 2 * row);
+        default:
+            return (nitf_Uint8)(col * 3 / 2);
+    }
+}
+
+static NITF_BOOL addImage(nitf_Record *record, const JPEGTestImage *image,
+                          nitf_Error *error)
+{
+    static const char *representations[JPEG_TEST_MAX_BANDS] =
+        { "R", "G", "B" };
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_Uint32 i;
+
+    if (!(segment = nitf_Record_newImageSegment(record, error)))
+        return NITF_FAILURE;
+    if (!(bands = (nitf_BandInfo**)NITF_MALLOC(sizeof(nitf_BandInfo*) *
+                                               image->numBands)))
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    for (i = 0; i < image->numBands; ++i)
+    {
+        if (!(bands[i] = nitf_BandInfo_construct(error)) ||
+            !nitf_BandInfo_init(bands[i], image->numBands == 1 ?
+                                "M" : representations[i], " ", "N", "   ",
+                                0, 0, NULL, error))
+            return NITF_FAILURE;
+    }
+    if (!nitf_ImageSubheader_setPixelInformation(segment->subheader, "INT",
+                                                 8, 8, "R",
+                                                 image->numBands == 1 ?
+                                                 "MONO" : "RGB", "VIS",
+                                                 image->numBands, bands,
+                                                 error) ||
+        !nitf_ImageSubheader_setBlocking(segment->subheader, image->numRows,
+                                         image->numCols, image->blockSize,
+                                         image->blockSize, image->imode,
+                                         error) ||
+        !nitf_Field_setString(segment->subheader->imageCompression,
+                              image->compression, error))
+        return NITF_FAILURE;
+    return NITF_SUCCESS;
+}
+
+NITF_BOOL JPEGTest_writeFile(const char *pathname,
+                             const JPEGTestImage *image,
+                             nitf_Uint32 numImages, nitf_Uint8 **data,
+                             nitf_Error *error)
+{
+    nitf_Record *record = NULL;
+    nitf_Writer *writer = NULL;
+    nitf_IOInterface *io = NULL;
+    nitf_Uint32 i, j;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!(record = nitf_Record_construct(NITF_VER_21, error)))
+        goto CLEANUP;
+    for (i = 0; i < numImages; ++i)
+        if (!addImage(record, image, error))
+            goto CLEANUP;
+
+    if (!(io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_WRITEONLY,
+                                         NITF_CREATE | NITF_TRUNCATE,
+                                         error)) ||
+        !(writer = nitf_Writer_construct(error)) ||
+        !nitf_Writer_prepareIO(writer, record, io, error))
+        goto CLEANUP;
+
+    for (i = 0; i < numImages; ++i)
+    {
+        nitf_ImageWriter *imageWriter;
+        nitf_ImageSource *source;
+        nitf_BandSource *band;
+
+        if (!(imageWriter = nitf_Writer_newImageWriter(writer, (int)i, NULL,
+                                                       error)) ||
+            !(source = nitf_ImageSource_construct(error)))
+            goto CLEANUP;
+        for (j = 0; j < image->numBands; ++j)
+        {
+            if (!(band = nitf_MemorySource_construct(
+                      data[i * image->numBands + j],
+                      image->numRows * image->numCols, 0, 1, 0, error)) ||
+                !nitf_ImageSource_addBand(source, band, error))
+                goto CLEANUP;
+        }
+        if (!nitf_ImageWriter_attachSource(imageWriter, source, error))
+            goto CLEANUP;
+    }
+    ok = nitf_Writer_write(writer, error);
+
+    CLEANUP:
+    {
+        if (writer)
+            nitf_Writer_destruct(&writer);
+        if (io)
+            nitf_IOInterface_destruct(&io);
+        if (record)
+            nitf_Record_destruct(&record);
+    }
+    return ok;
+}
+
+NITF_BOOL JPEGTest_readWindow(nitf_ImageReader *imageReader,
+                              nitf_Uint32 startRow, nitf_Uint32 startCol,
+                              nitf_Uint32 numRows, nitf_Uint32 numCols,
+                              nitf_Uint32 numBands, nitf_Uint8 **out,
+                              nitf_Error *error)
+{
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList[JPEG_TEST_MAX_BANDS];
+    nitf_Uint32 i;
+    int padded;
+    NITF_BOOL ok;
+
+    if (!(subWindow = nitf_SubWindow_construct(error)))
+        return NITF_FAILURE;
+    for (i = 0; i < numBands; ++i)
+        bandList[i] = i;
+    subWindow->startRow = startRow;
+    subWindow->startCol = startCol;
+    subWindow->numRows = numRows;
+    subWindow->numCols = numCols;
+    subWindow->bandList = bandList;
+    subWindow->numBands = numBands;
+    ok = nitf_ImageReader_read(imageReader, subWindow, out, &padded, error);
+    subWindow->bandList = NULL;
+    nitf_SubWindow_destruct(&subWindow);
+    return ok;
+}
@@ -0,0 +1,69 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Helpers shared by the JPEG plugin tests: a test pattern, writing JPEG
+ * compressed images to a file and reading windows back.
+ */
+
+#ifndef __JPEG_TEST_UTIL_H__
+#define __JPEG_TEST_UTIL_H__
+
+#include <import/nitf.h>
+
+#define JPEG_TEST_MAX_BANDS 3
+
+/* The layout of the test images */
+typedef struct _JPEGTestImage
+{
+    const char *compression;    /* C3 or M3 */
+    const char *imode;          /* Blocking mode */
+    nitf_Uint32 numRows;
+    nitf_Uint32 numCols;
+    nitf_Uint32 blockSize;      /* Rows and columns per block */
+    nitf_Uint32 numBands;       /* 1 (MONO) or 3 (RGB) */
+} JPEGTestImage;
+
+/*
+ * The value of a pixel of the test pattern.  Each band has its own
+ * gradient, so swapped bands do not match.
+ */
+nitf_Uint8 JPEGTest_pixel(nitf_Uint32 band, nitf_Uint32 row,
+                          nitf_Uint32 col);
+
+/*
+ * Write numImages images with the given layout to a file.  data holds the
+ * bands of each image, one after the other (image * numBands + band).
+ */
+NITF_BOOL JPEGTest_writeFile(const char *pathname,
+                             const JPEGTestImage *image,
+                             nitf_Uint32 numImages, nitf_Uint8 **data,
+                             nitf_Error *error);
+
+/* Read the first numBands bands of a window into out */
+NITF_BOOL JPEGTest_readWindow(nitf_ImageReader *imageReader,
+                              nitf_Uint32 startRow, nitf_Uint32 startCol,
+                              nitf_Uint32 numRows, nitf_Uint32 numCols,
+                              nitf_Uint32 numBands, nitf_Uint8 **out,
+                              nitf_Error *error);
+
+#endif
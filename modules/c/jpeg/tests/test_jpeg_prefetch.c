@@ -0,0 +1,240 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Reads overlapping windows of a C3 image from several threads at once,
+ * with blocks decoded ahead on a pool of threads, and checks that each
+ * window matches a read that decodes every block on demand.
+ */
+
+#include "jpeg_test_util.h"
+
+#define IMAGE_SIZE 256
+#define BLOCK_SIZE 32
+#define WINDOW_SIZE 96
+#define CACHE_BLOCKS 8
+#define NUM_THREADS 4
+#define NUM_PASSES 3
+
+static const JPEGTestImage image =
+{
+    "C3", "B", IMAGE_SIZE, IMAGE_SIZE, BLOCK_SIZE, 1
+};
+
+typedef struct _ReadJob
+{
+    nitf_ImageReader *imageReader;
+    const nitf_Uint8 *expected;
+    nitf_Uint32 first;          /* Window each thread starts on */
+    int mismatches;
+} ReadJob;
+
+static nitf_ImageReader *newImageReader(nitf_Reader *reader,
+                                        nitf_Uint32 numThreads,
+                                        nitf_Error *error)
+{
+    nitf_ImageReader *imageReader = NULL;
+    nrt_HashTable *options;
+
+    if (!(options = nrt_HashTable_construct(4, error)))
+        return NULL;
+    nrt_HashTable_setPolicy(options, NRT_DATA_RETAIN_OWNER);
+    if (nrt_HashTable_insert(options, C3_NUM_DECODE_THREADS_KEY,
+                             &numThreads, error))
+        imageReader = nitf_Reader_newImageReader(reader, 0, options, error);
+    nrt_HashTable_destruct(&options);
+    return imageReader;
+}
+
+static void readWindows(NITF_DATA *data)
+{
+    ReadJob *job = (ReadJob*)data;
+    const nitf_Uint32 numWindows = (IMAGE_SIZE - WINDOW_SIZE) / 16 + 1;
+    nitf_Uint8 out[WINDOW_SIZE * WINDOW_SIZE];
+    nitf_Uint8 *user[1];
+    nitf_Uint32 pass, i, row;
+    nitf_Error error;
+
+    user[0] = out;
+    for (pass = 0; pass < NUM_PASSES; ++pass)
+    {
+        for (i = 0; i < numWindows; ++i)
+        {
+            /* Windows are not block aligned, so they share blocks */
+            const nitf_Uint32 start =
+                ((job->first + i) % numWindows) * 16;
+            if (!JPEGTest_readWindow(job->imageReader, start, start / 2,
+                                     WINDOW_SIZE, WINDOW_SIZE, 1, user,
+                                     &error))
+            {
+                ++job->mismatches;
+                continue;
+            }
+            for (row = 0; row < WINDOW_SIZE; ++row)
+                if (memcmp(out + row * WINDOW_SIZE,
+                           job->expected + (start + row) * IMAGE_SIZE +
+                           start / 2, WINDOW_SIZE) != 0)
+                {
+                    ++job->mismatches;
+                    break;
+                }
+        }
+    }
+}
+
+/* The prefetch hook comes from the plugin's extensions table */
+static NITF_BOOL checkExtensions(nitf_Error *error)
+{
+    nitf_PluginRegistry *reg;
+    NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION construct;
+    NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION getExtensions;
+    const nitf_DecompressionExtensions *table;
+    int hadError = 0;
+
+    if (!(reg = nitf_PluginRegistry_getInstance(error)) ||
+        !(construct = nitf_PluginRegistry_retrieveDecompConstructor(
+              reg, "C3", &hadError, error)))
+        return NITF_FAILURE;
+
+    getExtensions = nitf_PluginRegistry_retrieveDecompExtensions(reg, "C3");
+    table = getExtensions ? (const nitf_DecompressionExtensions *)
+        (*getExtensions)("C3", error) : NULL;
+    if (!table || table->size != sizeof(nitf_DecompressionExtensions) ||
+        table->base != (*construct)("C3", error) || !table->prefetchBlocks)
+    {
+        nitf_Error_init(error, "C3 has no prefetch extension", NITF_CTXT,
+                        NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nitf_Error error;
+    const char *pathname = "test_jpeg_prefetch.ntf";
+    nitf_Uint8 *data = NULL;
+    nitf_Uint8 *expected = NULL;
+    nitf_IOInterface *io = NULL;
+    nitf_Reader *reader = NULL;
+    nitf_Record *record = NULL;
+    nitf_ImageReader *imageReader = NULL;
+    ReadJob jobs[NUM_THREADS];
+    nitf_Thread *threads[NUM_THREADS];
+    nitf_Uint32 i, row, col;
+
+    (void)argc;
+    (void)argv;
+    memset(threads, 0, sizeof(threads));
+
+    data = (nitf_Uint8*)NITF_MALLOC(IMAGE_SIZE * IMAGE_SIZE);
+    expected = (nitf_Uint8*)NITF_MALLOC(IMAGE_SIZE * IMAGE_SIZE);
+    if (!data || !expected)
+    {
+        nitf_Error_init(&error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    for (row = 0; row < IMAGE_SIZE; ++row)
+        for (col = 0; col < IMAGE_SIZE; ++col)
+            data[row * IMAGE_SIZE + col] = JPEGTest_pixel(0, row, col);
+    if (!JPEGTest_writeFile(pathname, &image, 1, &data, &error) ||
+        !checkExtensions(&error))
+        goto CATCH_ERROR;
+
+    if (!(io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_READONLY,
+                                         NITF_OPEN_EXISTING, &error)) ||
+        !(reader = nitf_Reader_construct(&error)) ||
+        !(record = nitf_Reader_readIO(reader, io, &error)))
+        goto CATCH_ERROR;
+
+    /* The reference decodes one block at a time */
+    if (!(imageReader = newImageReader(reader, 1, &error)) ||
+        !JPEGTest_readWindow(imageReader, 0, 0, IMAGE_SIZE, IMAGE_SIZE, 1,
+                             &expected, &error))
+        goto CATCH_ERROR;
+    nitf_ImageReader_destruct(&imageReader);
+
+    /*
+     * The cache holds fewer blocks than a window covers, so blocks are
+     * evicted and decoded again while other threads prefetch
+     */
+    if (!(imageReader = newImageReader(reader, NUM_THREADS, &error)))
+        goto CATCH_ERROR;
+    nitf_ImageReader_setReadCacheSize(imageReader,
+                                      CACHE_BLOCKS * BLOCK_SIZE * BLOCK_SIZE);
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        jobs[i].imageReader = imageReader;
+        jobs[i].expected = expected;
+        jobs[i].first = i * 3;
+        jobs[i].mismatches = 0;
+        if (!(threads[i] = nitf_Thread_construct(readWindows, &jobs[i],
+                                                 &error)))
+            goto CATCH_ERROR;
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        nitf_Thread_join(threads[i], &error);
+        nitf_Thread_destruct(&threads[i]);
+        if (jobs[i].mismatches)
+        {
+            nitf_Error_initf(&error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Thread %d read %d bad windows", (int)i,
+                             jobs[i].mismatches);
+            goto CATCH_ERROR;
+        }
+    }
+    printf("Read windows from %d threads\n", NUM_THREADS);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nitf_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        for (i = 0; i < NUM_THREADS; ++i)
+        {
+            if (threads[i])
+            {
+                nitf_Thread_join(threads[i], &error);
+                nitf_Thread_destruct(&threads[i]);
+            }
+        }
+        if (imageReader)
+            nitf_ImageReader_destruct(&imageReader);
+        if (record)
+            nitf_Record_destruct(&record);
+        if (reader)
+            nitf_Reader_destruct(&reader);
+        if (io)
+            nitf_IOInterface_destruct(&io);
+        if (expected)
+            NITF_FREE(expected);
+        if (data)
+            NITF_FREE(data);
+    }
+    return rc;
+}
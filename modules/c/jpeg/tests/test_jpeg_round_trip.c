@@ -0,0 +1,225 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Writes mono and RGB images with the C3 and M3 compressors, in each
+ * blocking mode, reads them back with the decompressor and checks the
+ * pixels and the COMRAT code.
+ */
+
+#include "jpeg_test_util.h"
+
+#define NUM_ROWS 96
+#define NUM_COLS 128
+#define BLOCK_SIZE 32
+#define MAX_ERROR 24
+#define WIDE_COLS 70000         /* Too wide for a JPEG block */
+
+static NITF_BOOL readFile(const char *pathname, const JPEGTestImage *test,
+                          nitf_Uint8 **out, char *comrat,
+                          nitf_Error *error)
+{
+    nitf_IOInterface *io = NULL;
+    nitf_Reader *reader = NULL;
+    nitf_Record *record = NULL;
+    nitf_ImageReader *imageReader = NULL;
+    nitf_ImageSegment *segment;
+    NITF_BOOL ok = NITF_FAILURE;
+
+    if (!(io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_READONLY,
+                                         NITF_OPEN_EXISTING, error)) ||
+        !(reader = nitf_Reader_construct(error)) ||
+        !(record = nitf_Reader_readIO(reader, io, error)))
+        goto CLEANUP;
+
+    segment = (nitf_ImageSegment*)nitf_List_get(record->images, 0, error);
+    if (!segment ||
+        !nitf_Field_get(segment->subheader->NITF_COMRAT, comrat,
+                        NITF_CONV_STRING, NITF_COMRAT_SZ + 1, error))
+        goto CLEANUP;
+
+    if (!(imageReader = nitf_Reader_newImageReader(reader, 0, NULL,
+                                                   error)))
+        goto CLEANUP;
+    ok = JPEGTest_readWindow(imageReader, 0, 0, NUM_ROWS, NUM_COLS,
+                             test->numBands, out, error);
+
+    CLEANUP:
+    {
+        if (imageReader)
+            nitf_ImageReader_destruct(&imageReader);
+        if (record)
+            nitf_Record_destruct(&record);
+        if (reader)
+            nitf_Reader_destruct(&reader);
+        if (io)
+            nitf_IOInterface_destruct(&io);
+    }
+    return ok;
+}
+
+static NITF_BOOL roundTrip(const JPEGTestImage *test, nitf_Uint8 **data,
+                           nitf_Uint8 **out, nitf_Error *error)
+{
+    const char *pathname = "test_jpeg_round_trip.ntf";
+    char comrat[NITF_COMRAT_SZ + 1];
+    nitf_Uint32 band, row, col;
+
+    if (!JPEGTest_writeFile(pathname, test, 1, data, error) ||
+        !readFile(pathname, test, out, comrat, error))
+        return NITF_FAILURE;
+
+    /* Tables scaled from the libjpeg defaults are recorded as custom */
+    if (strcmp(comrat, "00.0") != 0)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                         "COMRAT is '%s', not '00.0'", comrat);
+        return NITF_FAILURE;
+    }
+
+    for (band = 0; band < test->numBands; ++band)
+    {
+        for (row = 0; row < NUM_ROWS; ++row)
+        {
+            for (col = 0; col < NUM_COLS; ++col)
+            {
+                const int diff = (int)out[band][row * NUM_COLS + col] -
+                    (int)JPEGTest_pixel(band, row, col);
+                if (diff > MAX_ERROR || diff < -MAX_ERROR)
+                {
+                    nitf_Error_initf(error, NITF_CTXT,
+                                     NITF_ERR_INVALID_OBJECT,
+                                     "Band %d pixel (%d, %d) is %d, not %d",
+                                     (int)band, (int)row, (int)col,
+                                     (int)out[band][row * NUM_COLS + col],
+                                     (int)JPEGTest_pixel(band, row, col));
+                    return NITF_FAILURE;
+                }
+            }
+        }
+    }
+    return NITF_SUCCESS;
+}
+
+/* A block libjpeg can not compress fails the write, it does not exit */
+static NITF_BOOL compressFails(nitf_Error *error)
+{
+    static const JPEGTestImage wide =
+    {
+        "C3", "B", 1, WIDE_COLS, WIDE_COLS, 1
+    };
+    nitf_Uint8 *data;
+    nitf_Error writeError;
+    NITF_BOOL written;
+
+    if (!(data = (nitf_Uint8*)NITF_MALLOC(WIDE_COLS)))
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(data, 0, WIDE_COLS);
+    written = JPEGTest_writeFile("test_jpeg_round_trip.ntf", &wide, 1,
+                                 &data, &writeError);
+    NITF_FREE(data);
+    if (written || writeError.level != NITF_ERR_COMPRESSION)
+    {
+        nitf_Error_init(error, "A wide image did not fail to compress",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    printf("A wide image fails with: %s\n", writeError.message);
+    return NITF_SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+    static const JPEGTestImage tests[] =
+    {
+        { "C3", "B", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 1 },
+        { "C3", "P", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 3 },
+        { "C3", "B", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 3 },
+        { "C3", "S", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 3 },
+        { "M3", "B", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 1 },
+        { "M3", "P", NUM_ROWS, NUM_COLS, BLOCK_SIZE, 3 }
+    };
+    const nitf_Uint32 numTests = sizeof(tests) / sizeof(tests[0]);
+    int rc = 0;
+    nitf_Error error;
+    nitf_Uint8 *data[JPEG_TEST_MAX_BANDS];
+    nitf_Uint8 *out[JPEG_TEST_MAX_BANDS];
+    nitf_Uint32 i, row, col;
+
+    (void)argc;
+    (void)argv;
+    memset(data, 0, sizeof(data));
+    memset(out, 0, sizeof(out));
+
+    for (i = 0; i < JPEG_TEST_MAX_BANDS; ++i)
+    {
+        data[i] = (nitf_Uint8*)NITF_MALLOC(NUM_ROWS * NUM_COLS);
+        out[i] = (nitf_Uint8*)NITF_MALLOC(NUM_ROWS * NUM_COLS);
+        if (!data[i] || !out[i])
+        {
+            nitf_Error_init(&error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+        for (row = 0; row < NUM_ROWS; ++row)
+            for (col = 0; col < NUM_COLS; ++col)
+                data[i][row * NUM_COLS + col] = JPEGTest_pixel(i, row, col);
+    }
+
+    for (i = 0; i < numTests; ++i)
+    {
+        if (!roundTrip(&tests[i], data, out, &error))
+        {
+            printf("%s IMODE %s with %d band(s) failed\n",
+                   tests[i].compression, tests[i].imode,
+                   (int)tests[i].numBands);
+            goto CATCH_ERROR;
+        }
+        printf("%s IMODE %s with %d band(s) round trips\n",
+               tests[i].compression, tests[i].imode,
+               (int)tests[i].numBands);
+    }
+    if (!compressFails(&error))
+        goto CATCH_ERROR;
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nitf_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        for (i = 0; i < JPEG_TEST_MAX_BANDS; ++i)
+        {
+            if (data[i])
+                NITF_FREE(data[i]);
+            if (out[i])
+                NITF_FREE(out[i]);
+        }
+    }
+    return rc;
+}
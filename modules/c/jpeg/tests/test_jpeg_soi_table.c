@@ -0,0 +1,327 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ * Writes two C3 images into one file and reads them back through an io
+ * that counts what is read.  The SOI offset scan of an image must stop at
+ * the end of its segment, and a second ImageReader of the same image must
+ * reuse the offsets instead of scanning the image again.
+ */
+
+#include "jpeg_test_util.h"
+
+#define NUM_IMAGES 2
+#define IMAGE_SIZE 128
+#define BLOCK_SIZE 32
+#define MAX_ERROR 24
+
+/* Forwards to a BufferAdapter, without exposing its memory */
+typedef struct _CountingIO
+{
+    nitf_IOInterface *inner;
+    nitf_Uint64 bytesRead;
+    nitf_Off maxEnd;            /* End of the furthest read */
+} CountingIO;
+
+static void count(CountingIO *counter, nitf_Off offset, size_t size)
+{
+    counter->bytesRead += size;
+    if (offset + (nitf_Off)size > counter->maxEnd)
+        counter->maxEnd = offset + (nitf_Off)size;
+}
+
+static NITF_BOOL countingRead(NITF_DATA *data, void *buf, size_t size,
+                              nitf_Error *error)
+{
+    CountingIO *counter = (CountingIO*)data;
+    count(counter, nitf_IOInterface_tell(counter->inner, error), size);
+    return nitf_IOInterface_read(counter->inner, buf, size, error);
+}
+
+static NITF_BOOL countingReadAt(NITF_DATA *data, nitf_Off offset, void *buf,
+                                size_t size, nitf_Error *error)
+{
+    CountingIO *counter = (CountingIO*)data;
+    count(counter, offset, size);
+    return nitf_IOInterface_readAt(counter->inner, offset, buf, size, error);
+}
+
+static NITF_BOOL countingWrite(NITF_DATA *data, const void *buf, size_t size,
+                               nitf_Error *error)
+{
+    (void)data;
+    (void)buf;
+    (void)size;
+    nitf_Error_init(error, "Read only", NITF_CTXT, NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+
+static NITF_BOOL countingCanSeek(NITF_DATA *data, nitf_Error *error)
+{
+    return nitf_IOInterface_canSeek(((CountingIO*)data)->inner, error);
+}
+
+static nitf_Off countingSeek(NITF_DATA *data, nitf_Off offset, int whence,
+                             nitf_Error *error)
+{
+    return nitf_IOInterface_seek(((CountingIO*)data)->inner, offset, whence,
+                                 error);
+}
+
+static nitf_Off countingTell(NITF_DATA *data, nitf_Error *error)
+{
+    return nitf_IOInterface_tell(((CountingIO*)data)->inner, error);
+}
+
+static nitf_Off countingGetSize(NITF_DATA *data, nitf_Error *error)
+{
+    return nitf_IOInterface_getSize(((CountingIO*)data)->inner, error);
+}
+
+static int countingGetMode(NITF_DATA *data, nitf_Error *error)
+{
+    return nitf_IOInterface_getMode(((CountingIO*)data)->inner, error);
+}
+
+static NITF_BOOL countingClose(NITF_DATA *data, nitf_Error *error)
+{
+    (void)data;
+    (void)error;
+    return NITF_SUCCESS;
+}
+
+static void countingDestruct(NITF_DATA *data)
+{
+    /* The counter itself is freed by nitf_IOInterface_destruct */
+    nitf_IOInterface_destruct(&((CountingIO*)data)->inner);
+}
+
+static nitf_IOInterface *countingIO_construct(char *buf, size_t size,
+                                              nitf_Error *error)
+{
+    static nitf_IIOInterface iface =
+    {
+        countingRead, countingWrite, countingCanSeek, countingSeek,
+        countingTell, countingGetSize, countingGetMode, countingClose,
+        countingDestruct, countingReadAt, NULL
+    };
+    nitf_IOInterface *io = NULL;
+    CountingIO *counter = (CountingIO*)NITF_MALLOC(sizeof(CountingIO));
+
+    if (!counter || !(io = (nitf_IOInterface*)NITF_MALLOC(
+                          sizeof(nitf_IOInterface))))
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        if (counter)
+            NITF_FREE(counter);
+        return NULL;
+    }
+    memset(counter, 0, sizeof(CountingIO));
+    if (!(counter->inner = nitf_BufferAdapter_construct(buf, size, 0, error)))
+    {
+        NITF_FREE(counter);
+        NITF_FREE(io);
+        return NULL;
+    }
+    io->data = counter;
+    io->iface = &iface;
+    return io;
+}
+
+static const JPEGTestImage image =
+{
+    "C3", "B", IMAGE_SIZE, IMAGE_SIZE, BLOCK_SIZE, 1
+};
+
+/*
+ * Read a file into memory, the writer finds where it is from the size of
+ * its output, so it can not write into a buffer.
+ */
+static char *loadFile(const char *pathname, nitf_Off *length,
+                      nitf_Error *error)
+{
+    nitf_IOInterface *io;
+    char *buf = NULL;
+
+    if (!(io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_READONLY,
+                                         NITF_OPEN_EXISTING, error)))
+        return NULL;
+    *length = nitf_IOInterface_getSize(io, error);
+    if (*length <= 0 ||
+        !(buf = (char*)NITF_MALLOC((size_t)*length)) ||
+        !nitf_IOInterface_read(io, buf, (size_t)*length, error))
+    {
+        if (buf)
+            NITF_FREE(buf);
+        buf = NULL;
+    }
+    nitf_IOInterface_destruct(&io);
+    return buf;
+}
+
+/* Read one window of an image with a new ImageReader */
+static NITF_BOOL readWindow(nitf_Reader *reader, nitf_Uint32 index,
+                            nitf_Uint32 numRows, nitf_Uint32 numCols,
+                            nitf_Uint8 *out, nitf_Error *error)
+{
+    nitf_ImageReader *imageReader;
+    NITF_BOOL ok;
+
+    if (!(imageReader = nitf_Reader_newImageReader(reader, (int)index, NULL,
+                                                   error)))
+        return NITF_FAILURE;
+    ok = JPEGTest_readWindow(imageReader, 0, 0, numRows, numCols, 1, &out,
+                             error);
+    nitf_ImageReader_destruct(&imageReader);
+    return ok;
+}
+
+int main(int argc, char **argv)
+{
+    int rc = 0;
+    nitf_Error error;
+    const char *pathname = "test_jpeg_soi_table.ntf";
+    char *buf = NULL;
+    nitf_Off length;
+    nitf_Uint8 *data[NUM_IMAGES];
+    nitf_Uint8 out[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint8 first[BLOCK_SIZE * BLOCK_SIZE];
+    nitf_Uint8 again[BLOCK_SIZE * BLOCK_SIZE];
+    nitf_IOInterface *io = NULL;
+    CountingIO *counter;
+    nitf_Reader *reader = NULL;
+    nitf_Record *record = NULL;
+    nitf_Uint32 i, row, col;
+
+    (void)argc;
+    (void)argv;
+    memset(data, 0, sizeof(data));
+
+    for (i = 0; i < NUM_IMAGES; ++i)
+    {
+        if (!(data[i] = (nitf_Uint8*)NITF_MALLOC(IMAGE_SIZE * IMAGE_SIZE)))
+        {
+            nitf_Error_init(&error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
+        for (row = 0; row < IMAGE_SIZE; ++row)
+            for (col = 0; col < IMAGE_SIZE; ++col)
+                data[i][row * IMAGE_SIZE + col] = JPEGTest_pixel(i, row, col);
+    }
+
+    if (!JPEGTest_writeFile(pathname, &image, NUM_IMAGES, data, &error) ||
+        !(buf = loadFile(pathname, &length, &error)))
+        goto CATCH_ERROR;
+
+    if (!(io = countingIO_construct(buf, (size_t)length, &error)) ||
+        !(reader = nitf_Reader_construct(&error)) ||
+        !(record = nitf_Reader_readIO(reader, io, &error)))
+        goto CATCH_ERROR;
+    counter = (CountingIO*)io->data;
+
+    for (i = 0; i < NUM_IMAGES; ++i)
+    {
+        nitf_ImageSegment *segment =
+            (nitf_ImageSegment*)nitf_List_get(record->images, (int)i, &error);
+        const nitf_Uint64 segmentLength =
+            segment->imageEnd - segment->imageOffset;
+
+        /* The first read of a block scans the whole segment, and no more */
+        counter->bytesRead = 0;
+        counter->maxEnd = 0;
+        if (!readWindow(reader, i, BLOCK_SIZE, BLOCK_SIZE, first, &error))
+            goto CATCH_ERROR;
+        if (counter->bytesRead < segmentLength ||
+            counter->maxEnd > (nitf_Off)segment->imageEnd)
+        {
+            nitf_Error_initf(&error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Image %d: read %d bytes up to %d, the segment"
+                             " is %d - %d", (int)i, (int)counter->bytesRead,
+                             (int)counter->maxEnd, (int)segment->imageOffset,
+                             (int)segment->imageEnd);
+            goto CATCH_ERROR;
+        }
+
+        /* Another ImageReader reads the block without scanning again */
+        counter->bytesRead = 0;
+        if (!readWindow(reader, i, BLOCK_SIZE, BLOCK_SIZE, again, &error))
+            goto CATCH_ERROR;
+        if (counter->bytesRead >= segmentLength / 2 ||
+            memcmp(first, again, sizeof(first)) != 0)
+        {
+            nitf_Error_initf(&error, NITF_CTXT, NITF_ERR_INVALID_OBJECT,
+                             "Image %d was scanned again (%d bytes read)",
+                             (int)i, (int)counter->bytesRead);
+            goto CATCH_ERROR;
+        }
+
+        if (!readWindow(reader, i, IMAGE_SIZE, IMAGE_SIZE, out, &error))
+            goto CATCH_ERROR;
+
+        for (row = 0; row < IMAGE_SIZE; ++row)
+        {
+            for (col = 0; col < IMAGE_SIZE; ++col)
+            {
+                const int diff = (int)out[row * IMAGE_SIZE + col] -
+                    (int)JPEGTest_pixel(i, row, col);
+                if ((row < BLOCK_SIZE && col < BLOCK_SIZE &&
+                     first[row * BLOCK_SIZE + col] !=
+                     out[row * IMAGE_SIZE + col]) ||
+                    diff > MAX_ERROR || diff < -MAX_ERROR)
+                {
+                    nitf_Error_initf(&error, NITF_CTXT,
+                                     NITF_ERR_INVALID_OBJECT,
+                                     "Image %d pixel (%d, %d) is %d, not %d",
+                                     (int)i, (int)row, (int)col,
+                                     (int)out[row * IMAGE_SIZE + col],
+                                     (int)JPEGTest_pixel(i, row, col));
+                    goto CATCH_ERROR;
+                }
+            }
+        }
+    }
+    printf("Read %d C3 images\n", NUM_IMAGES);
+    goto CLEANUP;
+
+    CATCH_ERROR:
+    {
+        nitf_Error_print(&error, stdout, "Exiting...");
+        rc = 1;
+    }
+    CLEANUP:
+    {
+        if (record)
+            nitf_Record_destruct(&record);
+        if (reader)
+            nitf_Reader_destruct(&reader);
+        if (io)
+            nitf_IOInterface_destruct(&io);
+        if (buf)
+            NITF_FREE(buf);
+        for (i = 0; i < NUM_IMAGES; ++i)
+            if (data[i])
+                NITF_FREE(data[i]);
+    }
+    return rc;
+}
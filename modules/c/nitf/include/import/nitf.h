@@ -25,6 +25,7 @@
 
 #include "nitf/BandInfo.h"
 #include "nitf/BandSource.h"
+#include "nitf/ByteSwap.h"
 #include "nitf/ComponentInfo.h"
 #include "nitf/DESegment.h"
 #include "nitf/DESubheader.h"
@@ -52,6 +53,7 @@
 #include "nitf/RESubheader.h"
 #include "nitf/RowSource.h"
 #include "nitf/Reader.h"
+#include "nitf/ReaderOptions.h"
 #include "nitf/Record.h"
 #include "nitf/SegmentReader.h"
 #include "nitf/SegmentSource.h"
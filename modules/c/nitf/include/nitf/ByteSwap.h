@@ -0,0 +1,103 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_BYTE_SWAP_H__
+#define __NITF_BYTE_SWAP_H__
+
+#include "nitf/System.h"
+
+NITF_CXX_GUARD
+
+/*!
+ *  \enum nitf_ByteSwapLevel
+ *  \brief The instruction sets the byte swap kernels are written for
+ *
+ *  Every pixel read from or written to a NITF on a little-endian host is
+ *  byte swapped.  The kernels below do that a vector at a time, and the
+ *  best level the CPU supports is picked the first time one is called.
+ *  The scalar level is always available.
+ */
+typedef enum _nitf_ByteSwapLevel
+{
+    NITF_BYTE_SWAP_SCALAR = 0,
+    NITF_BYTE_SWAP_SSE2,
+    NITF_BYTE_SWAP_AVX2,
+    NITF_BYTE_SWAP_AVX512,
+    NITF_BYTE_SWAP_NEON
+} nitf_ByteSwapLevel;
+
+#define NITF_BYTE_SWAP_NUM_LEVELS 5
+
+/*!
+ *  Can this build, on this CPU, use the given level?
+ *  \param level The level
+ */
+NITFAPI(NITF_BOOL) nitf_ByteSwap_isSupported(nitf_ByteSwapLevel level);
+
+/*!
+ *  The level the kernels currently use.  Unless nitf_ByteSwap_setLevel
+ *  has been called, this is the best supported one.
+ */
+NITFAPI(nitf_ByteSwapLevel) nitf_ByteSwap_getLevel(void);
+
+/*!
+ *  Force the kernels to a given level.  This is meant for testing and
+ *  benchmarking, and should not be called while other threads are
+ *  reading or writing images.
+ *
+ *  \param level The level
+ *  \return NITF_FAILURE if the level is not supported
+ */
+NITFAPI(NITF_BOOL) nitf_ByteSwap_setLevel(nitf_ByteSwapLevel level);
+
+/*!
+ *  A printable name for a level, e.g. "AVX2"
+ *  \param level The level
+ */
+NITFAPI(const char *) nitf_ByteSwap_getLevelName(nitf_ByteSwapLevel level);
+
+/*!
+ *  Reverse the bytes of each 2-byte element of a buffer, in place.  The
+ *  buffer need not be aligned.
+ *
+ *  \param buffer The buffer
+ *  \param count The number of elements
+ */
+NITFAPI(void) nitf_ByteSwap_swap2(nitf_Uint8 * buffer, size_t count);
+
+/*!
+ *  Reverse the bytes of each 4-byte element of a buffer, in place
+ *  \param buffer The buffer
+ *  \param count The number of elements
+ */
+NITFAPI(void) nitf_ByteSwap_swap4(nitf_Uint8 * buffer, size_t count);
+
+/*!
+ *  Reverse the bytes of each 8-byte element of a buffer, in place
+ *  \param buffer The buffer
+ *  \param count The number of elements
+ */
+NITFAPI(void) nitf_ByteSwap_swap8(nitf_Uint8 * buffer, size_t count);
+
+NITF_CXX_ENDGUARD
+
+#endif
@@ -325,6 +325,19 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
         nitf_Error *
         error);
 
+/*!
+ *  Is the downsampler a pixel skip, where each output pixel stands for its
+ *  sample window?  When the reader asks for it, a decompressor that can
+ *  decode at a reduced resolution (e.g., a JPEG 2000 resolution level) may
+ *  be used in place of the skip.  The max downsampler picks a particular
+ *  pixel of the window, so it is never replaced.
+ *
+ *  \param downsampler The downsampler to check
+ *  \return True for the pixel skip downsampler
+ */
+NITFAPI(NITF_BOOL) nitf_DownSampler_isDecimating(nitf_DownSampler *
+                                                 downsampler);
+
 /*!
  *  The downsampler destructor is a management function.  While it does
  *  free the downsampler, it first destroys any user data using the
@@ -82,6 +82,8 @@ typedef struct _nitf_Field
     size_t length;
     NITF_BOOL resizable; /* private member that states whether the field
                             can be resized - default is false */
+    nitf_Arena* arena;   /* private member, the arena the field and its
+                            raw data live in, if any */
 }
 nitf_Field;
 
@@ -100,6 +102,16 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
                                            nitf_FieldType type,
                                            nitf_Error * error);
 
+/*!
+ *  Construct a field in the given arena (or on the heap if it is NULL),
+ *  rather than the current one.  Used to keep the Fields of a TRE in the
+ *  TRE's arena when they are added after reading.
+ */
+NITFPROT(nitf_Field *) nitf_Field_constructIn(size_t length,
+                                              nitf_FieldType type,
+                                              nitf_Arena * arena,
+                                              nitf_Error * error);
+
 
 /*!
  *  \fn nitf_Field_setRawData
@@ -498,6 +498,11 @@ typedef NITF_BOOL
   facility other than the NITF library memory allocation interface. This
   buffer must be freed via the freeBlock function entry.
 
+  When the IO interface supports positional reads (nitf_IOInterface_canReadAt)
+  the library calls readBlock without holding its own lock, so several
+  blocks may be read concurrently through one control object. Plugins with
+  state shared between calls must serialize it themselves.
+
   \ar object      - Associated reader
   \ar blockNumber - Block number
   \ar error       - Error object
@@ -532,6 +537,79 @@ typedef NITF_BOOL(*NITF_DECOMPRESSION_INTERFACE_FREE_BLOCK_FUNCTION)
 (nitf_DecompressionControl * object,
  nitf_Uint8 * block, nitf_Error * error);
 
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_PREFETCH_BLOCKS_FUNCTION - Image
+  decompression interface prefetch blocks function
+
+  This function pointer type is the type for the optional prefetchBlocks
+  field in the decompression extensions (nitf_DecompressionExtensions). Before a read request the
+  library passes the blocks that cover the requested sub-window, so that a
+  decompressor can decode them ahead of the readBlock calls that follow
+  (for example, concurrently). The blocks are still requested one at a time
+  via readBlock and freed via freeBlock. Prefetching is only a hint, a
+  decompressor that does not prefetch leaves the field NULL.
+
+  Blocks already held in the read cache are not passed, and no more blocks
+  are passed than the read cache can hold, so nothing is prefetched with
+  the default one block cache. When the source reads positionally this
+  function may run concurrently with readBlock and with other prefetch
+  calls, so a decompressor must not discard blocks that an earlier call
+  decoded ahead and that have not been read yet.
+
+  \ar object       - Associated reader
+  \ar blockNumbers - Blocks that will be read next
+  \ar numBlocks    - Number of blocks in the list
+  \ar error        - Error object
+
+  \return On error, FALSE is returned
+
+  On error, the error object is set
+*/
+
+typedef NITF_BOOL(*NITF_DECOMPRESSION_INTERFACE_PREFETCH_BLOCKS_FUNCTION)
+(nitf_DecompressionControl * object,
+ const nitf_Uint32 * blockNumbers, nitf_Uint32 numBlocks,
+ nitf_Error * error);
+
+/*!
+    \brief NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_FUNCTION - Image
+  decompression interface read reduced function
+
+  This function pointer type is the type for the optional readReduced
+  field in the decompression extensions (nitf_DecompressionExtensions). When reduced resolution
+  reads are enabled (nitf_ImageReader_setReducedResolution) and a request
+  is down-sampled by a power of two with a pixel skip down-sampler, the
+  library asks the decompressor for the sub-window at that reduced
+  resolution (for example, a JPEG 2000 resolution level) instead of reading
+  every block at full resolution and down-sampling it.
+
+  The sub-window is given at full resolution, its start is a multiple of
+  2^reduce and it may extend past the image edge by less than 2^reduce
+  pixels. The result holds all of the bands, one after the other, each
+  numRows by numCols (the reduced size) and is freed via freeBlock. The
+  library falls back to reading blocks when this function fails, so a
+  decompressor that can not provide the requested level simply fails.
+
+  \ar object      - Associated reader
+  \ar startRow    - First row (full resolution)
+  \ar startCol    - First column (full resolution)
+  \ar numRows     - Number of rows at the reduced resolution
+  \ar numCols     - Number of columns at the reduced resolution
+  \ar reduce      - Number of resolution levels to discard
+  \ar bufferSize  - Returns the size of the result in bytes
+  \ar error       - Error object
+
+  \return The reduced sub-window or NULL on error
+
+  On error, the error object is set
+*/
+
+typedef nitf_Uint8 *(*NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_FUNCTION)
+(nitf_DecompressionControl * object,
+ nitf_Uint32 startRow, nitf_Uint32 startCol,
+ nitf_Uint32 numRows, nitf_Uint32 numCols, nitf_Uint32 reduce,
+ nitf_Uint64 * bufferSize, nitf_Error * error);
+
 /*!
     \brief NITF_DECOMPRESSION_CONTROL_DESTROY_FUNCTION - Image decompression
     interface control object destructor
@@ -599,6 +677,32 @@ typedef struct _nitf_DecompressionInterface
 }
 nitf_DecompressionInterface;
 
+/*!
+  \brief nitf_DecompressionExtensions - Optional decompression entry points
+
+  Entry points added after nitf_DecompressionInterface was published live in
+  this separate table, so plugins built against the original interface keep
+  working unchanged. A plugin offers them by exporting
+  <compression type>_getExtendedInterface (for example,
+  C8_getExtendedInterface, see NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION)
+  that returns the table.
+
+  The library only uses the table with the interface named by base, and only
+  uses a member that lies within size, so members can be added at the end
+  without breaking plugins built with a shorter table. Any member may be
+  NULL.
+
+*/
+
+typedef struct _nitf_DecompressionExtensions
+{
+    size_t size;                                /*!< sizeof the table the plugin was built with */
+    const nitf_DecompressionInterface *base;    /*!< The interface this table extends */
+    NITF_DECOMPRESSION_INTERFACE_PREFETCH_BLOCKS_FUNCTION prefetchBlocks; /*!< Decode blocks ahead of readBlock */
+    NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_FUNCTION readReduced;       /*!< Read a power of two down-sampled sub-window */
+}
+nitf_DecompressionExtensions;
+
 /*!
   \brief NITF_DOWN_SAMPLE_FUNCTION - Function pointer for down-sample
   function
@@ -749,6 +853,11 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf);
   Row and column skips of more than one in the sub-window are not currently
   implemented.
 
+  Several threads may read sub-windows of the same object concurrently.
+  Each call builds its own control structures; the block cache, the
+  decompressor and each seek/read pair on the IO interface are serialized
+  internally.
+
   \param nitf The associated nitf_ImageIO object
   \param io The IO interface
   \param subWindow Sub-window to read
@@ -865,6 +974,60 @@ NITFPROT(void) nitf_ImageIO_setReadCaching
     nitf_ImageIO * nitf      /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageIO_setReadCacheSize - Enable cached reads with a budget
+
+  \b nitf_ImageIO_setReadCacheSize enables cached reads and sets the byte
+  budget of the least recently used block cache. Raw and decompressed
+  blocks are retained until the budget is exceeded. A budget of zero keeps
+  a single block. If the cache currently exceeds the new budget, least
+  recently used blocks are released.
+
+  See the documentation for nitf_ImageReader_setReadCacheSize
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_setReadCacheSize
+(
+    nitf_ImageIO * nitf,     /*!< Object to modify */
+    nitf_Uint64 maxBytes     /*!< Cache budget in bytes */
+);
+
+/*!
+  \brief nitf_ImageIO_setReducedResolution - Enable/disable reduced
+  resolution reads
+
+  See the documentation for nitf_ImageReader_setReducedResolution
+
+  \return Returns the current enable/disable state
+*/
+
+NITFPROT(int) nitf_ImageIO_setReducedResolution
+(
+    nitf_ImageIO * nitf,     /*!< Object to modify */
+    int enable               /*!< Enable reduced resolution reads if true */
+);
+
+/*!
+  \brief nitf_ImageIO_getReadCacheStats - Get read cache statistics
+
+  \b nitf_ImageIO_getReadCacheStats returns the number of block requests
+  satisfied from the read cache, the number that required a block read or
+  decompression, and the number of bytes currently cached. Any of the
+  output pointers may be NULL.
+
+  \return None
+*/
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats
+(
+    nitf_ImageIO * nitf,     /*!< Object to query */
+    nitf_Uint64 * hits,      /*!< Returns the number of cache hits */
+    nitf_Uint64 * misses,    /*!< Returns the number of cache misses */
+    nitf_Uint64 * usedBytes  /*!< Returns the bytes currently cached */
+);
+
 /*!
   \brief nitf_BlockingInfo_print - Print blocking information
 
@@ -897,6 +1060,12 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
   \b nitf_ImageIO_readBlockDirect reads a block of data directly from file without
   any manipulation or re-organization.  Only use this if you know what you're doing!
 
+  If the IO interface is addressable in memory (e.g. nitf_MMapAdapter_open)
+  and the block is stored uncompressed, the returned pointer refers to the
+  block in place and remains valid for the life of the IO interface.
+  Otherwise the block is owned by the read cache. The block must not be
+  modified.
+
   \param nitf         Image handle
   \param io           IO handle
   \param blockNumber  The block to read
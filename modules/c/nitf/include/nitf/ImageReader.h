@@ -47,7 +47,10 @@ nitf_ImageReader_getBlockingInfo(nitf_ImageReader * imageReader,
                                  nitf_Error * error);
 
 /*!
- *  TODO: Add documentation
+ *  Read a sub-window. See nitf_ImageIO_read for more details.
+ *
+ *  Reads may be issued concurrently from several threads on the same
+ *  reader, each with its own sub-window and buffers.
  */
 NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
         nitf_SubWindow * subWindow,
@@ -56,6 +59,9 @@ NITFAPI(NITF_BOOL) nitf_ImageReader_read(nitf_ImageReader * imageReader,
 
 /**
    Read a block directly from file
+
+   With a memory mapped input (nitf_MMapAdapter_open), uncompressed blocks
+   are returned in place rather than copied. See nitf_ImageIO_readBlockDirect.
  */
 NITFAPI(nitf_Uint8*) nitf_ImageReader_readBlock(nitf_ImageReader * imageReader,
                                                 nitf_Uint32 blockNumber,
@@ -84,6 +90,62 @@ NITFAPI(void) nitf_ImageReader_setReadCaching
     nitf_ImageReader * iReader  /*!< Object to modify */
 );
 
+/*!
+  \brief nitf_ImageReader_setReadCacheSize - Enable cached reads with a
+  byte budget
+
+  nitf_ImageReader_setReadCacheSize enables cached reads and bounds the
+  block cache to \b maxBytes. Blocks (raw, or decompressed for compressed
+  images) are kept in least recently used order, so a sub-window that is
+  read in several passes, or that crosses block boundaries, reads and
+  decompresses each block once while it stays in the cache. A budget of
+  zero keeps a single block, as nitf_ImageReader_setReadCaching does.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_setReadCacheSize
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    nitf_Uint64 maxBytes        /*!< Cache budget in bytes */
+);
+
+/*!
+  \brief nitf_ImageReader_setReducedResolution - Enable/disable reduced
+  resolution reads
+
+  nitf_ImageReader_setReducedResolution lets reads that are down-sampled
+  by a power of two with a pixel skip down-sampler be decoded at a reduced
+  resolution, when the decompression plugin supports it (for example, a
+  JPEG 2000 resolution level). This is much faster than decoding every
+  block at full resolution, but the wavelet reduction filters the image,
+  so the pixels differ from an exact skip. It is off by default.
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_setReducedResolution
+(
+    nitf_ImageReader * iReader, /*!< Object to modify */
+    int enable                  /*!< Enable reduced resolution reads if true */
+);
+
+/*!
+  \brief nitf_ImageReader_getReadCacheStats - Get read cache statistics
+
+  See the documentation for nitf_ImageIO_getReadCacheStats
+
+  \return None
+*/
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats
+(
+    nitf_ImageReader * iReader, /*!< Object to query */
+    nitf_Uint64 * hits,         /*!< Returns the number of cache hits */
+    nitf_Uint64 * misses,       /*!< Returns the number of cache misses */
+    nitf_Uint64 * usedBytes     /*!< Returns the bytes currently cached */
+);
+
 NITF_CXX_ENDGUARD
 
 #endif
@@ -29,6 +29,7 @@
 #define NITF_PLUGIN_HOOK_SUFFIX "_handler"
 #define NITF_PLUGIN_CONSTRUCT_SUFFIX "_construct"
 #define NITF_PLUGIN_DESTRUCT_SUFFIX "_destruct"
+#define NITF_PLUGIN_EXTENDED_INTERFACE_SUFFIX "_getExtendedInterface"
 
 #include "nitf/nitf_config.h"
 #include "nitf/System.h"
@@ -115,6 +116,26 @@ typedef void * (*NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION)
     nitf_Error* error
 );
 
+/*
+  \brief NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION - Function pointer for
+  the optional decompression extensions of a plugin.
+
+  A decompression plugin may export this function, named after the
+  compression type with NITF_PLUGIN_EXTENDED_INTERFACE_SUFFIX appended, to
+  offer the entry points that are not part of the original interface. The
+  return type is void * to avoid a dependency the nitf_ImageIO object. The
+  type is actually nitf_DecompressionExtensions *
+
+  \ar compressionType - Compression type code
+  \ar error           - Error object
+
+  \return Returns the extensions or NULL if there are none.
+*/
+typedef void * (*NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION)
+(
+    const char *compressionType,
+    nitf_Error* error
+);
 
 typedef void * (*NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
 (
@@ -61,6 +61,9 @@ typedef struct _protected_nitf_PluginRegistry
 
     nitf_List* dsos;
 
+    /*  Optional decompression extensions, by compression type  */
+    nitf_HashTable *decompressionExtensions;
+
 }
 nitf_PluginRegistry;
 
@@ -140,6 +143,18 @@ nitf_PluginRegistry_registerDecompressionHandler(
         NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION handler,
         nitf_Error* error);
 
+/*!
+ *  This function allows you to register the optional extensions
+ *  (nitf_DecompressionExtensions) of your own decompression handlers.
+ *  This function will override any extensions that are currently
+ *  registered for the identifier.
+ */
+NITFAPI(NITF_BOOL)
+nitf_PluginRegistry_registerDecompressionExtensions(
+        NITF_PLUGIN_INIT_FUNCTION init,
+        NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION extensions,
+        nitf_Error* error);
+
 /*!
  *  Public function to load the registry with plugins in the given directory.
  *  This will walk the DLL path and search
@@ -249,6 +264,18 @@ nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
 
 
 
+/*!
+ *  Retrieve the optional extensions function a decompression plugin
+ *  exports for ident (see nitf_DecompressionExtensions).
+ *
+ *  \param reg This is the registry
+ *  \param ident  This is the ID (e.g., C8)
+ *  \return The extensions function, or NULL if the plugin has none
+ */
+NITFPROT(NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION)
+nitf_PluginRegistry_retrieveDecompExtensions(nitf_PluginRegistry * reg,
+                                             const char *ident);
+
 NITFPROT(NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
 nitf_PluginRegistry_retrieveCompConstructor(nitf_PluginRegistry * reg,
                                             const char *ident,
@@ -46,6 +46,8 @@ typedef struct _nitf_Reader
     nitf_IOInterface* input;
     nitf_Record *record;
     NITF_BOOL ownInput;
+    NITF_BOOL lazyTREs;
+    NITF_BOOL recordArena;
 
 }
 nitf_Reader;
@@ -64,6 +66,36 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error);
  */
 NITFAPI(void) nitf_Reader_destruct(nitf_Reader ** reader);
 
+/*!
+ *  Choose whether TREs are parsed while the file is read (the default), or
+ *  left as raw bytes to be parsed by their plug-in on first access.  Lazy
+ *  parsing makes opening files with many large TREs cheap when only a few
+ *  of them are ever looked at.  Takes effect on the next read.  A lazy TRE
+ *  is parsed by whichever thread touches it first, so parse any that are
+ *  shared between threads first (see nitf_TRE_parse).
+ *  \param reader The reader object
+ *  \param lazy 1 to defer TRE parsing, 0 to parse while reading
+ */
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader* reader, NITF_BOOL lazy);
+
+/*!
+ *  Choose whether the Fields of each Record read, along with the lists,
+ *  hash tables and TRE data holding them, are allocated from an arena
+ *  owned by the Record, rather than one by one from the heap.  Those
+ *  objects keep using the arena when they grow or are added to later, and
+ *  are never freed one by one: destroying the Record skips them and
+ *  releases the arena in one go, which makes reading and destroying many
+ *  Records a good deal cheaper.  Anything taken from such a Record must
+ *  not outlive it; clone what needs to.  The arena is not threadsafe, so
+ *  such a Record must not be modified from two threads at once.
+ *  nitf_Record_getArenaBytes reports the arena usage.  Takes effect on the
+ *  next read.
+ *  \param reader The reader object
+ *  \param useArena 1 to give each Record an arena, 0 for the heap
+ */
+NITFAPI(void) nitf_Reader_setRecordArena(nitf_Reader* reader,
+                                         NITF_BOOL useArena);
+
 /*!
  *  This is the method for reading information from a NITF (or NSIF).  It
  *  reads all of the support data, including TREs, which it parses
@@ -0,0 +1,46 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2013 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_READER_OPTIONS_H__
+#define __NITF_READER_OPTIONS_H__
+
+#include "nitf/System.h"
+
+NITF_CXX_GUARD
+
+/*
+ * Decompression options, passed to nitf_Reader_newImageReader.  Blocks
+ * are only decoded ahead, on several threads, when the ImageReader has a
+ * read cache budget (nitf_ImageReader_setReadCacheSize) and reads
+ * positionally.
+ */
+
+/* J2K (C8) options, all nitf_Uint32.  1 turns decoding ahead off. */
+#define C8_NUM_DECODE_THREADS_KEY "numDecodeThreads"
+
+/* JPEG (C3/M3) options, all nitf_Uint32.  1 turns decoding ahead off. */
+#define C3_NUM_DECODE_THREADS_KEY "numDecodeThreads"
+
+NITF_CXX_ENDGUARD
+
+#endif
+
@@ -66,6 +66,9 @@ typedef struct _nitf_Record
 
     /* List of reserved segments (RES) */
     nitf_List *reservedExtensions;
+
+    /* Arena holding the objects of a Record filled by the Reader, if any */
+    nitf_Arena *arena;
 }
 nitf_Record;
 
@@ -119,6 +122,17 @@ NITFAPI(void) nitf_Record_destruct(nitf_Record ** record);
 NITFAPI(nitf_Version) nitf_Record_getVersion(const nitf_Record * record);
 
 
+/*!
+ * Returns the number of bytes the Record's objects take up in its arena.
+ * Only a Record read with nitf_Reader_setRecordArena turned on has an
+ * arena; for any other Record this is 0.
+ *
+ * \param record the Record object
+ * \return the bytes allocated from the arena
+ */
+NITFAPI(nitf_Uint64) nitf_Record_getArenaBytes(const nitf_Record * record);
+
+
 /*!
  *  Utility function gets the number of images out of the record.
  *  Just goes into the FHDR and gets out NUMI and converts the
@@ -207,6 +207,18 @@ typedef nrt_DLL             nitf_DLL;
 #define nitf_Mutex_delete   nrt_Mutex_delete
 
 
+/******************************************************************************/
+/* THREAD                                                                     */
+/******************************************************************************/
+#include "nrt/Thread.h"
+typedef nrt_Thread                  nitf_Thread;
+#define NITF_THREAD_RUN_FUNCTION    NRT_THREAD_RUN_FUNCTION
+#define nitf_Thread_construct       nrt_Thread_construct
+#define nitf_Thread_join            nrt_Thread_join
+#define nitf_Thread_destruct        nrt_Thread_destruct
+#define nitf_Thread_getNumCPUs      nrt_Thread_getNumCPUs
+
+
 /******************************************************************************/
 /* DIRECTORY                                                                  */
 /******************************************************************************/
@@ -228,6 +240,7 @@ typedef nrt_Directory                   nitf_Directory;
 
 #define nitf_IOHandle_create    nrt_IOHandle_create
 #define nitf_IOHandle_read      nrt_IOHandle_read
+#define nitf_IOHandle_readAt    nrt_IOHandle_readAt
 #define nitf_IOHandle_write     nrt_IOHandle_write
 #define nitf_IOHandle_seek      nrt_IOHandle_seek
 #define nitf_IOHandle_tell      nrt_IOHandle_tell
@@ -249,11 +262,16 @@ typedef NRT_IO_INTERFACE_GET_SIZE       NITF_IO_INTERFACE_GET_SIZE;
 typedef NRT_IO_INTERFACE_GET_MODE       NITF_IO_INTERFACE_GET_MODE;
 typedef NRT_IO_INTERFACE_CLOSE          NITF_IO_INTERFACE_CLOSE;
 typedef NRT_IO_INTERFACE_DESTRUCT       NITF_IO_INTERFACE_DESTRUCT;
+typedef NRT_IO_INTERFACE_READ_AT        NITF_IO_INTERFACE_READ_AT;
+typedef NRT_IO_INTERFACE_GET_BUFFER     NITF_IO_INTERFACE_GET_BUFFER;
 
 typedef nrt_IIOInterface                nitf_IIOInterface;
 typedef nrt_IOInterface                 nitf_IOInterface;
 
 #define nitf_IOInterface_read           nrt_IOInterface_read
+#define nitf_IOInterface_readAt         nrt_IOInterface_readAt
+#define nitf_IOInterface_canReadAt      nrt_IOInterface_canReadAt
+#define nitf_IOInterface_getBuffer      nrt_IOInterface_getBuffer
 #define nitf_IOInterface_write          nrt_IOInterface_write
 #define nitf_IOInterface_canSeek        nrt_IOInterface_canSeek
 #define nitf_IOInterface_seek           nrt_IOInterface_seek
@@ -265,6 +283,8 @@ typedef nrt_IOInterface                 nitf_IOInterface;
 #define nitf_IOHandleAdapter_construct  nrt_IOHandleAdapter_construct
 #define nitf_IOHandleAdapter_open       nrt_IOHandleAdapter_open
 #define nitf_BufferAdapter_construct    nrt_BufferAdapter_construct
+#define nitf_MMapAdapter_construct      nrt_MMapAdapter_construct
+#define nitf_MMapAdapter_open           nrt_MMapAdapter_open
 
 
 /******************************************************************************/
@@ -384,6 +404,22 @@ typedef nrt_IntStack                nitf_IntStack;
 #define NITF_INT_STACK_DEPTH        NRT_INT_STACK_DEPTH
 
 
+/******************************************************************************/
+/* ARENA                                                                      */
+/******************************************************************************/
+#include "nrt/Arena.h"
+typedef nrt_Arena                   nitf_Arena;
+
+#define nitf_Arena_construct        nrt_Arena_construct
+#define nitf_Arena_destruct         nrt_Arena_destruct
+#define nitf_Arena_malloc           nrt_Arena_malloc
+#define nitf_Arena_contains         nrt_Arena_contains
+#define nitf_Arena_getBytesUsed     nrt_Arena_getBytesUsed
+#define nitf_Arena_getBytesReserved nrt_Arena_getBytesReserved
+#define nitf_Arena_setCurrent       nrt_Arena_setCurrent
+#define nitf_Arena_getCurrent       nrt_Arena_getCurrent
+
+
 /******************************************************************************/
 /* TREE                                                                       */
 /******************************************************************************/
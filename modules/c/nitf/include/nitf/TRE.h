@@ -302,6 +302,12 @@ typedef struct _nitf_TREHandler
      * the type that the plug-in handles
      */
     NITF_DATA* data;
+
+    /* The read programs nitf_TREUtils_createBasicHandler compiled for data,
+     * so nitf_TREUtils_basicRead finds them without a search or a lock.
+     * Other handlers leave this NULL.
+     */
+    NITF_DATA* programs;
 } nitf_TREHandler;
 
 
@@ -430,6 +436,46 @@ NITFAPI(int) nitf_TRE_getCurrentSize(nitf_TRE* tre, nitf_Error* error);
  */
 NITFAPI(const char*) nitf_TRE_getID(nitf_TRE* tre);
 
+/*!
+ *  Read the raw bytes of a TRE without parsing them (for Reader).  The
+ *  TRE keeps its tag and data, and is handed to its plug-in handler the
+ *  first time one of its fields is requested.  Until then its size is
+ *  the length read, and writing it puts back the original bytes.
+ *
+ *  The first access swaps the TRE's handler and private data without any
+ *  locking, so a lazy TRE must not be touched from more than one thread
+ *  until it has been parsed.  Call nitf_TRE_parse before sharing it.
+ *  \param tre The TRE skeleton
+ *  \param io The IO interface, positioned at the TRE data
+ *  \param length The length of the TRE data
+ *  \param record The record being read, handed to the plug-in's read
+ *  \param error The error to populate on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE on error
+ */
+NITFPROT(NITF_BOOL) nitf_TRE_readLazy(nitf_TRE* tre,
+                                      nitf_IOInterface* io,
+                                      nitf_Uint32 length,
+                                      struct _nitf_Record* record,
+                                      nitf_Error* error);
+
+/*!
+ *  Returns 1 unless the TRE was read lazily and has not been touched yet
+ *  \param tre The TRE
+ */
+NITFAPI(NITF_BOOL) nitf_TRE_isParsed(nitf_TRE* tre);
+
+/*!
+ *  Parse a lazily read TRE now, rather than on first access.  Does nothing
+ *  if the TRE is already parsed.  If the plug-in cannot parse the data,
+ *  the TRE falls back to the raw handler, as it would in the Reader.  If
+ *  that fails too the TRE stays unparsed and every later access fails
+ *  with the same error, without parsing again.
+ *  \param tre The TRE
+ *  \param error The error to populate on failure
+ *  \return NITF_SUCCESS, or NITF_FAILURE on error
+ */
+NITFAPI(NITF_BOOL) nitf_TRE_parse(nitf_TRE* tre, nitf_Error* error);
+
 
 NITF_CXX_ENDGUARD
 
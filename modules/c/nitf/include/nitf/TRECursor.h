@@ -60,7 +60,8 @@ nitf_TRECursor;
 
 
 /*!
- *  Initializes the cursor
+ *  Initializes the cursor.  A lazily read TRE is parsed first, and if
+ *  that fails the cursor has no TRE and iterating it fails.
  *
  *  \param tre The input TRE
  *  \return A cursor for the TRE
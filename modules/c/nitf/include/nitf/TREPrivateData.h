@@ -40,6 +40,8 @@ typedef struct _nitf_TREPrivateData
     nitf_TREDescription* description;
     nitf_HashTable *hash;
     NITF_DATA *userData;    /*! user-defined - meant for extending this */
+    nitf_Arena *arena;      /* private member, the arena the data was
+                               constructed in, if any */
 } nitf_TREPrivateData;
 
 
@@ -0,0 +1,99 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NITF_TRE_PROGRAM_H__
+#define __NITF_TRE_PROGRAM_H__
+
+#include "nitf/TRE.h"
+#include "nitf/TREDescription.h"
+
+NITF_CXX_GUARD
+
+struct _nitf_TREInstruction;
+
+/*!
+ *  \struct nitf_TREProgram
+ *  \brief A TREDescription compiled for reading
+ *
+ *  Walking a description with a nitf_TRECursor rebuilds every loop tag
+ *  and re-parses every loop count, condition and length expression, for
+ *  every field of every TRE read.  A program does all of that once: each
+ *  description entry becomes an instruction with its jumps, its parsed
+ *  operands and the fields it refers to resolved ahead of time, so a
+ *  read is a single pass over the data.
+ *
+ *  A program is only built for descriptions whose references it can
+ *  resolve exactly; nitf_TREProgram_compile returns NULL for the rest,
+ *  which are read with nitf_TREUtils_parse as before.
+ */
+typedef struct _nitf_TREProgram
+{
+    struct _nitf_TREInstruction *instructions;
+    int numInstructions;
+    int numSlots;           /* Fields other instructions refer to */
+    int *slotDepth;         /* The loop depth of each of them */
+    int fixedLength;        /* The TRE length, if it has no choice, or -1 */
+} nitf_TREProgram;
+
+/*!
+ *  Compile a description
+ *  \param description The description, terminated by NITF_END
+ *  \param error Populated on failure, with NITF_ERR_INVALID_OBJECT if the
+ *  description is one that cannot be compiled
+ *  \return The program, or NULL if the description could not be compiled
+ */
+NITFPROT(nitf_TREProgram *) nitf_TREProgram_compile(
+        nitf_TREDescription * description, nitf_Error * error);
+
+/*!
+ *  Can a TRE of the given length possibly be read with this program?
+ *  \param program The program
+ *  \param length The length of the TRE data
+ */
+NITFPROT(NITF_BOOL) nitf_TREProgram_fits(nitf_TREProgram * program,
+                                         nitf_Uint32 length);
+
+/*!
+ *  Read the fields of a TRE, just as nitf_TREUtils_parse would for the
+ *  description the program was compiled from.  The TRE private data must
+ *  already be set up with that description and the length of the data.
+ *
+ *  \param program The program
+ *  \param tre The TRE
+ *  \param bufptr The TRE data
+ *  \param error Populated on failure
+ *  \return One on success, zero on failure
+ */
+NITFPROT(int) nitf_TREProgram_parse(nitf_TREProgram * program,
+                                    nitf_TRE * tre,
+                                    char *bufptr,
+                                    nitf_Error * error);
+
+/*!
+ *  Destroy a program
+ *  \param program The program, NULL-set on return
+ */
+NITFPROT(void) nitf_TREProgram_destruct(nitf_TREProgram ** program);
+
+NITF_CXX_ENDGUARD
+
+#endif
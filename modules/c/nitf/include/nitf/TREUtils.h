@@ -75,6 +75,13 @@ NITFAPI(nitf_TREHandler*)
                                      nitf_TREHandler *handler,
                                      nitf_Error* error);
 
+/*!
+ *  Free the read programs nitf_TREUtils_createBasicHandler compiled.  The
+ *  plugin registry calls this before it unloads the plugins whose
+ *  descriptions they were compiled from.
+ */
+NITFPROT(void) nitf_TREUtils_freeBasicPrograms(void);
+
 /*!
  * The "basic" functions used by the basic handler.
  * If you're creating your own handler, you can use these for the functions
@@ -29,6 +29,12 @@ NITF_CXX_GUARD
 
 #define C8_COMPRESSION_RATIO_KEY "compressionRatio"
 #define C8_NUM_RESOLUTIONS_KEY   "numResolutions"
+#define C8_NUM_THREADS_KEY       "numThreads"
+
+/* JPEG (C3/M3) options, all nitf_Uint32 */
+#define C3_QUALITY_KEY           "quality"
+#define C3_RESTART_INTERVAL_KEY  "restartInterval"
+#define C3_NUM_THREADS_KEY       "numThreads"
 
 NITF_CXX_ENDGUARD
 
@@ -122,7 +122,8 @@ NITFPRIV(int) ENGRDA_parse(nitf_TRE * tre,
                     prevValueType : cursor.desc_ptr->data_type;
 
             /* construct the field */
-            field = nitf_Field_construct(length, fieldType, error);
+            field = nitf_Field_constructIn(length, fieldType,
+                                           privData->arena, error);
             if (!field)
                 goto CATCH_ERROR;
 
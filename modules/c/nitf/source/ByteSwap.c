@@ -0,0 +1,401 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/ByteSwap.h"
+
+/*
+ *  The x86 kernels are compiled with function target attributes, so the
+ *  library itself is still built for the baseline instruction set and
+ *  only calls them once the CPU has been checked.  Compilers without
+ *  those (and MSVC) get the SSE2 kernels where SSE2 is the baseline.
+ */
+#if (defined(__x86_64__) || defined(__i386__)) && \
+    (defined(__clang__) || (defined(__GNUC__) && __GNUC__ >= 5))
+#   define NITF_BYTE_SWAP_X86_DISPATCH
+#   define NITF_BYTE_SWAP_SSE2_KERNELS
+#   define NITF_BYTE_SWAP_TARGET(isa) __attribute__((target(isa)))
+#   include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#   define NITF_BYTE_SWAP_SSE2_KERNELS
+#   define NITF_BYTE_SWAP_TARGET(isa)
+#   include <emmintrin.h>
+#endif
+
+#if defined(__ARM_NEON) || defined(__ARM_NEON__)
+#   define NITF_BYTE_SWAP_NEON_KERNELS
+#   include <arm_neon.h>
+#endif
+
+typedef void (*NITF_BYTE_SWAP_FUNCTION) (nitf_Uint8 * buffer, size_t count);
+
+typedef struct _ByteSwapKernels
+{
+    NITF_BYTE_SWAP_FUNCTION swap2;
+    NITF_BYTE_SWAP_FUNCTION swap4;
+    NITF_BYTE_SWAP_FUNCTION swap8;
+} ByteSwapKernels;
+
+/*
+ *  The scalar kernels finish off whatever the vector ones leave over.
+ *  memcpy keeps them correct for buffers that are not element aligned
+ *  and compiles to a single load and store.
+ */
+NITFPRIV(void) swap2Scalar(nitf_Uint8 * buffer, size_t count)
+{
+    nitf_Uint16 value;
+    size_t i;
+
+    for (i = 0; i < count; i++, buffer += 2)
+    {
+        memcpy(&value, buffer, 2);
+        value = (nitf_Uint16) ((value << 8) | (value >> 8));
+        memcpy(buffer, &value, 2);
+    }
+}
+
+NITFPRIV(void) swap4Scalar(nitf_Uint8 * buffer, size_t count)
+{
+    nitf_Uint32 value;
+    size_t i;
+
+    for (i = 0; i < count; i++, buffer += 4)
+    {
+        memcpy(&value, buffer, 4);
+        value = (value << 24) | ((value << 8) & 0x00FF0000) |
+                ((value >> 8) & 0x0000FF00) | (value >> 24);
+        memcpy(buffer, &value, 4);
+    }
+}
+
+NITFPRIV(void) swap8Scalar(nitf_Uint8 * buffer, size_t count)
+{
+    nitf_Uint32 high;
+    nitf_Uint32 low;
+    size_t i;
+
+    for (i = 0; i < count; i++, buffer += 8)
+    {
+        memcpy(&high, buffer, 4);
+        memcpy(&low, buffer + 4, 4);
+        swap4Scalar((nitf_Uint8 *) &high, 1);
+        swap4Scalar((nitf_Uint8 *) &low, 1);
+        memcpy(buffer, &low, 4);
+        memcpy(buffer + 4, &high, 4);
+    }
+}
+
+#ifdef NITF_BYTE_SWAP_SSE2_KERNELS
+
+/*
+ *  SSE2 has no byte shuffle, so bytes are swapped within each 16-bit
+ *  word with shifts and the words are then reordered.
+ */
+NITF_BYTE_SWAP_TARGET("sse2")
+NITFPRIV(__m128i) swapWordBytesSSE2(__m128i value)
+{
+    return _mm_or_si128(_mm_slli_epi16(value, 8), _mm_srli_epi16(value, 8));
+}
+
+NITF_BYTE_SWAP_TARGET("sse2")
+NITFPRIV(void) swap2SSE2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        __m128i *p = (__m128i *) (buffer + 2 * i);
+        _mm_storeu_si128(p, swapWordBytesSSE2(_mm_loadu_si128(p)));
+    }
+    swap2Scalar(buffer + 2 * i, count - i);
+}
+
+NITF_BYTE_SWAP_TARGET("sse2")
+NITFPRIV(void) swap4SSE2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        __m128i *p = (__m128i *) (buffer + 4 * i);
+        __m128i value = swapWordBytesSSE2(_mm_loadu_si128(p));
+        value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+        value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(2, 3, 0, 1));
+        _mm_storeu_si128(p, value);
+    }
+    swap4Scalar(buffer + 4 * i, count - i);
+}
+
+NITF_BYTE_SWAP_TARGET("sse2")
+NITFPRIV(void) swap8SSE2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        __m128i *p = (__m128i *) (buffer + 8 * i);
+        __m128i value = swapWordBytesSSE2(_mm_loadu_si128(p));
+        value = _mm_shufflelo_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+        value = _mm_shufflehi_epi16(value, _MM_SHUFFLE(0, 1, 2, 3));
+        _mm_storeu_si128(p, value);
+    }
+    swap8Scalar(buffer + 8 * i, count - i);
+}
+
+#endif
+
+#ifdef NITF_BYTE_SWAP_X86_DISPATCH
+
+/* Byte shuffles for each element size, repeated in every 128-bit lane */
+static const nitf_Uint8 SHUFFLE_2[16] =
+    { 1, 0, 3, 2, 5, 4, 7, 6, 9, 8, 11, 10, 13, 12, 15, 14 };
+static const nitf_Uint8 SHUFFLE_4[16] =
+    { 3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12 };
+static const nitf_Uint8 SHUFFLE_8[16] =
+    { 7, 6, 5, 4, 3, 2, 1, 0, 15, 14, 13, 12, 11, 10, 9, 8 };
+
+/* Shuffle whole vectors, returning the number of bytes done */
+NITF_BYTE_SWAP_TARGET("avx2")
+NITFPRIV(size_t) shuffleAVX2(nitf_Uint8 * buffer, size_t numBytes,
+                             const nitf_Uint8 * shuffle)
+{
+    const __m256i mask = _mm256_broadcastsi128_si256(
+            _mm_loadu_si128((const __m128i *) shuffle));
+    size_t offset;
+
+    for (offset = 0; offset + 32 <= numBytes; offset += 32)
+    {
+        __m256i *p = (__m256i *) (buffer + offset);
+        _mm256_storeu_si256(p, _mm256_shuffle_epi8(_mm256_loadu_si256(p),
+                                                   mask));
+    }
+    return offset;
+}
+
+NITF_BYTE_SWAP_TARGET("avx2")
+NITFPRIV(void) swap2AVX2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX2(buffer, 2 * count, SHUFFLE_2);
+    swap2Scalar(buffer + done, count - done / 2);
+}
+
+NITF_BYTE_SWAP_TARGET("avx2")
+NITFPRIV(void) swap4AVX2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX2(buffer, 4 * count, SHUFFLE_4);
+    swap4Scalar(buffer + done, count - done / 4);
+}
+
+NITF_BYTE_SWAP_TARGET("avx2")
+NITFPRIV(void) swap8AVX2(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX2(buffer, 8 * count, SHUFFLE_8);
+    swap8Scalar(buffer + done, count - done / 8);
+}
+
+NITF_BYTE_SWAP_TARGET("avx512f,avx512bw")
+NITFPRIV(size_t) shuffleAVX512(nitf_Uint8 * buffer, size_t numBytes,
+                               const nitf_Uint8 * shuffle)
+{
+    const __m512i mask = _mm512_broadcast_i32x4(
+            _mm_loadu_si128((const __m128i *) shuffle));
+    size_t offset;
+
+    for (offset = 0; offset + 64 <= numBytes; offset += 64)
+    {
+        void *p = buffer + offset;
+        _mm512_storeu_si512(p, _mm512_shuffle_epi8(_mm512_loadu_si512(p),
+                                                   mask));
+    }
+    return offset;
+}
+
+NITF_BYTE_SWAP_TARGET("avx512f,avx512bw")
+NITFPRIV(void) swap2AVX512(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX512(buffer, 2 * count, SHUFFLE_2);
+    swap2Scalar(buffer + done, count - done / 2);
+}
+
+NITF_BYTE_SWAP_TARGET("avx512f,avx512bw")
+NITFPRIV(void) swap4AVX512(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX512(buffer, 4 * count, SHUFFLE_4);
+    swap4Scalar(buffer + done, count - done / 4);
+}
+
+NITF_BYTE_SWAP_TARGET("avx512f,avx512bw")
+NITFPRIV(void) swap8AVX512(nitf_Uint8 * buffer, size_t count)
+{
+    size_t done = shuffleAVX512(buffer, 8 * count, SHUFFLE_8);
+    swap8Scalar(buffer + done, count - done / 8);
+}
+
+#endif
+
+#ifdef NITF_BYTE_SWAP_NEON_KERNELS
+
+NITFPRIV(void) swap2NEON(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 8 <= count; i += 8)
+    {
+        nitf_Uint8 *p = buffer + 2 * i;
+        vst1q_u8(p, vrev16q_u8(vld1q_u8(p)));
+    }
+    swap2Scalar(buffer + 2 * i, count - i);
+}
+
+NITFPRIV(void) swap4NEON(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 4 <= count; i += 4)
+    {
+        nitf_Uint8 *p = buffer + 4 * i;
+        vst1q_u8(p, vrev32q_u8(vld1q_u8(p)));
+    }
+    swap4Scalar(buffer + 4 * i, count - i);
+}
+
+NITFPRIV(void) swap8NEON(nitf_Uint8 * buffer, size_t count)
+{
+    size_t i;
+
+    for (i = 0; i + 2 <= count; i += 2)
+    {
+        nitf_Uint8 *p = buffer + 8 * i;
+        vst1q_u8(p, vrev64q_u8(vld1q_u8(p)));
+    }
+    swap8Scalar(buffer + 8 * i, count - i);
+}
+
+#endif
+
+/* Indexed by nitf_ByteSwapLevel; levels not built in are left NULL */
+static const ByteSwapKernels KERNELS[NITF_BYTE_SWAP_NUM_LEVELS] =
+{
+    { swap2Scalar, swap4Scalar, swap8Scalar },
+#ifdef NITF_BYTE_SWAP_SSE2_KERNELS
+    { swap2SSE2, swap4SSE2, swap8SSE2 },
+#else
+    { NULL, NULL, NULL },
+#endif
+#ifdef NITF_BYTE_SWAP_X86_DISPATCH
+    { swap2AVX2, swap4AVX2, swap8AVX2 },
+    { swap2AVX512, swap4AVX512, swap8AVX512 },
+#else
+    { NULL, NULL, NULL },
+    { NULL, NULL, NULL },
+#endif
+#ifdef NITF_BYTE_SWAP_NEON_KERNELS
+    { swap2NEON, swap4NEON, swap8NEON }
+#else
+    { NULL, NULL, NULL }
+#endif
+};
+
+static const char *LEVEL_NAMES[NITF_BYTE_SWAP_NUM_LEVELS] =
+{
+    "Scalar", "SSE2", "AVX2", "AVX-512", "NEON"
+};
+
+/*
+ *  The level in use, or -1 until the first call picks one.  Picking is
+ *  idempotent, so threads racing to do it all store the same value.
+ */
+static int currentLevel = -1;
+
+NITFAPI(NITF_BOOL) nitf_ByteSwap_isSupported(nitf_ByteSwapLevel level)
+{
+    if ((int) level < 0 || level >= NITF_BYTE_SWAP_NUM_LEVELS ||
+        !KERNELS[level].swap2)
+        return NITF_FAILURE;
+
+#ifdef NITF_BYTE_SWAP_X86_DISPATCH
+    __builtin_cpu_init();
+    switch (level)
+    {
+        case NITF_BYTE_SWAP_SSE2:
+            return __builtin_cpu_supports("sse2") ? NITF_SUCCESS
+                                                  : NITF_FAILURE;
+        case NITF_BYTE_SWAP_AVX2:
+            return __builtin_cpu_supports("avx2") ? NITF_SUCCESS
+                                                  : NITF_FAILURE;
+        case NITF_BYTE_SWAP_AVX512:
+            return (__builtin_cpu_supports("avx512f") &&
+                    __builtin_cpu_supports("avx512bw")) ? NITF_SUCCESS
+                                                        : NITF_FAILURE;
+        default:
+            break;
+    }
+#endif
+    return NITF_SUCCESS;
+}
+
+NITFAPI(nitf_ByteSwapLevel) nitf_ByteSwap_getLevel(void)
+{
+    int level = currentLevel;
+
+    if (level < 0)
+    {
+        for (level = NITF_BYTE_SWAP_NUM_LEVELS - 1; level > 0; --level)
+        {
+            if (nitf_ByteSwap_isSupported((nitf_ByteSwapLevel) level))
+                break;
+        }
+        currentLevel = level;
+    }
+    return (nitf_ByteSwapLevel) level;
+}
+
+NITFAPI(NITF_BOOL) nitf_ByteSwap_setLevel(nitf_ByteSwapLevel level)
+{
+    if (!nitf_ByteSwap_isSupported(level))
+        return NITF_FAILURE;
+
+    currentLevel = (int) level;
+    return NITF_SUCCESS;
+}
+
+NITFAPI(const char *) nitf_ByteSwap_getLevelName(nitf_ByteSwapLevel level)
+{
+    if ((int) level < 0 || level >= NITF_BYTE_SWAP_NUM_LEVELS)
+        return "Unknown";
+    return LEVEL_NAMES[level];
+}
+
+NITFAPI(void) nitf_ByteSwap_swap2(nitf_Uint8 * buffer, size_t count)
+{
+    KERNELS[nitf_ByteSwap_getLevel()].swap2(buffer, count);
+}
+
+NITFAPI(void) nitf_ByteSwap_swap4(nitf_Uint8 * buffer, size_t count)
+{
+    KERNELS[nitf_ByteSwap_getLevel()].swap4(buffer, count);
+}
+
+NITFAPI(void) nitf_ByteSwap_swap8(nitf_Uint8 * buffer, size_t count)
+{
+    KERNELS[nitf_ByteSwap_getLevel()].swap8(buffer, count);
+}
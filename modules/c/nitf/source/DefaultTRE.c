@@ -126,7 +126,8 @@ NITFPRIV(NITF_BOOL) defaultRead(nitf_IOInterface *io,
     if (!success)
         goto CATCH_ERROR;
 
-    field = nitf_Field_construct(length, NITF_BINARY, error);
+    field = nitf_Field_constructIn(length, NITF_BINARY,
+            ((nitf_TREPrivateData*)tre->priv)->arena, error);
     if (field == NULL)
     {
         goto CATCH_ERROR;
@@ -296,7 +297,8 @@ NITFPRIV(NITF_BOOL) defaultSetField(nitf_TRE * tre,
         return NITF_FAILURE;
 	}
 
-	field = nitf_Field_construct(dataLength, NITF_BINARY, error);
+	field = nitf_Field_constructIn(dataLength, NITF_BINARY,
+	        ((nitf_TREPrivateData*)tre->priv)->arena, error);
     if (!field)
         return NITF_FAILURE;
 
@@ -408,7 +410,8 @@ NITFAPI(nitf_TREHandler*) nitf_DefaultTRE_handler(nitf_Error * error)
         defaultGetCurrentSize,
         defaultClone,
         defaultDestruct,
-        NULL    /* data - We don't need this! */
+        NULL,   /* data - We don't need this! */
+        NULL    /* programs */
     };
 
     return &handler;
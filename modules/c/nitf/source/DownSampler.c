@@ -1071,3 +1071,9 @@ NITFAPI(nitf_DownSampler *) nitf_Select2DownSample_construct(nitf_Uint32
     downsampler->iface = &iSelect2DownSample;
     return downsampler;
 }
+
+NITFAPI(NITF_BOOL) nitf_DownSampler_isDecimating(nitf_DownSampler *
+                                                 downsampler)
+{
+    return downsampler->iface->apply == &PixelSkip_apply;
+}
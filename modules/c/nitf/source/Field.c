@@ -52,9 +52,35 @@ NITF_BOOL copyAndFillZeros(nitf_Field * field,
     return NITF_SUCCESS;
 }
 
-NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
-        nitf_FieldType type,
-        nitf_Error * error)
+/*
+ *  A field built in an arena takes its raw data from that arena for as
+ *  long as it lives, so it never holds heap memory and freeing it is a
+ *  no-op.  Everything else uses the heap.
+ */
+NITFPRIV(char *) allocRaw(nitf_Field * field, size_t size,
+                          nitf_Error * error)
+{
+    char *raw;
+    if (field->arena)
+        return (char *) nitf_Arena_malloc(field->arena, size, error);
+
+    raw = (char *) NITF_MALLOC(size);
+    if (!raw)
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+    return raw;
+}
+
+NITFPRIV(void) freeRaw(nitf_Field * field, char *raw)
+{
+    if (!field->arena)
+        NITF_FREE(raw);
+}
+
+NITFPRIV(nitf_Field *) constructField(size_t length,
+                                      nitf_FieldType type,
+                                      nitf_Arena * arena,
+                                      nitf_Error * error)
 {
     nitf_Field *field = NULL;
 
@@ -65,18 +91,29 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
         goto CATCH_ERROR;
     }
 
-    field = (nitf_Field *) NITF_MALLOC(sizeof(nitf_Field));
-    if (!field)
+    if (arena)
     {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                        NITF_CTXT, NITF_ERR_MEMORY);
-        goto CATCH_ERROR;
+        field = (nitf_Field *) nitf_Arena_malloc(arena, sizeof(nitf_Field),
+                                                 error);
+        if (!field)
+            goto CATCH_ERROR;
+    }
+    else
+    {
+        field = (nitf_Field *) NITF_MALLOC(sizeof(nitf_Field));
+        if (!field)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
     }
 
     field->type = type;
     field->raw = NULL;
     field->length = 0; /* this gets set by resizeField */
     field->resizable = 1; /* set to 1 so we can use the resize code */
+    field->arena = arena;
 
     if (!nitf_Field_resizeField(field, length, error))
         goto CATCH_ERROR;
@@ -90,6 +127,22 @@ NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
       return NULL;
 }
 
+NITFAPI(nitf_Field *) nitf_Field_construct(size_t length,
+        nitf_FieldType type,
+        nitf_Error * error)
+{
+    return constructField(length, type, nitf_Arena_getCurrent(), error);
+}
+
+
+NITFPROT(nitf_Field *) nitf_Field_constructIn(size_t length,
+        nitf_FieldType type,
+        nitf_Arena * arena,
+        nitf_Error * error)
+{
+    return constructField(length, type, arena, error);
+}
+
 
 NITFAPI(NITF_BOOL) nitf_Field_setRawData(nitf_Field * field,
         NITF_DATA * data,
@@ -525,13 +578,13 @@ NITFAPI(void) nitf_Field_destruct(nitf_Field ** field)
 {
     if (*field)
     {
-        if ((*field)->raw)
+        /* arena memory, raw data included, goes away with the arena */
+        if (!(*field)->arena)
         {
-            NITF_FREE((*field)->raw);
-            (*field)->raw = NULL;
+            if ((*field)->raw)
+                NITF_FREE((*field)->raw);
+            NITF_FREE(*field);
         }
-
-        NITF_FREE(*field);
         *field = NULL;
     }
 }
@@ -551,8 +604,9 @@ NITFAPI(nitf_Field *) nitf_Field_clone(nitf_Field * source,
 
     if (source)
     {
-        /* construct new one */
-        field = nitf_Field_construct(source->length, source->type, error);
+        /* construct new one, always on the heap so it can outlive the
+         * source's arena */
+        field = constructField(source->length, source->type, NULL, error);
         if (field)
         {
             field->resizable = source->resizable;
@@ -1020,12 +1074,10 @@ NITFPROT(NITF_BOOL) nitf_Field_resetLength(nitf_Field * field,
         /* remember old data */
         raw = field->raw;
 
-        field->raw = (char *) NITF_MALLOC(newLength + 1);
+        field->raw = allocRaw(field, newLength + 1, error);
         if (!field->raw)
         {
             field->raw = raw;
-            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                            NITF_CTXT, NITF_ERR_MEMORY);
             return 0;
         }
 
@@ -1061,7 +1113,7 @@ NITFPROT(NITF_BOOL) nitf_Field_resetLength(nitf_Field * field,
         }
 
         /* free the old memory */
-        NITF_FREE(raw);
+        freeRaw(field, raw);
     }
     else
     {
@@ -1111,18 +1163,14 @@ NITFAPI(NITF_BOOL) nitf_Field_resizeField(nitf_Field *field,
     if (field && newLength != field->length)
     {
         if (field->raw)
-            NITF_FREE(field->raw);
+            freeRaw(field, field->raw);
 
         field->raw = NULL;
 
         /* re-malloc */
-        field->raw = (char *) NITF_MALLOC(newLength + 1);
+        field->raw = allocRaw(field, newLength + 1, error);
         if (!field->raw)
-        {
-            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                            NITF_CTXT, NITF_ERR_MEMORY);
             goto CATCH_ERROR;
-        }
 
         /* set the new length */
         field->length = newLength;
@@ -20,7 +20,11 @@
  *
  */
 
+#include <stddef.h>
+
 #include "nitf/ImageIO.h"
+#include "nitf/ByteSwap.h"
+#include "nitf/PluginRegistry.h"
 
 
 /*!
@@ -135,6 +139,14 @@ compression of a one byte unsigned image.\n
    in bytes */
 #define NITF_IMAGE_IO_PAD_MAX_LENGTH (16)
 
+/*! \def NITF_IMAGE_IO_PLAN_MAX_GAP - Planned reads read through gaps of up
+   to this many bytes between pieces of the request rather than seek */
+#define NITF_IMAGE_IO_PLAN_MAX_GAP ((nitf_Uint64) 64 * 1024)
+
+/*! \def NITF_IMAGE_IO_PLAN_MAX_RUN - Largest single read, in bytes, made by
+   coalescing pieces of a planned read */
+#define NITF_IMAGE_IO_PLAN_MAX_RUN ((nitf_Uint64) 8 * 1024 * 1024)
+
 /*!
   \def NITF_IMAGE_IO_PAD_SCANNER - Macro to a create pad scan function
 
@@ -449,6 +461,64 @@ typedef struct
 }
 _nitf_ImageIOBlockCacheControl;
 
+/*!
+  \brief _nitf_ImageIOReadCacheEntry - Read cache entry
+
+  One block held by the read cache. The decompressed flag records whether
+  the buffer was returned by the decompression plugin's readBlock function
+  (and must be released with its freeBlock function) or was allocated here
+  for a raw uncompressed block.
+
+  The lastUse field is the value of the cache clock the last time the
+  entry was referenced and is used to select the least recently used entry
+  for eviction.
+*/
+
+typedef struct
+{
+    nitf_Uint32 number;         /*!< Block number */
+    NITF_BOOL decompressed;     /*!< Buffer owned by the decompressor */
+    nitf_Uint8 *block;          /*!< Block buffer */
+    nitf_Uint64 size;           /*!< Block buffer size in bytes */
+    nitf_Uint64 lastUse;        /*!< Cache clock at last reference */
+}
+_nitf_ImageIOReadCacheEntry;
+
+/*!
+  \brief _nitf_ImageIOReadCache - Read block cache
+
+  The _nitf_ImageIOReadCache structure manages the LRU block cache used by
+  the cached reader and by direct block reads.
+
+  Blocks are keyed by block number. For band sequential images (IMODE S)
+  each band has its own block numbers, so the key includes the band. For
+  other blocking modes a block contains all bands.
+
+  The cache holds as many blocks as fit in maxBytes. A maxBytes of zero
+  selects the original behavior, a cache of exactly one block. At least one
+  block is always retained, even if it exceeds the budget.
+
+  The index array maps block numbers to entries (NITF_IMAGE_IO_NO_BLOCK if
+  the block is not cached), so hits are resolved without a search. The
+  array is allocated on the first cache access since the total block count
+  is not final until the blocking information has been read.
+*/
+
+typedef struct
+{
+    nitf_Uint64 maxBytes;       /*!< Byte budget, zero for one block */
+    nitf_Uint64 usedBytes;      /*!< Bytes currently held */
+    nitf_Uint32 numEntries;     /*!< Number of entries in use */
+    nitf_Uint32 allocEntries;   /*!< Number of entries allocated */
+    _nitf_ImageIOReadCacheEntry *entries;       /*!< Cache entries */
+    nitf_Uint32 *index;         /*!< Block number to entry index */
+    nitf_Uint32 indexLength;    /*!< Length of the index array */
+    nitf_Uint64 clock;          /*!< LRU clock */
+    nitf_Uint64 hits;           /*!< Number of cache hits */
+    nitf_Uint64 misses;         /*!< Number of cache misses */
+}
+_nitf_ImageIOReadCache;
+
 /*!
   \brief _nitf_ImageIO - Object private data structure
 
@@ -473,6 +543,12 @@ table that points past the last block. This entry facilitates calculating
 the block size by subtracting the offset  of the current and next block.
 The extra entry avoids making the last block a special case. This
 calculation is used to read compressed blocks.
+
+Reads may be issued concurrently from several threads. Each read has its
+own control structures, the lock serializes the one-time set-up (masks,
+decompressor start), the read block cache, the decompressor and file
+access. The activeReads count replaces the read control pointer as the
+"read in progress" indication checked by write operations.
 */
 
 typedef struct
@@ -499,17 +575,23 @@ typedef struct
     nitf_Uint64 dataLength;     /*!< Length of the data including masks */
     /*!< Configuration parameters */
     _nitf_ImageIOParameters parameters;
-    /*!< Block control */
-    _nitf_ImageIOBlockCacheControl blockControl;
+    /*!< Read block cache */
+    _nitf_ImageIOReadCache readCache;
     /*!< Compression handler function */
     nitf_CompressionInterface *compressor;
     /*!< Decompression handler function */
     nitf_DecompressionInterface *decompressor;
+    /*!< Optional decompressor prefetch, from its extensions */
+    NITF_DECOMPRESSION_INTERFACE_PREFETCH_BLOCKS_FUNCTION prefetchBlocks;
+    /*!< Optional decompressor reduced resolution read, from its extensions */
+    NITF_DECOMPRESSION_INTERFACE_READ_REDUCED_FUNCTION readReduced;
     /*!< Compression control object */
     nitf_CompressionControl *compressionControl;
     /*!< Decompression control object */
     nitf_DecompressionControl *decompressionControl;
     int cachedWriteFlag;        /*!< Using caching writes if TRUE */
+    /*!< Decode pixel skip requests at a reduced resolution if TRUE */
+    int reducedResolutionFlag;
     /*!< Block and pad mask header */
     _nitf_ImageIO_MaskHeader maskHeader;
     nitf_Uint64 *blockMask;     /*!< Block mask */
@@ -518,8 +600,10 @@ typedef struct
     int oneBand;                /*!< Read/write one band at a time if TRUE */
     /*!< Control structure for current write */
     struct _nitf_ImageIOWriteControl_s *writeControl;
-    /*!< Control structure for current read */
-    struct _nitf_ImageIOReadControl_s *readControl;
+    /*!< Number of reads in progress */
+    nitf_Uint32 activeReads;
+    /*!< Serializes access to shared state by concurrent reads */
+    nitf_Mutex lock;
     _NITF_IMAGE_IO_PAD_SCAN_FUNC padScanner; /*! Scans for pad pixels in write */
     /*! Total blocks written to disk */
     nitf_Int64 totalBlocksWritten;
@@ -889,6 +973,24 @@ typedef struct _nitf_ImageIOReadControl_s
 }
 _nitf_ImageIOReadControl;
 
+/*!
+  \brief _nitf_ImageIOReadSegment - One piece of a planned read
+
+  A planned read (see nitf_ImageIO_readPlanned) first lists every piece of
+  the file the request needs, for all bands, and where in the user buffers
+  each piece goes. Pieces that continue the previous one in both the file
+  and the user buffer are merged as they are listed, so a sub-window as
+  wide as the block is one piece per block and band.
+*/
+
+typedef struct
+{
+    nitf_Uint64 fileOffset;     /*!< Offset of the data in the file */
+    size_t count;               /*!< Byte count */
+    nitf_Uint8 *user;           /*!< Destination in the user buffer */
+}
+_nitf_ImageIOReadSegment;
+
 /*!
   \brief nitf_ImageIO_BPixelControl - The actual implementation beneath the
   opaque decompression control pointer
@@ -911,9 +1013,6 @@ typedef struct _nitf_ImageIO_BPixelControl
 
     /*! Size of compressed block in bytes */
     size_t blockSizeCompressed;
-
-    /*! Buffer for compressed block */
-    nitf_Uint8 *buffer;
 }
 nitf_ImageIO_BPixelControl;
 
@@ -945,9 +1044,6 @@ typedef struct _nitf_ImageIO_12PixelControl
 
     /*! Size of compressed block in bytes */
     size_t blockSizeCompressed;
-
-    /*! Buffer for compressed block */
-    nitf_Uint8 *buffer;
 }
 nitf_ImageIO_12PixelControl;
 
@@ -1050,6 +1146,14 @@ NITFPRIV(int) nitf_ImageIO_decodeBlockingMode(_nitf_ImageIO* nitf,
 NITFPRIV(void) nitf_ImageIO_revertOptimizedModes(_nitf_ImageIO *nitfI,
                                                  int numBands);
 
+/*!
+ * Checks whether nitf_ImageIO_revertOptimizedModes would change the mode.
+ * \param nitfI        the ImageIO structure
+ * \param numBands    the number of bands (when reading), or 0 when writing.
+ */
+NITFPRIV(NITF_BOOL) nitf_ImageIO_needsRevert(_nitf_ImageIO *nitfI,
+                                             int numBands);
+
 
 /*!
   \brief nitf_ImageIO_setIO - Set the reader and writer functions
@@ -1640,6 +1744,88 @@ NITFPRIV(int) nitf_ImageIO_checkSubWindow(_nitf_ImageIO * nitf,
                                           nitf_Error * error    /*!< Error object */
                                          );
 
+/*!
+  \brief nitf_ImageIO_prefetchBlocks - Hand the decompressor the blocks of
+  a request
+
+  nitf_ImageIO_prefetchBlocks builds the list of blocks that cover a
+  (checked) sub-window and passes it to the decompression plugin's
+  prefetchBlocks function, if it has one, so the plugin can decode them
+  before they are read. Nothing is done for uncompressed images.
+
+  Blocks already in the read cache are left out, and the list stops at as
+  many blocks as the cache budget holds, since blocks decoded beyond that
+  would be evicted before they are used. With the default one block cache
+  nothing is prefetched.
+
+  The function takes the object lock itself. As with readBlock, the
+  plugin is called without the lock when the IO interface reads
+  positionally.
+
+\b Note:
+
+This is an internal function and is not intended to be called
+directly by the user.
+
+\return Returns FALSE on error (NITF_BOOL)
+
+On error, the supplied error object is set.
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_prefetchBlocks(_nitf_ImageIO * nitf,
+                                                nitf_IOInterface * io,
+                                                nitf_SubWindow * subWindow,
+                                                nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_setDecompressionExtensions - Look up the optional
+  entry points of the decompressor
+
+  nitf_ImageIO_setDecompressionExtensions asks the plugin registry for the
+  extensions exported for the image's compression type and sets the
+  object's prefetchBlocks and readReduced from them. A table that extends a
+  different interface than the object's decompressor is ignored, as is any
+  member past the size the plugin was built with. Without extensions both
+  are NULL.
+
+\b Note:
+
+This is an internal function and is not intended to be called
+directly by the user.
+
+\return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_setDecompressionExtensions(_nitf_ImageIO * nitf,
+                                                      const char *compression);
+
+/*!
+  \brief nitf_ImageIO_readReduced - Read a down-sampled sub-window at a
+  reduced resolution
+
+  nitf_ImageIO_readReduced serves a (checked) request that is down-sampled
+  by a power of two with a pixel skip down-sampler via the decompression
+  plugin's readReduced function, if it has one and reduced resolution reads
+  were enabled with nitf_ImageIO_setReducedResolution. The plugin decodes
+  only the matching resolution level, rather than every block at full
+  resolution. The start of the sub-window must be a multiple of the skip.
+
+  The caller must hold the object lock.
+
+\b Note:
+
+This is an internal function and is not intended to be called
+directly by the user.
+
+\return Returns TRUE if the request was read, FALSE if it has to be read
+the usual way (NITF_BOOL)
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readReduced(_nitf_ImageIO * nitf,
+                                             nitf_SubWindow * subWindow,
+                                             nitf_Uint8 ** user,
+                                             int *padded);
+
 /*!
   \brief nitf_ImageIO_checkOneRead - Check for single read case
 
@@ -1676,6 +1862,22 @@ No compression (for now)
 NITFPRIV(NITF_BOOL) nitf_ImageIO_checkOneRead(_nitf_ImageIO * nitfI,
         NITF_BOOL all);
 
+/*!
+  \brief nitf_ImageIO_checkReadPlan - Check for a planned read
+
+  nitf_ImageIO_checkReadPlan checks whether a request can be done as a
+  planned read (see nitf_ImageIO_readPlanned). That is the case for
+  uncompressed band sequential ("S") and band interleaved by block ("B")
+  images read at full resolution.
+
+  \return TRUE if the request can be planned
+*/
+
+/*!< The NITF object internal data */
+/*!< The request */
+NITFPRIV(NITF_BOOL) nitf_ImageIO_checkReadPlan(_nitf_ImageIO * nitfI,
+        nitf_SubWindow * subWindow);
+
 /*!
   \brief nitf_ImageIO_mkMasks - Make the block and pad pixel masks
 
@@ -1868,6 +2070,63 @@ NITFPRIV(int) nitf_ImageIO_readRequestDownSample(_nitf_ImageIOControl * cntl, ni
         nitf_Error * error     /*!< Error object */
                                                 );
 
+/*!
+  \brief nitf_ImageIO_readPlanned - Do the read request as a planned read
+
+  nitf_ImageIO_readPlanned reads all of the bands of a request in one pass.
+  Rather than read each band of each row separately, it lists the file
+  offsets of all the data in a row of blocks, for every band, sorts them,
+  and coalesces pieces that are adjacent or separated by small gaps into
+  single reads. The data is read straight into the user buffers when a
+  read is a single piece, and through a staging buffer otherwise. Each
+  band is unformatted once, after all of it has been read.
+
+  The cntl argument must be set up for all requested bands.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+directly by the user.
+
+On error, FALSE is returned and error is set.
+
+Possible errors include:
+
+Memory allocation error
+I/O error
+*/
+
+/*!< The control structure */
+/*!< I/O handle */
+NITFPRIV(int) nitf_ImageIO_readPlanned(_nitf_ImageIOControl * cntl,
+                                       nitf_IOInterface* io,
+                                       nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_readSegments - Read the pieces of a planned read
+
+  nitf_ImageIO_readSegments sorts the listed pieces of a planned read by
+  file offset and reads them, coalescing neighbors into single reads. The
+  staging buffer is grown as needed and kept by the caller between calls.
+
+  \return FALSE is returned on error and the error object is set
+*/
+
+/*!< The control structure */
+/*!< I/O handle */
+/*!< The pieces */
+/*!< Number of pieces */
+/*!< Staging buffer */
+/*!< Staging buffer size in bytes */
+/*!< Error object */
+NITFPRIV(int) nitf_ImageIO_readSegments(_nitf_ImageIOControl * cntl,
+                                        nitf_IOInterface* io,
+                                        _nitf_ImageIOReadSegment * segments,
+                                        size_t numSegments,
+                                        nitf_Uint8 ** staging,
+                                        size_t * stagingSize,
+                                        nitf_Error * error);
+
 /*!
   \brief nitf_ImageIO_allocatePad - Allocate pad pixel buffer
 
@@ -1920,6 +2179,11 @@ NITFPRIV(int) nitf_ImageIO_readPad(_nitf_ImageIOBlock * blockIO,
   nitf_ImageIO_readFromFile reads data from a file at a specified offset.
   This function is used any time data must be read from a file.
 
+  The read is positional (nitf_IOInterface_readAt). If the interface does
+  not implement readAt natively, the read falls back on a seek and read,
+  and concurrent callers must hold the ImageIO lock (see
+  nitf_ImageIO_lockFileRead).
+
   \b Note:
 
   This is an internal function and is not intended to be called
@@ -1939,6 +2203,31 @@ NITFPRIV(int) nitf_ImageIO_readFromFile(nitf_IOInterface* io, nitf_Uint64 fileOf
                                         nitf_Error * errorBuffer        /*!< Error object */
                                        );
 
+/*!
+  \brief nitf_ImageIO_lockFileRead - Serialize a file read if required
+
+  nitf_ImageIO_lockFileRead acquires the ImageIO lock before a call to
+  nitf_ImageIO_readFromFile when the IO interface has no native positional
+  read, since the fallback seek and read share the interface's offset.
+  With a native readAt, file reads proceed without the lock.
+
+  nitf_ImageIO_unlockFileRead releases the lock taken by
+  nitf_ImageIO_lockFileRead, if any.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+  directly by the user.
+
+\return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_lockFileRead(_nitf_ImageIO * nitf,
+                                         nitf_IOInterface* io);
+
+NITFPRIV(void) nitf_ImageIO_unlockFileRead(_nitf_ImageIO * nitf,
+                                           nitf_IOInterface* io);
+
 /*!
   \brief nitf_ImageIO_writeToFile - Write data to a file
 
@@ -2085,6 +2374,121 @@ I/O errors
 int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO, nitf_IOInterface* io, nitf_Error * error      /*!< Error object */
                              );
 
+/*!
+  \brief nitf_ImageIO_getCachedBlock - Get a block through the read cache
+
+  nitf_ImageIO_getCachedBlock returns the buffer for the requested block,
+  reading or decompressing it on a cache miss. On a miss the least recently
+  used blocks are evicted until the new block fits in the cache budget.
+
+  The returned buffer remains valid until the block is evicted. The caller
+  must hold the object's lock. When the IO interface supports positional
+  reads the lock is released while the block is read and decompressed and
+  is held again on return.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+the user.
+
+\return Returns NULL on error
+
+On error, the error object is set. Possible errors include:
+
+Memory allocation error
+I/O errors
+Decompression errors
+*/
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_getCachedBlock(_nitf_ImageIO * nitf,
+                                                   nitf_IOInterface* io,
+                                                   nitf_Uint32 blockNumber,
+                                                   nitf_Uint64 * blockSize,
+                                                   nitf_Error * error);
+
+/*!
+  \brief nitf_ImageIO_getMappedBlock - Get a block in place from memory
+
+  nitf_ImageIO_getMappedBlock returns a pointer to the requested block
+  inside the IO interface's own storage (see nitf_IOInterface_getBuffer),
+  avoiding both the read and the copy into a block buffer. This only
+  applies to uncompressed blocks present in the file, with no pixel
+  packing, and only when the IO interface is addressable in memory (e.g.
+  the memory map adapter). The lock is not required.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called
+  directly by the user.
+
+\return The block or NULL if the block is not available in place
+*/
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_getMappedBlock(_nitf_ImageIO * nitf,
+                                                   nitf_IOInterface* io,
+                                                   nitf_Uint32 blockNumber,
+                                                   nitf_Uint64 * blockSize);
+
+/*!
+  \brief nitf_ImageIO_trimReadCache - Evict blocks from the read cache
+
+  nitf_ImageIO_trimReadCache evicts least recently used blocks until
+  \b reserve additional bytes will fit in the budget. With a budget of
+  zero (single block cache) any non-zero reserve empties the cache.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+the user.
+
+\return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_trimReadCache(_nitf_ImageIO * nitf,
+                                          nitf_Uint64 reserve);
+
+/*!
+  \brief nitf_ImageIO_freeReadCache - Free the read cache
+
+  nitf_ImageIO_freeReadCache evicts all blocks from the read cache and frees
+  its tables. The budget and statistics are retained.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+the user.
+
+\return None
+*/
+
+NITFPRIV(void) nitf_ImageIO_freeReadCache(_nitf_ImageIO * nitf);
+
+/*!
+  \brief nitf_ImageIO_readSubWindow - Read a sub-window
+
+  nitf_ImageIO_readSubWindow does the work of nitf_ImageIO_read once the
+  shared set-up is complete. All per-request state is kept in control
+  structures owned by the call, so it may run concurrently with other reads
+  of the same object.
+
+  \b Note:
+
+  This is an internal function and is not intended to be called directly by
+the user.
+
+\return Returns FALSE on error
+
+On error, the error object is set.
+*/
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readSubWindow(_nitf_ImageIO * nitfI,
+                                               nitf_IOInterface* io,
+                                               nitf_SubWindow * subWindow,
+                                               nitf_Uint8 ** user,
+                                               int *padded,
+                                               nitf_Error * error);
+
+
 /*!
   \brief nitf_ImageIO_uncachedWriter - Write pixel data to a file without
    block caching
@@ -3153,6 +3557,7 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     }
     /* Initialize all fields to zero */
     memset(nitf, 0, sizeof(_nitf_ImageIO));
+    nitf_Mutex_init(&(nitf->lock));
 
     /*   Adjust block column and row counts for 2500C  */
     if ((nBlocksPerColumn == 1) && (numRowsPerBlock == 0))
@@ -3173,10 +3578,8 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
     nitf->decompressor = decompressor;
     nitf->compressionControl = NULL;
     nitf->decompressionControl = NULL;
-    nitf->blockControl.number = NITF_IMAGE_IO_NO_BLOCK;
-    nitf->blockControl.freeFlag = 1;
-    nitf->blockControl.block = NULL;
     nitf->cachedWriteFlag = 0;
+    nitf->reducedResolutionFlag = 0;
 
     nitf_ImageIO_setDefaultParameters(nitf);
 
@@ -3229,6 +3632,8 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_construct(
         nitf->compressor = &nitf_ImageIO_12PixelComInterface;
     }
 
+    nitf_ImageIO_setDecompressionExtensions(nitf, sub->imageCompression->raw);
+
     if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
     {
         nitf->nBlocksTotal =
@@ -3297,10 +3702,13 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 
     clone->blockInfoFlag = 0;
 
-    memset(&(clone->blockControl), 0,
-           sizeof(_nitf_ImageIOBlockCacheControl));
+    memset(&(clone->readCache), 0, sizeof(_nitf_ImageIOReadCache));
+    clone->readCache.maxBytes =
+        ((_nitf_ImageIO *) image)->readCache.maxBytes;
 
     clone->decompressionControl = NULL;
+    clone->activeReads = 0;
+    nitf_Mutex_init(&(clone->lock));
 
     memset(&(clone->maskHeader), 0, sizeof(_nitf_ImageIO_MaskHeader));
     clone->blockMask = NULL;
@@ -3312,7 +3720,6 @@ NITFPROT(nitf_ImageIO *) nitf_ImageIO_clone(nitf_ImageIO * image,
 NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
 {
     _nitf_ImageIO *nitfp;       /* Pointer to internal type */
-    nitf_Error error;           /* For decompressor free block call */
 
     if (*nitf == NULL)
         return;
@@ -3325,16 +3732,7 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
     if (nitfp->padMask != NULL)
         NITF_FREE(nitfp->padMask);
 
-    if (nitfp->blockControl.block != NULL)
-    {
-        /* No plugin */
-        if (nitfp->decompressor == NULL)
-            NITF_FREE(nitfp->blockControl.block);
-        else
-            (*(nitfp->decompressor->freeBlock)) (nitfp->decompressionControl,
-                                                 nitfp->blockControl.block,
-                                                 &error);
-    }
+    nitf_ImageIO_freeReadCache(nitfp);
 
     if (nitfp->decompressionControl != NULL)
         (*(nitfp->decompressor->destroyControl))(&(nitfp->decompressionControl));
@@ -3342,6 +3740,7 @@ NITFPROT(void) nitf_ImageIO_destruct(nitf_ImageIO ** nitf)
     if (nitfp->compressionControl != NULL)
         (*(nitfp->compressor->destroyControl))(&(nitfp->compressionControl));
 
+    nitf_Mutex_delete(&(nitfp->lock));
     NITF_FREE(nitfp);
     *nitf = NULL;
     return;
@@ -3356,28 +3755,40 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                                       int *padded, nitf_Error * error)
 {
     _nitf_ImageIO *nitfI;       /* Internal version of nitf */
-    int all;                    /* Full image read flag */
     nitf_BlockingInfo *blockInfo; /* For get blocking info call */
-    NITF_BOOL oneRead;          /* Complete request in one read flag */
-    int oneBand;                /* One band flag */
-    _nitf_ImageIOControl *cntl; /* IO control structure */
-    _nitf_ImageIOReadControl *readCntl; /* Read control structure */
-    nitf_SubWindow tmpSub;      /* Temp sub-window structure for one band loop */
-    nitf_Uint32 band;           /* Current band */
-    int ret;                    /* Return value */
+    NITF_BOOL ret;              /* Return value */
 
-    ret = 1;                    /* To avoid warning */
     nitfI = (_nitf_ImageIO *) nitf;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    /*
+     *   Set-up of the shared state is serialized, the request itself uses
+     * its own control structures so several reads may be in progress
+     */
+
+    nitf_Mutex_lock(&(nitfI->lock));
+    if (nitfI->writeControl != NULL)
     {
+        nitf_Mutex_unlock(&(nitfI->lock));
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
         return NITF_FAILURE;
     }
 
-    /* *possibly* revert the optimized modes */
-    nitf_ImageIO_revertOptimizedModes(nitfI, subWindow->numBands);
+    /*
+     *   Reverting the optimized modes changes state that reads in progress
+     * depend on
+     */
+    if (nitf_ImageIO_needsRevert(nitfI, subWindow->numBands))
+    {
+        if (nitfI->activeReads != 0)
+        {
+            nitf_Mutex_unlock(&(nitfI->lock));
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "I/O operation in progress");
+            return NITF_FAILURE;
+        }
+        nitf_ImageIO_revertOptimizedModes(nitfI, subWindow->numBands);
+    }
 
     /*
      *      Check the request, set-up blocking first since the sub-window
@@ -3386,32 +3797,88 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
 
     blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
     if (blockInfo == NULL)
+    {
+        nitf_Mutex_unlock(&(nitfI->lock));
         return NITF_FAILURE;
+    }
 
     /* Not needed */
     nitf_BlockingInfo_destruct(&blockInfo);
 
-    if (!nitf_ImageIO_checkSubWindow(nitfI, subWindow, &all, error))
-        return 0;
-
-    /*
-     *   Look for single read cases (down-sampling never does a single read or
-     * one band reads if the method is multi-band)
-     */
+    nitfI->activeReads += 1;
+    nitf_Mutex_unlock(&(nitfI->lock));
 
-    oneBand = nitfI->oneBand;
-    if ((subWindow->downsampler != NULL) &&
-            ((subWindow->downsampler->rowSkip != 1)
-             || (subWindow->downsampler->colSkip != 1)))
-    {
-        oneRead = 0;
-        if (subWindow->downsampler->multiBand)
-            oneBand = 0;
-    }
-    else
-        oneRead = nitf_ImageIO_checkOneRead(nitfI, all);
+    ret = nitf_ImageIO_readSubWindow(nitfI, io, subWindow, user, padded,
+                                     error);
 
-    /*      Set-up and do the read (one band at a time or all bands at once) */
+    nitf_Mutex_lock(&(nitfI->lock));
+    nitfI->activeReads -= 1;
+    nitf_Mutex_unlock(&(nitfI->lock));
+
+    return ret;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readSubWindow(_nitf_ImageIO * nitfI,
+                                               nitf_IOInterface* io,
+                                               nitf_SubWindow * subWindow,
+                                               nitf_Uint8 ** user,
+                                               int *padded,
+                                               nitf_Error * error)
+{
+    int all;                    /* Full image read flag */
+    NITF_BOOL oneRead;          /* Complete request in one read flag */
+    int oneBand;                /* One band flag */
+    NITF_BOOL planned;          /* Planned multi-band read flag */
+    _nitf_ImageIOControl *cntl; /* IO control structure */
+    _nitf_ImageIOReadControl *readCntl; /* Read control structure */
+    nitf_SubWindow tmpSub;      /* Temp sub-window structure for one band loop */
+    nitf_Uint32 band;           /* Current band */
+    NITF_BOOL reduced;          /* Read at a reduced resolution flag */
+    int ret;                    /* Return value */
+
+    ret = 1;                    /* To avoid warning */
+
+    if (!nitf_ImageIO_checkSubWindow(nitfI, subWindow, &all, error))
+        return 0;
+
+    /* A down-sampled request may be decoded at a reduced resolution */
+    nitf_Mutex_lock(&(nitfI->lock));
+    reduced = nitf_ImageIO_readReduced(nitfI, subWindow, user, padded);
+    nitf_Mutex_unlock(&(nitfI->lock));
+    if (reduced)
+        return 1;
+
+    /* Let the decompressor get a head start on the blocks of the request */
+    if (!nitf_ImageIO_prefetchBlocks(nitfI, io, subWindow, error))
+        return 0;
+
+    /*
+     *   Look for single read cases (down-sampling never does a single read or
+     * one band reads if the method is multi-band)
+     */
+
+    oneBand = nitfI->oneBand;
+    if ((subWindow->downsampler != NULL) &&
+            ((subWindow->downsampler->rowSkip != 1)
+             || (subWindow->downsampler->colSkip != 1)))
+    {
+        oneRead = 0;
+        if (subWindow->downsampler->multiBand)
+            oneBand = 0;
+    }
+    else
+        oneRead = nitf_ImageIO_checkOneRead(nitfI, all);
+
+    /*
+     *   Uncompressed "S" and "B" requests are planned for all bands at once,
+     * rather than read a band and a row at a time
+     */
+
+    planned = !oneRead && nitf_ImageIO_checkReadPlan(nitfI, subWindow);
+    if (planned)
+        oneBand = 0;
+
+    /*      Set-up and do the read (one band at a time or all bands at once) */
 
     if (oneBand || oneRead)
     {
@@ -3435,7 +3902,6 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
                 nitf_ImageIOControl_destruct(&cntl);
                 return 0;
             }
-            nitfI->readControl = readCntl;
             if (oneRead)
                 ret = nitf_ImageIO_oneRead(cntl, io, error);
             else
@@ -3449,7 +3915,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
             }
 
             nitf_ImageIOControl_destruct(&cntl);
-            nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
+            nitf_ImageIOReadControl_destruct(&readCntl);
         }
     }
     else
@@ -3468,9 +3934,9 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
             nitf_ImageIOControl_destruct(&cntl);
             return 0;
         }
-        nitfI->readControl = readCntl;
-
-        if (cntl->downSampling)
+        if (planned)
+            ret = nitf_ImageIO_readPlanned(cntl, io, error);
+        else if (cntl->downSampling)
             ret =
                 nitf_ImageIO_readRequestDownSample(cntl, subWindow, io,
                                                    error);
@@ -3479,7 +3945,7 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_read(nitf_ImageIO * nitf,
 
         *padded = cntl->padded;
         nitf_ImageIOControl_destruct(&cntl);
-        nitf_ImageIOReadControl_destruct(&(nitfI->readControl));
+        nitf_ImageIOReadControl_destruct(&readCntl);
     }
 
     return ret;
@@ -3572,21 +4038,28 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeSequential(nitf_ImageIO * nitf,
 
     nitfI = (_nitf_ImageIO *) nitf;
 
-    /* *possibly* revert the optimized modes */
-    nitf_ImageIO_revertOptimizedModes(nitfI, 0);
-
-    /*      Check for I/O in progress */
+    /*      Check for I/O in progress, the lock is held until the write is set */
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    nitf_Mutex_lock(&(nitfI->lock));
+    if ((nitfI->writeControl != NULL) || (nitfI->activeReads != 0))
     {
+        nitf_Mutex_unlock(&(nitfI->lock));
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
         return NITF_FAILURE;
     }
 
+    /* *possibly* revert the optimized modes */
+    nitf_ImageIO_revertOptimizedModes(nitfI, 0);
+
     /*      Create I/O control */
 
     subWindow = nitf_SubWindow_construct(error);
+    if (subWindow == NULL)
+    {
+        nitf_Mutex_unlock(&(nitfI->lock));
+        return NITF_FAILURE;
+    }
     subWindow->startRow = 0;
     subWindow->numRows = nitfI->numRows;
     subWindow->startCol = 0;
@@ -3600,7 +4073,10 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeSequential(nitf_ImageIO * nitf,
     nitf_SubWindow_destruct(&subWindow);
 
     if (cntl == NULL)
+    {
+        nitf_Mutex_unlock(&(nitfI->lock));
         return NITF_FAILURE;
+    }
 
     /*      Get the result object */
 
@@ -3610,10 +4086,12 @@ NITFPROT(NITF_BOOL) nitf_ImageIO_writeSequential(nitf_ImageIO * nitf,
     if (writeCntl == NULL)
     {
         nitf_ImageIOControl_destruct(&cntl);
+        nitf_Mutex_unlock(&(nitfI->lock));
         return NITF_FAILURE;
     }
 
     nitfI->writeControl = writeCntl;
+    nitf_Mutex_unlock(&(nitfI->lock));
     return NITF_SUCCESS;
 }
 
@@ -3964,7 +4442,64 @@ NITFPROT(void) nitf_ImageIO_setReadCaching(nitf_ImageIO * nitf)
     _nitf_ImageIO *initf;   /* Internal representation of object */
 
     initf = (_nitf_ImageIO *) nitf;
+
+    /*
+     *   Reads in progress may pick up the new reader part way through, the
+     * cached and uncached readers return the same data
+     */
+    nitf_Mutex_lock(&(initf->lock));
+    initf->vtbl.reader = nitf_ImageIO_cachedReader;
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+NITFPROT(void) nitf_ImageIO_setReadCacheSize(nitf_ImageIO * nitf,
+                                             nitf_Uint64 maxBytes)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
     initf->vtbl.reader = nitf_ImageIO_cachedReader;
+    initf->readCache.maxBytes = maxBytes;
+    nitf_ImageIO_trimReadCache(initf, 0);
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return;
+}
+
+NITFPROT(int) nitf_ImageIO_setReducedResolution(nitf_ImageIO * nitf,
+                                               int enable)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+    int saved;              /* Saved result */
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
+    saved = initf->reducedResolutionFlag;
+    initf->reducedResolutionFlag = enable ? 1 : 0;
+    nitf_Mutex_unlock(&(initf->lock));
+
+    return saved;
+}
+
+NITFPROT(void) nitf_ImageIO_getReadCacheStats(nitf_ImageIO * nitf,
+                                              nitf_Uint64 * hits,
+                                              nitf_Uint64 * misses,
+                                              nitf_Uint64 * usedBytes)
+{
+    _nitf_ImageIO *initf;   /* Internal representation of object */
+
+    initf = (_nitf_ImageIO *) nitf;
+    nitf_Mutex_lock(&(initf->lock));
+    if (hits != NULL)
+        *hits = initf->readCache.hits;
+    if (misses != NULL)
+        *misses = initf->readCache.misses;
+    if (usedBytes != NULL)
+        *usedBytes = initf->readCache.usedBytes;
+    nitf_Mutex_unlock(&(initf->lock));
 
     return;
 }
@@ -4001,6 +4536,15 @@ NITFPROT(void) nitf_BlockingInfo_print(nitf_BlockingInfo * info,
 /*======================== Internal Functions ================================*/
 /*============================================================================*/
 
+NITFPRIV(NITF_BOOL) nitf_ImageIO_needsRevert(_nitf_ImageIO *nitfI,
+                                             int numBands)
+{
+    return (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24 &&
+            (numBands == 3 || numBands == 0))
+        || (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_IQ &&
+            (numBands == 2 || numBands == 0));
+}
+
 NITFPRIV(void) nitf_ImageIO_revertOptimizedModes(_nitf_ImageIO *nitfI, int numBands)
 {
     if (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_RGB24 &&
@@ -5245,11 +5789,14 @@ int nitf_ImageIO_setup_SBR(_nitf_ImageIOControl * cntl, nitf_Error * error)
          * freeFlag tells the destructor when to free the buffers so as
          * not to double free a buffer. This is the reason for the flag
          * variables
+         *
+         * A compressor is handed the whole block, so the bands of a block
+         * column always share a buffer when there is one
          */
         freeCacheBuffer = 1;       /* Always allocate first band */
         freeCacheBufferReset = 1;  /* Do allocate after first band */
         if ((nitf->blockingMode != NITF_IMAGE_IO_BLOCKING_MODE_S)
-            && nitf->cachedWriteFlag)
+            && (nitf->cachedWriteFlag || nitf->compressor != NULL))
         {
             cacheBuffer = (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
             if (cacheBuffer == NULL)
@@ -5806,7 +6353,8 @@ nitf_ImageIOControl_construct(_nitf_ImageIO * nitf,
         return NULL;
     }
 
-    if(nitf->compressor != NULL)
+    /* Reads never use the compressor (12-bit pixels install one) */
+    if(!reading && (nitf->compressor != NULL))
     {
         if(!(*(nitf->compressor->start))(
                 nitf->compressionControl, nitf->pixelBase,
@@ -6093,6 +6641,244 @@ NITFPRIV(int) nitf_ImageIO_checkSubWindow(_nitf_ImageIO * nitf,
 }
 
 
+NITFPRIV(NITF_BOOL) nitf_ImageIO_prefetchBlocks(_nitf_ImageIO * nitf,
+                                                nitf_IOInterface * io,
+                                                nitf_SubWindow * subWindow,
+                                                nitf_Error * error)
+{
+    nitf_Uint32 rowSkip;        /* Row skip factor */
+    nitf_Uint32 colSkip;        /* Column skip factor */
+    nitf_Uint32 startBlockRow;  /* First block row of the request */
+    nitf_Uint32 endBlockRow;    /* Last block row of the request */
+    nitf_Uint32 startBlockCol;  /* First block column of the request */
+    nitf_Uint32 endBlockCol;    /* Last block column of the request */
+    nitf_Uint32 numBlocks;      /* Number of blocks in the request */
+    nitf_Uint64 maxBlocks;      /* Number of blocks the cache holds */
+    nitf_Uint32 *blockNumbers;  /* The blocks of the request */
+    nitf_Uint32 blockNumber;    /* Current block */
+    nitf_Uint32 blockRow;       /* Current block row */
+    nitf_Uint32 blockCol;       /* Current block column */
+    nitf_Uint32 idx;            /* Current index into blockNumbers */
+    nitf_Uint32 count;          /* Blocks of the request looked at */
+    _nitf_ImageIOReadCache *cache;      /* The read cache */
+    NITF_BOOL unlocked;         /* Lock released for the prefetch */
+    NITF_BOOL ret;              /* Return value */
+
+    if ((nitf->decompressor == NULL)
+        || (nitf->prefetchBlocks == NULL)
+        || (nitf->decompressionControl == NULL))
+        return NITF_SUCCESS;
+
+    /* Band sequential blocks are numbered per band, only spatial blocks */
+    if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+        return NITF_SUCCESS;
+
+    nitf_Mutex_lock(&(nitf->lock));
+
+    /* Decoding more than the cache holds only evicts what was decoded */
+    cache = &(nitf->readCache);
+    maxBlocks = (nitf->vtbl.reader == nitf_ImageIO_cachedReader
+                 && nitf->blockSize != 0) ?
+        cache->maxBytes / nitf->blockSize : 0;
+    if (maxBlocks < 2)
+    {
+        nitf_Mutex_unlock(&(nitf->lock));
+        return NITF_SUCCESS;
+    }
+
+    if (subWindow->downsampler != NULL)
+    {
+        rowSkip = subWindow->downsampler->rowSkip;
+        colSkip = subWindow->downsampler->colSkip;
+    }
+    else
+    {
+        rowSkip = 1;
+        colSkip = 1;
+    }
+
+    /*
+     * As in the set-up functions, the last down-sample neighborhood may
+     * extend past the edge of the image
+     */
+    startBlockRow = subWindow->startRow / nitf->blockInfo.numRowsPerBlock;
+    endBlockRow = (subWindow->startRow + subWindow->numRows * rowSkip - 1) /
+        nitf->blockInfo.numRowsPerBlock;
+    if (endBlockRow >= nitf->blockInfo.numBlocksPerCol)
+        endBlockRow = nitf->blockInfo.numBlocksPerCol - 1;
+
+    startBlockCol = subWindow->startCol / nitf->blockInfo.numColsPerBlock;
+    endBlockCol = (subWindow->startCol + subWindow->numCols * colSkip - 1) /
+        nitf->blockInfo.numColsPerBlock;
+    if (endBlockCol >= nitf->blockInfo.numBlocksPerRow)
+        endBlockCol = nitf->blockInfo.numBlocksPerRow - 1;
+
+    numBlocks = (endBlockRow - startBlockRow + 1) *
+        (endBlockCol - startBlockCol + 1);
+    if (numBlocks > maxBlocks)
+        numBlocks = (nitf_Uint32) maxBlocks;
+
+    /* Nothing to overlap for a single block */
+    if (numBlocks < 2)
+    {
+        nitf_Mutex_unlock(&(nitf->lock));
+        return NITF_SUCCESS;
+    }
+
+    blockNumbers =
+        (nitf_Uint32 *) NITF_MALLOC(numBlocks * sizeof(nitf_Uint32));
+    if (blockNumbers == NULL)
+    {
+        nitf_Mutex_unlock(&(nitf->lock));
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Error allocating block list: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        return NITF_FAILURE;
+    }
+
+    /* The first blocks of the request, in the order they are read */
+    idx = 0;
+    count = 0;
+    for (blockRow = startBlockRow;
+         blockRow <= endBlockRow && count < numBlocks; blockRow++)
+    {
+        for (blockCol = startBlockCol;
+             blockCol <= endBlockCol && count < numBlocks; blockCol++)
+        {
+            count++;
+            blockNumber = blockRow * nitf->blockInfo.numBlocksPerRow +
+                blockCol;
+            if ((cache->index != NULL) && (blockNumber < cache->indexLength)
+                && (cache->index[blockNumber] != NITF_IMAGE_IO_NO_BLOCK))
+                continue;
+            blockNumbers[idx++] = blockNumber;
+        }
+    }
+
+    if (idx < 2)
+    {
+        nitf_Mutex_unlock(&(nitf->lock));
+        NITF_FREE(blockNumbers);
+        return NITF_SUCCESS;
+    }
+
+    unlocked = nitf_IOInterface_canReadAt(io);
+    if (unlocked)
+        nitf_Mutex_unlock(&(nitf->lock));
+    ret = (*(nitf->prefetchBlocks)) (nitf->decompressionControl,
+                                     blockNumbers, idx, error);
+    if (!unlocked)
+        nitf_Mutex_unlock(&(nitf->lock));
+    NITF_FREE(blockNumbers);
+    return ret;
+}
+
+
+/* A member is only there if the plugin's table was built with it */
+#define NITF_IMAGE_IO_HAS_EXTENSION(TABLE, MEMBER) \
+    ((TABLE)->size >= offsetof(nitf_DecompressionExtensions, MEMBER) \
+        + sizeof((TABLE)->MEMBER))
+
+NITFPRIV(void) nitf_ImageIO_setDecompressionExtensions(_nitf_ImageIO * nitf,
+                                                      const char *compression)
+{
+    nitf_PluginRegistry *reg;
+    NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION getExtensions;
+    const nitf_DecompressionExtensions *table;
+    nitf_Error error;           /* No extensions is not an error */
+
+    nitf->prefetchBlocks = NULL;
+    nitf->readReduced = NULL;
+    if (nitf->decompressor == NULL)
+        return;
+
+    reg = nitf_PluginRegistry_getInstance(&error);
+    if (reg == NULL)
+        return;
+    getExtensions =
+        nitf_PluginRegistry_retrieveDecompExtensions(reg, compression);
+    if (getExtensions == NULL)
+        return;
+
+    /* The table only goes with the interface it extends */
+    table = (const nitf_DecompressionExtensions *)
+        (*getExtensions) (compression, &error);
+    if ((table == NULL) || (table->base != nitf->decompressor))
+        return;
+
+    if (NITF_IMAGE_IO_HAS_EXTENSION(table, prefetchBlocks))
+        nitf->prefetchBlocks = table->prefetchBlocks;
+    if (NITF_IMAGE_IO_HAS_EXTENSION(table, readReduced))
+        nitf->readReduced = table->readReduced;
+}
+
+NITFPRIV(NITF_BOOL) nitf_ImageIO_readReduced(_nitf_ImageIO * nitf,
+                                             nitf_SubWindow * subWindow,
+                                             nitf_Uint8 ** user,
+                                             int *padded)
+{
+    nitf_Uint32 skip;           /* Down-sample factor */
+    nitf_Uint32 reduce;         /* Resolution levels to discard */
+    nitf_Uint8 *buffer;         /* All bands at the reduced resolution */
+    nitf_Uint64 bufferSize;     /* Size of buffer in bytes */
+    size_t pixelCount;          /* Pixels per band */
+    size_t bandSize;            /* Bytes per band */
+    nitf_Uint32 band;           /* Current band */
+    nitf_Error error;           /* Failures only mean reading the usual way */
+
+    if (!nitf->reducedResolutionFlag
+        || (nitf->decompressor == NULL)
+        || (nitf->readReduced == NULL)
+        || (nitf->decompressionControl == NULL)
+        || (subWindow->downsampler == NULL)
+        || !nitf_DownSampler_isDecimating(subWindow->downsampler))
+        return 0;
+
+    /* Each resolution level halves both dimensions */
+    skip = subWindow->downsampler->rowSkip;
+    if ((skip < 2) || (skip != subWindow->downsampler->colSkip)
+        || ((skip & (skip - 1)) != 0)
+        || (subWindow->startRow % skip != 0)
+        || (subWindow->startCol % skip != 0))
+        return 0;
+
+    for (reduce = 0; ((nitf_Uint32) 1 << reduce) < skip; reduce++)
+        ;
+
+    buffer = (*(nitf->readReduced)) (nitf->decompressionControl,
+                                     subWindow->startRow,
+                                     subWindow->startCol,
+                                     subWindow->numRows,
+                                     subWindow->numCols,
+                                     reduce, &bufferSize, &error);
+    if (buffer == NULL)
+        return 0;
+
+    pixelCount = (size_t) subWindow->numRows * subWindow->numCols;
+    bandSize = pixelCount * nitf->pixel.bytes;
+    if (bufferSize != (nitf_Uint64) bandSize * nitf->numBands)
+    {
+        (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                            buffer, &error);
+        return 0;
+    }
+
+    for (band = 0; band < subWindow->numBands; band++)
+    {
+        memcpy(user[band], buffer + bandSize * subWindow->bandList[band],
+               bandSize);
+        if (nitf->vtbl.unformat != NULL)
+            (*(nitf->vtbl.unformat)) (user[band], pixelCount,
+                                      nitf->pixel.shift);
+    }
+
+    (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                        buffer, &error);
+    *padded = 0;
+    return 1;
+}
+
+
 NITFPRIV(NITF_BOOL) nitf_ImageIO_checkOneRead(_nitf_ImageIO * nitfI,
                                               NITF_BOOL all)
 {
@@ -6171,6 +6957,22 @@ NITFPRIV(NITF_BOOL) nitf_ImageIO_checkOneRead(_nitf_ImageIO * nitfI,
 }
 
 
+NITFPRIV(NITF_BOOL) nitf_ImageIO_checkReadPlan(_nitf_ImageIO * nitfI,
+                                               nitf_SubWindow * subWindow)
+{
+    if ((subWindow->downsampler != NULL) &&
+            ((subWindow->downsampler->rowSkip != 1)
+             || (subWindow->downsampler->colSkip != 1)))
+        return 0;
+
+    /* Compressed and cached reads go through the block cache instead */
+    return ((nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+            || (nitfI->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_B))
+        && (nitfI->vtbl.reader == nitf_ImageIO_uncachedReader)
+        && (nitfI->vtbl.unpack == NULL);
+}
+
+
 NITFPRIV(int) nitf_ImageIO_mkMasks(nitf_ImageIO * img,
                                    nitf_IOInterface* io, int reading,
                                    nitf_Error * error)
@@ -6717,13 +7519,18 @@ NITFPRIV(int) nitf_ImageIO_oneRead(_nitf_ImageIOControl * cntl,
     pixelCount = (size_t)nitf->numRowsActual * (size_t)nitf->numColumnsActual;
     count = pixelCount * nitf->pixel.bytes;
 
+    nitf_ImageIO_lockFileRead(nitf, io);
     if (!nitf_ImageIO_readFromFile(io,
                                    blockIO->cntl->nitf->pixelBase +
                                    blockIO->blockOffset.orig,
                                    blockIO->user.buffer +
                                    blockIO->user.offset.mark,
                                    count,error))
+    {
+        nitf_ImageIO_unlockFileRead(nitf, io);
         return NITF_FAILURE;
+    }
+    nitf_ImageIO_unlockFileRead(nitf, io);
 
     if (nitf->vtbl.unformat != NULL)
         (*(nitf->vtbl.unformat)) (blockIO->user.buffer
@@ -6799,69 +7606,295 @@ NITFPRIV(int) nitf_ImageIO_readRequest(_nitf_ImageIOControl * cntl,
     return 1;
 }
 
-/* This function is used when FR != DR (down-Sampling) */
-NITFPRIV(int) nitf_ImageIO_readRequestDownSample(_nitf_ImageIOControl *
-                                                 cntl,
-                                                 nitf_SubWindow *
-                                                 subWindow,
-                                                 nitf_IOInterface* io,
-                                                 nitf_Error * error)
+
+NITFPRIV(int) nitf_ImageIO_readPlanned(_nitf_ImageIOControl * cntl,
+                                       nitf_IOInterface* io,
+                                       nitf_Error * error)
 {
-    _nitf_ImageIO *nitf; /* Parent _nitf_ImageIO object */
-    nitf_Uint32 nBlockCols;   /* Number of block columns */
-    nitf_Uint32 numRowsFull; /* Number of rows to read in full res sub-window */
-    nitf_Uint32 numBands;     /* Number of bands */
-    nitf_Uint32 col;          /* Block column index */
-    nitf_Uint32 row;          /* Current row in sub-window */
-    nitf_Uint32 band;         /* Current band in sub-window */
+    _nitf_ImageIO *nitf;       /* Parent _nitf_ImageIO object */
+    nitf_Uint32 nBlockCols;    /* Number of block columns */
+    nitf_Uint32 numRows;       /* Number of rows in the requested sub-window */
+    nitf_Uint32 numBands;      /* Number of bands */
+    nitf_Uint32 col;           /* Block column index */
+    nitf_Uint32 row;           /* First row of the current row of blocks */
+    nitf_Uint32 batchRows;     /* Rows of the current row of blocks */
+    nitf_Uint32 batchRow;      /* Current row in the current row of blocks */
+    nitf_Uint32 band;          /* Current band in sub-window */
     _nitf_ImageIOBlock *blockIO; /* The current  block IO structure */
-    nitf_Uint8 *columnSave;   /* Column save buffer ptr,current block column */
-    NITF_BOOL noUserInc;      /* Do not increment user buffer pointer if TRUE */
-    nitf_Uint32 bytes;        /* Pixel size in bytes */
-    nitf_Uint32 rowSkipCount; /* Number of rows since the last row skip */
-    nitf_Uint32 numColsDR;    /* Number of columns, down-sample resolution */
+    _nitf_ImageIOReadSegment *segments; /* Pieces of the current row of blocks */
+    _nitf_ImageIOReadSegment *segment;  /* The last piece listed */
+    size_t numSegments;        /* Number of pieces listed */
+    nitf_Uint64 fileOffset;    /* File offset of the current row */
+    nitf_Uint8 *user;          /* User buffer for the current row */
+    nitf_Uint8 *staging;       /* Staging buffer for coalesced reads */
+    size_t stagingSize;        /* Staging buffer size in bytes */
+    int ret;                   /* Return value */
 
     nitf = cntl->nitf;
-
-    /*
-     * Calculate the number of rows to read (full resolution). Check for the
-     * full resolution size to go outside of the image (This can happen if
-     * down-sampling and the final row of neighbords is partially out of the
-     * image
-     */
-
-    numRowsFull = (cntl->numRows) * (cntl->rowSkip);
-    if (cntl->row + numRowsFull > nitf->numRows)
-        numRowsFull = nitf->numRows - cntl->row;
-
+    numRows = cntl->numRows;
     numBands = cntl->numBandSubset;
     nBlockCols = cntl->nBlockIO / numBands;
-    bytes = nitf->pixel.bytes;
-    noUserInc = 1; /* Only increment after calling down-sample plugin */
-    rowSkipCount = 0;
 
-    blockIO = NULL; /* Avoid spurious uninitialized warning */
-    numColsDR = 0;  /* Avoid spurious uninitialized warning */
-    for (col = 0; col < nBlockCols; col++)
+    /* A row of blocks is planned at a time, this is the most it can hold */
+    batchRows = (numRows < nitf->numRowsPerBlock) ?
+        numRows : nitf->numRowsPerBlock;
+    segments = (_nitf_ImageIOReadSegment *)
+        NITF_MALLOC(sizeof(_nitf_ImageIOReadSegment)
+                    * numBands * nBlockCols * batchRows);
+    if (segments == NULL)
     {
-        columnSave = cntl->columnSave;
-        rowSkipCount = 0;
-        for (row = 0; row < numRowsFull; row++)
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                         "Error allocating read plan: %s",
+                         NITF_STRERROR(NITF_ERRNO));
+        return NITF_FAILURE;
+    }
+    staging = NULL;
+    stagingSize = 0;
+    ret = NITF_SUCCESS;
+
+    for (row = 0; (row < numRows) && ret; row += batchRows)
+    {
+        /* All block I/O's are on the same row, the first one will do */
+        batchRows = cntl->blockIO[0][0].rowsUntil + 1;
+        if (batchRows > numRows - row)
+            batchRows = numRows - row;
+
+        numSegments = 0;
+        for (band = 0; (band < numBands) && ret; band++)
         {
-            for (band = 0; band < numBands; band++)
+            for (col = 0; (col < nBlockCols) && ret; col++)
             {
                 blockIO = &(cntl->blockIO[col][band]);
-                numColsDR = blockIO->pixelCountDR;
+                for (batchRow = 0; batchRow < batchRows; batchRow++)
+                {
+                    if (blockIO->imageDataOffset == NITF_IMAGE_IO_NO_OFFSET)
+                    {
+                        if (!nitf_ImageIO_readPad(blockIO, error))
+                        {
+                            ret = NITF_FAILURE;
+                            break;
+                        }
+                        cntl->padded = 1;
+                    }
+                    else
+                    {
+                        fileOffset = nitf->pixelBase +
+                            blockIO->imageDataOffset +
+                            blockIO->blockOffset.mark;
+                        user = blockIO->rwBuffer.buffer +
+                            blockIO->rwBuffer.offset.mark;
+
+                        segment = (numSegments > 0) ?
+                            &(segments[numSegments - 1]) : NULL;
+                        if ((segment != NULL)
+                            && (segment->fileOffset + segment->count
+                                == fileOffset)
+                            && (segment->user + segment->count == user))
+                            segment->count += blockIO->readCount;
+                        else
+                        {
+                            segment = &(segments[numSegments++]);
+                            segment->fileOffset = fileOffset;
+                            segment->count = blockIO->readCount;
+                            segment->user = user;
+                        }
 
-                if (blockIO->doIO)
-                    if (!(*(nitf->vtbl.reader)) (blockIO, io, error))
-                        return NITF_FAILURE;
+                        if (blockIO->padMask[blockIO->number]
+                            != NITF_IMAGE_IO_NO_OFFSET)
+                            cntl->padded = 1;
+                    }
 
-                if (nitf->vtbl.unpack != NULL)
-                    (*(nitf->vtbl.unpack)) (blockIO, error);
+                    /* See nitf_ImageIO_readRequest */
+                    if (row + batchRow != numRows - 1)
+                        nitf_ImageIO_nextRow(blockIO, 0);
 
-                /*
-                 * Copy first neighborhood data from previous block
+                    if (blockIO->rowsUntil == 0)
+                        blockIO->rowsUntil = nitf->numRowsPerBlock - 1;
+                    else
+                        blockIO->rowsUntil -= 1;
+                }
+            }
+        }
+
+        if (ret)
+            ret = nitf_ImageIO_readSegments(cntl, io, segments, numSegments,
+                                            &staging, &stagingSize, error);
+    }
+
+    NITF_FREE(segments);
+    if (staging != NULL)
+        NITF_FREE(staging);
+    if (!ret)
+        return NITF_FAILURE;
+
+    if (nitf->vtbl.unformat != NULL)
+    {
+        for (band = 0; band < numBands; band++)
+            (*(nitf->vtbl.unformat)) (cntl->userBase[band],
+                                      (size_t) numRows * cntl->numColumns,
+                                      nitf->pixel.shift);
+    }
+
+    return NITF_SUCCESS;
+}
+
+
+NITFPRIV(int) nitf_ImageIO_compareSegments(const void *a, const void *b)
+{
+    const _nitf_ImageIOReadSegment *segA = (const _nitf_ImageIOReadSegment *) a;
+    const _nitf_ImageIOReadSegment *segB = (const _nitf_ImageIOReadSegment *) b;
+
+    if (segA->fileOffset < segB->fileOffset)
+        return -1;
+    return (segA->fileOffset > segB->fileOffset) ? 1 : 0;
+}
+
+
+NITFPRIV(int) nitf_ImageIO_readSegments(_nitf_ImageIOControl * cntl,
+                                        nitf_IOInterface* io,
+                                        _nitf_ImageIOReadSegment * segments,
+                                        size_t numSegments,
+                                        nitf_Uint8 ** staging,
+                                        size_t * stagingSize,
+                                        nitf_Error * error)
+{
+    _nitf_ImageIO *nitf;       /* Parent _nitf_ImageIO object */
+    size_t first;              /* First piece of the current read */
+    size_t last;               /* Last piece of the current read */
+    size_t i;
+    nitf_Uint64 start;         /* File offset of the current read */
+    nitf_Uint64 end;           /* End of the current read */
+    _nitf_ImageIOReadSegment *next; /* Next piece */
+    NITF_BOOL ok;
+
+    nitf = cntl->nitf;
+
+    /* "S" mode bands are far apart in the file, "B" mode bands are not */
+    qsort(segments, numSegments, sizeof(_nitf_ImageIOReadSegment),
+          nitf_ImageIO_compareSegments);
+
+    for (first = 0; first < numSegments; first = last + 1)
+    {
+        start = segments[first].fileOffset;
+        end = start + segments[first].count;
+        for (last = first; last + 1 < numSegments; last++)
+        {
+            next = &(segments[last + 1]);
+            if ((next->fileOffset < end)
+                || (next->fileOffset - end > NITF_IMAGE_IO_PLAN_MAX_GAP)
+                || (next->fileOffset + next->count - start
+                    > NITF_IMAGE_IO_PLAN_MAX_RUN))
+                break;
+            end = next->fileOffset + next->count;
+        }
+
+        if (last == first)
+        {
+            /* A single piece goes straight to the user buffer */
+            nitf_ImageIO_lockFileRead(nitf, io);
+            ok = nitf_ImageIO_readFromFile(io, start, segments[first].user,
+                                           segments[first].count, error);
+            nitf_ImageIO_unlockFileRead(nitf, io);
+            if (!ok)
+                return NITF_FAILURE;
+            continue;
+        }
+
+        if ((size_t) (end - start) > *stagingSize)
+        {
+            if (*staging != NULL)
+                NITF_FREE(*staging);
+            *stagingSize = 0;
+            *staging = (nitf_Uint8 *) NITF_MALLOC((size_t) (end - start));
+            if (*staging == NULL)
+            {
+                nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                                 "Error allocating read buffer: %s",
+                                 NITF_STRERROR(NITF_ERRNO));
+                return NITF_FAILURE;
+            }
+            *stagingSize = (size_t) (end - start);
+        }
+
+        nitf_ImageIO_lockFileRead(nitf, io);
+        ok = nitf_ImageIO_readFromFile(io, start, *staging,
+                                       (size_t) (end - start), error);
+        nitf_ImageIO_unlockFileRead(nitf, io);
+        if (!ok)
+            return NITF_FAILURE;
+
+        for (i = first; i <= last; i++)
+            memcpy(segments[i].user,
+                   *staging + (segments[i].fileOffset - start),
+                   segments[i].count);
+    }
+
+    return NITF_SUCCESS;
+}
+
+/* This function is used when FR != DR (down-Sampling) */
+NITFPRIV(int) nitf_ImageIO_readRequestDownSample(_nitf_ImageIOControl *
+                                                 cntl,
+                                                 nitf_SubWindow *
+                                                 subWindow,
+                                                 nitf_IOInterface* io,
+                                                 nitf_Error * error)
+{
+    _nitf_ImageIO *nitf; /* Parent _nitf_ImageIO object */
+    nitf_Uint32 nBlockCols;   /* Number of block columns */
+    nitf_Uint32 numRowsFull; /* Number of rows to read in full res sub-window */
+    nitf_Uint32 numBands;     /* Number of bands */
+    nitf_Uint32 col;          /* Block column index */
+    nitf_Uint32 row;          /* Current row in sub-window */
+    nitf_Uint32 band;         /* Current band in sub-window */
+    _nitf_ImageIOBlock *blockIO; /* The current  block IO structure */
+    nitf_Uint8 *columnSave;   /* Column save buffer ptr,current block column */
+    NITF_BOOL noUserInc;      /* Do not increment user buffer pointer if TRUE */
+    nitf_Uint32 bytes;        /* Pixel size in bytes */
+    nitf_Uint32 rowSkipCount; /* Number of rows since the last row skip */
+    nitf_Uint32 numColsDR;    /* Number of columns, down-sample resolution */
+
+    nitf = cntl->nitf;
+
+    /*
+     * Calculate the number of rows to read (full resolution). Check for the
+     * full resolution size to go outside of the image (This can happen if
+     * down-sampling and the final row of neighbords is partially out of the
+     * image
+     */
+
+    numRowsFull = (cntl->numRows) * (cntl->rowSkip);
+    if (cntl->row + numRowsFull > nitf->numRows)
+        numRowsFull = nitf->numRows - cntl->row;
+
+    numBands = cntl->numBandSubset;
+    nBlockCols = cntl->nBlockIO / numBands;
+    bytes = nitf->pixel.bytes;
+    noUserInc = 1; /* Only increment after calling down-sample plugin */
+    rowSkipCount = 0;
+
+    blockIO = NULL; /* Avoid spurious uninitialized warning */
+    numColsDR = 0;  /* Avoid spurious uninitialized warning */
+    for (col = 0; col < nBlockCols; col++)
+    {
+        columnSave = cntl->columnSave;
+        rowSkipCount = 0;
+        for (row = 0; row < numRowsFull; row++)
+        {
+            for (band = 0; band < numBands; band++)
+            {
+                blockIO = &(cntl->blockIO[col][band]);
+                numColsDR = blockIO->pixelCountDR;
+
+                if (blockIO->doIO)
+                    if (!(*(nitf->vtbl.reader)) (blockIO, io, error))
+                        return NITF_FAILURE;
+
+                if (nitf->vtbl.unpack != NULL)
+                    (*(nitf->vtbl.unpack)) (blockIO, error);
+
+                /*
+                 * Copy first neighborhood data from previous block
                  * column and save
                  * residual data from this column
                  */
@@ -7102,25 +8135,29 @@ NITFPRIV(int) nitf_ImageIO_readFromFile(nitf_IOInterface* io,
                                         size_t count,
                                         nitf_Error * error)
 {
-    size_t bytes;               /* Amount of current read */
-    char *bufp;                 /* pointer into the buffer */
-    /* Seek to the offset */
-    bytes = count;
-    bufp = (char *) buffer;
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(io,
-                                               (nitf_Off) fileOffset,
-                                               NITF_SEEK_SET, error)))
-    {
-        return NITF_FAILURE;
-    }
-    if (!nitf_IOInterface_read(io, bufp, bytes, error))
+    /* Positional read, the interface's current offset is not used */
+    if (!nitf_IOInterface_readAt(io, (nitf_Off) fileOffset,
+                                 (char *) buffer, count, error))
     {
         return NITF_FAILURE;
     }
     return NITF_SUCCESS;
 }
 
+NITFPRIV(void) nitf_ImageIO_lockFileRead(_nitf_ImageIO * nitf,
+                                         nitf_IOInterface* io)
+{
+    if (!nitf_IOInterface_canReadAt(io))
+        nitf_Mutex_lock(&(nitf->lock));
+}
+
+NITFPRIV(void) nitf_ImageIO_unlockFileRead(_nitf_ImageIO * nitf,
+                                           nitf_IOInterface* io)
+{
+    if (!nitf_IOInterface_canReadAt(io))
+        nitf_Mutex_unlock(&(nitf->lock));
+}
+
 NITFPRIV(int) nitf_ImageIO_writeToFile(nitf_IOInterface* io,
                                        nitf_Uint64 fileOffset,
                                        const nitf_Uint8 * buffer,
@@ -7354,16 +8391,22 @@ int nitf_ImageIO_uncachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
+        _nitf_ImageIO *nitf;    /* Associated ImageIO object */
+
+        nitf = blockIO->cntl->nitf;
+        nitf_ImageIO_lockFileRead(nitf, io);
         if (!nitf_ImageIO_readFromFile(io,
-                                       blockIO->cntl->nitf->pixelBase +
+                                       nitf->pixelBase +
                                        blockIO->imageDataOffset +
                                        blockIO->blockOffset.mark,
                                        blockIO->rwBuffer.buffer +
                                        blockIO->rwBuffer.offset.mark,
                                        blockIO->readCount, error))
         {
+            nitf_ImageIO_unlockFileRead(nitf, io);
             return NITF_FAILURE;
         }
+        nitf_ImageIO_unlockFileRead(nitf, io);
 
         if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
             blockIO->cntl->padded = 1;
@@ -7380,6 +8423,7 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     _nitf_ImageIO *nitf;        /* Associated ImageIO object */
     _nitf_ImageIOControl *cntl; /* Associated control object */
     nitf_Uint64 blockSize;
+    nitf_Uint32 blockNumber;    /* Block number across all bands */
 
     cntl = blockIO->cntl;
     nitf = cntl->nitf;
@@ -7396,69 +8440,32 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
     else
     {
-        if (nitf->blockControl.number != blockIO->number)
-        {
-            if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-                  && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-                     && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-            {
-                /* Allocate block buffer if required */
-                if (nitf->blockControl.block == NULL)
-                {
-                    nitf->blockControl.block =
-                        (nitf_Uint8 *) NITF_MALLOC(nitf->blockSize);
-                    if (nitf->blockControl.block == NULL)
-                    {
-                        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                         "Error allocating block buffer: %s",
-                                         NITF_STRERROR(NITF_ERRNO));
-                        return NITF_FAILURE;
-                    }
-                }
-                /* Read the block */
-
-                if (!nitf_ImageIO_readFromFile(io,
-                                               blockIO->cntl->nitf->
-                                               pixelBase +
-                                               blockIO->imageDataOffset,
-                                               nitf->blockControl.block,
-                                               nitf->blockSize, error))
-                    return NITF_FAILURE;
-            }
-            else
-            {
-                /* Decompression interface structure */
-                nitf_DecompressionInterface* decompInterface;
+        nitf_Uint8 *block;          /* Cached block buffer */
 
-                /* No plugin */
-                if (nitf->decompressor == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT,
-                                     NITF_ERR_DECOMPRESSION,
-                                     "No decompression plugin for compressed type");
-                    return NITF_FAILURE;
-                }
+        /*
+         * In S mode the block number and masks are relative to the band,
+         * the cache and decompressor count the blocks of every band
+         */
+        blockNumber = blockIO->number;
+        if (nitf->blockingMode == NITF_IMAGE_IO_BLOCKING_MODE_S)
+            blockNumber += blockIO->band *
+                nitf->nBlocksPerRow * nitf->nBlocksPerColumn;
 
-                decompInterface = nitf->decompressor;
-                if (nitf->blockControl.block != NULL)
-                    (*(decompInterface->freeBlock)) (nitf->decompressionControl,
-                                                     nitf->blockControl.block,
-                                                     error);
-                nitf->blockControl.block =
-                    (*(decompInterface->readBlock)) (nitf->decompressionControl,
-                                                     blockIO->number,
-                                                     &blockSize,
-                                                     error);
-                if (nitf->blockControl.block == NULL)
-                    return NITF_FAILURE;
-            }
-            nitf->blockControl.number = blockIO->number;
+        /* The block may be evicted by another read once unlocked */
+        nitf_Mutex_lock(&(nitf->lock));
+        block = nitf_ImageIO_getCachedBlock(nitf, io, blockNumber,
+                                            &blockSize, error);
+        if (block == NULL)
+        {
+            nitf_Mutex_unlock(&(nitf->lock));
+            return NITF_FAILURE;
         }
 
         /* Get data from block */
         memcpy(blockIO->rwBuffer.buffer + blockIO->rwBuffer.offset.mark,
-               nitf->blockControl.block + blockIO->blockOffset.mark,
+               block + blockIO->blockOffset.mark,
                blockIO->readCount);
+        nitf_Mutex_unlock(&(nitf->lock));
 
         if (blockIO->padMask[blockIO->number] != NITF_IMAGE_IO_NO_OFFSET)
             blockIO->cntl->padded = 1;
@@ -7467,6 +8474,283 @@ int nitf_ImageIO_cachedReader(_nitf_ImageIOBlock * blockIO,
     }
 }
 
+/*========================= Start Read Block Cache  ================================*/
+
+/* Release the buffer of one cache entry and remove the entry */
+NITFPRIV(void) nitf_ImageIO_evictCacheEntry(_nitf_ImageIO * nitf,
+                                            nitf_Uint32 idx)
+{
+    _nitf_ImageIOReadCache *cache;      /* The read cache */
+    _nitf_ImageIOReadCacheEntry *entry; /* Entry to evict */
+    nitf_Error error;                   /* For decompressor free block call */
+
+    cache = &(nitf->readCache);
+    entry = &(cache->entries[idx]);
+
+    if (entry->decompressed)
+        (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                            entry->block, &error);
+    else
+        NITF_FREE(entry->block);
+
+    cache->usedBytes -= entry->size;
+    cache->index[entry->number] = NITF_IMAGE_IO_NO_BLOCK;
+
+    /* Move the last entry into the hole */
+    cache->numEntries -= 1;
+    if (idx != cache->numEntries)
+    {
+        *entry = cache->entries[cache->numEntries];
+        cache->index[entry->number] = idx;
+    }
+    return;
+}
+
+NITFPRIV(void) nitf_ImageIO_trimReadCache(_nitf_ImageIO * nitf,
+                                          nitf_Uint64 reserve)
+{
+    _nitf_ImageIOReadCache *cache;      /* The read cache */
+    nitf_Uint32 lru;                    /* Least recently used entry */
+    nitf_Uint32 i;
+
+    cache = &(nitf->readCache);
+    while ((cache->numEntries > 0) &&
+           (cache->usedBytes + reserve > cache->maxBytes))
+    {
+        lru = 0;
+        for (i = 1; i < cache->numEntries; i++)
+        {
+            if (cache->entries[i].lastUse < cache->entries[lru].lastUse)
+                lru = i;
+        }
+        nitf_ImageIO_evictCacheEntry(nitf, lru);
+    }
+    return;
+}
+
+/* Empty the read cache and release its tables, the budget is retained */
+NITFPRIV(void) nitf_ImageIO_freeReadCache(_nitf_ImageIO * nitf)
+{
+    _nitf_ImageIOReadCache *cache;      /* The read cache */
+
+    cache = &(nitf->readCache);
+    while (cache->numEntries > 0)
+        nitf_ImageIO_evictCacheEntry(nitf, cache->numEntries - 1);
+
+    if (cache->entries != NULL)
+        NITF_FREE(cache->entries);
+    if (cache->index != NULL)
+        NITF_FREE(cache->index);
+
+    cache->entries = NULL;
+    cache->allocEntries = 0;
+    cache->index = NULL;
+    cache->indexLength = 0;
+    return;
+}
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_getCachedBlock(_nitf_ImageIO * nitf,
+                                                   nitf_IOInterface* io,
+                                                   nitf_Uint32 blockNumber,
+                                                   nitf_Uint64 * blockSize,
+                                                   nitf_Error * error)
+{
+    _nitf_ImageIOReadCache *cache;      /* The read cache */
+    _nitf_ImageIOReadCacheEntry *entry; /* Entry for the block */
+    NITF_BOOL decompressed;             /* Block read via the decompressor */
+    nitf_Uint8 *block;                  /* The block buffer */
+    nitf_Uint64 size;                   /* Block buffer size */
+    NITF_BOOL unlocked;                 /* Lock released for the read */
+    NITF_BOOL ok;                       /* Read status */
+    nitf_Uint32 i;
+
+    cache = &(nitf->readCache);
+
+    /* Allocate the index on first use */
+    if (cache->index == NULL)
+    {
+        cache->indexLength = nitf->nBlocksTotal;
+        cache->index = (nitf_Uint32 *)
+            NITF_MALLOC(cache->indexLength * sizeof(nitf_Uint32));
+        if (cache->index == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block cache index: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+        for (i = 0; i < cache->indexLength; i++)
+            cache->index[i] = NITF_IMAGE_IO_NO_BLOCK;
+    }
+
+    if (blockNumber >= cache->indexLength)
+    {
+        nitf_Error_initf(error, NITF_CTXT, NITF_ERR_INVALID_PARAMETER,
+                         "Invalid block number %lu",
+                         (unsigned long) blockNumber);
+        return NULL;
+    }
+
+    cache->clock += 1;
+
+    /* Hit */
+    if (cache->index[blockNumber] != NITF_IMAGE_IO_NO_BLOCK)
+    {
+        entry = &(cache->entries[cache->index[blockNumber]]);
+        entry->lastUse = cache->clock;
+        cache->hits += 1;
+        *blockSize = entry->size;
+        return entry->block;
+    }
+
+    /* Miss */
+    cache->misses += 1;
+
+    /*
+     *  With positional reads the block is read and decompressed without
+     *  the lock so other reads can proceed, see the decompression
+     *  interface's readBlock
+     */
+    unlocked = nitf_IOInterface_canReadAt(io);
+    if ((nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
+        && (nitf->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
+        && (nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+    {
+        decompressed = 0;
+        size = nitf->blockSize;
+
+        block = (nitf_Uint8 *) NITF_MALLOC(size);
+        if (block == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block buffer: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            return NULL;
+        }
+
+        /* Read the block */
+        if (unlocked)
+            nitf_Mutex_unlock(&(nitf->lock));
+        ok = nitf_ImageIO_readFromFile(io,
+                                       nitf->pixelBase +
+                                       nitf->blockMask[blockNumber],
+                                       block, size, error);
+        if (unlocked)
+            nitf_Mutex_lock(&(nitf->lock));
+        if (!ok)
+        {
+            NITF_FREE(block);
+            return NULL;
+        }
+    }
+    else
+    {
+        /* No plugin */
+        if (nitf->decompressor == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT,
+                             NITF_ERR_DECOMPRESSION,
+                             "No decompression plugin for compressed type");
+            return NULL;
+        }
+
+        decompressed = 1;
+        if (unlocked)
+            nitf_Mutex_unlock(&(nitf->lock));
+        block = (*(nitf->decompressor->readBlock)) (nitf->decompressionControl,
+                                                    blockNumber, &size,
+                                                    error);
+        if (unlocked)
+            nitf_Mutex_lock(&(nitf->lock));
+        if (block == NULL)
+            return NULL;
+    }
+
+    /* Another read may have cached the block meanwhile, use its copy */
+    if (cache->index[blockNumber] != NITF_IMAGE_IO_NO_BLOCK)
+    {
+        if (decompressed)
+            (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                                block, error);
+        else
+            NITF_FREE(block);
+
+        entry = &(cache->entries[cache->index[blockNumber]]);
+        entry->lastUse = cache->clock;
+        *blockSize = entry->size;
+        return entry->block;
+    }
+    nitf_ImageIO_trimReadCache(nitf, size);
+
+    /* Grow the entry array if required */
+    if (cache->numEntries == cache->allocEntries)
+    {
+        _nitf_ImageIOReadCacheEntry *entries;   /* New entry array */
+        nitf_Uint32 allocEntries;               /* New allocation count */
+
+        allocEntries = (cache->allocEntries == 0) ? 1 : 2 * cache->allocEntries;
+        entries = (_nitf_ImageIOReadCacheEntry *)
+            NITF_REALLOC(cache->entries,
+                         allocEntries * sizeof(_nitf_ImageIOReadCacheEntry));
+        if (entries == NULL)
+        {
+            nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
+                             "Error allocating block cache: %s",
+                             NITF_STRERROR(NITF_ERRNO));
+            if (decompressed)
+                (*(nitf->decompressor->freeBlock)) (nitf->decompressionControl,
+                                                    block, error);
+            else
+                NITF_FREE(block);
+            return NULL;
+        }
+        cache->entries = entries;
+        cache->allocEntries = allocEntries;
+    }
+
+    entry = &(cache->entries[cache->numEntries]);
+    entry->number = blockNumber;
+    entry->decompressed = decompressed;
+    entry->block = block;
+    entry->size = size;
+    entry->lastUse = cache->clock;
+    cache->index[blockNumber] = cache->numEntries;
+    cache->numEntries += 1;
+    cache->usedBytes += size;
+
+    *blockSize = size;
+    return block;
+}
+
+NITFPRIV(nitf_Uint8 *) nitf_ImageIO_getMappedBlock(_nitf_ImageIO * nitf,
+                                                   nitf_IOInterface* io,
+                                                   nitf_Uint32 blockNumber,
+                                                   nitf_Uint64 * blockSize)
+{
+    nitf_Error error;           /* Not being in memory is not an error */
+    const void *block;          /* The block in place */
+
+    if ((nitf->pixel.type == NITF_IMAGE_IO_PIXEL_TYPE_B)
+        || (nitf->pixel.type == NITF_IMAGE_IO_PIXEL_TYPE_12)
+        || !(nitf->compression & NITF_IMAGE_IO_NO_COMPRESSION))
+        return NULL;
+
+    if ((blockNumber >= nitf->nBlocksTotal)
+        || (nitf->blockMask[blockNumber] == NITF_IMAGE_IO_NO_OFFSET))
+        return NULL;
+
+    block = nitf_IOInterface_getBuffer(io,
+                                       (nitf_Off) (nitf->pixelBase +
+                                                   nitf->blockMask[blockNumber]),
+                                       (size_t) nitf->blockSize, &error);
+    if (block == NULL)
+        return NULL;
+
+    *blockSize = nitf->blockSize;
+    return (nitf_Uint8 *) block;
+}
+
+/*========================= End Read Block Cache  ================================*/
 /*========================= Start Direct Block Reading  ================================*/
 NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
                                                      nitf_IOInterface *io,
@@ -7478,8 +8762,10 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
 
     nitfI = (_nitf_ImageIO *) nitf;
 
-    if ((nitfI->writeControl != NULL) || (nitfI->readControl != NULL))
+    nitf_Mutex_lock(&(nitfI->lock));
+    if ((nitfI->writeControl != NULL) || (nitfI->activeReads != 0))
     {
+        nitf_Mutex_unlock(&(nitfI->lock));
         nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
                          "I/O operation in progress");
         return NITF_FAILURE;
@@ -7495,6 +8781,7 @@ NITFPROT(NRT_BOOL) nitf_ImageIO_setupDirectBlockRead(nitf_ImageIO *nitf,
      *  check requires the block size
      */
     blockInfo = nitf_ImageIO_getBlockingInfo(nitf, io, error);
+    nitf_Mutex_unlock(&(nitfI->lock));
     if (blockInfo == NULL)
         return NITF_FAILURE;
 
@@ -7511,74 +8798,20 @@ NITFPROT(nitf_Uint8*) nitf_ImageIO_readBlockDirect(nitf_ImageIO* nitf,
                                                    nitf_Error * error)
 {
     _nitf_ImageIO *nitfI;        /* Associated ImageIO object */
-    nitf_Uint64 imageDataOffset;
+    nitf_Uint8 *block;           /* The block */
 
     nitfI = (_nitf_ImageIO*) nitf;
-    imageDataOffset = nitfI->blockMask[blockNumber];
-
-    if (nitfI->blockControl.number != blockNumber)
-    {
-        if ((nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_B)
-            && (nitfI->pixel.type != NITF_IMAGE_IO_PIXEL_TYPE_12)
-            && (nitfI->compression & NITF_IMAGE_IO_NO_COMPRESSION))
-        {
-            /* Allocate block buffer if required */
-            if (nitfI->blockControl.block == NULL)
-            {
-                nitfI->blockControl.block =
-                    (nitf_Uint8 *) NITF_MALLOC(nitfI->blockSize);
-                if (nitfI->blockControl.block == NULL)
-                {
-                    nitf_Error_initf(error, NITF_CTXT, NITF_ERR_MEMORY,
-                                     "Error allocating block buffer: %s",
-                                     NITF_STRERROR(NITF_ERRNO));
-                    return NULL;
-                }
-            }
-            /* Read the block */
-
-            if (!nitf_ImageIO_readFromFile(io,
-                                           nitfI->pixelBase + imageDataOffset,
-                                           nitfI->blockControl.block,
-                                           nitfI->blockSize, error))
-            {
-                return NULL;
-            }
-
-            *blockSize = nitfI->blockSize;
-        }
-        else
-        {
-            /* Decompression interface structure */
-            nitf_DecompressionInterface* decompInterface;
 
-            /* No plugin */
-            if (nitfI->decompressor == NULL)
-            {
-                nitf_Error_initf(error, NITF_CTXT,
-                                 NITF_ERR_DECOMPRESSION,
-                                 "No decompression plugin for compressed type");
-                return NULL;
-            }
+    /* Memory resident data is returned in place */
+    block = nitf_ImageIO_getMappedBlock(nitfI, io, blockNumber, blockSize);
+    if (block != NULL)
+        return block;
 
-            decompInterface = nitfI->decompressor;
-            if (nitfI->blockControl.block != NULL)
-                (*(decompInterface->freeBlock)) (nitfI->decompressionControl,
-                                                 nitfI->blockControl.block,
-                                                 error);
-            nitfI->blockControl.block =
-                (*(decompInterface->readBlock)) (nitfI->decompressionControl,
-                                                 blockNumber, blockSize,
-                                                 error);
-            if (nitfI->blockControl.block == NULL)
-            {
-                return NULL;
-            }
-        }
-        nitfI->blockControl.number = blockNumber;
-    }
-
-    return nitfI->blockControl.block;
+    nitf_Mutex_lock(&(nitfI->lock));
+    block = nitf_ImageIO_getCachedBlock(nitfI, io, blockNumber, blockSize,
+                                        error);
+    nitf_Mutex_unlock(&(nitfI->lock));
+    return block;
 }
 
 /*========================= End Direct Block Reading  ================================*/
@@ -8025,22 +9258,10 @@ void nitf_ImageIO_unformatUShift_8(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_2(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp16 = (nitf_Uint16 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16++;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-    }
+    nitf_ByteSwap_swap2(buffer, count);
 
     return;
 }
@@ -8049,26 +9270,10 @@ void nitf_ImageIO_swapOnly_2(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
+    nitf_ByteSwap_swap4(buffer, count);
 
     return;
 }
@@ -8076,26 +9281,11 @@ void nitf_ImageIO_swapOnly_4(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp32 = (nitf_Uint32 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[3];
-        bp8[3] = tmp8;
-    }
+    /* Each half of a complex value is swapped on its own */
+    nitf_ByteSwap_swap2(buffer, 2 * count);
 
     return;
 }
@@ -8104,32 +9294,10 @@ void nitf_ImageIO_swapOnly_4c(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
+    nitf_ByteSwap_swap8(buffer, count);
 
     return;
 }
@@ -8138,32 +9306,10 @@ void nitf_ImageIO_swapOnly_8(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[4];
-        bp8[4] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[5];
-        bp8[5] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
+    nitf_ByteSwap_swap4(buffer, 2 * count);
 
     return;
 }
@@ -8172,47 +9318,10 @@ void nitf_ImageIO_swapOnly_8c(nitf_Uint8 * buffer,
 void nitf_ImageIO_swapOnly_16c(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
-    nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    size_t i;
-
     /* Silence compiler warnings about unused variables */
     (void)shiftCount;
 
-    bp64 = (nitf_Uint64 *) buffer;
-    for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        bp8 = (nitf_Uint8 *) (bp64++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
+    nitf_ByteSwap_swap8(buffer, 2 * count);
 
     return;
 }
@@ -8223,23 +9332,19 @@ void nitf_ImageIO_unformatSwapExtend_2(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint16 tmp16;          /* Temp value, 16 bit */
+    nitf_Int16 tmp16;           /* Temp value, 16 bit */
     size_t i;
 
+    nitf_ByteSwap_swap2(buffer, count);
+
+    /* The right shift of the signed temp is what extends the sign */
     shift = (nitf_Int16) shiftCount;
     bp16 = (nitf_Int16 *) buffer;
     for (i = 0; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
-        tmp16 = *bp16 << shift;
-        *(bp16++) = tmp16 >> shift;
+        tmp16 = (nitf_Int16) ((nitf_Uint16) *bp16 << shift);
+        *(bp16++) = (nitf_Int16) (tmp16 >> shift);
     }
 
     return;
@@ -8251,26 +9356,17 @@ void nitf_ImageIO_unformatSwapExtend_4(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint8 tmp32;           /* Temp value, 32 bit */
+    nitf_Int32 tmp32;           /* Temp value, 32 bit */
     size_t i;
 
+    nitf_ByteSwap_swap4(buffer, count);
+
     shift = (nitf_Int32) shiftCount;
     bp32 = (nitf_Int32 *) buffer;
     for (i = 0; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) (bp32++);
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
-        tmp32 = *bp32 << shift;
+        tmp32 = (nitf_Int32) ((nitf_Uint32) *bp32 << shift);
         *(bp32++) = tmp32 >> shift;
     }
 
@@ -8284,32 +9380,17 @@ void nitf_ImageIO_unformatSwapExtend_8(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
-    nitf_Uint64 tmp64;          /* Temp value, 64 bit */
+    nitf_Int64 tmp64;           /* Temp value, 64 bit */
     size_t i;
 
+    nitf_ByteSwap_swap8(buffer, count);
+
     shift = (nitf_Int64) shiftCount;
     bp64 = (nitf_Int64 *) buffer;
     for (i = 0; i < count; i++)
     {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
-        tmp64 = *bp64 << shift;
+        tmp64 = (nitf_Int64) ((nitf_Uint64) *bp64 << shift);
         *(bp64++) = tmp64 >> shift;
     }
 
@@ -8322,22 +9403,15 @@ void nitf_ImageIO_unformatSwapShift_2(nitf_Uint8 * buffer,
                                       nitf_Uint32 shiftCount)
 {
     nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap2(buffer, count);
+
     shift = (nitf_Int16) shiftCount;
     bp16 = (nitf_Int16 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
         *(bp16++) >>= shift;
-    }
 
     return;
 }
@@ -8348,26 +9422,15 @@ void nitf_ImageIO_unformatSwapShift_4(nitf_Uint8 * buffer,
                                       nitf_Uint32 shiftCount)
 {
     nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap4(buffer, count);
+
     shift = (nitf_Int32) shiftCount;
     bp32 = (nitf_Int32 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
         *(bp32++) >>= shift;
-    }
 
     return;
 }
@@ -8379,32 +9442,15 @@ void nitf_ImageIO_unformatSwapShift_8(nitf_Uint8 * buffer,
                                       nitf_Uint32 shiftCount)
 {
     nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap8(buffer, count);
+
     shift = (nitf_Int64) shiftCount;
     bp64 = (nitf_Int64 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
         *(bp64++) >>= shift;
-    }
 
     return;
 }
@@ -8415,22 +9461,15 @@ void nitf_ImageIO_unformatSwapUShift_2(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Uint16 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap2(buffer, count);
+
     shift = (nitf_Uint16) shiftCount;
     bp16 = (nitf_Uint16 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
         *(bp16++) >>= shift;
-    }
 
     return;
 }
@@ -8440,26 +9479,15 @@ void nitf_ImageIO_unformatSwapUShift_4(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Uint32 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap4(buffer, count);
+
     shift = (nitf_Uint32) shiftCount;
     bp32 = (nitf_Uint32 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
         *(bp32++) >>= shift;
-    }
 
     return;
 }
@@ -8471,32 +9499,15 @@ void nitf_ImageIO_unformatSwapUShift_8(nitf_Uint8 * buffer,
                                        nitf_Uint32 shiftCount)
 {
     nitf_Uint64 shift;          /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap8(buffer, count);
+
     shift = (nitf_Uint64) shiftCount;
     bp64 = (nitf_Uint64 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
         *(bp64++) >>= shift;
-    }
 
     return;
 }
@@ -8855,7 +9866,8 @@ void nitf_ImageIO_formatMask_1(nitf_Uint8 * buffer,
     nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     size_t i;
 
-    mask = ((nitf_Uint8) - 1) << (8 - shiftCount);
+    /* Keep the significant bits, clear the shiftCount bits above them */
+    mask = (nitf_Uint8) (((nitf_Uint8) - 1) >> shiftCount);
     bp8 = (nitf_Uint8 *) buffer;
     for (i = 0; i < count; i++)
         *(bp8++) &= mask;
@@ -8866,11 +9878,11 @@ void nitf_ImageIO_formatMask_1(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_2(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint16 mask;           /* The mask */
     nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
     size_t i;
 
-    mask = ((nitf_Uint16) - 1) << (16 - shiftCount);
+    mask = (nitf_Uint16) (((nitf_Uint16) - 1) >> shiftCount);
     bp16 = (nitf_Uint16 *) buffer;
     for (i = 0; i < count; i++)
         *(bp16++) &= mask;
@@ -8882,11 +9894,11 @@ void nitf_ImageIO_formatMask_2(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_4(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint32 mask;           /* The mask */
     nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
     size_t i;
 
-    mask = ((nitf_Uint32) - 1) << (32 - shiftCount);
+    mask = ((nitf_Uint32) - 1) >> shiftCount;
     bp32 = (nitf_Uint32 *) buffer;
     for (i = 0; i < count; i++)
         *(bp32++) &= mask;
@@ -8900,11 +9912,11 @@ void nitf_ImageIO_formatMask_4(nitf_Uint8 * buffer,
 void nitf_ImageIO_formatMask_8(nitf_Uint8 * buffer,
         size_t count, nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
+    nitf_Uint64 mask;           /* The mask */
     nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
     size_t i;
 
-    mask = ((nitf_Uint64) - 1) << (64 - shiftCount);
+    mask = ((nitf_Uint64) - 1) >> shiftCount;
     bp64 = (nitf_Uint64 *) buffer;
     for (i = 0; i < count; i++)
         *(bp64++) &= mask;
@@ -8918,22 +9930,15 @@ void nitf_ImageIO_formatShiftSwap_2(nitf_Uint8 * buffer,
                                     nitf_Uint32 shiftCount)
 {
     nitf_Int16 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int16 *bp16;           /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap2(buffer, count);
+
     shift = (nitf_Int16) shiftCount;
     bp16 = (nitf_Int16 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-
         *(bp16++) >>= shift;
-    }
 
     return;
 }
@@ -8944,26 +9949,15 @@ void nitf_ImageIO_formatShiftSwap_4(nitf_Uint8 * buffer,
                                     nitf_Uint32 shiftCount)
 {
     nitf_Int32 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int32 *bp32;           /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap4(buffer, count);
+
     shift = (nitf_Int32) shiftCount;
     bp32 = (nitf_Int32 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-
         *(bp32++) >>= shift;
-    }
 
     return;
 }
@@ -8975,32 +9969,15 @@ void nitf_ImageIO_formatShiftSwap_8(nitf_Uint8 * buffer,
                                     nitf_Uint32 shiftCount)
 {
     nitf_Int64 shift;           /* Shift count */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
     nitf_Int64 *bp64;           /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
+    nitf_ByteSwap_swap8(buffer, count);
+
     shift = (nitf_Int64) shiftCount;
     bp64 = (nitf_Int64 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-
         *(bp64++) >>= shift;
-    }
 
     return;
 }
@@ -9010,23 +9987,16 @@ void nitf_ImageIO_formatMaskSwap_2(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
+    nitf_Uint16 mask;           /* The mask */
     nitf_Uint16 *bp16;          /* Buffer pointer, 16 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
-    mask = ((nitf_Uint16) - 1) << (16 - shiftCount);
+    mask = (nitf_Uint16) (((nitf_Uint16) - 1) >> shiftCount);
     bp16 = (nitf_Uint16 *) buffer;
     for (i = 0; i < count; i++)
-    {
         *(bp16++) &= mask;
 
-        bp8 = (nitf_Uint8 *) bp16;
-        tmp8 = bp8[0];
-        bp8[0] = bp8[1];
-        bp8[1] = tmp8;
-    }
+    nitf_ByteSwap_swap2(buffer, count);
 
     return;
 }
@@ -9036,27 +10006,16 @@ void nitf_ImageIO_formatMaskSwap_4(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
+    nitf_Uint32 mask;           /* The mask */
     nitf_Uint32 *bp32;          /* Buffer pointer, 32 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
-    mask = ((nitf_Uint32) - 1) << (32 - shiftCount);
+    mask = ((nitf_Uint32) - 1) >> shiftCount;
     bp32 = (nitf_Uint32 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp32;
-
         *(bp32++) &= mask;
 
-        tmp8 = bp8[0];
-        bp8[0] = bp8[3];
-        bp8[3] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[2];
-        bp8[2] = tmp8;
-    }
+    nitf_ByteSwap_swap4(buffer, count);
 
     return;
 }
@@ -9067,33 +10026,16 @@ void nitf_ImageIO_formatMaskSwap_8(nitf_Uint8 * buffer,
                                    size_t count,
                                    nitf_Uint32 shiftCount)
 {
-    nitf_Uint8 mask;            /* The mask */
-    nitf_Uint8 *bp8;            /* Buffer pointer, 8 bit */
+    nitf_Uint64 mask;           /* The mask */
     nitf_Uint64 *bp64;          /* Buffer pointer, 64 bit */
-    nitf_Uint8 tmp8;            /* Temp value, 8 bit */
     size_t i;
 
-    mask = ((nitf_Uint64) - 1) << (64 - shiftCount);
+    mask = ((nitf_Uint64) - 1) >> shiftCount;
     bp64 = (nitf_Uint64 *) buffer;
     for (i = 0; i < count; i++)
-    {
-        bp8 = (nitf_Uint8 *) bp64;
-
         *(bp64++) &= mask;
 
-        tmp8 = bp8[0];
-        bp8[0] = bp8[7];
-        bp8[7] = tmp8;
-        tmp8 = bp8[1];
-        bp8[1] = bp8[6];
-        bp8[6] = tmp8;
-        tmp8 = bp8[2];
-        bp8[2] = bp8[5];
-        bp8[5] = tmp8;
-        tmp8 = bp8[3];
-        bp8[3] = bp8[4];
-        bp8[4] = tmp8;
-    }
+    nitf_ByteSwap_swap8(buffer, count);
 
     return;
 }
@@ -9134,7 +10076,6 @@ nitf_ImageIO_bPixelOpen(nitf_ImageSubheader * subheader,
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
-    icntl->buffer = NULL;
 
     return (nitf_DecompressionControl *) icntl;
 }
@@ -9153,20 +10094,13 @@ NITFPRIV(NITF_BOOL) nitf_ImageIO_bPixelStart(nitf_DecompressionControl * control
 
     /* Silence compiler warnings about unused variables */
     (void)fileLength;
+    (void)error;
 
     icntl->io = io;
     icntl->offset = offset;
     icntl->blockInfo = blockInfo;
     icntl->blockMask = blockMask;
     icntl->blockSizeCompressed = (blockInfo->length + 7) / 8;
-    icntl->buffer = (nitf_Uint8 *) NITF_MALLOC(icntl->blockSizeCompressed);
-    if (icntl->buffer == NULL)
-    {
-        nitf_Error_init(error, "Error creating control object",
-                        NITF_CTXT, NITF_ERR_DECOMPRESSION);
-        NITF_FREE(icntl);
-        return NITF_FAILURE;
-    }
 
     return NITF_SUCCESS;
 }
@@ -9183,6 +10117,7 @@ nitf_ImageIO_bPixelReadBlock(nitf_DecompressionControl * control,
     size_t uncompressedLen;     /* Length of uncompressed block */
     nitf_Uint8 *block;          /* Uncompressed result */
     nitf_Uint8 *blockPtr;       /* Pointer in uncompressed result */
+    nitf_Uint8 *compressed;     /* Compressed input */
     nitf_Uint8 *compPtr;        /* Pointer in compressed input */
     nitf_Uint8 current;         /* Current byte of compressed data */
     size_t i;
@@ -9190,35 +10125,36 @@ nitf_ImageIO_bPixelReadBlock(nitf_DecompressionControl * control,
     icntl = (nitf_ImageIO_BPixelControl *) control;
     uncompressedLen = icntl->blockInfo->length;
 
-    /* Read the data */
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
-                                               (nitf_Off) (icntl->offset +
-                                                           icntl->
-                                                           blockMask
-                                                           [blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
-
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
-        return NULL;
-
-    /* Allocate block */
+    /*
+     *   Blocks may be read concurrently, so the compressed input is per call
+     * and follows the uncompressed result in one allocation
+     */
 
-    block = (nitf_Uint8 *) NITF_MALLOC(uncompressedLen);
+    block = (nitf_Uint8 *) NITF_MALLOC(uncompressedLen +
+                                       icntl->blockSizeCompressed);
     if (block == NULL)
     {
         nitf_Error_init(error, "Error creating block buffer",
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    compressed = block + uncompressedLen;
+
+    /* Read the data */
+
+    if (!nitf_IOInterface_readAt(icntl->io,
+                 (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
+                                 (char *) compressed,
+                                 icntl->blockSizeCompressed, error))
+    {
+        NITF_FREE(block);
+        return NULL;
+    }
 
     /* Decompress the result */
 
     blockPtr = block;
-    compPtr = icntl->buffer;
+    compPtr = compressed;
     current = 0;                /* Avoids uninitialized variable warning */
     for (i = 0; i < uncompressedLen; i++)
     {
@@ -9239,8 +10175,6 @@ nitf_ImageIO_bPixelClose(nitf_DecompressionControl **control)
     nitf_ImageIO_BPixelControl *icntl;
     icntl = (nitf_ImageIO_BPixelControl *) * control;
 
-    if (icntl->buffer != NULL)
-        NITF_FREE((void *) (icntl->buffer));
     NITF_FREE((void *) (icntl));
     *control = NULL;
     return;
@@ -9282,7 +10216,6 @@ nitf_ImageIO_12PixelOpen(nitf_ImageSubheader * subheader,
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
-    icntl->buffer = NULL;
 
     return (nitf_DecompressionControl *) icntl;
 }
@@ -9300,6 +10233,7 @@ nitf_ImageIO_12PixelStart(nitf_DecompressionControl* control,
 
     /* Silence compiler warnings about unused variables */
     (void)fileLength;
+    (void)error;
 
     icntl = (nitf_ImageIO_12PixelControl *)control;
     icntl->io = io;
@@ -9320,15 +10254,6 @@ nitf_ImageIO_12PixelStart(nitf_DecompressionControl* control,
 
     icntl->blockSizeCompressed = 3*(icntl->blockPixelCount/2) + 2*(icntl->odd);
 
-    icntl->buffer = (nitf_Uint8 *) NITF_MALLOC(icntl->blockSizeCompressed);
-    if (icntl->buffer == NULL)
-    {
-        nitf_Error_init(error, "Error creating control object",
-                        NITF_CTXT, NITF_ERR_DECOMPRESSION);
-        NITF_FREE(icntl);
-        return NITF_FAILURE;
-    }
-
     return NITF_SUCCESS;
 }
 
@@ -9343,6 +10268,7 @@ nitf_ImageIO_12PixelReadBlock(nitf_DecompressionControl* control,
     size_t uncompressedLen;        /* Length of uncompressed block */
     nitf_Uint8 *block;             /* Uncompressed result */
     nitf_Uint16 *blockPtr;         /* Pointer in uncompressed result */
+    nitf_Uint8 *compressed;        /* Compressed input */
     nitf_Uint8 *compPtr;           /* Pointer in compressed input */
     nitf_Uint16 a;                 /* Components of compressed pixel */
     nitf_Uint16 b;
@@ -9352,32 +10278,36 @@ nitf_ImageIO_12PixelReadBlock(nitf_DecompressionControl* control,
     icntl = (nitf_ImageIO_12PixelControl *) control;
     uncompressedLen = icntl->blockInfo->length;
 
-    /* Read the data */
-
-    if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(icntl->io,
-                 (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
-                                               NITF_SEEK_SET, error)))
-        return NULL;
-
-    if (!nitf_IOInterface_read(icntl->io,
-                               (char *) (icntl->buffer),
-                               icntl->blockSizeCompressed, error))
-        return NULL;
-
-    /* Allocate block */
+    /*
+     *   Blocks may be read concurrently, so the compressed input is per call
+     * and follows the uncompressed result in one allocation
+     */
 
-    block = (nitf_Uint8 *) NITF_MALLOC(uncompressedLen);
+    block = (nitf_Uint8 *) NITF_MALLOC(uncompressedLen +
+                                       icntl->blockSizeCompressed);
     if (block == NULL)
     {
         nitf_Error_init(error, "Error creating block buffer",
                         NITF_CTXT, NITF_ERR_DECOMPRESSION);
         return NULL;
     }
+    compressed = block + uncompressedLen;
+
+    /* Read the data */
+
+    if (!nitf_IOInterface_readAt(icntl->io,
+                 (nitf_Off) (icntl->offset + icntl->blockMask[blockNumber]),
+                                 (char *) compressed,
+                                 icntl->blockSizeCompressed, error))
+    {
+        NITF_FREE(block);
+        return NULL;
+    }
 
     /* Decompress the result */
 
     blockPtr = (nitf_Uint16 *) block;
-    compPtr = icntl->buffer;
+    compPtr = compressed;
     for (i = 0; i < icntl->blockPixelCount/2; i++)
     {
       a = *(compPtr++);
@@ -9408,8 +10338,6 @@ nitf_ImageIO_12PixelClose(nitf_DecompressionControl **control)
     nitf_ImageIO_12PixelControl *icntl;
     icntl = (nitf_ImageIO_12PixelControl *) * control;
 
-    if (icntl->buffer != NULL)
-        NITF_FREE((void *) (icntl->buffer));
     NITF_FREE((void *) (icntl));
     *control = NULL;
     return;
@@ -9643,6 +10571,17 @@ NITFPRIV(void) nitf_ImageIO_print(nitf_ImageIO * nitf, FILE * file)
             nitfp->parameters.noCacheThreshold);
     fprintf(file, "     Clear cache after I/O operation: %ld\n",
             nitfp->parameters.clearCache);
+    fprintf(file, "  Read block cache:\n");
+    fprintf(file, "    Byte budget (zero for one block): %llu\n",
+            (unsigned long long) nitfp->readCache.maxBytes);
+    fprintf(file, "    Bytes in use: %llu\n",
+            (unsigned long long) nitfp->readCache.usedBytes);
+    fprintf(file, "    Number of blocks cached: %lu\n",
+            (unsigned long) nitfp->readCache.numEntries);
+    fprintf(file, "    Hits: %llu\n",
+            (unsigned long long) nitfp->readCache.hits);
+    fprintf(file, "    Misses: %llu\n",
+            (unsigned long long) nitfp->readCache.misses);
     fprintf(file, "  Block and pad mask header:\n");
     fprintf(file, "    Ready flag %d\n", nitfp->maskHeader.ready);
     fprintf(file, "    Offset to actual image data past masks: %lx\n",
@@ -99,3 +99,27 @@ NITFPROT(void) nitf_ImageReader_setReadCaching(nitf_ImageReader * iReader)
     nitf_ImageIO_setReadCaching(iReader->imageDeblocker);
     return;
 }
+
+NITFAPI(void) nitf_ImageReader_setReadCacheSize(nitf_ImageReader * iReader,
+                                                nitf_Uint64 maxBytes)
+{
+    nitf_ImageIO_setReadCacheSize(iReader->imageDeblocker, maxBytes);
+    return;
+}
+
+NITFAPI(void) nitf_ImageReader_setReducedResolution(nitf_ImageReader * iReader,
+                                                    int enable)
+{
+    nitf_ImageIO_setReducedResolution(iReader->imageDeblocker, enable);
+    return;
+}
+
+NITFAPI(void) nitf_ImageReader_getReadCacheStats(nitf_ImageReader * iReader,
+                                                 nitf_Uint64 * hits,
+                                                 nitf_Uint64 * misses,
+                                                 nitf_Uint64 * usedBytes)
+{
+    nitf_ImageIO_getReadCacheStats(iReader->imageDeblocker,
+                                   hits, misses, usedBytes);
+    return;
+}
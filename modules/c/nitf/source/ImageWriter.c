@@ -24,6 +24,12 @@
 #include "nitf/ImageIO.h"
 #include "nitf/PluginRegistry.h"
 
+/*
+ *  Rows are written a block row at a time, unless a block row of every band
+ *  would take more than this many bytes (e.g. when the image is one block)
+ */
+#define NITF_IMAGE_WRITER_MAX_BUFFER (64 * 1024 * 1024)
+
 /*
  *  Private implementation struct
  */
@@ -64,6 +70,7 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     nitf_Uint8 **user = NULL;
     nitf_Uint8 *userContig = NULL;
     nitf_Uint32 row, band, block;
+    nitf_Uint32 rowsPerWrite, numRowsThisWrite;
     size_t rowSize, blockSize, numBlocks;
     nitf_Uint32 numImageBands = 0;
     nitf_Off offset;
@@ -139,6 +146,28 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
     }
     else
     {
+        /*
+         * Pull a block row per band from the sources at a time, so each
+         * block row costs one source read per band and one writeRows call
+         */
+        blockInfo = nitf_ImageIO_getBlockingInfo(impl->imageBlocker,
+                                                 output, error);
+        if (blockInfo == NULL)
+            goto CATCH_ERROR;
+        rowsPerWrite = blockInfo->numRowsPerBlock;
+        nitf_BlockingInfo_destruct(&blockInfo);
+
+        if (rowsPerWrite > impl->numRows)
+            rowsPerWrite = impl->numRows;
+        if ((nitf_Uint64) rowsPerWrite * rowSize * numImageBands >
+            NITF_IMAGE_WRITER_MAX_BUFFER)
+        {
+            rowsPerWrite = (nitf_Uint32) (NITF_IMAGE_WRITER_MAX_BUFFER /
+                                          (rowSize * numImageBands));
+            if (rowsPerWrite == 0)
+                rowsPerWrite = 1;
+        }
+
         user = (nitf_Uint8 **) NITF_MALLOC(sizeof(nitf_Uint8*) * numImageBands);
         if (!user)
         {
@@ -146,9 +175,10 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
                             NITF_ERR_MEMORY);
             goto CATCH_ERROR;
         }
+        memset(user, 0, sizeof(nitf_Uint8*) * numImageBands);
         for (band = 0; band < numImageBands; band++)
         {
-            user[band] = (nitf_Uint8 *) NITF_MALLOC(rowSize);
+            user[band] = (nitf_Uint8 *) NITF_MALLOC(rowSize * rowsPerWrite);
             if (!user[band])
             {
                 nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
@@ -157,23 +187,29 @@ NITFPRIV(NITF_BOOL) ImageWriter_write(NITF_DATA * data,
             }
         }
 
-        for (row = 0; row < impl->numRows; ++row)
+        for (row = 0; row < impl->numRows; row += numRowsThisWrite)
         {
+            numRowsThisWrite = impl->numRows - row;
+            if (numRowsThisWrite > rowsPerWrite)
+                numRowsThisWrite = rowsPerWrite;
+
             for (band = 0; band < numImageBands; ++band)
             {
                 bandSrc = nitf_ImageSource_getBand(impl->imageSource,
                                                    band, error);
                 if (bandSrc == NULL)
-                    return NITF_FAILURE;
+                    goto CATCH_ERROR;
 
                 if (!(*(bandSrc->iface->read)) (bandSrc->data, (char *) user[band],
-                                                (size_t) rowSize, error))
+                                                rowSize * numRowsThisWrite,
+                                                error))
                 {
                     goto CATCH_ERROR;
                 }
             }
 
-            if (!nitf_ImageIO_writeRows(impl->imageBlocker, output, 1, user, error))
+            if (!nitf_ImageIO_writeRows(impl->imageBlocker, output,
+                                        numRowsThisWrite, user, error))
                 goto CATCH_ERROR;
         }
     }
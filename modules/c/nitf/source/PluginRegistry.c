@@ -21,6 +21,7 @@
  */
 
 #include "nitf/PluginRegistry.h"
+#include "nitf/TREUtils.h"
 
 NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error);
 NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg);
@@ -100,6 +101,10 @@ NITFPROT(nitf_PluginRegistry *)
         /*  constructed                                         */
         if (theInstance == NULL)
         {
+            /*  The registry outlives any Record being read, so it must  */
+            /*  not come out of the Record's arena                       */
+            nitf_Arena *arena = nitf_Arena_setCurrent(NULL);
+
             theInstance = implicitConstruct(error);
             /*  If this succeeded...  */
             if (theInstance)
@@ -116,6 +121,7 @@ NITFPROT(nitf_PluginRegistry *)
                     implicitDestruct(&theInstance);
                 }
             }
+            nitf_Arena_setCurrent(arena);
         }
 
         nitf_Mutex_unlock( GET_MUTEX());
@@ -180,6 +186,15 @@ NITFPRIV(NITF_BOOL) insertPlugin(nitf_PluginRegistry * reg,
             return NITF_FAILURE;
         }
 
+        /* Decompression extensions are optional, most plugins have none */
+        if (hash == reg->decompressionHandlers)
+        {
+            nitf_Error noExtensions;
+            insertCreator(dll, reg->decompressionExtensions, key,
+                          NITF_PLUGIN_EXTENDED_INTERFACE_SUFFIX,
+                          &noExtensions);
+        }
+
     }
     return NITF_SUCCESS;
 }
@@ -207,6 +222,7 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     reg->compressionHandlers = NULL;
     reg->treHandlers = NULL;
     reg->decompressionHandlers = NULL;
+    reg->decompressionExtensions = NULL;
     reg->dsos = NULL;
 
     reg->dsos = nitf_List_construct(error);
@@ -258,6 +274,16 @@ NITFPRIV(nitf_PluginRegistry *) implicitConstruct(nitf_Error * error)
     nitf_HashTable_setPolicy(reg->decompressionHandlers,
                              NITF_DATA_RETAIN_OWNER);
 
+    reg->decompressionExtensions =
+        nitf_HashTable_construct(NITF_DECOMPRESSION_HASH_SIZE, error);
+    if (!reg->decompressionExtensions)
+    {
+        implicitDestruct(&reg);
+        return NULL;
+    }
+    nitf_HashTable_setPolicy(reg->decompressionExtensions,
+                             NITF_DATA_RETAIN_OWNER);
+
     /*  Start with a clean slate  */
     memset(reg->path, 0, NITF_MAX_PATH);
 
@@ -331,6 +357,8 @@ NITFPRIV(void) implicitDestruct(nitf_PluginRegistry ** reg)
             nitf_HashTable_destruct(&(*reg)->compressionHandlers);
         if ((*reg)->decompressionHandlers)
             nitf_HashTable_destruct(&(*reg)->decompressionHandlers);
+        if ((*reg)->decompressionExtensions)
+            nitf_HashTable_destruct(&(*reg)->decompressionExtensions);
         NITF_FREE(*reg);
         *reg = NULL;
     }
@@ -445,6 +473,9 @@ NITFPROT(NITF_BOOL) nitf_PluginRegistry_unload(nitf_PluginRegistry * reg,
     /*  Pop the front off, until the list is empty  */
     nitf_List* l = reg->dsos;
     NITF_BOOL success = NITF_SUCCESS;
+
+    /* The programs refer to descriptions inside the DSOs */
+    nitf_TREUtils_freeBasicPrograms();
     while ( ! nitf_List_isEmpty(l) )
     {
         nitf_DLL* dso = (nitf_DLL*)nitf_List_popFront(l);
@@ -595,6 +626,44 @@ nitf_PluginRegistry_registerDecompressionHandler(
     return ok;
 }
 
+NITFAPI(NITF_BOOL)
+nitf_PluginRegistry_registerDecompressionExtensions(
+        NITF_PLUGIN_INIT_FUNCTION init,
+        NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION extensions,
+        nitf_Error * error)
+{
+    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(error);
+
+    const char** ident;
+    int i = 1;
+    int ok = 1;
+    if (!reg)
+    {
+        return NITF_FAILURE;
+    }
+    if ( (ident = (*init)(error)) == NULL)
+    {
+        return NITF_FAILURE;
+    }
+
+    if (!ident[0] || (strcmp(ident[0], NITF_PLUGIN_DECOMPRESSION_KEY) != 0))
+    {
+        nitf_Error_initf(error,
+                         NITF_CTXT,
+                         NITF_ERR_INVALID_OBJECT,
+                         "Expected a Decompression identity");
+        return NITF_FAILURE;
+    }
+
+    for (; ident[i] != NULL; ++i)
+    {
+        ok &= nitf_HashTable_insert(reg->decompressionExtensions, ident[i],
+                (NITF_DATA*)extensions, error);
+    }
+
+    return ok;
+}
+
 NITFAPI(NITF_BOOL)
 nitf_PluginRegistry_registerTREHandler(NITF_PLUGIN_INIT_FUNCTION init,
                                        NITF_PLUGIN_TRE_HANDLER_FUNCTION handle,
@@ -852,6 +921,15 @@ nitf_PluginRegistry_retrieveDecompConstructor(nitf_PluginRegistry * reg,
     return (NITF_PLUGIN_DECOMPRESSION_CONSTRUCT_FUNCTION) pair->data;
 }
 
+NITFPROT(NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION)
+nitf_PluginRegistry_retrieveDecompExtensions(nitf_PluginRegistry * reg,
+                                             const char *ident)
+{
+    nitf_Pair *pair = nitf_HashTable_find(reg->decompressionExtensions, ident);
+    return pair ? (NITF_PLUGIN_DECOMPRESSION_EXTENSIONS_FUNCTION) pair->data
+                : NULL;
+}
+
 NITFPROT(NITF_PLUGIN_COMPRESSION_CONSTRUCT_FUNCTION)
 nitf_PluginRegistry_retrieveCompConstructor(nitf_PluginRegistry * reg,
                                             const char *ident,
@@ -956,6 +1034,8 @@ nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
     nitf_Pair *pair;
     /*  We are trying to find tre_main  */
     NITF_PLUGIN_TRE_HANDLER_FUNCTION treMain = NULL;
+    /*  Handlers are shared, so nothing they build may be Record memory  */
+    nitf_Arena *arena;
 
     /*  No error has occurred (yet)  */
     *hadError = 0;
@@ -974,7 +1054,9 @@ nitf_PluginRegistry_retrieveTREHandler(nitf_PluginRegistry * reg,
     /*  If something is, get its DLL part  */
     treMain = (NITF_PLUGIN_TRE_HANDLER_FUNCTION) pair->data;
 
+    arena = nitf_Arena_setCurrent(NULL);
     theHandler = (*treMain)(error);
+    nitf_Arena_setCurrent(arena);
     if (!theHandler)
     {
         *hadError = 1;
@@ -137,6 +137,40 @@ if (!readComponentInfo(reader_, \
 /*  This is the size of each num* (numi, numx, nums, numdes, numres)  */
 #define NITF_IVAL_SZ 3
 
+/*  Headers are parsed out of memory.  This is the minimum amount read    */
+/*  from the input at once when the length of what follows is unknown.    */
+#define NITF_READER_BUFFER_SZ 8192
+
+/*  Fields up to this size are read into a stack buffer                   */
+#define NITF_READER_FIELD_SZ 128
+
+/* Size of the blocks a Record's arena takes from the heap */
+#define NITF_READER_ARENA_CHUNK_SZ 65536
+
+/*  The header buffer wraps the input for the duration of readIO.  It     */
+/*  keeps its own (logical) offset, so tell and seek behave as they do    */
+/*  on the input, and satisfies reads from a window of the input read     */
+/*  with a single positional read.                                        */
+typedef struct _HeaderBufferControl
+{
+    nitf_IOInterface *io;       /* The wrapped input */
+    nitf_Off size;              /* Size of the input */
+    nitf_Off position;          /* Logical offset */
+    char *buffer;               /* The window */
+    size_t capacity;            /* Allocated size of the window */
+    nitf_Off start;             /* Input offset of the window */
+    size_t length;              /* Valid bytes in the window */
+} HeaderBufferControl;
+
+NITFPRIV(nitf_IOInterface *) bufferInput(nitf_IOInterface * io,
+                                         nitf_Error * error);
+
+NITFPRIV(void) unbufferInput(nitf_Reader * reader, NITF_BOOL restore);
+
+NITFPRIV(NITF_BOOL) bufferSection(nitf_Reader * reader,
+                                  nitf_Uint64 length,
+                                  nitf_Error * error);
+
 NITFPRIV(nitf_BandInfo **) readBandInfo(nitf_Reader * reader,
                                         unsigned int nbands,
                                         nitf_Error * error);
@@ -265,12 +299,17 @@ NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
                               nitf_Field * field,
                               int length, nitf_Error * error)
 {
-    char *buf = (char *) NITF_MALLOC(length);
-    if (!buf)
+    char fieldBuf[NITF_READER_FIELD_SZ];
+    char *buf = fieldBuf;
+    if (length > NITF_READER_FIELD_SZ)
     {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                NITF_CTXT, NITF_ERR_MEMORY);
-        goto CATCH_ERROR;
+        buf = (char *) NITF_MALLOC(length);
+        if (!buf)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                    NITF_CTXT, NITF_ERR_MEMORY);
+            goto CATCH_ERROR;
+        }
     }
 
     if (!readField(reader, buf, length, error))
@@ -281,16 +320,18 @@ NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
     {
         if (length == NITF_INT16_SZ)
         {
-            nitf_Int16 int16 =
-                (nitf_Int16)NITF_NTOHS(*((nitf_Int16 *) buf));
+            nitf_Int16 int16;
+            memcpy(&int16, buf, NITF_INT16_SZ);
+            int16 = (nitf_Int16)NITF_NTOHS(int16);
             if (!nitf_Field_setRawData(field,
                     (NITF_DATA *) & int16, length, error))
                 goto CATCH_ERROR;
         }
         else if (length == NITF_INT32_SZ)
         {
-            nitf_Int32 int32 =
-                (nitf_Int32)NITF_NTOHL(*((nitf_Int32 *) buf));
+            nitf_Int32 int32;
+            memcpy(&int32, buf, NITF_INT32_SZ);
+            int32 = (nitf_Int32)NITF_NTOHL(int32);
             if (!nitf_Field_setRawData(field,
                     (NITF_DATA *) & int32, length, error))
                 goto CATCH_ERROR;
@@ -308,11 +349,12 @@ NITFPRIV(NITF_BOOL) readValue(nitf_Reader * reader,
             goto CATCH_ERROR;
     }
 
-    NITF_FREE(buf);
+    if (buf != fieldBuf)
+        NITF_FREE(buf);
     return NITF_SUCCESS;
 
 CATCH_ERROR:
-    if (buf) NITF_FREE(buf);
+    if (buf && buf != fieldBuf) NITF_FREE(buf);
     return NITF_FAILURE;
 }
 
@@ -419,6 +461,269 @@ NITFPRIV(void) resetIOInterface(nitf_Reader * reader)
 }
 
 
+/*  Makes sure the window holds [offset, offset + size), clipped to the    */
+/*  end of the input, reading at least NITF_READER_BUFFER_SZ bytes.        */
+NITFPRIV(NITF_BOOL) HeaderBuffer_fill(HeaderBufferControl * control,
+                                      nitf_Off offset, size_t size,
+                                      nitf_Error * error)
+{
+    size_t length;
+
+    if (offset >= control->start &&
+        offset + (nitf_Off) size <= control->start + (nitf_Off) control->length)
+        return NITF_SUCCESS;
+
+    if (size < NITF_READER_BUFFER_SZ)
+        size = NITF_READER_BUFFER_SZ;
+    if (offset >= control->size)
+        length = 0;
+    else if ((nitf_Off) size > control->size - offset)
+        length = (size_t) (control->size - offset);
+    else
+        length = size;
+
+    if (length > control->capacity)
+    {
+        char *buffer = (char *) NITF_REALLOC(control->buffer, length);
+        if (!buffer)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        control->buffer = buffer;
+        control->capacity = length;
+    }
+
+    /* Invalidate first, in case the read fails part way */
+    control->start = offset;
+    control->length = 0;
+    if (!nitf_IOInterface_readAt(control->io, offset, control->buffer,
+                                 length, error))
+        return NITF_FAILURE;
+    control->length = length;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_readAt(NITF_DATA * data, nitf_Off offset,
+                                        void *buf, size_t size,
+                                        nitf_Error * error)
+{
+    HeaderBufferControl *control = (HeaderBufferControl *) data;
+
+    if (size == 0)
+        return NITF_SUCCESS;
+
+    /* Big reads that miss the window go straight to the input */
+    if (size > NITF_READER_BUFFER_SZ &&
+        (offset < control->start ||
+         offset + (nitf_Off) size > control->start + (nitf_Off) control->length))
+        return nitf_IOInterface_readAt(control->io, offset, buf, size, error);
+
+    if (!HeaderBuffer_fill(control, offset, size, error))
+        return NITF_FAILURE;
+
+    if (offset + (nitf_Off) size > control->start + (nitf_Off) control->length)
+    {
+        nitf_Error_init(error, "Unexpected end of file",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        return NITF_FAILURE;
+    }
+
+    memcpy(buf, control->buffer + (offset - control->start), size);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_read(NITF_DATA * data, void *buf,
+                                      size_t size, nitf_Error * error)
+{
+    HeaderBufferControl *control = (HeaderBufferControl *) data;
+
+    if (!HeaderBuffer_readAt(data, control->position, buf, size, error))
+        return NITF_FAILURE;
+    control->position += (nitf_Off) size;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_write(NITF_DATA * data, const void *buf,
+                                       size_t size, nitf_Error * error)
+{
+    (void) data;
+    (void) buf;
+    (void) size;
+    nitf_Error_init(error, "The reader input is read-only",
+                    NITF_CTXT, NITF_ERR_WRITING_TO_FILE);
+    return NITF_FAILURE;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_canSeek(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_seek(NITF_DATA * data, nitf_Off offset,
+                                     int whence, nitf_Error * error)
+{
+    HeaderBufferControl *control = (HeaderBufferControl *) data;
+    nitf_Off position;
+
+    if (whence == NITF_SEEK_SET)
+        position = offset;
+    else if (whence == NITF_SEEK_CUR)
+        position = control->position + offset;
+    else if (whence == NITF_SEEK_END)
+        position = control->size + offset;
+    else
+    {
+        nitf_Error_init(error, "Invalid/unsupported seek directive",
+                        NITF_CTXT, NITF_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+
+    if (position < 0)
+    {
+        nitf_Error_init(error, "Seek before the start of the file",
+                        NITF_CTXT, NITF_ERR_SEEKING_IN_FILE);
+        return -1;
+    }
+    control->position = position;
+    return position;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_tell(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((HeaderBufferControl *) data)->position;
+}
+
+NITFPRIV(nitf_Off) HeaderBuffer_getSize(NITF_DATA * data, nitf_Error * error)
+{
+    (void) error;
+    return ((HeaderBufferControl *) data)->size;
+}
+
+NITFPRIV(int) HeaderBuffer_getMode(NITF_DATA * data, nitf_Error * error)
+{
+    (void) data;
+    (void) error;
+    return NITF_ACCESS_READONLY;
+}
+
+NITFPRIV(NITF_BOOL) HeaderBuffer_close(NITF_DATA * data, nitf_Error * error)
+{
+    /* The wrapped input is not ours to close */
+    (void) data;
+    (void) error;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) HeaderBuffer_destruct(NITF_DATA * data)
+{
+    HeaderBufferControl *control = (HeaderBufferControl *) data;
+    if (control && control->buffer)
+    {
+        NITF_FREE(control->buffer);
+        control->buffer = NULL;
+    }
+}
+
+static nitf_IIOInterface headerBufferInterface = {
+    &HeaderBuffer_read,
+    &HeaderBuffer_write,
+    &HeaderBuffer_canSeek,
+    &HeaderBuffer_seek,
+    &HeaderBuffer_tell,
+    &HeaderBuffer_getSize,
+    &HeaderBuffer_getMode,
+    &HeaderBuffer_close,
+    &HeaderBuffer_destruct,
+    &HeaderBuffer_readAt
+};
+
+
+NITFPRIV(nitf_IOInterface *) bufferInput(nitf_IOInterface * io,
+                                         nitf_Error * error)
+{
+    nitf_IOInterface *impl = NULL;
+    HeaderBufferControl *control = NULL;
+
+    impl = (nitf_IOInterface *) NITF_MALLOC(sizeof(nitf_IOInterface));
+    if (!impl)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nitf_IOInterface));
+
+    control = (HeaderBufferControl *) NITF_MALLOC(sizeof(HeaderBufferControl));
+    if (!control)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(HeaderBufferControl));
+    impl->data = (NITF_DATA *) control;
+    impl->iface = &headerBufferInterface;
+
+    control->io = io;
+    control->size = nitf_IOInterface_getSize(io, error);
+    if (!NITF_IO_SUCCESS(control->size))
+        goto CATCH_ERROR;
+    control->position = nitf_IOInterface_tell(io, error);
+    if (!NITF_IO_SUCCESS(control->position))
+        goto CATCH_ERROR;
+    return impl;
+
+CATCH_ERROR:
+    if (impl)
+        nitf_IOInterface_destruct(&impl);
+    return NULL;
+}
+
+
+/*  Puts the original input back in place of the header buffer.  On       */
+/*  success, the input is left where parsing ended, as if unbuffered.      */
+NITFPRIV(void) unbufferInput(nitf_Reader * reader, NITF_BOOL restore)
+{
+    nitf_IOInterface *buffered = reader->input;
+    HeaderBufferControl *control;
+    nitf_Error error;
+
+    if (!buffered || buffered->iface != &headerBufferInterface)
+        return;
+
+    control = (HeaderBufferControl *) buffered->data;
+    reader->input = control->io;
+    if (restore)
+        nitf_IOInterface_seek(reader->input, control->position,
+                              NITF_SEEK_SET, &error);
+    nitf_IOInterface_destruct(&buffered);
+}
+
+
+/*  Reads the next length bytes (e.g. a subheader, whose length is known   */
+/*  from the file header) with one read, if they are not already held.     */
+NITFPRIV(NITF_BOOL) bufferSection(nitf_Reader * reader,
+                                  nitf_Uint64 length,
+                                  nitf_Error * error)
+{
+    HeaderBufferControl *control;
+
+    if (reader->input->iface != &headerBufferInterface)
+        return NITF_SUCCESS;
+
+    control = (HeaderBufferControl *) reader->input->data;
+    if ((nitf_Off) length > control->size)
+        length = (nitf_Uint64) control->size;
+    return HeaderBuffer_fill(control, control->position, (size_t) length,
+                             error);
+}
+
+
 NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
 {
     /*  Create the reader */
@@ -443,6 +748,8 @@ NITFAPI(nitf_Reader *) nitf_Reader_construct(nitf_Error * error)
     reader->record = NULL;
     reader->input = NULL;
     reader->ownInput = 0;
+    reader->lazyTREs = 0;
+    reader->recordArena = 0;
     resetIOInterface(reader);
 
     /*  Return our results  */
@@ -504,6 +811,18 @@ NITFAPI(void) nitf_Reader_destruct(nitf_Reader ** reader)
 }
 
 
+NITFAPI(void) nitf_Reader_setLazyTREs(nitf_Reader* reader, NITF_BOOL lazy)
+{
+    reader->lazyTREs = lazy;
+}
+
+NITFAPI(void) nitf_Reader_setRecordArena(nitf_Reader* reader,
+                                         NITF_BOOL useArena)
+{
+    reader->recordArena = useArena;
+}
+
+
 NITFPRIV(NITF_BOOL) readImageSubheader(nitf_Reader * reader,
                                        unsigned int imageIndex,
                                        nitf_Version fver,
@@ -954,6 +1273,13 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
 
     char fileLenBuf[NITF_FL_SZ + 1];    /* File length buffer */
     char streamingBuf[NITF_FL_SZ];
+    nitf_Off startOffset;               /* Offset of FHDR in the input */
+    nitf_Off headerOffset;              /* Offset just past HL */
+
+    /* The NITF may be embedded in a larger input, HL is relative to it */
+    startOffset = nitf_IOInterface_tell(reader->input, error);
+    if (!NITF_IO_SUCCESS(startOffset))
+        goto CATCH_ERROR;
 
     /* FHDR */
     TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_FHDR);
@@ -1028,6 +1354,15 @@ NITFPRIV(NITF_BOOL) readHeader(nitf_Reader * reader, nitf_Error * error)
     TRY_READ_MEMBER_VALUE(reader, fileHeader, NITF_HL);
     NITF_TRY_GET_UINT32(fileHeader->NITF_HL, &num32, error);
 
+    /* Now that the header length is known, read the rest of it at once */
+    headerOffset = nitf_IOInterface_tell(reader->input, error);
+    if (!NITF_IO_SUCCESS(headerOffset))
+        goto CATCH_ERROR;
+    headerOffset -= startOffset;
+    if ((nitf_Off) num32 > headerOffset &&
+        !bufferSection(reader, num32 - headerOffset, error))
+        goto CATCH_ERROR;
+
     /* Read the image info section */
     TRY_READ_COMPONENT(reader,
                        &fileHeader->imageInfo,
@@ -1197,7 +1532,13 @@ NITFPRIV(NITF_BOOL) readTRE(nitf_Reader * reader,
     if (!tre)
         goto CATCH_ERROR;
 
-    if (!handleTRE(reader, length, tre, error))
+    if (reader->lazyTREs)
+    {
+        if (!nitf_TRE_readLazy(tre, reader->input, length, reader->record,
+                               error))
+            goto CATCH_ERROR;
+    }
+    else if (!handleTRE(reader, length, tre, error))
         goto CATCH_ERROR;
 
     /*  Insert the tre into the data store  */
@@ -1382,9 +1723,9 @@ NITFAPI(nitf_Record *) nitf_Reader_read(nitf_Reader * reader,
 }
 
 
-NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
-                                          nitf_IOInterface* io,
-                                          nitf_Error* error)
+NITFPRIV(nitf_Record *) readRecord(nitf_Reader* reader,
+                                   nitf_IOInterface* io,
+                                   nitf_Error* error)
 {
     nitf_Uint32 i = 0;          /* iterator */
     nitf_Uint32 num32;          /* generic uint32 */
@@ -1404,6 +1745,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
     if (!reader->input)
         goto CATCH_ERROR;
 
+    /* Parse headers out of memory, see bufferInput */
+    reader->input = bufferInput(io, error);
+    if (!reader->input)
+        goto CATCH_ERROR;
+
     /*  This part is trivial thanks to our readHeader accessor  */
     if (!readHeader(reader, error))
         goto CATCH_ERROR;
@@ -1429,6 +1775,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
 
         /* Read the sub-header */
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LISH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readImageSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1472,6 +1823,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LSSH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readGraphicSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         graphicSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1510,6 +1866,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LLSH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readLabelSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         labelSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1546,6 +1907,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LTSH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readTextSubheader(reader, i, fver, error))
             goto CATCH_ERROR;
         textSegment->offset = nitf_IOInterface_tell(reader->input,
@@ -1584,6 +1950,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LDSH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readDESubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1608,6 +1979,11 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
             goto CATCH_ERROR;
         }
 
+        NITF_TRY_GET_UINT32(reader->record->header->NITF_LRESH(i),
+                            &length32, error);
+        if (!bufferSection(reader, length32, error))
+            goto CATCH_ERROR;
+
         if (!readRESubheader(reader, i, fver, error))
             goto CATCH_ERROR;
 
@@ -1622,15 +1998,47 @@ NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
         }
     }
 
+    unbufferInput(reader, 1);
     return reader->record;
 
 CATCH_ERROR:
+    unbufferInput(reader, 0);
     nitf_Record_destruct(&reader->record);
     resetIOInterface(reader);
     return NULL;
 }
 
 
+NITFAPI(nitf_Record *) nitf_Reader_readIO(nitf_Reader* reader,
+                                          nitf_IOInterface* io,
+                                          nitf_Error* error)
+{
+    nitf_Arena *arena = NULL;
+    nitf_Arena *previous = NULL;
+    nitf_Record *record = NULL;
+
+    if (!reader->recordArena)
+        return readRecord(reader, io, error);
+
+    arena = nitf_Arena_construct(NITF_READER_ARENA_CHUNK_SZ, error);
+    if (!arena)
+        return NULL;
+
+    /* Fields constructed while reading come out of the arena */
+    previous = nitf_Arena_setCurrent(arena);
+    record = readRecord(reader, io, error);
+    nitf_Arena_setCurrent(previous);
+
+    if (!record)
+    {
+        nitf_Arena_destruct(&arena);
+        return NULL;
+    }
+    record->arena = arena;
+    return record;
+}
+
+
 NITFPRIV(nitf_DecompressionInterface *) getDecompIface(const char *comp,
         int *bad,
         nitf_Error * error)
@@ -597,6 +597,7 @@ NITFAPI(nitf_Record *) nitf_Record_construct(nitf_Version version,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
 
     /*
      * This block does the children creations
@@ -678,6 +679,7 @@ NITFAPI(nitf_Record *) nitf_Record_clone(const nitf_Record * source,
     record->texts = NULL;
     record->dataExtensions = NULL;
     record->reservedExtensions = NULL;
+    record->arena = NULL;
 
     /* Right now, we are only doing the header and image setup  */
     record->header = nitf_FileHeader_clone(source->header, error);
@@ -821,12 +823,24 @@ NITFAPI(void) nitf_Record_destruct(nitf_Record ** record)
             nitf_List_destruct(&(*record)->reservedExtensions);
         }
 
+        /* Last, since everything above may live in it.  The Fields, lists
+         * and TRE data in the arena were skipped by their destructors, so
+         * the walk above only freed the segments, subheaders and TREs
+         * themselves, and the arena takes the rest in one go. */
+        nitf_Arena_destruct(&(*record)->arena);
+
         NITF_FREE(*record);
         *record = NULL;
     }
 }
 
 
+NITFAPI(nitf_Uint64) nitf_Record_getArenaBytes(const nitf_Record * record)
+{
+    return record->arena ? nitf_Arena_getBytesUsed(record->arena) : 0;
+}
+
+
 NITFAPI(nitf_Version) nitf_Record_getVersion(const nitf_Record * record)
 {
     char version[6];
@@ -39,19 +39,13 @@ NITFAPI(NITF_BOOL) nitf_SegmentReader_read(nitf_SegmentReader *
     }
 
     /*
-       Do the read via IOHandle_read. If the virtaul offset is 0 seek to the
-       baseOffset first. This handles the initial read. If the offset is not
-       0 assume the file is positioned to the correct place
-
+       Do the read via IOInterface_readAt from the virtual offset, so the
+       read does not depend on where the underlying file is positioned
      */
-    if (segmentReader->virtualOffset == 0)
-        if (!NITF_IO_SUCCESS(nitf_IOInterface_seek(segmentReader->input,
-                                                   segmentReader->baseOffset,
-                                                   NITF_SEEK_SET, error)))
-            return (NITF_FAILURE);
-
-    ret = nitf_IOInterface_read
-          (segmentReader->input, (char *) buffer, count, error);
+    ret = nitf_IOInterface_readAt(segmentReader->input,
+                                  (nitf_Off) (segmentReader->baseOffset +
+                                              segmentReader->virtualOffset),
+                                  (char *) buffer, count, error);
     segmentReader->virtualOffset += count;
     return ret;
 }
@@ -191,3 +191,243 @@ NITFAPI(const char*) nitf_TRE_getID(nitf_TRE* tre)
 {
     return tre->handler->getID(tre);
 }
+
+/*
+ *  Private data for a TRE that has been read but not parsed.  The raw
+ *  bytes are kept until the first access, when the real handler takes
+ *  over the TRE.  A parse that fails is not retried, later accesses
+ *  report the same error.
+ */
+typedef struct _LazyTREData
+{
+    char* raw;
+    nitf_Uint32 length;
+    struct _nitf_Record* record;    /* The record read into, if known */
+    NITF_BOOL failed;
+    nitf_Error error;               /* Why the parse failed */
+} LazyTREData;
+
+NITFPRIV(nitf_TREHandler*) lazyHandler(void);
+
+/* Release whatever a handler's failed read left behind */
+NITFPRIV(void) lazyDiscard(nitf_TRE* tre)
+{
+    if (tre->priv && tre->handler && tre->handler->destruct)
+        tre->handler->destruct(tre);
+    tre->priv = NULL;
+}
+
+NITFPRIV(NITF_BOOL) lazyParse(nitf_TRE* tre, nitf_Error* error)
+{
+    int bad = 0;
+    NITF_BOOL ok = NITF_FAILURE;
+    LazyTREData* data = (LazyTREData*)tre->priv;
+    nitf_IOInterface* io = NULL;
+    nitf_TREHandler* handler = NULL;
+    nitf_PluginRegistry* reg = NULL;
+
+    if (data->failed)
+    {
+        *error = data->error;
+        return NITF_FAILURE;
+    }
+
+    io = nitf_BufferAdapter_construct(data->raw, data->length, 0, error);
+    if (!io)
+        return NITF_FAILURE;
+
+    reg = nitf_PluginRegistry_getInstance(error);
+    if (reg)
+    {
+        handler = nitf_PluginRegistry_retrieveTREHandler(reg, tre->tag,
+                                                         &bad, error);
+        if (!bad && handler)
+        {
+            tre->handler = handler;
+            tre->priv = NULL;
+            ok = handler->read(io, data->length, tre, data->record, error);
+        }
+    }
+
+    /* same fallback as the Reader, store it raw */
+    if (!ok && !bad)
+    {
+        lazyDiscard(tre);
+        nitf_IOInterface_seek(io, 0, NITF_SEEK_SET, error);
+        tre->handler = nitf_DefaultTRE_handler(error);
+        tre->priv = NULL;
+        if (tre->handler)
+            ok = tre->handler->read(io, data->length, tre, data->record,
+                                    error);
+    }
+    nitf_IOInterface_destruct(&io);
+
+    if (!ok)
+    {
+        /* leave it unparsed, with its raw bytes still usable */
+        lazyDiscard(tre);
+        tre->handler = lazyHandler();
+        tre->priv = data;
+        data->failed = 1;
+        data->error = *error;
+        return NITF_FAILURE;
+    }
+
+    NITF_FREE(data->raw);
+    NITF_FREE(data);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(const char*) lazyGetID(nitf_TRE* tre)
+{
+    nitf_Error error;
+    return lazyParse(tre, &error) ? tre->handler->getID(tre) : NULL;
+}
+
+NITFPRIV(NITF_BOOL) lazySetField(nitf_TRE* tre,
+                                 const char* tag,
+                                 NITF_DATA* data,
+                                 size_t dataLength,
+                                 nitf_Error* error)
+{
+    return lazyParse(tre, error) &&
+        tre->handler->setField(tre, tag, data, dataLength, error);
+}
+
+NITFPRIV(nitf_Field*) lazyGetField(nitf_TRE* tre, const char* tag)
+{
+    nitf_Error error;
+    return lazyParse(tre, &error) ? tre->handler->getField(tre, tag) : NULL;
+}
+
+NITFPRIV(nitf_List*) lazyFind(nitf_TRE* tre,
+                              const char* pattern,
+                              nitf_Error* error)
+{
+    return lazyParse(tre, error) ?
+        tre->handler->find(tre, pattern, error) : NULL;
+}
+
+NITFPRIV(nitf_TREEnumerator*) lazyBegin(nitf_TRE* tre, nitf_Error* error)
+{
+    return lazyParse(tre, error) ? tre->handler->begin(tre, error) : NULL;
+}
+
+/* An untouched TRE is written back exactly as it was read */
+NITFPRIV(NITF_BOOL) lazyWrite(nitf_IOInterface* io,
+                              nitf_TRE* tre,
+                              struct _nitf_Record* record,
+                              nitf_Error* error)
+{
+    LazyTREData* data = (LazyTREData*)tre->priv;
+    return nitf_IOInterface_write(io, data->raw, data->length, error);
+}
+
+NITFPRIV(int) lazyGetCurrentSize(nitf_TRE* tre, nitf_Error* error)
+{
+    return (int)((LazyTREData*)tre->priv)->length;
+}
+
+NITFPRIV(LazyTREData*) lazyConstruct(nitf_Uint32 length, nitf_Error* error)
+{
+    LazyTREData* data = (LazyTREData*)NITF_MALLOC(sizeof(LazyTREData));
+    if (!data)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+
+    /* never a zero-sized allocation */
+    data->raw = (char*)NITF_MALLOC(length + 1);
+    if (!data->raw)
+    {
+        NITF_FREE(data);
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NULL;
+    }
+    data->length = length;
+    data->record = NULL;
+    data->failed = 0;
+    return data;
+}
+
+NITFPRIV(NITF_BOOL) lazyClone(nitf_TRE* source,
+                              nitf_TRE* tre,
+                              nitf_Error* error)
+{
+    LazyTREData* sourceData = (LazyTREData*)source->priv;
+    LazyTREData* data = lazyConstruct(sourceData->length, error);
+    if (!data)
+        return NITF_FAILURE;
+
+    /* The copy is parsed on its own, without the source's record */
+    memcpy(data->raw, sourceData->raw, sourceData->length);
+    tre->priv = data;
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(void) lazyDestruct(nitf_TRE* tre)
+{
+    LazyTREData* data = (LazyTREData*)tre->priv;
+    if (data)
+    {
+        NITF_FREE(data->raw);
+        NITF_FREE(data);
+        tre->priv = NULL;
+    }
+}
+
+NITFPRIV(nitf_TREHandler*) lazyHandler(void)
+{
+    static nitf_TREHandler handler =
+    {
+        NULL,
+        lazyGetID,
+        NULL,
+        lazySetField,
+        lazyGetField,
+        lazyFind,
+        lazyWrite,
+        lazyBegin,
+        lazyGetCurrentSize,
+        lazyClone,
+        lazyDestruct,
+        NULL
+    };
+    return &handler;
+}
+
+NITFPROT(NITF_BOOL) nitf_TRE_readLazy(nitf_TRE* tre,
+                                      nitf_IOInterface* io,
+                                      nitf_Uint32 length,
+                                      struct _nitf_Record* record,
+                                      nitf_Error* error)
+{
+    LazyTREData* data = lazyConstruct(length, error);
+    if (!data)
+        return NITF_FAILURE;
+
+    if (length > 0 && !nitf_IOInterface_read(io, data->raw, length, error))
+    {
+        NITF_FREE(data->raw);
+        NITF_FREE(data);
+        return NITF_FAILURE;
+    }
+
+    data->record = record;
+    tre->handler = lazyHandler();
+    tre->priv = data;
+    return NITF_SUCCESS;
+}
+
+NITFAPI(NITF_BOOL) nitf_TRE_isParsed(nitf_TRE* tre)
+{
+    return tre->handler != lazyHandler();
+}
+
+NITFAPI(NITF_BOOL) nitf_TRE_parse(nitf_TRE* tre, nitf_Error* error)
+{
+    return nitf_TRE_isParsed(tre) ? NITF_SUCCESS : lazyParse(tre, error);
+}
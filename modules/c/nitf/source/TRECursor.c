@@ -98,8 +98,10 @@ NITFAPI(nitf_TRECursor) nitf_TRECursor_begin(nitf_TRE * tre)
     tre_cursor.end_ptr = NULL;
     tre_cursor.prev_ptr = NULL;
     tre_cursor.desc_ptr = NULL;
+    tre_cursor.tre = NULL;
 
-    if (tre)
+    /* A lazily read TRE has no description until it is parsed */
+    if (tre && nitf_TRE_parse(tre, &error))
     {
         /* set the start index */
         tre_cursor.index = -1;
@@ -257,6 +259,12 @@ NITFAPI(int) nitf_TRECursor_iterate(nitf_TRECursor * tre_cursor,
                         NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!tre_cursor->tre)
+    {
+        nitf_Error_init(error, "TRE is missing or could not be parsed",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
 
     /* count how many descriptions there are */
 
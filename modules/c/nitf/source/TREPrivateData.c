@@ -22,26 +22,59 @@
 
 #include "nitf/TREPrivateData.h"
 
+/*
+ *  Private data built in an arena keeps everything it holds (its name,
+ *  its hash table and the Fields in it) in that arena for as long as it
+ *  lives, so destroying it is a no-op and the arena releases it all.
+ */
+NITFPRIV(void) freeMemory(nitf_TREPrivateData *priv, void *p)
+{
+    if (!priv->arena)
+        NITF_FREE(p);
+}
+
+NITFPRIV(nitf_HashTable *) constructHash(nitf_TREPrivateData *priv,
+                                         nitf_Error * error)
+{
+    nitf_HashTable *hash;
+    nitf_Arena *previous = nitf_Arena_setCurrent(priv->arena);
+    hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    nitf_Arena_setCurrent(previous);
+    return hash;
+}
 
 NITFAPI(nitf_TREPrivateData *) nitf_TREPrivateData_construct(
         nitf_Error * error)
 {
-    nitf_TREPrivateData *priv = (nitf_TREPrivateData*) NITF_MALLOC(
-            sizeof(nitf_TREPrivateData));
-    if (!priv)
+    nitf_TREPrivateData *priv;
+    nitf_Arena *arena = nitf_Arena_getCurrent();
+    if (arena)
     {
-        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                        NITF_CTXT, NITF_ERR_MEMORY);
-        return NULL;
+        priv = (nitf_TREPrivateData*) nitf_Arena_malloc(
+                arena, sizeof(nitf_TREPrivateData), error);
+        if (!priv)
+            return NULL;
+    }
+    else
+    {
+        priv = (nitf_TREPrivateData*) NITF_MALLOC(
+                sizeof(nitf_TREPrivateData));
+        if (!priv)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                            NITF_CTXT, NITF_ERR_MEMORY);
+            return NULL;
+        }
     }
 
+    priv->arena = arena;
     priv->length = 0;
     priv->descriptionName = NULL;
     priv->description = NULL;
     priv->userData = NULL;
 
     /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    priv->hash = constructHash(priv, error);
 
     if (!priv->hash)
     {
@@ -81,7 +114,10 @@ nitf_TREPrivateData_clone(nitf_TREPrivateData *source, nitf_Error * error)
 
     if (source)
     {
+        /* always on the heap, like the Field clones that go in it */
+        nitf_Arena *previous = nitf_Arena_setCurrent(NULL);
         priv = nitf_TREPrivateData_construct(error);
+        nitf_Arena_setCurrent(previous);
         if (!priv)
             goto CATCH_ERROR;
 
@@ -159,11 +195,16 @@ NITFPRIV(int) destructHashValue(nitf_HashTable * ht,
 NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
 {
     nitf_Error e;
-    if (*priv)
+    if (*priv && (*priv)->arena)
+    {
+        /* the arena owns all of it */
+        *priv = NULL;
+    }
+    else if (*priv)
     {
         if ((*priv)->descriptionName)
         {
-            NITF_FREE((*priv)->descriptionName);
+            freeMemory(*priv, (*priv)->descriptionName);
             (*priv)->descriptionName = NULL;
         }
         if ((*priv)->hash)
@@ -176,7 +217,7 @@ NITFAPI(void) nitf_TREPrivateData_destruct(nitf_TREPrivateData **priv)
             nitf_HashTable_destruct(&((*priv)->hash));
 
         }
-        NITF_FREE(*priv);
+        freeMemory(*priv, *priv);
         *priv = NULL;
     }
 }
@@ -197,7 +238,7 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_flush(nitf_TREPrivateData *priv,
     }
 
     /* create the hashtable for the fields */
-    priv->hash = nitf_HashTable_construct(NITF_TRE_HASH_SIZE, error);
+    priv->hash = constructHash(priv, error);
 
     if (!priv->hash)
     {
@@ -217,19 +258,29 @@ NITFPROT(NITF_BOOL) nitf_TREPrivateData_setDescriptionName(
     /* if already set, free it */
     if (priv->descriptionName)
     {
-        NITF_FREE(priv->descriptionName);
+        freeMemory(priv, priv->descriptionName);
         priv->descriptionName = NULL;
     }
 
     /* copy the description id */
     if (name)
     {
-        priv->descriptionName = (char*)NITF_MALLOC(strlen(name) + 1);
-        if (!priv->descriptionName)
+        if (priv->arena)
         {
-            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
-                    NITF_CTXT, NITF_ERR_MEMORY);
-            return NITF_FAILURE;
+            priv->descriptionName = (char*)nitf_Arena_malloc(
+                    priv->arena, strlen(name) + 1, error);
+            if (!priv->descriptionName)
+                return NITF_FAILURE;
+        }
+        else
+        {
+            priv->descriptionName = (char*)NITF_MALLOC(strlen(name) + 1);
+            if (!priv->descriptionName)
+            {
+                nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO),
+                        NITF_CTXT, NITF_ERR_MEMORY);
+                return NITF_FAILURE;
+            }
         }
         strcpy(priv->descriptionName, name);
     }
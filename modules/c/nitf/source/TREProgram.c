@@ -0,0 +1,973 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nitf/TREProgram.h"
+#include "nitf/TREPrivateData.h"
+
+/* Same limits as the nitf_TRECursor */
+#define TAG_BUF_LEN 256
+#define MAX_DEPTH 10
+
+/* Instruction opcodes */
+enum
+{
+    OP_FIELD,
+    OP_LOOP,
+    OP_ENDLOOP,
+    OP_IF,
+    OP_ENDIF,
+    OP_NOP
+};
+
+/* Where a loop count comes from */
+enum
+{
+    COUNT_CONSTANT,
+    COUNT_FUNCTION,
+    COUNT_FIELD
+};
+
+/* Condition operators */
+enum
+{
+    COND_EQ,            /* String comparisons */
+    COND_NE,
+    COND_LT,            /* Integer comparisons */
+    COND_GT,
+    COND_LE,
+    COND_GE,
+    COND_EQUAL,
+    COND_NOT_EQUAL,
+    COND_BITS           /* Bit test */
+};
+
+/* Postfix length expression tokens */
+enum
+{
+    TOKEN_NUMBER,
+    TOKEN_FIELD,
+    TOKEN_OPERATOR
+};
+
+typedef unsigned int (*NITF_TRE_PROGRAM_COUNT_FUNCTION) (nitf_TRE *,
+                                                         char idx[10][10],
+                                                         int,
+                                                         nitf_Error*);
+
+typedef struct _nitf_TREToken
+{
+    int kind;
+    int value;          /* The number, operator or slot */
+} nitf_TREToken;
+
+typedef struct _nitf_TREInstruction
+{
+    int op;
+    nitf_TREDescription *desc;  /* The entry it was compiled from */
+    int parent;         /* The innermost enclosing LOOP, or -1 */
+    int jump;           /* LOOP, IF: their end; ENDLOOP: its LOOP */
+    size_t tagLength;
+
+    /* OP_FIELD */
+    int slot;           /* Where it is kept if referred to, or -1 */
+    nitf_TREToken *tokens;      /* The conditional length, if any */
+    int numTokens;
+
+    /* OP_LOOP, OP_IF */
+    int kind;           /* COUNT_ or COND_ */
+    int ref;            /* The slot of the field it tests */
+    int value;          /* The constant count or operand */
+    char arith;         /* Loop count operator, or 0 */
+    const char *operand;        /* String operand of a condition */
+} nitf_TREInstruction;
+
+/* Where the fields that are referred to were last read */
+typedef struct _nitf_TRESlot
+{
+    nitf_Field *field;
+    int idx[MAX_DEPTH];
+} nitf_TRESlot;
+
+
+/*
+ *  Find the one field named by a reference, and give it a slot.  Only
+ *  fields read earlier, at the same or an enclosing loop level, are taken:
+ *  the latest one read is then the one the tag lookup of the cursor would
+ *  find.  Anything else fails, leaving the description to the cursor.
+ */
+NITFPRIV(int) resolve(nitf_TREProgram * program, int at, const char *name)
+{
+    nitf_TREInstruction *instructions = program->instructions;
+    int found = -1;
+    int depth = 0;
+    int parent;
+    int i;
+
+    if (strchr(name, '['))
+        return -1;
+
+    for (i = 0; i < program->numInstructions; ++i)
+    {
+        if (instructions[i].op == OP_FIELD &&
+            strcmp(instructions[i].desc->tag, name) == 0)
+        {
+            if (found >= 0)
+                return -1;
+            found = i;
+        }
+    }
+    if (found < 0 || found >= at)
+        return -1;
+
+    for (parent = instructions[at].parent;
+         parent != instructions[found].parent && parent >= 0;
+         parent = instructions[parent].parent)
+        ;
+    if (parent != instructions[found].parent)
+        return -1;
+
+    if (instructions[found].slot < 0)
+    {
+        for (parent = instructions[found].parent; parent >= 0;
+             parent = instructions[parent].parent)
+            ++depth;
+        program->slotDepth[program->numSlots] = depth;
+        instructions[found].slot = program->numSlots++;
+    }
+    return instructions[found].slot;
+}
+
+/*
+ *  The description of the field given a slot
+ */
+NITFPRIV(nitf_TREDescription *) slotDesc(nitf_TREProgram * program, int slot)
+{
+    int i;
+
+    for (i = 0; i < program->numInstructions; ++i)
+    {
+        if (program->instructions[i].op == OP_FIELD &&
+            program->instructions[i].slot == slot)
+            return program->instructions[i].desc;
+    }
+    return NULL;
+}
+
+/*
+ *  Can the field in a slot be read as an int?  One that cannot fails every
+ *  read the same way, and since the cursor then takes it as 0 or false, a
+ *  description that needs it is left to the cursor.
+ */
+NITFPRIV(NITF_BOOL) slotIsInteger(nitf_TREProgram * program, int slot)
+{
+    nitf_TREDescription *desc = slotDesc(program, slot);
+
+    if (desc->data_type == NITF_BCS_N)
+        return NITF_SUCCESS;
+    return desc->data_type == NITF_BINARY &&
+        (desc->data_count == NITF_INT16_SZ ||
+         desc->data_count == NITF_INT32_SZ ||
+         desc->data_count == NITF_INT64_SZ);
+}
+
+NITFPRIV(NITF_BOOL) compileLoop(nitf_TREProgram * program, int at)
+{
+    nitf_TREInstruction *in = &program->instructions[at];
+    const char *op;
+
+    if (!in->desc->tag)
+        return NITF_FAILURE;
+
+    if (in->desc->label && strcmp(in->desc->label, NITF_CONST_N) == 0)
+    {
+        in->kind = COUNT_CONSTANT;
+        in->value = NITF_ATO32(in->desc->tag);
+        return NITF_SUCCESS;
+    }
+    if (in->desc->label && strcmp(in->desc->label, NITF_FUNCTION) == 0)
+    {
+        in->kind = COUNT_FUNCTION;
+        return NITF_SUCCESS;
+    }
+
+    in->kind = COUNT_FIELD;
+    if ((in->ref = resolve(program, at, in->desc->tag)) < 0 ||
+        !slotIsInteger(program, in->ref))
+        return NITF_FAILURE;
+
+    if (in->desc->label && strlen(in->desc->label) != 0)
+    {
+        op = in->desc->label;
+        while (isspace(*op))
+            op++;
+        if (*op != '+' && *op != '-' && *op != '*' && *op != '/' &&
+            *op != '%')
+            return NITF_FAILURE;
+        in->arith = *op++;
+        while (isspace(*op))
+            op++;
+        in->value = NITF_ATO32(op);
+        if ((in->arith == '/' || in->arith == '%') && in->value == 0)
+            return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) compileIf(nitf_TREProgram * program, int at)
+{
+    static const char *conditions[] =
+    {
+        "eq", "ne", "<", ">", "<=", ">=", "==", "!=", "&", NULL
+    };
+    nitf_TREInstruction *in = &program->instructions[at];
+    const char *op;
+    const char *space;
+    int type;
+    int i;
+
+    if (!in->desc->tag || !in->desc->label)
+        return NITF_FAILURE;
+    if ((in->ref = resolve(program, at, in->desc->tag)) < 0)
+        return NITF_FAILURE;
+
+    op = in->desc->label;
+    while (isspace(*op))
+        op++;
+    if (!(space = strchr(op, ' ')))
+        return NITF_FAILURE;
+
+    for (i = 0; conditions[i]; ++i)
+    {
+        if (strlen(conditions[i]) == (size_t)(space - op) &&
+            strncmp(conditions[i], op, space - op) == 0)
+            break;
+    }
+    if (!conditions[i])
+        return NITF_FAILURE;
+
+    in->kind = i;
+    in->operand = space + 1;
+
+    /* Like a field that is no int, a condition that does not suit the
+     * type of its field fails every read, and the cursor takes it as false */
+    type = slotDesc(program, in->ref)->data_type;
+    if (in->kind == COND_EQ || in->kind == COND_NE)
+    {
+        if (type == NITF_BCS_N)
+            return NITF_FAILURE;
+    }
+    else if (in->kind == COND_BITS)
+    {
+        if (type != NITF_BINARY || !slotIsInteger(program, in->ref))
+            return NITF_FAILURE;
+    }
+    else if (type != NITF_BCS_N)
+    {
+        return NITF_FAILURE;
+    }
+
+    if (in->kind == COND_BITS)
+        in->value = (int)NITF_ATOU32_BASE(in->operand, 0);
+    else if (in->kind != COND_EQ && in->kind != COND_NE)
+        in->value = NITF_ATO32(in->operand);
+    return NITF_SUCCESS;
+}
+
+NITFPRIV(NITF_BOOL) compileLength(nitf_TREProgram * program, int at)
+{
+    nitf_TREInstruction *in = &program->instructions[at];
+    const char *expression = in->desc->special;
+    char token[TAG_BUF_LEN];
+    const char *cur;
+    size_t length;
+
+    /* Without an expression, the field is always skipped */
+    if (!expression)
+        return NITF_SUCCESS;
+    if (strlen(expression) >= TAG_BUF_LEN)
+        return NITF_FAILURE;
+
+    /* There can be no more tokens than half the characters, rounded up */
+    in->tokens = (nitf_TREToken *)NITF_MALLOC(
+            sizeof(nitf_TREToken) * (strlen(expression) / 2 + 1));
+    if (!in->tokens)
+        return NITF_FAILURE;
+
+    for (cur = expression; *cur; cur += length)
+    {
+        nitf_TREToken *t = &in->tokens[in->numTokens];
+
+        while (isspace(*cur))
+            cur++;
+        for (length = 0; cur[length] && !isspace(cur[length]); ++length)
+            ;
+        if (length == 0)
+            break;
+        if (length >= sizeof(token))
+            return NITF_FAILURE;
+        memcpy(token, cur, length);
+        token[length] = 0;
+
+        if (length == 1 && strchr("+-*/%", token[0]))
+        {
+            t->kind = TOKEN_OPERATOR;
+            t->value = token[0];
+        }
+        else if (nitf_Utils_isNumeric(token))
+        {
+            t->kind = TOKEN_NUMBER;
+            t->value = NITF_ATO32(token);
+        }
+        else
+        {
+            t->kind = TOKEN_FIELD;
+            if ((t->value = resolve(program, at, token)) < 0 ||
+                !slotIsInteger(program, t->value))
+                return NITF_FAILURE;
+        }
+        in->numTokens++;
+    }
+    return NITF_SUCCESS;
+}
+
+
+NITFPROT(nitf_TREProgram *) nitf_TREProgram_compile(
+        nitf_TREDescription * description, nitf_Error * error)
+{
+    nitf_TREProgram *program = NULL;
+    nitf_TREInstruction *in;
+    int loops[MAX_DEPTH];
+    int numLoops = 0;
+    nitf_IntStack *ifs = NULL;
+    NITF_BOOL fixed = 1;
+    int count = 0;
+    int i;
+
+    while (description[count].data_type != NITF_END)
+        count++;
+
+    program = (nitf_TREProgram *)NITF_MALLOC(sizeof(nitf_TREProgram));
+    if (!program)
+        goto CATCH_MEMORY;
+    memset(program, 0, sizeof(nitf_TREProgram));
+    program->instructions = (nitf_TREInstruction *)NITF_MALLOC(
+            sizeof(nitf_TREInstruction) * (count + 1));
+    program->slotDepth = (int *)NITF_MALLOC(sizeof(int) * (count + 1));
+    if (!program->instructions || !program->slotDepth)
+        goto CATCH_MEMORY;
+    memset(program->instructions, 0, sizeof(nitf_TREInstruction) * count);
+    program->numInstructions = count;
+    if (!(ifs = nitf_IntStack_construct(error)))
+        goto CATCH_ERROR;
+
+    /* Lay out the instructions and match up the blocks */
+    program->fixedLength = 0;
+    for (i = 0; i < count; ++i)
+    {
+        in = &program->instructions[i];
+        in->desc = &description[i];
+        in->parent = numLoops > 0 ? loops[numLoops - 1] : -1;
+        in->slot = -1;
+        in->ref = -1;
+        in->tagLength = in->desc->tag ? strlen(in->desc->tag) : 0;
+
+        switch (in->desc->data_type)
+        {
+        case NITF_BCS_A:
+        case NITF_BCS_N:
+        case NITF_BINARY:
+            in->op = OP_FIELD;
+            if (!in->desc->tag || in->tagLength >= TAG_BUF_LEN)
+                goto CATCH_UNSUPPORTED;
+            if (in->desc->data_count >= 0)
+                program->fixedLength += in->desc->data_count;
+            else if (in->desc->data_count == NITF_TRE_GOBBLE ||
+                     in->desc->data_count == NITF_TRE_CONDITIONAL_LENGTH)
+                fixed = 0;
+            else
+                goto CATCH_UNSUPPORTED;
+            break;
+        case NITF_LOOP:
+            in->op = OP_LOOP;
+            if (numLoops == MAX_DEPTH)
+                goto CATCH_UNSUPPORTED;
+            loops[numLoops++] = i;
+            fixed = 0;
+            break;
+        case NITF_ENDLOOP:
+            in->op = OP_ENDLOOP;
+            if (numLoops == 0)
+                goto CATCH_UNSUPPORTED;
+            in->jump = loops[--numLoops];
+            program->instructions[in->jump].jump = i;
+            break;
+        case NITF_IF:
+            in->op = OP_IF;
+            nitf_IntStack_push(ifs, i, error);
+            fixed = 0;
+            break;
+        case NITF_ENDIF:
+            in->op = OP_ENDIF;
+            if (nitf_IntStack_depth(ifs, error) < 0)
+                goto CATCH_UNSUPPORTED;
+            in->jump = nitf_IntStack_pop(ifs, error);
+            program->instructions[in->jump].jump = i;
+            break;
+        case NITF_COMP_LEN:
+            in->op = OP_NOP;
+            break;
+        default:
+            goto CATCH_UNSUPPORTED;
+        }
+    }
+    if (numLoops != 0 || nitf_IntStack_depth(ifs, error) >= 0)
+        goto CATCH_UNSUPPORTED;
+    if (!fixed)
+        program->fixedLength = -1;
+
+    /* Now that every field is known, resolve the references to them */
+    for (i = 0; i < count; ++i)
+    {
+        in = &program->instructions[i];
+        if ((in->op == OP_LOOP && !compileLoop(program, i)) ||
+            (in->op == OP_IF && !compileIf(program, i)) ||
+            (in->op == OP_FIELD &&
+             in->desc->data_count == NITF_TRE_CONDITIONAL_LENGTH &&
+             !compileLength(program, i)))
+            goto CATCH_UNSUPPORTED;
+    }
+
+    nitf_IntStack_destruct(&ifs);
+    return program;
+
+  CATCH_MEMORY:
+    nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                    NITF_ERR_MEMORY);
+    goto CATCH_ERROR;
+
+  CATCH_UNSUPPORTED:
+    nitf_Error_init(error, "TRE description cannot be compiled",
+                    NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+
+  CATCH_ERROR:
+    if (ifs)
+        nitf_IntStack_destruct(&ifs);
+    nitf_TREProgram_destruct(&program);
+    return NULL;
+}
+
+
+NITFPROT(NITF_BOOL) nitf_TREProgram_fits(nitf_TREProgram * program,
+                                         nitf_Uint32 length)
+{
+    /* Data can run out before the description does, but not the reverse */
+    return program->fixedLength < 0 ||
+        (nitf_Uint32)program->fixedLength >= length;
+}
+
+
+/*
+ *  The field a reference resolves to, if it was read at the current loop
+ *  indices
+ */
+NITFPRIV(nitf_Field *) lookup(nitf_TREProgram * program,
+                              nitf_TRESlot * slots,
+                              int slot,
+                              const int *idx)
+{
+    const int depth = program->slotDepth[slot];
+
+    if (!slots[slot].field ||
+        memcmp(slots[slot].idx, idx, sizeof(int) * depth) != 0)
+        return NULL;
+    return slots[slot].field;
+}
+
+/*
+ *  Evaluate a loop count, returning -1 on failure
+ */
+NITFPRIV(int) evalLoop(nitf_TREProgram * program,
+                       nitf_TREInstruction * in,
+                       nitf_TRE * tre,
+                       nitf_TRESlot * slots,
+                       const int *idx,
+                       int depth,
+                       nitf_Error * error)
+{
+    nitf_Field *field;
+    int loops;
+    int i;
+
+    switch (in->kind)
+    {
+    case COUNT_CONSTANT:
+        loops = in->value;
+        break;
+    case COUNT_FUNCTION:
+    {
+        char idx_str[10][10];
+        NITF_TRE_PROGRAM_COUNT_FUNCTION fn =
+            (NITF_TRE_PROGRAM_COUNT_FUNCTION)in->desc->tag;
+
+        for (i = 0; i < depth; ++i)
+            NITF_SNPRINTF(idx_str[i], sizeof(idx_str[i]), "[%d]", idx[i]);
+        loops = (*fn)(tre, idx_str, depth, error);
+        if (loops == -1)
+            return -1;
+        break;
+    }
+    default:
+        if (!(field = lookup(program, slots, in->ref, idx)))
+        {
+            nitf_Error_init(error,
+                            "nitf_TREProgram_parse: invalid TRE loop counter",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return -1;
+        }
+        if (!nitf_Field_get(field, (char *)&loops, NITF_CONV_INT,
+                            sizeof(loops), error))
+            return -1;
+
+        switch (in->arith)
+        {
+        case '+':
+            loops += in->value;
+            break;
+        case '-':
+            loops -= in->value;
+            break;
+        case '*':
+            loops *= in->value;
+            break;
+        case '/':
+            loops /= in->value;
+            break;
+        case '%':
+            loops %= in->value;
+            break;
+        default:
+            break;
+        }
+    }
+    return loops < 0 ? 0 : loops;
+}
+
+/*
+ *  Evaluate a condition, returning -1 on failure
+ */
+NITFPRIV(int) evalIf(nitf_TREProgram * program,
+                     nitf_TREInstruction * in,
+                     nitf_TRESlot * slots,
+                     const int *idx,
+                     nitf_Error * error)
+{
+    nitf_Field *field;
+    int fieldData;
+    unsigned int bitFieldData;
+    int status;
+
+    if (!(field = lookup(program, slots, in->ref, idx)))
+    {
+        nitf_Error_init(error, "Unable to find tag in TRE hash",
+                        NITF_CTXT, NITF_ERR_UNK);
+        return -1;
+    }
+
+    switch (in->kind)
+    {
+    case COND_EQ:
+    case COND_NE:
+        if (field->type == NITF_BCS_N)
+        {
+            nitf_Error_init(error,
+                            "evaluate: can't use eq/ne to compare a number",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return -1;
+        }
+        status = strncmp(field->raw, in->operand, field->length);
+        return in->kind == COND_EQ ? !status : status != 0;
+
+    case COND_BITS:
+        if (field->type != NITF_BINARY)
+        {
+            nitf_Error_init(error,
+                            "evaluate: must use binary data for bit-wise expressions",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return -1;
+        }
+        if (!nitf_Field_get(field, (char *)&bitFieldData, NITF_CONV_UINT,
+                            sizeof(bitFieldData), error))
+            return -1;
+        return ((unsigned int)in->value & bitFieldData) != 0;
+
+    default:
+        if (field->type != NITF_BCS_N)
+        {
+            nitf_Error_init(error,
+                            "evaluate: can't use strings for logical expressions",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+            return -1;
+        }
+        if (!nitf_Field_get(field, (char *)&fieldData, NITF_CONV_INT,
+                            sizeof(fieldData), error))
+            return -1;
+
+        status = fieldData - in->value;
+        switch (in->kind)
+        {
+        case COND_LT:
+            return status < 0;
+        case COND_GT:
+            return status > 0;
+        case COND_LE:
+            return status <= 0;
+        case COND_GE:
+            return status >= 0;
+        case COND_EQUAL:
+            return status == 0;
+        default:
+            return status != 0;
+        }
+    }
+}
+
+/*
+ *  Evaluate a conditional length, returning -1 on failure
+ */
+NITFPRIV(int) evalLength(nitf_TREProgram * program,
+                         nitf_TREInstruction * in,
+                         nitf_TRESlot * slots,
+                         const int *idx,
+                         nitf_Error * error)
+{
+    int stack[TAG_BUF_LEN / 2 + 1];
+    int depth = 0;
+    int i;
+
+    for (i = 0; i < in->numTokens; ++i)
+    {
+        const nitf_TREToken *t = &in->tokens[i];
+
+        if (t->kind == TOKEN_OPERATOR)
+        {
+            int op1, op2;
+
+            if (depth == 0)
+            {
+                nitf_Error_init(error,
+                        "nitf_TREProgram_parse: invalid expression",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return -1;
+            }
+            op2 = stack[--depth];
+            /* assume 0 for the first operand of a unary op */
+            op1 = depth == 0 ? 0 : stack[--depth];
+
+            switch (t->value)
+            {
+            case '+':
+                stack[depth++] = op1 + op2;
+                break;
+            case '-':
+                stack[depth++] = op1 - op2;
+                break;
+            case '*':
+                stack[depth++] = op1 * op2;
+                break;
+            case '/':
+            case '%':
+                if (op2 == 0)
+                {
+                    nitf_Error_init(error,
+                            "nitf_TREProgram_parse: attempt to divide by zero",
+                            NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                    return -1;
+                }
+                stack[depth++] = t->value == '/' ? op1 / op2 : op1 % op2;
+                break;
+            }
+        }
+        else if (t->kind == TOKEN_NUMBER)
+        {
+            stack[depth++] = t->value;
+        }
+        else
+        {
+            nitf_Field *field = lookup(program, slots, t->value, idx);
+
+            if (!field)
+            {
+                nitf_Error_init(error,
+                        "nitf_TREProgram_parse: invalid TRE field reference",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+                return -1;
+            }
+            if (!nitf_Field_get(field, (char *)&stack[depth], NITF_CONV_INT,
+                                sizeof(int), error))
+                return -1;
+            depth++;
+        }
+    }
+
+    if (depth != 1)
+    {
+        nitf_Error_init(error, "Invalid postfix expression",
+                        NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
+        return -1;
+    }
+    return stack[0];
+}
+
+/*
+ *  Rewrite the "[i][j]..." loop suffix from the given level down
+ */
+NITFPRIV(void) setSuffix(char *suffix, int *suffixEnd, const int *idx,
+                         int from, int depth)
+{
+    int i;
+
+    for (i = from; i < depth; ++i)
+    {
+        int n = NITF_SNPRINTF(suffix + suffixEnd[i], TAG_BUF_LEN - suffixEnd[i],
+                              "[%d]", idx[i]);
+        suffixEnd[i + 1] = suffixEnd[i] +
+            (n < 0 || n >= TAG_BUF_LEN - suffixEnd[i] ?
+             TAG_BUF_LEN - 1 - suffixEnd[i] : n);
+    }
+}
+
+NITFPROT(int) nitf_TREProgram_parse(nitf_TREProgram * program,
+                                    nitf_TRE * tre,
+                                    char *bufptr,
+                                    nitf_Error * error)
+{
+    nitf_TREPrivateData *privData = (nitf_TREPrivateData*)tre->priv;
+    const int total = (int)privData->length;
+    nitf_TRESlot *slots = NULL;
+    nitf_Field *field = NULL;
+    int idx[MAX_DEPTH];
+    int counts[MAX_DEPTH];
+    int depth = 0;
+    char suffix[TAG_BUF_LEN];
+    int suffixEnd[MAX_DEPTH + 1];
+    char tag[TAG_BUF_LEN];
+    int offset = 0;
+    int pc = 0;
+    int loops;
+    int status = NITF_SUCCESS;
+
+    /* flush the hash first, to protect from duplicate entries */
+    nitf_TREPrivateData_flush(privData, error);
+
+    if (program->numSlots > 0)
+    {
+        slots = (nitf_TRESlot *)NITF_MALLOC(
+                sizeof(nitf_TRESlot) * program->numSlots);
+        if (!slots)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            return NITF_FAILURE;
+        }
+        memset(slots, 0, sizeof(nitf_TRESlot) * program->numSlots);
+    }
+    suffix[0] = 0;
+    suffixEnd[0] = 0;
+
+    while (pc < program->numInstructions && offset < total)
+    {
+        nitf_TREInstruction *in = &program->instructions[pc];
+        int length;
+
+        switch (in->op)
+        {
+        case OP_FIELD:
+            length = in->desc->data_count;
+            if (length == NITF_TRE_CONDITIONAL_LENGTH)
+            {
+                length = in->tokens ?
+                    evalLength(program, in, slots, idx, error) : 0;
+                if (length < 0)
+                {
+                    nitf_Error_print(error, stderr, "TRE expression error:");
+                    goto DONE;
+                }
+                if (length == 0)
+                {
+                    pc++;
+                    break;
+                }
+            }
+            else if (length == NITF_TRE_GOBBLE)
+            {
+                length = total - offset;
+            }
+
+            if (length > total - offset)
+            {
+                nitf_Error_init(error, "TRE data is shorter than it should be",
+                                NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+                goto CATCH_ERROR;
+            }
+
+            field = nitf_Field_constructIn(length, in->desc->data_type,
+                                           privData->arena, error);
+            if (!field)
+                goto CATCH_ERROR;
+
+            if (field->type == NITF_BINARY && length == NITF_INT16_SZ)
+            {
+                nitf_Int16 int16;
+                memcpy(&int16, bufptr + offset, sizeof(int16));
+                int16 = (nitf_Int16)NITF_NTOHS(int16);
+                status = nitf_Field_setRawData(field, (NITF_DATA *)&int16,
+                                               length, error);
+            }
+            else if (field->type == NITF_BINARY && length == NITF_INT32_SZ)
+            {
+                nitf_Int32 int32;
+                memcpy(&int32, bufptr + offset, sizeof(int32));
+                int32 = (nitf_Int32)NITF_NTOHL(int32);
+                status = nitf_Field_setRawData(field, (NITF_DATA *)&int32,
+                                               length, error);
+            }
+            else
+            {
+                status = nitf_Field_setRawData(field,
+                                               (NITF_DATA *)(bufptr + offset),
+                                               length, error);
+            }
+            if (!status)
+            {
+                nitf_Field_destruct(&field);
+                goto CATCH_ERROR;
+            }
+
+            memcpy(tag, in->desc->tag, in->tagLength);
+            if (in->tagLength + suffixEnd[depth] < TAG_BUF_LEN)
+            {
+                memcpy(tag + in->tagLength, suffix, suffixEnd[depth] + 1);
+            }
+            else
+            {
+                memcpy(tag + in->tagLength, suffix,
+                       TAG_BUF_LEN - 1 - in->tagLength);
+                tag[TAG_BUF_LEN - 1] = 0;
+            }
+            nitf_HashTable_insert(privData->hash, tag, field, error);
+
+            if (in->slot >= 0)
+            {
+                slots[in->slot].field = field;
+                memcpy(slots[in->slot].idx, idx, sizeof(int) * depth);
+            }
+            offset += length;
+            pc++;
+            break;
+
+        case OP_LOOP:
+            loops = evalLoop(program, in, tre, slots, idx, depth, error);
+            if (loops < 0)
+                goto CATCH_ERROR;
+            if (loops > 0)
+            {
+                counts[depth] = loops;
+                idx[depth] = 0;
+                setSuffix(suffix, suffixEnd, idx, depth, depth + 1);
+                depth++;
+                pc++;
+            }
+            else
+            {
+                pc = in->jump + 1;
+            }
+            break;
+
+        case OP_ENDLOOP:
+            if (--counts[depth - 1] > 0)
+            {
+                idx[depth - 1]++;
+                setSuffix(suffix, suffixEnd, idx, depth - 1, depth);
+                pc = in->jump + 1;
+            }
+            else
+            {
+                depth--;
+                suffix[suffixEnd[depth]] = 0;
+                pc++;
+            }
+            break;
+
+        case OP_IF:
+            status = evalIf(program, in, slots, idx, error);
+            if (status < 0)
+                goto CATCH_ERROR;
+            pc = status ? pc + 1 : in->jump + 1;
+            break;
+
+        default:
+            pc++;
+            break;
+        }
+    }
+
+  DONE:
+    if (slots)
+        NITF_FREE(slots);
+
+    /* check if we still have more to parse, and throw an error if so */
+    if (offset < total)
+    {
+        nitf_Error_init(error, "TRE data is longer than it should be",
+                        NITF_CTXT, NITF_ERR_INVALID_OBJECT);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+
+  CATCH_ERROR:
+    if (slots)
+        NITF_FREE(slots);
+    return NITF_FAILURE;
+}
+
+
+NITFPROT(void) nitf_TREProgram_destruct(nitf_TREProgram ** program)
+{
+    int i;
+
+    if (*program)
+    {
+        if ((*program)->instructions)
+        {
+            for (i = 0; i < (*program)->numInstructions; ++i)
+            {
+                if ((*program)->instructions[i].tokens)
+                    NITF_FREE((*program)->instructions[i].tokens);
+            }
+            NITF_FREE((*program)->instructions);
+        }
+        if ((*program)->slotDepth)
+            NITF_FREE((*program)->slotDepth);
+        NITF_FREE(*program);
+        *program = NULL;
+    }
+}
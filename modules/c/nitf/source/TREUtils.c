@@ -22,6 +22,7 @@
 
 #include "nitf/TREUtils.h"
 #include "nitf/TREPrivateData.h"
+#include "nitf/TREProgram.h"
 
 
 NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
@@ -69,8 +70,8 @@ NITFAPI(int) nitf_TREUtils_parse(nitf_TRE * tre,
              */
 
             /* construct the field */
-            field = nitf_Field_construct(length,
-                    cursor.desc_ptr->data_type, error);
+            field = nitf_Field_constructIn(length,
+                    cursor.desc_ptr->data_type, privData->arena, error);
             if (!field)
                 goto CATCH_ERROR;
 
@@ -164,6 +165,9 @@ NITFAPI(char *) nitf_TREUtils_getRawData(nitf_TRE * tre, nitf_Uint32* treLength,
     /* the cursor */
     nitf_TRECursor cursor;
 
+    if (!nitf_TRE_parse(tre, error))
+        return NULL;
+
     /* get actual length of TRE */
     length = nitf_TREUtils_computeLength(tre);
     *treLength = length;
@@ -304,6 +308,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!nitf_TRE_parse(tre, error))
+        return NITF_FAILURE;
 
     /* If the field already exists, get it and modify it */
     if (nitf_HashTable_exists(((nitf_TREPrivateData*)tre->priv)->hash, tag))
@@ -378,7 +384,9 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_setValue(nitf_TRE * tre,
                     }
 
                     /* construct the field */
-                    field = nitf_Field_construct(length, type, error);
+                    field = nitf_Field_constructIn(length, type,
+                            ((nitf_TREPrivateData*)tre->priv)->arena,
+                            error);
 
                     /* now, set the data */
                     nitf_Field_setRawData(field, (NITF_DATA *) data,
@@ -493,8 +501,9 @@ NITFPRIV(NITF_BOOL) fillEmptyTREField(nitf_TRECursor* cursor, nitf_Pair* pair, n
         fieldLength = 1;
     }
 
-    field = nitf_Field_construct(fieldLength,
+    field = nitf_Field_constructIn(fieldLength,
             cursor->desc_ptr->data_type,
+            ((nitf_TREPrivateData*)cursor->tre->priv)->arena,
             error);
 
     /* set the field to be resizable later on */
@@ -551,6 +560,9 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_fillData(nitf_TRE * tre,
 {
     nitf_TRECursor cursor;
 
+    if (!nitf_TRE_parse(tre, error))
+        return NITF_FAILURE;
+
     /* set the description so the cursor can use it */
     ((nitf_TREPrivateData*)tre->priv)->description =
         (nitf_TREDescription*)descrip;
@@ -599,6 +611,8 @@ NITFAPI(int) nitf_TREUtils_print(nitf_TRE * tre, nitf_Error * error)
                 NITF_CTXT, NITF_ERR_INVALID_PARAMETER);
         return NITF_FAILURE;
     }
+    if (!nitf_TRE_parse(tre, error))
+        return NITF_FAILURE;
 
     cursor = nitf_TRECursor_begin(tre);
     while (!nitf_TRECursor_isDone(&cursor) && (status == NITF_SUCCESS))
@@ -635,8 +649,8 @@ NITFAPI(int) nitf_TREUtils_computeLength(nitf_TRE * tre)
     nitf_Field *field; /* temp nitf_Field */
     nitf_TRECursor cursor;
 
-    /* get out if TRE is null */
-    if (!tre)
+    /* get out if TRE is null or cannot be parsed */
+    if (!tre || !nitf_TRE_parse(tre, &error))
         return -1;
 
     cursor = nitf_TRECursor_begin(tre);
@@ -675,8 +689,8 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_isSane(nitf_TRE * tre)
     nitf_Error error;
     nitf_TRECursor cursor;
 
-    /* get out if TRE is null */
-    if (!tre)
+    /* get out if TRE is null or cannot be parsed */
+    if (!tre || !nitf_TRE_parse(tre, &error))
         return NITF_FAILURE;
 
     cursor = nitf_TRECursor_begin(tre);
@@ -690,6 +704,168 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_isSane(nitf_TRE * tre)
     return status;
 }
 
+/*
+ *  The programs the basic handler compiled for one handler, one per
+ *  description (NULL where it could not be compiled).  The handler points
+ *  at its entry, and every entry is also kept on a list so the programs can
+ *  be freed before the plugins are unloaded.
+ */
+typedef struct _nitf_BasicPrograms
+{
+    nitf_TREHandler *handler;
+    nitf_TREDescriptionSet *set;
+    nitf_TREProgram **programs;
+    int numPrograms;
+    struct _nitf_BasicPrograms *next;
+} nitf_BasicPrograms;
+
+static nitf_BasicPrograms *basicPrograms = NULL;
+
+#ifndef WIN32
+    static nitf_Mutex basicProgramsLock = NITF_MUTEX_INIT;
+#else
+    static nitf_Mutex basicProgramsLock = NULL;
+    static long basicProgramsInitLock = 0;
+#endif
+
+NITFPRIV(nitf_Mutex*) getBasicProgramsLock(void)
+{
+#ifdef WIN32
+    if (basicProgramsLock == NULL)
+    {
+        while (InterlockedExchange(&basicProgramsInitLock, 1) == 1)
+            /* loop, another thread own the lock */ ;
+        if (basicProgramsLock == NULL)
+            nitf_Mutex_init(&basicProgramsLock);
+        InterlockedExchange(&basicProgramsInitLock, 0);
+    }
+#endif
+    return &basicProgramsLock;
+}
+
+NITFPRIV(void) freeBasicPrograms(nitf_BasicPrograms **entry)
+{
+    int i;
+
+    if (*entry)
+    {
+        for (i = 0; i < (*entry)->numPrograms; ++i)
+            nitf_TREProgram_destruct(&(*entry)->programs[i]);
+        if ((*entry)->programs)
+            NITF_FREE((*entry)->programs);
+        NITF_FREE(*entry);
+        *entry = NULL;
+    }
+}
+
+/*
+ *  Compile a set's descriptions for a handler.  Descriptions that cannot be
+ *  compiled are parsed with a cursor; anything else that goes wrong fails.
+ */
+NITFPRIV(NITF_BOOL) compileBasicPrograms(nitf_TREDescriptionSet *set,
+                                         nitf_TREHandler *handler,
+                                         nitf_Error *error)
+{
+    nitf_BasicPrograms *entry;
+    nitf_TREDescriptionInfo *info;
+    nitf_Error compileError;
+    int i;
+
+    entry = (nitf_BasicPrograms*)handler->programs;
+    if (entry && entry->set == set)
+        return NITF_SUCCESS;
+
+    entry = (nitf_BasicPrograms*)NITF_MALLOC(sizeof(nitf_BasicPrograms));
+    if (!entry)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
+    memset(entry, 0, sizeof(nitf_BasicPrograms));
+    entry->handler = handler;
+    entry->set = set;
+
+    for (info = set->descriptions; info && info->description; ++info)
+        ++entry->numPrograms;
+    if (entry->numPrograms > 0)
+    {
+        entry->programs = (nitf_TREProgram**)NITF_MALLOC(
+                sizeof(nitf_TREProgram*) * entry->numPrograms);
+        if (!entry->programs)
+        {
+            nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                            NITF_ERR_MEMORY);
+            freeBasicPrograms(&entry);
+            return NITF_FAILURE;
+        }
+        memset(entry->programs, 0,
+               sizeof(nitf_TREProgram*) * entry->numPrograms);
+    }
+
+    for (i = 0; i < entry->numPrograms; ++i)
+    {
+        info = &set->descriptions[i];
+        entry->programs[i] = nitf_TREProgram_compile(info->description,
+                                                     &compileError);
+        if (!entry->programs[i])
+        {
+            if (compileError.level != NITF_ERR_INVALID_OBJECT)
+            {
+                *error = compileError;
+                freeBasicPrograms(&entry);
+                return NITF_FAILURE;
+            }
+#ifdef NITF_DEBUG
+            printf("TRE description %s is parsed with a cursor: %s\n",
+                   info->name, compileError.message);
+#endif
+        }
+    }
+
+    /*
+     * Programs for another set this handler had before may still be in use
+     * by a read, so they stay on the list until the plugins are unloaded
+     */
+    nitf_Mutex_lock(getBasicProgramsLock());
+    entry->next = basicPrograms;
+    basicPrograms = entry;
+    handler->programs = entry;
+    nitf_Mutex_unlock(getBasicProgramsLock());
+    return NITF_SUCCESS;
+}
+
+NITFPROT(void) nitf_TREUtils_freeBasicPrograms(void)
+{
+    nitf_BasicPrograms *entry;
+
+    nitf_Mutex_lock(getBasicProgramsLock());
+    while (basicPrograms)
+    {
+        entry = basicPrograms;
+        basicPrograms = entry->next;
+        if (entry->handler->programs == entry)
+            entry->handler->programs = NULL;
+        freeBasicPrograms(&entry);
+    }
+    nitf_Mutex_unlock(getBasicProgramsLock());
+}
+
+/*
+ *  Does the length single out the description, either because it is the
+ *  length the description is marked for, or because it is the only length
+ *  the description allows?
+ */
+NITFPRIV(NITF_BOOL) basicMatchesLength(nitf_TREDescriptionInfo *info,
+                                       nitf_TREProgram *program,
+                                       nitf_Uint32 length)
+{
+    if (info->lengthMatch >= 0)
+        return (nitf_Uint32)info->lengthMatch == length;
+    return program && program->fixedLength >= 0 &&
+        (nitf_Uint32)program->fixedLength == length;
+}
+
 NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
                                            nitf_Uint32 length,
                                            nitf_TRE* tre,
@@ -697,9 +873,13 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
                                            nitf_Error* error)
 {
     int ok;
+    int pass;
+    int index;
     char *data = NULL;
     nitf_TREDescriptionSet *descriptions = NULL;
     nitf_TREDescriptionInfo *infoPtr = NULL;
+    nitf_BasicPrograms *programs = NULL;
+    nitf_TREProgram *program;
 
     if (!tre)
         return NITF_FAILURE;
@@ -732,47 +912,62 @@ NITFAPI(NITF_BOOL) nitf_TREUtils_basicRead(nitf_IOInterface* io,
         return NITF_FAILURE;
     }
 
+    /* Handlers that share the basic read without being created by
+     * nitf_TREUtils_createBasicHandler have no programs */
+    programs = (nitf_BasicPrograms*)tre->handler->programs;
+    if (programs && programs->set != descriptions)
+        programs = NULL;
+
     tre->priv = NULL;
     infoPtr = descriptions->descriptions;
     tre->priv = nitf_TREPrivateData_construct(error);
     ((nitf_TREPrivateData*)tre->priv)->length = length;
 
+    /*
+     * Try the descriptions the length singles out first, then the rest in
+     * order, skipping those the data cannot possibly fit
+     */
     ok = NITF_FAILURE;
-    while (infoPtr && (infoPtr->description != NULL))
+    for (pass = 0; pass < 2 && !ok && tre->priv; ++pass)
     {
-        if (!tre->priv)
+        for (infoPtr = descriptions->descriptions, index = 0;
+             infoPtr && (infoPtr->description != NULL) && !ok;
+             infoPtr++, index++)
         {
-            break;
-        }
-
-        ((nitf_TREPrivateData*)tre->priv)->description = infoPtr->description;
+            program = programs && index < programs->numPrograms ?
+                programs->programs[index] : NULL;
+            if ((pass == 0) != basicMatchesLength(infoPtr, program, length) ||
+                (program && !nitf_TREProgram_fits(program, length)))
+                continue;
+
+            ((nitf_TREPrivateData*)tre->priv)->description =
+                infoPtr->description;
 #ifdef NITF_DEBUG
-        printf("Trying TRE with description: %s\n\n", infoPtr->name);
+            printf("Trying TRE with description: %s\n\n", infoPtr->name);
 #endif
-        ok = nitf_TREUtils_parse(tre, data, error);
-        if (ok)
-        {
-            nitf_TREPrivateData *priv = (nitf_TREPrivateData*)tre->priv;
-            /* copy the name */
-            if (!nitf_TREPrivateData_setDescriptionName(
-                    priv, infoPtr->name, error))
+            if (program)
+                ok = nitf_TREProgram_parse(program, tre, data, error);
+            else
+                ok = nitf_TREUtils_parse(tre, data, error);
+            if (ok)
             {
-                /* something bad happened... so we need to cleanup */
-                NITF_FREE(data);
-                nitf_TREPrivateData_destruct(&priv);
-                tre->priv = NULL;
-                return NITF_FAILURE;
-            }
+                nitf_TREPrivateData *priv = (nitf_TREPrivateData*)tre->priv;
+                /* copy the name */
+                if (!nitf_TREPrivateData_setDescriptionName(
+                        priv, infoPtr->name, error))
+                {
+                    /* something bad happened... so we need to cleanup */
+                    NITF_FREE(data);
+                    nitf_TREPrivateData_destruct(&priv);
+                    tre->priv = NULL;
+                    return NITF_FAILURE;
+                }
 
-            /*nitf_HashTable_print( ((nitf_TREPrivateData*)tre->priv)->hash );*/
-            break;
+                /*nitf_HashTable_print( ((nitf_TREPrivateData*)tre->priv)->hash );*/
+            }
         }
-
-        infoPtr++;
     }
 
-
-
     if (data) NITF_FREE(data);
     return ok;
 }
@@ -1048,6 +1243,10 @@ nitf_TREUtils_createBasicHandler(nitf_TREDescriptionSet* set,
                                  nitf_TREHandler *handler,
                                  nitf_Error* error)
 {
+    /* Compile the descriptions once, for basicRead */
+    if (!compileBasicPrograms(set, handler, error))
+        return NULL;
+
     handler->init = nitf_TREUtils_basicInit;
     handler->getID = nitf_TREUtils_basicGetID;
     handler->read = nitf_TREUtils_basicRead;
@@ -0,0 +1,111 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+/*
+ *  Time the byte swap kernels at each level this CPU supports against
+ *  the scalar ones.
+ *
+ *  Usage: test_byte_swap_speed [megabytes [passes]]
+ */
+
+#include <import/nitf.h>
+
+typedef void (*SwapFunction) (nitf_Uint8 * buffer, size_t count);
+
+static double timeSwap(SwapFunction swap, nitf_Uint8 * buffer,
+                       size_t numBytes, size_t elementSize, int passes)
+{
+    double start;
+    int i;
+
+    /* Once to warm the cache and fault the pages in */
+    swap(buffer, numBytes / elementSize);
+
+    start = nrt_Utils_getCurrentTimeMillis();
+    for (i = 0; i < passes; ++i)
+        swap(buffer, numBytes / elementSize);
+    return (nrt_Utils_getCurrentTimeMillis() - start) / passes;
+}
+
+int main(int argc, char **argv)
+{
+    static const SwapFunction swaps[] =
+    {
+        nitf_ByteSwap_swap2, nitf_ByteSwap_swap4, nitf_ByteSwap_swap8
+    };
+    static const size_t elementSizes[] = { 2, 4, 8 };
+
+    size_t numBytes = 64;
+    int passes = 20;
+    nitf_Uint8 *buffer;
+    double scalarMillis[3];
+    int level;
+    int i;
+
+    if (argc > 1)
+        numBytes = (size_t) atoi(argv[1]);
+    if (argc > 2)
+        passes = atoi(argv[2]);
+    if (numBytes == 0 || passes <= 0)
+    {
+        printf("Usage: %s [megabytes [passes]]\n", argv[0]);
+        exit(EXIT_FAILURE);
+    }
+    numBytes <<= 20;
+
+    buffer = (nitf_Uint8 *) NITF_MALLOC(numBytes);
+    if (!buffer)
+    {
+        printf("Could not allocate %lu bytes\n", (unsigned long) numBytes);
+        exit(EXIT_FAILURE);
+    }
+    memset(buffer, 0x5A, numBytes);
+
+    printf("Default level: %s\n",
+           nitf_ByteSwap_getLevelName(nitf_ByteSwap_getLevel()));
+    printf("%-8s %6s %10s %10s %8s\n",
+           "Level", "Size", "ms/pass", "MB/s", "Speedup");
+
+    for (level = 0; level < NITF_BYTE_SWAP_NUM_LEVELS; ++level)
+    {
+        if (!nitf_ByteSwap_setLevel((nitf_ByteSwapLevel) level))
+            continue;
+
+        for (i = 0; i < 3; ++i)
+        {
+            double millis = timeSwap(swaps[i], buffer, numBytes,
+                                     elementSizes[i], passes);
+            if (level == NITF_BYTE_SWAP_SCALAR)
+                scalarMillis[i] = millis;
+
+            printf("%-8s %6d %10.3f %10.1f %7.2fx\n",
+                   nitf_ByteSwap_getLevelName((nitf_ByteSwapLevel) level),
+                   (int) elementSizes[i], millis,
+                   millis > 0 ? (numBytes / 1048576.0) / (millis / 1000.0)
+                              : 0.0,
+                   millis > 0 ? scalarMillis[i] / millis : 0.0);
+        }
+    }
+
+    NITF_FREE(buffer);
+    return 0;
+}
@@ -0,0 +1,305 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define MAX_COUNT 131
+#define IMAGE_SIZE 16
+
+/*
+ *  Swap elements of the given size at every supported level, for every
+ *  count up to a few vectors' worth and at unaligned offsets, and check
+ *  each byte against where it should have landed.
+ */
+static void checkSwap(const char* testName, size_t elementSize)
+{
+    nitf_Uint8 original[MAX_COUNT * 8 + 8];
+    nitf_Uint8 buffer[MAX_COUNT * 8 + 8];
+    nitf_ByteSwapLevel defaultLevel = nitf_ByteSwap_getLevel();
+    int level;
+    size_t offset;
+    size_t count;
+    size_t i;
+
+    for (i = 0; i < sizeof(original); ++i)
+        original[i] = (nitf_Uint8) (i * 7 + 1);
+
+    for (level = 0; level < NITF_BYTE_SWAP_NUM_LEVELS; ++level)
+    {
+        if (!nitf_ByteSwap_isSupported((nitf_ByteSwapLevel) level))
+            continue;
+        TEST_ASSERT(nitf_ByteSwap_setLevel((nitf_ByteSwapLevel) level));
+        TEST_ASSERT_EQ_INT(nitf_ByteSwap_getLevel(), level);
+
+        for (offset = 0; offset < 4; ++offset)
+        {
+            for (count = 0; count <= MAX_COUNT; ++count)
+            {
+                memcpy(buffer, original, sizeof(buffer));
+                if (elementSize == 2)
+                    nitf_ByteSwap_swap2(buffer + offset, count);
+                else if (elementSize == 4)
+                    nitf_ByteSwap_swap4(buffer + offset, count);
+                else
+                    nitf_ByteSwap_swap8(buffer + offset, count);
+
+                for (i = 0; i < sizeof(buffer); ++i)
+                {
+                    size_t expected = i;
+                    if (i >= offset && i < offset + count * elementSize)
+                    {
+                        size_t position = (i - offset) % elementSize;
+                        expected = i - position + (elementSize - 1 - position);
+                    }
+                    TEST_ASSERT_EQ_INT(buffer[i], original[expected]);
+                }
+            }
+        }
+    }
+
+    TEST_ASSERT(nitf_ByteSwap_setLevel(defaultLevel));
+}
+
+TEST_CASE(testSwap2)
+{
+    checkSwap(testName, 2);
+}
+
+TEST_CASE(testSwap4)
+{
+    checkSwap(testName, 4);
+}
+
+TEST_CASE(testSwap8)
+{
+    checkSwap(testName, 8);
+}
+
+TEST_CASE(testLevels)
+{
+    int level;
+
+    /* The default is the best level the CPU has */
+    for (level = nitf_ByteSwap_getLevel() + 1;
+         level < NITF_BYTE_SWAP_NUM_LEVELS; ++level)
+    {
+        TEST_ASSERT(!nitf_ByteSwap_isSupported((nitf_ByteSwapLevel) level));
+    }
+
+    TEST_ASSERT(nitf_ByteSwap_isSupported(NITF_BYTE_SWAP_SCALAR));
+    TEST_ASSERT(!nitf_ByteSwap_isSupported(
+            (nitf_ByteSwapLevel) NITF_BYTE_SWAP_NUM_LEVELS));
+    TEST_ASSERT(!nitf_ByteSwap_setLevel(
+            (nitf_ByteSwapLevel) NITF_BYTE_SWAP_NUM_LEVELS));
+    TEST_ASSERT_EQ_STR(nitf_ByteSwap_getLevelName(NITF_BYTE_SWAP_SCALAR),
+                       "Scalar");
+}
+
+/*
+ *  12 significant bits of signed data in 16 bit pixels are stored
+ *  big-endian without their sign bits, so reading them back swaps and sign
+ *  extends them.  The file is written with all 16 bits significant, from
+ *  data that already has the sign bits cleared, and read back as 12 bits.
+ */
+/*
+ *  Write a single band, blocked SI image with 16 bit pixels, of which
+ *  abpp are significant
+ */
+static void writeSigned(const char* testName, const char* pathname,
+                        const void* data, nitf_Uint32 abpp)
+{
+    nitf_Error error;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOInterface *io;
+    nitf_Writer *writer;
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *source;
+    nitf_BandSource *band;
+
+    record = nitf_Record_construct(NITF_VER_21, &error);
+    TEST_ASSERT(record);
+    segment = nitf_Record_newImageSegment(record, &error);
+    TEST_ASSERT(segment);
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    TEST_ASSERT(bands);
+    bands[0] = nitf_BandInfo_construct(&error);
+    TEST_ASSERT(bands[0]);
+    TEST_ASSERT(nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0,
+                                   NULL, &error));
+    TEST_ASSERT(nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                        "SI", 16, abpp, "R",
+                                                        "MONO", "VIS", 1,
+                                                        bands, &error));
+    TEST_ASSERT(nitf_ImageSubheader_setBlocking(segment->subheader,
+                                                IMAGE_SIZE, IMAGE_SIZE,
+                                                IMAGE_SIZE, IMAGE_SIZE, "B",
+                                                &error));
+
+    io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_WRITEONLY,
+                                   NITF_CREATE | NITF_TRUNCATE, &error);
+    TEST_ASSERT(io);
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepareIO(writer, record, io, &error));
+    imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, &error);
+    TEST_ASSERT(imageWriter);
+    source = nitf_ImageSource_construct(&error);
+    TEST_ASSERT(source);
+    band = nitf_MemorySource_construct(data,
+                                       IMAGE_SIZE * IMAGE_SIZE * 2, 0, 2,
+                                       0, &error);
+    TEST_ASSERT(band);
+    TEST_ASSERT(nitf_ImageSource_addBand(source, band, &error));
+    TEST_ASSERT(nitf_ImageWriter_attachSource(imageWriter, source, &error));
+    TEST_ASSERT(nitf_Writer_write(writer, &error));
+    nitf_Writer_destruct(&writer);
+    nitf_IOInterface_destruct(&io);
+    nitf_Record_destruct(&record);
+}
+
+/*
+ *  Read the image writeSigned() wrote, taking abpp bits as significant
+ *  whatever the file says, and check the pixels.  The raw pixels are
+ *  returned as they are in the file.
+ */
+static void readSigned(const char* testName, const char* pathname,
+                       nitf_Uint32 abpp, const nitf_Int16* expected,
+                       nitf_Uint8* raw)
+{
+    nitf_Error error;
+    nitf_Int16 out[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint8 *user[1];
+    nitf_Uint32 bandList = 0;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_ImageReader *imageReader;
+    nitf_SubWindow *subWindow;
+    int padded;
+    size_t i;
+
+    io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(segment);
+    TEST_ASSERT(nitf_Field_setUint32(segment->subheader->NITF_ABPP, abpp,
+                                     &error));
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    subWindow = nitf_SubWindow_construct(&error);
+    TEST_ASSERT(subWindow);
+    subWindow->numRows = IMAGE_SIZE;
+    subWindow->numCols = IMAGE_SIZE;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    user[0] = (nitf_Uint8 *) out;
+    TEST_ASSERT(nitf_ImageReader_read(imageReader, subWindow, user, &padded,
+                                      &error));
+    for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE; ++i)
+        TEST_ASSERT_EQ_INT(out[i], expected[i]);
+
+    TEST_ASSERT(nitf_IOInterface_seek(io, (nitf_Off) segment->imageOffset,
+                                      NITF_SEEK_SET, &error) >= 0);
+    TEST_ASSERT(nitf_IOInterface_read(io, (char *) raw,
+                                      IMAGE_SIZE * IMAGE_SIZE * 2, &error));
+
+    subWindow->bandList = NULL;
+    nitf_SubWindow_destruct(&subWindow);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+/* Both ends of the 12 bit range, and small values either side of zero */
+static void makeSigned12(nitf_Int16* values)
+{
+    size_t i;
+
+    for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE; ++i)
+        values[i] = (nitf_Int16) ((int) (i * 37 % 4096) - 2048);
+    values[0] = -2048;
+    values[1] = 2047;
+    values[2] = -1;
+    values[3] = 0;
+    values[4] = 1;
+}
+
+TEST_CASE(testReadSigned12)
+{
+    const char *pathname = "test_byte_swap_si12.ntf";
+    nitf_Int16 expected[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint16 data[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint8 raw[IMAGE_SIZE * IMAGE_SIZE * 2];
+    size_t i;
+
+    /* Written with all 16 bits significant, then read as 12 */
+    makeSigned12(expected);
+    for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE; ++i)
+        data[i] = (nitf_Uint16) expected[i] & 0x0FFF;
+
+    writeSigned(testName, pathname, data, 16);
+    readSigned(testName, pathname, 12, expected, raw);
+}
+
+TEST_CASE(testWriteSigned12)
+{
+    const char *pathname = "test_byte_swap_si12_write.ntf";
+    nitf_Int16 expected[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint8 raw[IMAGE_SIZE * IMAGE_SIZE * 2];
+    size_t i;
+
+    /*
+     * Sign extended values go in, and the writer has to mask off all but
+     * the 12 significant bits of the 16 bit pixels
+     */
+    makeSigned12(expected);
+    writeSigned(testName, pathname, expected, 12);
+    readSigned(testName, pathname, 12, expected, raw);
+
+    for (i = 0; i < IMAGE_SIZE * IMAGE_SIZE; ++i)
+    {
+        const nitf_Uint16 pixel =
+            (nitf_Uint16) ((raw[2 * i] << 8) | raw[2 * i + 1]);
+        TEST_ASSERT_EQ_INT(pixel, (nitf_Uint16) expected[i] & 0x0FFF);
+    }
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testLevels);
+    CHECK(testSwap2);
+    CHECK(testSwap4);
+    CHECK(testSwap8);
+    CHECK(testReadSigned12);
+    CHECK(testWriteSigned12);
+    return 0;
+}
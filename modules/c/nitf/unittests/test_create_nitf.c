@@ -1244,10 +1244,88 @@ TEST_CASE_ARGS(testRead)
     nitf_Record_destruct(&record);
 }
 
+TEST_CASE_ARGS(testReadEmbedded)
+{
+    static const size_t prefixes[] = { 16, 1000 };
+    nitf_Reader *reader = NULL;
+    nitf_Record *expected = NULL;
+    nitf_Record *record = NULL;
+    nitf_ImageSegment *expectedImage;
+    nitf_ImageSegment *image;
+    nitf_IOInterface *io;
+    nitf_IOHandle handle;
+    nitf_Error error;
+    nitf_Off size;
+    char *buf;
+    size_t i;
+    char* outname = argc > 1 ? argv[1] : "test_create.ntf";
+
+    handle = nitf_IOHandle_create(outname, NITF_ACCESS_READONLY,
+                                  NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(!NITF_INVALID_HANDLE(handle));
+    size = nitf_IOHandle_getSize(handle, &error);
+    TEST_ASSERT(size > 0);
+
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    expected = nitf_Reader_read(reader, handle, &error);
+    TEST_ASSERT(expected);
+    expectedImage = (nitf_ImageSegment *) nitf_List_get(expected->images, 0,
+                                                        &error);
+
+    /* The same file behind some leading bytes, read from its own start */
+    for (i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); ++i)
+    {
+        buf = (char *) NITF_MALLOC(prefixes[i] + (size_t) size);
+        TEST_ASSERT(buf);
+        memset(buf, 'X', prefixes[i]);
+        TEST_ASSERT(nitf_IOHandle_seek(handle, 0, NITF_SEEK_SET, &error) == 0);
+        TEST_ASSERT(nitf_IOHandle_read(handle, buf + prefixes[i],
+                                       (size_t) size, &error));
+
+        io = nitf_BufferAdapter_construct(buf, prefixes[i] + (size_t) size,
+                                          1, &error);
+        TEST_ASSERT(io);
+        TEST_ASSERT(nitf_IOInterface_seek(io, (nitf_Off) prefixes[i],
+                                          NITF_SEEK_SET, &error) ==
+                    (nitf_Off) prefixes[i]);
+        record = nitf_Reader_readIO(reader, io, &error);
+        TEST_ASSERT(record);
+
+        TEST_ASSERT(strncmp(record->header->fileTitle->raw,
+                            expected->header->fileTitle->raw,
+                            record->header->fileTitle->length) == 0);
+        TEST_ASSERT(strncmp(record->header->headerLength->raw,
+                            expected->header->headerLength->raw,
+                            record->header->headerLength->length) == 0);
+        TEST_ASSERT(strncmp(record->header->numImages->raw,
+                            expected->header->numImages->raw,
+                            record->header->numImages->length) == 0);
+
+        image = (nitf_ImageSegment *) nitf_List_get(record->images, 0,
+                                                    &error);
+        TEST_ASSERT(image);
+        TEST_ASSERT(strncmp(image->subheader->imageId->raw,
+                            expectedImage->subheader->imageId->raw,
+                            image->subheader->imageId->length) == 0);
+        TEST_ASSERT(image->imageOffset ==
+                    expectedImage->imageOffset + prefixes[i]);
+        TEST_ASSERT(image->imageEnd == expectedImage->imageEnd + prefixes[i]);
+
+        nitf_Record_destruct(&record);
+        nitf_IOInterface_destruct(&io);
+    }
+
+    nitf_Record_destruct(&expected);
+    nitf_Reader_destruct(&reader);
+    nitf_IOHandle_close(handle);
+}
+
 int main(int argc, char **argv)
 {
     CHECK_ARGS(testCreate);
     CHECK_ARGS(testRead);
+    CHECK_ARGS(testReadEmbedded);
     return 0;
 }
 
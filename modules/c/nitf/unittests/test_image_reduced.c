@@ -0,0 +1,385 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ *
+ */
+
+/*
+ *  Reads an image through a stand-in decompressor that can also serve
+ *  reduced resolution reads, and checks that pixel skip and max reads only
+ *  take that path when it is asked for.
+ */
+
+#include <stddef.h>
+
+#include <import/nitf.h>
+#include "Test.h"
+
+#define IMAGE_SIZE 64
+#define BLOCK_SIZE 32
+#define SKIP 2
+#define OUT_SIZE (IMAGE_SIZE / SKIP)
+#define REDUCED_VALUE 0xEE
+
+/*  Stored uncompressed, the stand-in "decompressor" just reads blocks  */
+typedef struct _PassThroughControl
+{
+    nitf_IOInterface *io;
+    nitf_Uint64 offset;
+    nitf_Uint64 blockLength;
+} PassThroughControl;
+
+static const char *passThroughIdent[] =
+{
+    NITF_PLUGIN_DECOMPRESSION_KEY, "C8", NULL
+};
+
+static int reducedReads = 0;
+
+static nitf_Uint8 pixel(nitf_Uint32 row, nitf_Uint32 col)
+{
+    return (nitf_Uint8)((row * 7 + col * 13) % 251);
+}
+
+static nitf_DecompressionControl *passThroughOpen(nitf_ImageSubheader *
+                                                  subheader,
+                                                  nrt_HashTable *options,
+                                                  nitf_Error *error)
+{
+    PassThroughControl *control =
+        (PassThroughControl *) NITF_MALLOC(sizeof(PassThroughControl));
+    (void) subheader;
+    (void) options;
+    if (!control)
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+    return control;
+}
+
+static NITF_BOOL passThroughStart(nitf_DecompressionControl *object,
+                                  nitf_IOInterface *io,
+                                  nitf_Uint64 offset,
+                                  nitf_Uint64 fileLength,
+                                  nitf_BlockingInfo *blockInfo,
+                                  nitf_Uint64 *blockMask,
+                                  nitf_Error *error)
+{
+    PassThroughControl *control = (PassThroughControl *) object;
+    (void) fileLength;
+    (void) blockMask;
+    (void) error;
+    control->io = io;
+    control->offset = offset;
+    control->blockLength = blockInfo->length;
+    return NITF_SUCCESS;
+}
+
+static nitf_Uint8 *passThroughReadBlock(nitf_DecompressionControl *object,
+                                        nitf_Uint32 blockNumber,
+                                        nitf_Uint64 *blockSize,
+                                        nitf_Error *error)
+{
+    PassThroughControl *control = (PassThroughControl *) object;
+    nitf_Uint8 *block = (nitf_Uint8 *) NITF_MALLOC(control->blockLength);
+
+    if (!block)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    if (!nitf_IOInterface_readAt(control->io,
+                                 (nitf_Off) (control->offset +
+                                             blockNumber *
+                                             control->blockLength),
+                                 block, (size_t) control->blockLength,
+                                 error))
+    {
+        NITF_FREE(block);
+        return NULL;
+    }
+    *blockSize = control->blockLength;
+    return block;
+}
+
+static NITF_BOOL passThroughFreeBlock(nitf_DecompressionControl *object,
+                                      nitf_Uint8 *block, nitf_Error *error)
+{
+    (void) object;
+    (void) error;
+    NITF_FREE(block);
+    return NITF_SUCCESS;
+}
+
+static void passThroughClose(nitf_DecompressionControl **object)
+{
+    if (object && *object)
+    {
+        NITF_FREE(*object);
+        *object = NULL;
+    }
+}
+
+/*  A real plugin would decode a resolution level, this one is recognizable */
+static nitf_Uint8 *passThroughReadReduced(nitf_DecompressionControl *object,
+                                          nitf_Uint32 startRow,
+                                          nitf_Uint32 startCol,
+                                          nitf_Uint32 numRows,
+                                          nitf_Uint32 numCols,
+                                          nitf_Uint32 reduce,
+                                          nitf_Uint64 *bufferSize,
+                                          nitf_Error *error)
+{
+    nitf_Uint8 *buffer = (nitf_Uint8 *) NITF_MALLOC(numRows * numCols);
+    (void) object;
+    (void) startRow;
+    (void) startCol;
+    (void) reduce;
+    if (!buffer)
+    {
+        nitf_Error_init(error, NITF_STRERROR(NITF_ERRNO), NITF_CTXT,
+                        NITF_ERR_MEMORY);
+        return NULL;
+    }
+    memset(buffer, REDUCED_VALUE, numRows * numCols);
+    *bufferSize = numRows * numCols;
+    ++reducedReads;
+    return buffer;
+}
+
+static nitf_DecompressionInterface passThroughInterface =
+{
+    passThroughOpen, passThroughStart, passThroughReadBlock,
+    passThroughFreeBlock, passThroughClose, NULL
+};
+
+static nitf_DecompressionExtensions passThroughExtensions =
+{
+    sizeof(nitf_DecompressionExtensions), &passThroughInterface, NULL,
+    passThroughReadReduced
+};
+
+static const char **passThroughInit(nitf_Error *error)
+{
+    (void) error;
+    return passThroughIdent;
+}
+
+static void *passThroughConstruct(const char *compressionType,
+                                  nitf_Error *error)
+{
+    (void) compressionType;
+    (void) error;
+    return &passThroughInterface;
+}
+
+static void *passThroughGetExtensions(const char *compressionType,
+                                      nitf_Error *error)
+{
+    (void) compressionType;
+    (void) error;
+    return &passThroughExtensions;
+}
+
+/*  Write an uncompressed image, so the pass through can read its blocks  */
+static void writeImage(const char *testName, const char *pathname,
+                       nitf_Uint8 *data)
+{
+    nitf_Error error;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_BandInfo **bands;
+    nitf_IOInterface *io;
+    nitf_Writer *writer;
+    nitf_ImageWriter *imageWriter;
+    nitf_ImageSource *source;
+    nitf_BandSource *band;
+
+    record = nitf_Record_construct(NITF_VER_21, &error);
+    TEST_ASSERT(record);
+    segment = nitf_Record_newImageSegment(record, &error);
+    TEST_ASSERT(segment);
+    bands = (nitf_BandInfo **) NITF_MALLOC(sizeof(nitf_BandInfo *));
+    TEST_ASSERT(bands);
+    bands[0] = nitf_BandInfo_construct(&error);
+    TEST_ASSERT(bands[0]);
+    TEST_ASSERT(nitf_BandInfo_init(bands[0], "M", " ", "N", "   ", 0, 0,
+                                   NULL, &error));
+    TEST_ASSERT(nitf_ImageSubheader_setPixelInformation(segment->subheader,
+                                                        "INT", 8, 8, "R",
+                                                        "MONO", "VIS", 1,
+                                                        bands, &error));
+    TEST_ASSERT(nitf_ImageSubheader_setBlocking(segment->subheader,
+                                                IMAGE_SIZE, IMAGE_SIZE,
+                                                BLOCK_SIZE, BLOCK_SIZE, "B",
+                                                &error));
+
+    io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_WRITEONLY,
+                                   NITF_CREATE | NITF_TRUNCATE, &error);
+    TEST_ASSERT(io);
+    writer = nitf_Writer_construct(&error);
+    TEST_ASSERT(writer);
+    TEST_ASSERT(nitf_Writer_prepareIO(writer, record, io, &error));
+    imageWriter = nitf_Writer_newImageWriter(writer, 0, NULL, &error);
+    TEST_ASSERT(imageWriter);
+    source = nitf_ImageSource_construct(&error);
+    TEST_ASSERT(source);
+    band = nitf_MemorySource_construct(data, IMAGE_SIZE * IMAGE_SIZE, 0, 1,
+                                       0, &error);
+    TEST_ASSERT(band);
+    TEST_ASSERT(nitf_ImageSource_addBand(source, band, &error));
+    TEST_ASSERT(nitf_ImageWriter_attachSource(imageWriter, source, &error));
+    TEST_ASSERT(nitf_Writer_write(writer, &error));
+
+    nitf_Writer_destruct(&writer);
+    nitf_IOInterface_destruct(&io);
+    nitf_Record_destruct(&record);
+}
+
+static void readSkipped(const char *testName, nitf_ImageReader *imageReader,
+                        nitf_DownSampler *downSampler, nitf_Uint8 *out)
+{
+    nitf_Error error;
+    nitf_SubWindow *subWindow;
+    nitf_Uint32 bandList = 0;
+    nitf_Uint8 *user[1];
+    int padded;
+
+    subWindow = nitf_SubWindow_construct(&error);
+    TEST_ASSERT(subWindow);
+    subWindow->numRows = OUT_SIZE;
+    subWindow->numCols = OUT_SIZE;
+    subWindow->bandList = &bandList;
+    subWindow->numBands = 1;
+    TEST_ASSERT(nitf_SubWindow_setDownSampler(subWindow, downSampler,
+                                              &error));
+    user[0] = out;
+    TEST_ASSERT(nitf_ImageReader_read(imageReader, subWindow, user, &padded,
+                                      &error));
+    subWindow->bandList = NULL;
+    nitf_SubWindow_destruct(&subWindow);
+}
+
+TEST_CASE(testReducedResolutionOptIn)
+{
+    const char *pathname = "test_image_reduced.ntf";
+    nitf_Error error;
+    nitf_Uint8 data[IMAGE_SIZE * IMAGE_SIZE];
+    nitf_Uint8 out[OUT_SIZE * OUT_SIZE];
+    nitf_IOInterface *io;
+    nitf_Reader *reader;
+    nitf_Record *record;
+    nitf_ImageSegment *segment;
+    nitf_ImageReader *imageReader;
+    nitf_DownSampler *pixelSkip;
+    nitf_DownSampler *maxDownSample;
+    nitf_Uint32 row, col, r, c;
+
+    for (row = 0; row < IMAGE_SIZE; ++row)
+        for (col = 0; col < IMAGE_SIZE; ++col)
+            data[row * IMAGE_SIZE + col] = pixel(row, col);
+    writeImage(testName, pathname, data);
+
+    TEST_ASSERT(nitf_PluginRegistry_registerDecompressionHandler(
+                    passThroughInit, passThroughConstruct, &error));
+    TEST_ASSERT(nitf_PluginRegistry_registerDecompressionExtensions(
+                    passThroughInit, passThroughGetExtensions, &error));
+
+    io = nitf_IOHandleAdapter_open(pathname, NITF_ACCESS_READONLY,
+                                   NITF_OPEN_EXISTING, &error);
+    TEST_ASSERT(io);
+    reader = nitf_Reader_construct(&error);
+    TEST_ASSERT(reader);
+    record = nitf_Reader_readIO(reader, io, &error);
+    TEST_ASSERT(record);
+
+    /*  Read the stored blocks through the stand-in decompressor  */
+    segment = (nitf_ImageSegment *) nitf_List_get(record->images, 0, &error);
+    TEST_ASSERT(segment);
+    TEST_ASSERT(nitf_Field_setString(segment->subheader->NITF_IC, "C8",
+                                     &error));
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+
+    pixelSkip = nitf_PixelSkip_construct(SKIP, SKIP, &error);
+    TEST_ASSERT(pixelSkip);
+    maxDownSample = nitf_MaxDownSample_construct(SKIP, SKIP, &error);
+    TEST_ASSERT(maxDownSample);
+
+    /*  By default a pixel skip is exact  */
+    readSkipped(testName, imageReader, pixelSkip, out);
+    TEST_ASSERT_EQ_INT(reducedReads, 0);
+    for (row = 0; row < OUT_SIZE; ++row)
+        for (col = 0; col < OUT_SIZE; ++col)
+            TEST_ASSERT_EQ_INT(out[row * OUT_SIZE + col],
+                               pixel(row * SKIP, col * SKIP));
+
+    /*  Max never takes the reduced path, even when it is enabled  */
+    nitf_ImageReader_setReducedResolution(imageReader, 1);
+    readSkipped(testName, imageReader, maxDownSample, out);
+    TEST_ASSERT_EQ_INT(reducedReads, 0);
+    for (row = 0; row < OUT_SIZE; ++row)
+    {
+        for (col = 0; col < OUT_SIZE; ++col)
+        {
+            nitf_Uint8 expected = 0;
+            for (r = 0; r < SKIP; ++r)
+                for (c = 0; c < SKIP; ++c)
+                    if (pixel(row * SKIP + r, col * SKIP + c) > expected)
+                        expected = pixel(row * SKIP + r, col * SKIP + c);
+            TEST_ASSERT_EQ_INT(out[row * OUT_SIZE + col], expected);
+        }
+    }
+
+    /*  Once enabled, a pixel skip is decoded at the reduced resolution  */
+    readSkipped(testName, imageReader, pixelSkip, out);
+    TEST_ASSERT_EQ_INT(reducedReads, 1);
+    for (row = 0; row < OUT_SIZE * OUT_SIZE; ++row)
+        TEST_ASSERT_EQ_INT(out[row], REDUCED_VALUE);
+
+    /*  A plugin built before readReduced existed has a shorter table  */
+    nitf_ImageReader_destruct(&imageReader);
+    passThroughExtensions.size =
+        offsetof(nitf_DecompressionExtensions, readReduced);
+    imageReader = nitf_Reader_newImageReader(reader, 0, NULL, &error);
+    TEST_ASSERT(imageReader);
+    nitf_ImageReader_setReducedResolution(imageReader, 1);
+    readSkipped(testName, imageReader, pixelSkip, out);
+    TEST_ASSERT_EQ_INT(reducedReads, 1);
+    for (row = 0; row < OUT_SIZE; ++row)
+        for (col = 0; col < OUT_SIZE; ++col)
+            TEST_ASSERT_EQ_INT(out[row * OUT_SIZE + col],
+                               pixel(row * SKIP, col * SKIP));
+
+    nitf_DownSampler_destruct(&pixelSkip);
+    nitf_DownSampler_destruct(&maxDownSample);
+    nitf_ImageReader_destruct(&imageReader);
+    nitf_Record_destruct(&record);
+    nitf_Reader_destruct(&reader);
+    nitf_IOInterface_destruct(&io);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+    CHECK(testReducedResolutionOptIn);
+    return 0;
+}
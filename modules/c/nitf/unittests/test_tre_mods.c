@@ -151,6 +151,59 @@ TEST_CASE(testSize)
     nitf_TRE_destruct(&tre);
 }
 
+TEST_CASE(testReadBack)
+{
+    nitf_Error error;
+    char data[] = "02"
+                  "FT000010FT000020FT000030FT000040002"
+                  "000000000000011000000000000021"
+                  "000000000000012000000000000022"
+                  "M  00001M  00002M  00003M  00004001"
+                  "000000000000031000000000000034";
+    const nitf_Uint32 treLength = (nitf_Uint32)strlen(data);
+    nitf_IOInterface* io = NULL;
+    nitf_TRE* tre = nitf_TRE_construct("ACCPOB", NULL, &error);
+    TEST_ASSERT(tre);
+    TEST_ASSERT_EQ_INT(treLength, 162);
+
+    io = nitf_BufferAdapter_construct(data, treLength, 0, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(tre->handler->read(io, treLength, tre, NULL, &error));
+
+    TEST_ASSERT_EQ_STR(nitf_TRE_getField(tre, "UNIAAH[0]")->raw, "FT0");
+    TEST_ASSERT_EQ_STR(nitf_TRE_getField(tre, "APV[0]")->raw, "00040");
+    TEST_ASSERT_EQ_STR(nitf_TRE_getField(tre, "LON[0][1]")->raw,
+                       "000000000000012");
+    TEST_ASSERT_EQ_STR(nitf_TRE_getField(tre, "UNIAAH[1]")->raw, "M  ");
+    TEST_ASSERT_EQ_STR(nitf_TRE_getField(tre, "LAT[1][0]")->raw,
+                       "000000000000034");
+    TEST_ASSERT(nitf_TRE_getField(tre, "LON[1][1]") == NULL);
+    TEST_ASSERT_EQ_INT(tre->handler->getCurrentSize(tre, &error),
+                       treLength);
+
+    nitf_IOInterface_destruct(&io);
+    nitf_TRE_destruct(&tre);
+}
+
+TEST_CASE(testReadShort)
+{
+    nitf_Error error;
+    char data[] = "01FT000010FT000020FT000030FT000040002"
+                  "000000000000011000000000";
+    const nitf_Uint32 treLength = (nitf_Uint32)strlen(data);
+    nitf_IOInterface* io = NULL;
+    nitf_TRE* tre = nitf_TRE_construct("ACCPOB", NULL, &error);
+    TEST_ASSERT(tre);
+
+    /* The data ends in the middle of LAT[0][0] */
+    io = nitf_BufferAdapter_construct(data, treLength, 0, &error);
+    TEST_ASSERT(io);
+    TEST_ASSERT(!tre->handler->read(io, treLength, tre, NULL, &error));
+
+    nitf_IOInterface_destruct(&io);
+    nitf_TRE_destruct(&tre);
+}
+
 TEST_CASE(iterateUnfilled)
 {
     nitf_Error error;
@@ -240,6 +293,8 @@ int main(int argc, char **argv)
     CHECK(testBasicMod);
     CHECK(testNestedMod);
     CHECK(testIncompleteCondMod);
+    CHECK(testReadBack);
+    CHECK(testReadShort);
     CHECK(iterateUnfilled);
     CHECK(populateThenIterate);
     CHECK(populateWhileIterating);
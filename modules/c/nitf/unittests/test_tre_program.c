@@ -0,0 +1,259 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2019, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nitf.h>
+#include <nitf/TREPrivateData.h>
+#include <nitf/TREProgram.h>
+#include "Test.h"
+
+/*
+ *  Make a TRE from a description, with every number that can be set to one
+ *  set to one, so the loops in the description are entered
+ */
+static nitf_TRE* populate(const char* tag,
+                          const nitf_TREDescriptionInfo* info,
+                          nitf_Error* error)
+{
+    nitf_TRECursor cursor;
+    nitf_TRE* tre = nitf_TRE_construct(tag, info->name, error);
+
+    if (!tre)
+        return NULL;
+
+    cursor = nitf_TRECursor_begin(tre);
+    while (!nitf_TRECursor_isDone(&cursor))
+    {
+        if (!nitf_TRECursor_iterate(&cursor, error))
+            break;
+        if (cursor.desc_ptr->data_type == NITF_BCS_N &&
+            cursor.length > 0)
+        {
+            nitf_TRE_setField(tre, cursor.tag_str, "1", 1, error);
+        }
+    }
+    nitf_TRECursor_cleanup(&cursor);
+
+    /* The fields the new counts call for start out blank */
+    if (!nitf_TREUtils_fillData(tre, info->description, error))
+        nitf_TRE_destruct(&tre);
+    return tre;
+}
+
+/*
+ *  Parse the data into a TRE of its own, with the program if there is one,
+ *  or else with a cursor
+ */
+static nitf_TRE* parse(nitf_TRE* source,
+                       nitf_TREDescription* description,
+                       nitf_TREProgram* program,
+                       char* data,
+                       nitf_Uint32 length,
+                       nitf_Error* error)
+{
+    nitf_TREPrivateData* priv;
+    nitf_TRE* tre = nitf_TRE_createSkeleton(source->tag, error);
+    NITF_BOOL ok;
+
+    if (!tre)
+        return NULL;
+    tre->handler = source->handler;
+    tre->priv = priv = nitf_TREPrivateData_construct(error);
+    if (!priv)
+    {
+        nitf_TRE_destruct(&tre);
+        return NULL;
+    }
+    priv->length = length;
+    priv->description = description;
+
+    ok = program ? nitf_TREProgram_parse(program, tre, data, error) :
+        nitf_TREUtils_parse(tre, data, error);
+    if (!ok)
+        nitf_TRE_destruct(&tre);
+    return tre;
+}
+
+/*
+ *  Do the TREs have the same fields, with the same values?
+ */
+static NITF_BOOL sameFields(nitf_TRE* tre1, nitf_TRE* tre2, const char* name)
+{
+    nitf_HashTable* hash1 = ((nitf_TREPrivateData*)tre1->priv)->hash;
+    nitf_HashTable* hash2 = ((nitf_TREPrivateData*)tre2->priv)->hash;
+    nitf_HashTableIterator it = nitf_HashTable_begin(hash1);
+    nitf_HashTableIterator end = nitf_HashTable_end(hash1);
+    int count1 = 0;
+    int count2 = 0;
+
+    for (; nitf_HashTableIterator_notEqualTo(&it, &end);
+         nitf_HashTableIterator_increment(&it))
+    {
+        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
+        nitf_Field* field1 = (nitf_Field*)pair->data;
+        nitf_Pair* other = nitf_HashTable_find(hash2, pair->key);
+        nitf_Field* field2 = other ? (nitf_Field*)other->data : NULL;
+
+        if (!field2 || field1->type != field2->type ||
+            field1->length != field2->length ||
+            memcmp(field1->raw, field2->raw, field1->length) != 0)
+        {
+            fprintf(stderr, "%s: field %s differs\n", name, pair->key);
+            return NITF_FAILURE;
+        }
+        ++count1;
+    }
+
+    it = nitf_HashTable_begin(hash2);
+    end = nitf_HashTable_end(hash2);
+    for (; nitf_HashTableIterator_notEqualTo(&it, &end);
+         nitf_HashTableIterator_increment(&it))
+        ++count2;
+
+    if (count1 != count2)
+    {
+        fprintf(stderr, "%s: %d fields read with the program, %d with a "
+                "cursor\n", name, count1, count2);
+        return NITF_FAILURE;
+    }
+    return NITF_SUCCESS;
+}
+
+/*
+ *  Every description the shipped plugins compile must read its own output
+ *  into the same fields as a cursor does
+ */
+TEST_CASE(testProgramMatchesCursor)
+{
+    nitf_Error error;
+    nitf_PluginRegistry* reg = nitf_PluginRegistry_getInstance(&error);
+    nitf_HashTableIterator it;
+    nitf_HashTableIterator end;
+    int numCompared = 0;
+
+    TEST_ASSERT(reg);
+    it = nitf_HashTable_begin(reg->treHandlers);
+    end = nitf_HashTable_end(reg->treHandlers);
+    for (; nitf_HashTableIterator_notEqualTo(&it, &end);
+         nitf_HashTableIterator_increment(&it))
+    {
+        nitf_Pair* pair = nitf_HashTableIterator_get(&it);
+        int bad = 0;
+        nitf_TREHandler* handler =
+            nitf_PluginRegistry_retrieveTREHandler(reg, pair->key, &bad,
+                                                   &error);
+        nitf_TREDescriptionSet* set;
+        nitf_TREDescriptionInfo* info;
+
+        TEST_ASSERT(!bad);
+        if (!handler || handler->read != nitf_TREUtils_basicRead)
+            continue;
+
+        set = (nitf_TREDescriptionSet*)handler->data;
+        for (info = set->descriptions; info && info->description; ++info)
+        {
+            nitf_TREProgram* program;
+            nitf_TRE* tre;
+            nitf_TRE* withProgram;
+            nitf_TRE* withCursor;
+            nitf_Uint32 length;
+            char* data;
+
+            program = nitf_TREProgram_compile(info->description, &error);
+            if (!program)
+            {
+                TEST_ASSERT_EQ_INT(error.level, NITF_ERR_INVALID_OBJECT);
+                continue;
+            }
+
+            tre = populate(pair->key, info, &error);
+            TEST_ASSERT(tre);
+            data = nitf_TREUtils_getRawData(tre, &length, &error);
+            TEST_ASSERT(data);
+
+            withProgram = parse(tre, info->description, program, data,
+                                length, &error);
+            withCursor = parse(tre, info->description, NULL, data,
+                               length, &error);
+            if (!withProgram || !withCursor)
+            {
+                fprintf(stderr, "%s (%s): read with the program %s, with "
+                        "a cursor %s\n", pair->key, info->name,
+                        withProgram ? "passed" : "failed",
+                        withCursor ? "passed" : "failed");
+            }
+            TEST_ASSERT(withProgram && withCursor);
+            TEST_ASSERT(sameFields(withProgram, withCursor, info->name));
+
+            nitf_TRE_destruct(&withProgram);
+            nitf_TRE_destruct(&withCursor);
+            NITF_FREE(data);
+            nitf_TRE_destruct(&tre);
+            nitf_TREProgram_destruct(&program);
+            ++numCompared;
+        }
+    }
+    TEST_ASSERT(numCompared > 0);
+}
+
+/*
+ *  A loop counter the data never got to is an error, not an empty loop
+ */
+TEST_CASE(testMissingLoopCounter)
+{
+    static nitf_TREDescription description[] = {
+        {NITF_BCS_N, 1, "Flag", "FLAG" },
+        {NITF_IF, 0, "== 1", "FLAG" },
+        {NITF_BCS_N, 1, "Count", "COUNT" },
+        {NITF_ENDIF, 0, NULL, NULL},
+        {NITF_LOOP, 0, NULL, "COUNT"},
+        {NITF_BCS_A, 2, "Value", "VALUE" },
+        {NITF_ENDLOOP, 0, NULL, NULL},
+        {NITF_END, 0, NULL, NULL}
+    };
+    nitf_Error error;
+    char data[] = "0AB";
+    nitf_TREProgram* program = nitf_TREProgram_compile(description, &error);
+    nitf_TRE* tre = nitf_TRE_createSkeleton("TEST", &error);
+
+    TEST_ASSERT(program);
+    TEST_ASSERT(tre);
+    tre->priv = nitf_TREPrivateData_construct(&error);
+    TEST_ASSERT(tre->priv);
+    ((nitf_TREPrivateData*)tre->priv)->length = 3;
+    ((nitf_TREPrivateData*)tre->priv)->description = description;
+
+    TEST_ASSERT(!nitf_TREProgram_parse(program, tre, data, &error));
+
+    nitf_TREPrivateData_destruct((nitf_TREPrivateData**)&tre->priv);
+    nitf_TRE_destruct(&tre);
+    nitf_TREProgram_destruct(&program);
+}
+
+int main(int argc, char **argv)
+{
+    (void) argc;
+    (void) argv;
+
+    CHECK(testProgramMatchesCursor);
+    CHECK(testMissingLoopCounter);
+    return 0;
+}
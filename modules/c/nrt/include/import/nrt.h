@@ -23,6 +23,7 @@
 #ifndef __IMPORT_NRT_H__
 #define __IMPORT_NRT_H__
 
+#include "nrt/Arena.h"
 #include "nrt/DateTime.h"
 #include "nrt/Debug.h"
 #include "nrt/Defines.h"
@@ -37,6 +38,7 @@
 #include "nrt/Memory.h"
 #include "nrt/Pair.h"
 #include "nrt/Sync.h"
+#include "nrt/Thread.h"
 #include "nrt/System.h"
 #include "nrt/Tree.h"
 #include "nrt/Types.h"
@@ -0,0 +1,111 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NRT_ARENA_H__
+#define __NRT_ARENA_H__
+
+#include "nrt/System.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  \struct nrt_Arena
+ *  \brief  A bump allocator for objects that share one lifetime
+ *
+ *  Allocations are carved out of large chunks and are never freed one
+ *  at a time.  All of the memory goes away at once when the arena is
+ *  destroyed.  An arena is not threadsafe, it is meant to be filled by
+ *  one thread and then only read.
+ */
+typedef struct _nrt_Arena
+{
+    struct _nrt_ArenaChunk* chunks;
+    size_t chunkSize;
+    nrt_Uint64 bytesUsed;
+    nrt_Uint64 bytesReserved;
+    size_t* slots;          /* hash set of the pages the chunks cover */
+    size_t numSlots;
+    size_t slotCapacity;
+} nrt_Arena;
+
+/*!
+ *  Construct an empty arena
+ *  \param chunkSize The size of the blocks the arena grabs from the heap
+ *  \param error Populated on failure
+ *  \return The arena, or NULL on failure
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error);
+
+/*!
+ *  Release everything allocated from the arena, and the arena itself
+ *  \param arena The arena to destroy, NULL-set on return
+ */
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena);
+
+/*!
+ *  Allocate from the arena.  The memory is suitably aligned for any type
+ *  and lives until the arena is destroyed.  Requests larger than the
+ *  chunk size get a chunk of their own.
+ *  \param arena The arena
+ *  \param size The number of bytes
+ *  \param error Populated on failure
+ *  \return The memory, or NULL on failure
+ */
+NRTAPI(void *) nrt_Arena_malloc(nrt_Arena * arena, size_t size,
+                                nrt_Error * error);
+
+/*!
+ *  Does this pointer point into memory handed out by the arena?  This is a
+ *  constant time lookup, however many chunks the arena has.
+ *  \param arena The arena
+ *  \param ptr The pointer to check
+ *  \return 1 if the arena owns the pointer, 0 otherwise
+ */
+NRTAPI(NRT_BOOL) nrt_Arena_contains(const nrt_Arena * arena,
+                                    const void *ptr);
+
+/*!
+ *  The number of bytes handed out by the arena so far
+ */
+NRTAPI(nrt_Uint64) nrt_Arena_getBytesUsed(const nrt_Arena * arena);
+
+/*!
+ *  The number of bytes the arena holds from the heap
+ */
+NRTAPI(nrt_Uint64) nrt_Arena_getBytesReserved(const nrt_Arena * arena);
+
+/*!
+ *  Make an arena the current one for the calling thread.  Constructors
+ *  that support arenas allocate from the current arena, if there is one.
+ *  \param arena The new current arena, or NULL for none
+ *  \return The previously current arena, to be restored afterwards
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_setCurrent(nrt_Arena * arena);
+
+/*!
+ *  The current arena for the calling thread, or NULL if there is none
+ */
+NRTAPI(nrt_Arena *) nrt_Arena_getCurrent(void);
+
+NRT_CXX_ENDGUARD
+
+#endif
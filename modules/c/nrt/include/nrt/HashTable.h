@@ -51,6 +51,8 @@ typedef struct _NRT_HashTable
     int nbuckets;
     int adopt;
     unsigned int (*hash) (struct _NRT_HashTable *, const char *);
+    /* private member, the arena the table was constructed in, if any */
+    struct _nrt_Arena *arena;
 } nrt_HashTable;
 
 typedef unsigned int (*NRT_HASH_FUNCTION) (nrt_HashTable *, const char *);
@@ -66,6 +66,26 @@ NRTAPI(nrt_IOHandle) nrt_IOHandle_create(const char *fname,
 NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
                                    nrt_Error * error);
 
+/*!
+ *  Read from the IO handle starting at an absolute offset.  Like
+ *  nrt_IOHandle_read(), this function returns after having read the
+ *  requisite number of bytes or fails out.  On Unix, the handle's file
+ *  position is left untouched (pread), so several threads may read from
+ *  the same handle at once.  On Windows, the read is positioned via an
+ *  OVERLAPPED offset, which is also safe for concurrent readAt callers
+ *  but does move the file pointer.
+ *
+ *  \param handle The handle to read from
+ *  \param offset The offset from the start of the file
+ *  \param buf    The buffer to read into
+ *  \param size   The number of bytes to read
+ *  \param error  Populated if function returns 0
+ *  \return       1 on success and 0 otherwise
+ */
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error);
+
 /*!
  *  Write to the IO handle.  This function attempts to write to the IO handle
  *  until it has written the requisite number of bytes (specified as the size
@@ -39,6 +39,10 @@ typedef nrt_Off(*NRT_IO_INTERFACE_GET_SIZE) (NRT_DATA *, nrt_Error *);
 typedef int (*NRT_IO_INTERFACE_GET_MODE) (NRT_DATA *, nrt_Error *);
 typedef NRT_BOOL(*NRT_IO_INTERFACE_CLOSE) (NRT_DATA *, nrt_Error *);
 typedef void (*NRT_IO_INTERFACE_DESTRUCT) (NRT_DATA *);
+typedef NRT_BOOL(*NRT_IO_INTERFACE_READ_AT) (NRT_DATA *, nrt_Off, void *,
+                                             size_t, nrt_Error *);
+typedef const void *(*NRT_IO_INTERFACE_GET_BUFFER) (NRT_DATA *, nrt_Off,
+                                                    size_t, nrt_Error *);
 
 typedef struct _NRT_IIOInterface
 {
@@ -51,6 +55,12 @@ typedef struct _NRT_IIOInterface
     NRT_IO_INTERFACE_GET_MODE getMode;
     NRT_IO_INTERFACE_CLOSE close;
     NRT_IO_INTERFACE_DESTRUCT destruct;
+
+    /* Optional - may be NULL, in which case readAt falls back on seek/read */
+    NRT_IO_INTERFACE_READ_AT readAt;
+
+    /* Optional - may be NULL if the data is not addressable in memory */
+    NRT_IO_INTERFACE_GET_BUFFER getBuffer;
 } nrt_IIOInterface;
 
 typedef struct _NRT_IOInterface
@@ -65,6 +75,35 @@ typedef struct _NRT_IOInterface
 NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface *, void* buf, size_t size,
                                       nrt_Error * error);
 
+/**
+ * Reads data from the interface starting at an absolute offset.  If the
+ * interface provides a readAt implementation, the current position is not
+ * used and reads from several threads may be issued at once.  Otherwise,
+ * this falls back on a seek followed by a read, which moves the current
+ * position and must be serialized by the caller.
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error);
+
+/**
+ * Returns whether the interface implements readAt natively (i.e. whether
+ * nrt_IOInterface_readAt may be called concurrently)
+ */
+NRTAPI(NRT_BOOL) nrt_IOInterface_canReadAt(nrt_IOInterface * io);
+
+/**
+ * Returns a pointer to size bytes starting at offset within the interface's
+ * own storage (the memory map adapter's mapping), without copying.  The
+ * pointer remains valid until the interface is destroyed and must not be
+ * written through.  Returns NULL if the interface is not addressable in
+ * memory (no error is set) or if the range is out of bounds (the error is
+ * set); callers should fall back on nrt_IOInterface_readAt.
+ */
+NRTAPI(const void *) nrt_IOInterface_getBuffer(nrt_IOInterface * io,
+                                               nrt_Off offset, size_t size,
+                                               nrt_Error * error);
+
 /**
  * Writes data to the interface
  */
@@ -131,5 +170,20 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
                                                       NRT_BOOL ownBuf,
                                                       nrt_Error * error);
 
+/**
+ * Creates a read-only IOInterface that memory maps the entire file behind
+ * an open IOHandle.  The handle is not adopted; it may be closed once this
+ * returns.  Reads are copies out of the mapping, and
+ * nrt_IOInterface_getBuffer returns pointers straight into it.
+ */
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_construct(nrt_IOHandle handle,
+                                                    nrt_Error * error);
+
+/**
+ * Creates a read-only IOInterface that memory maps the named file.
+ */
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_open(const char *fname,
+                                               nrt_Error * error);
+
 NRT_CXX_ENDGUARD
 #endif
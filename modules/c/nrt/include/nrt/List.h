@@ -82,6 +82,8 @@ typedef struct _NRT_List
     nrt_ListNode *first;
     /* ! A pointer to the final node */
     nrt_ListNode *last;
+    /* ! private member, the arena the list was constructed in, if any */
+    struct _nrt_Arena *arena;
 
 } nrt_List;
 
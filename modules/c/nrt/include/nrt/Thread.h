@@ -0,0 +1,86 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef __NRT_THREAD_H__
+#define __NRT_THREAD_H__
+
+#include "nrt/Defines.h"
+#include "nrt/Types.h"
+#include "nrt/Memory.h"
+#include "nrt/Error.h"
+
+NRT_CXX_GUARD
+
+/*!
+ *  The function run by a thread.  It receives the data pointer that was
+ *  handed to nrt_Thread_construct.
+ */
+typedef void (*NRT_THREAD_RUN_FUNCTION) (NRT_DATA * data);
+
+/*!
+ *  \struct nrt_Thread
+ *  \brief A native thread, started when it is constructed
+ *
+ *  This is only as much threading as the C library needs internally (for
+ *  instance, plugins decoding blocks concurrently).  Every thread must be
+ *  joined before it is destroyed.
+ */
+typedef struct _nrt_Thread
+{
+    NRT_THREAD_RUN_FUNCTION run;    /* The function to run */
+    NRT_DATA *data;                 /* Its argument */
+    void *native;                   /* The native thread handle */
+} nrt_Thread;
+
+/*!
+ *  Construct a thread and start it running
+ *  \param run The function to run
+ *  \param data The argument to pass it
+ *  \param error Populated on failure
+ *  \return The running thread, or NULL on failure
+ */
+NRTAPI(nrt_Thread *) nrt_Thread_construct(NRT_THREAD_RUN_FUNCTION run,
+                                          NRT_DATA * data,
+                                          nrt_Error * error);
+
+/*!
+ *  Wait for the thread to finish running
+ *  \param thread The thread
+ *  \param error Populated on failure
+ *  \return NRT_SUCCESS, or NRT_FAILURE if the thread could not be joined
+ */
+NRTAPI(NRT_BOOL) nrt_Thread_join(nrt_Thread * thread, nrt_Error * error);
+
+/*!
+ *  Destroy a thread object.  The thread must already have been joined.
+ *  \param thread The thread, NULL-set on return
+ */
+NRTAPI(void) nrt_Thread_destruct(nrt_Thread ** thread);
+
+/*!
+ *  The number of processors online, at least 1
+ */
+NRTAPI(nrt_Uint32) nrt_Thread_getNumCPUs(void);
+
+NRT_CXX_ENDGUARD
+
+#endif
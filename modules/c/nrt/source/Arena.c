@@ -0,0 +1,234 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Arena.h"
+
+/* Keeps every allocation aligned for the widest basic types */
+typedef union _ArenaAlign
+{
+    double d;
+    nrt_Uint64 u;
+    void* p;
+} ArenaAlign;
+
+#define NRT_ARENA_ALIGN(SZ) \
+    (((SZ) + sizeof(ArenaAlign) - 1) / sizeof(ArenaAlign) * sizeof(ArenaAlign))
+
+/*
+ *  Chunk data is laid out on whole slots, and the arena keeps a hash set
+ *  of the slots it covers, so finding out whether a pointer is in the
+ *  arena is a single lookup no matter how many chunks there are.
+ */
+#define NRT_ARENA_SLOT_SHIFT 12
+#define NRT_ARENA_SLOT_SZ ((size_t) 1 << NRT_ARENA_SLOT_SHIFT)
+#define NRT_ARENA_SLOT_ROUND(SZ) \
+    (((SZ) + NRT_ARENA_SLOT_SZ - 1) & ~(NRT_ARENA_SLOT_SZ - 1))
+#define NRT_ARENA_SLOT(PTR) ((size_t) (PTR) >> NRT_ARENA_SLOT_SHIFT)
+
+typedef struct _nrt_ArenaChunk
+{
+    struct _nrt_ArenaChunk* next;
+    char* data;     /* slot aligned, inside the chunk's own allocation */
+    size_t size;
+    size_t used;
+} nrt_ArenaChunk;
+
+#if defined(WIN32)
+static __declspec(thread) nrt_Arena* currentArena = NULL;
+#else
+static __thread nrt_Arena* currentArena = NULL;
+#endif
+
+NRTAPI(nrt_Arena *) nrt_Arena_construct(size_t chunkSize, nrt_Error * error)
+{
+    nrt_Arena *arena = (nrt_Arena *) NRT_MALLOC(sizeof(nrt_Arena));
+    if (!arena)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+    arena->chunks = NULL;
+    arena->chunkSize = chunkSize;
+    arena->bytesUsed = 0;
+    arena->bytesReserved = 0;
+    arena->slots = NULL;
+    arena->numSlots = 0;
+    arena->slotCapacity = 0;
+    return arena;
+}
+
+/* Open addressing, slot numbers are stored plus one so 0 is empty */
+NRTPRIV(size_t) findSlot(const size_t *slots, size_t capacity, size_t slot)
+{
+    size_t i = (slot * 2654435761u) & (capacity - 1);
+    while (slots[i] && slots[i] != slot + 1)
+        i = (i + 1) & (capacity - 1);
+    return i;
+}
+
+NRTPRIV(NRT_BOOL) addSlots(nrt_Arena * arena, const char *data, size_t size,
+                           nrt_Error * error)
+{
+    const size_t first = NRT_ARENA_SLOT(data);
+    const size_t count = size >> NRT_ARENA_SLOT_SHIFT;
+    size_t slot;
+
+    /* Keep the table at most half full */
+    if ((arena->numSlots + count) * 2 > arena->slotCapacity)
+    {
+        size_t capacity = arena->slotCapacity ? arena->slotCapacity : 64;
+        size_t *slots;
+        size_t i;
+        while ((arena->numSlots + count) * 2 > capacity)
+            capacity *= 2;
+
+        slots = (size_t *) NRT_MALLOC(capacity * sizeof(size_t));
+        if (!slots)
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NRT_FAILURE;
+        }
+        memset(slots, 0, capacity * sizeof(size_t));
+        for (i = 0; i < arena->slotCapacity; ++i)
+        {
+            if (arena->slots[i])
+                slots[findSlot(slots, capacity, arena->slots[i] - 1)] =
+                    arena->slots[i];
+        }
+        if (arena->slots)
+            NRT_FREE(arena->slots);
+        arena->slots = slots;
+        arena->slotCapacity = capacity;
+    }
+
+    for (slot = first; slot < first + count; ++slot)
+        arena->slots[findSlot(arena->slots, arena->slotCapacity, slot)] =
+            slot + 1;
+    arena->numSlots += count;
+    return NRT_SUCCESS;
+}
+
+NRTAPI(void) nrt_Arena_destruct(nrt_Arena ** arena)
+{
+    if (*arena)
+    {
+        nrt_ArenaChunk *chunk = (*arena)->chunks;
+        while (chunk)
+        {
+            nrt_ArenaChunk *next = chunk->next;
+            NRT_FREE(chunk);
+            chunk = next;
+        }
+        if ((*arena)->slots)
+            NRT_FREE((*arena)->slots);
+        NRT_FREE(*arena);
+        *arena = NULL;
+    }
+}
+
+NRTAPI(void *) nrt_Arena_malloc(nrt_Arena * arena, size_t size,
+                                nrt_Error * error)
+{
+    nrt_ArenaChunk *chunk = arena->chunks;
+    void *ptr;
+
+    size = NRT_ARENA_ALIGN(size);
+    if (!chunk || chunk->size - chunk->used < size)
+    {
+        /* The data gets whole slots of its own, so no other allocation
+         * shares a slot with it */
+        const size_t dataSize = size > arena->chunkSize ?
+            size : arena->chunkSize;
+        const size_t slotBytes = NRT_ARENA_SLOT_ROUND(dataSize);
+        const size_t chunkBytes = NRT_ARENA_ALIGN(sizeof(nrt_ArenaChunk)) +
+            NRT_ARENA_SLOT_SZ + slotBytes;
+
+        chunk = (nrt_ArenaChunk *) NRT_MALLOC(chunkBytes);
+        if (!chunk)
+        {
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NULL;
+        }
+        chunk->data = (char *) NRT_ARENA_SLOT_ROUND(
+            (size_t) chunk + NRT_ARENA_ALIGN(sizeof(nrt_ArenaChunk)));
+        chunk->size = dataSize;
+        chunk->used = 0;
+        if (!addSlots(arena, chunk->data, slotBytes, error))
+        {
+            NRT_FREE(chunk);
+            return NULL;
+        }
+        arena->bytesReserved += chunkBytes;
+
+        /* An oversized chunk goes behind the current one, so the room
+         * left in the current one is not thrown away */
+        if (arena->chunks && dataSize > arena->chunkSize)
+        {
+            chunk->next = arena->chunks->next;
+            arena->chunks->next = chunk;
+        }
+        else
+        {
+            chunk->next = arena->chunks;
+            arena->chunks = chunk;
+        }
+    }
+
+    ptr = chunk->data + chunk->used;
+    chunk->used += size;
+    arena->bytesUsed += size;
+    return ptr;
+}
+
+NRTAPI(NRT_BOOL) nrt_Arena_contains(const nrt_Arena * arena,
+                                    const void *ptr)
+{
+    if (!arena->slotCapacity)
+        return 0;
+    return arena->slots[findSlot(arena->slots, arena->slotCapacity,
+                                 NRT_ARENA_SLOT(ptr))] != 0;
+}
+
+NRTAPI(nrt_Uint64) nrt_Arena_getBytesUsed(const nrt_Arena * arena)
+{
+    return arena->bytesUsed;
+}
+
+NRTAPI(nrt_Uint64) nrt_Arena_getBytesReserved(const nrt_Arena * arena)
+{
+    return arena->bytesReserved;
+}
+
+NRTAPI(nrt_Arena *) nrt_Arena_setCurrent(nrt_Arena * arena)
+{
+    nrt_Arena *previous = currentArena;
+    currentArena = arena;
+    return previous;
+}
+
+NRTAPI(nrt_Arena *) nrt_Arena_getCurrent(void)
+{
+    return currentArena;
+}
@@ -21,6 +21,38 @@
  */
 
 #include "nrt/HashTable.h"
+#include "nrt/Arena.h"
+
+/*
+ *  A table built in an arena takes its own memory (pairs and keys
+ *  included) from that arena for as long as it lives, and from the heap
+ *  otherwise.  Adopted data may have come from either.
+ */
+NRTPRIV(void *) allocMemory(nrt_HashTable * ht, size_t size,
+                            nrt_Error * error)
+{
+    void *p;
+    if (ht->arena)
+        return nrt_Arena_malloc(ht->arena, size, error);
+
+    p = NRT_MALLOC(size);
+    if (!p)
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+    return p;
+}
+
+NRTPRIV(void) freeMemory(nrt_HashTable * ht, void *p)
+{
+    if (!ht->arena)
+        NRT_FREE(p);
+}
+
+NRTPRIV(void) freeData(nrt_HashTable * ht, NRT_DATA * data)
+{
+    if (!ht->arena || !nrt_Arena_contains(ht->arena, data))
+        NRT_FREE(data);
+}
 
 NRTAPI(nrt_HashTable *) nrt_HashTable_construct(int nbuckets, nrt_Error * error)
 {
@@ -28,14 +60,22 @@ NRTAPI(nrt_HashTable *) nrt_HashTable_construct(int nbuckets, nrt_Error * error)
     int hashSize;
 
     /* Create the hash table object itself */
-    nrt_HashTable *ht = (nrt_HashTable *) NRT_MALLOC(sizeof(nrt_HashTable));
-    if (!ht)
+    nrt_HashTable *ht;
+    nrt_Arena *arena = nrt_Arena_getCurrent();
+    if (arena)
+        ht = (nrt_HashTable *) nrt_Arena_malloc(arena, sizeof(nrt_HashTable),
+                                                error);
+    else
     {
-        /* If we had problems, error population and return */
-        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
-                       NRT_ERR_MEMORY);
-        return NULL;
+        ht = (nrt_HashTable *) NRT_MALLOC(sizeof(nrt_HashTable));
+        if (!ht)
+            /* If we had problems, error population and return */
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
     }
+    if (!ht)
+        return NULL;
+    ht->arena = arena;
 
     /* Adopt the data by default */
     ht->adopt = NRT_DATA_ADOPT;
@@ -47,15 +87,12 @@ NRTAPI(nrt_HashTable *) nrt_HashTable_construct(int nbuckets, nrt_Error * error)
     ht->nbuckets = nbuckets;
 
     /* Allocate the list of lists (still need to allocate each list */
-    ht->buckets = (nrt_List **) NRT_MALLOC(hashSize);
+    ht->buckets = (nrt_List **) allocMemory(ht, hashSize, error);
     if (!ht->buckets)
     {
-        /* If we had problems, error population, and */
-        /* free the object we have and return */
-        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
-                       NRT_ERR_MEMORY);
+        /* If we had problems, free the object we have and return */
         /* Dont bother with the destructor */
-        NRT_FREE(ht);
+        freeMemory(ht, ht);
         return NULL;
     }
     /* Make sure if we have to call the destructor we are good */
@@ -119,6 +156,14 @@ NRTAPI(void) nrt_HashTable_destruct(nrt_HashTable ** ht)
     /* If the hash table exists at all */
     if (*ht)
     {
+        /* A table in an arena that does not adopt its data has nothing
+         * on the heap, it all goes away with the arena */
+        if ((*ht)->arena && !(*ht)->adopt)
+        {
+            *ht = NULL;
+            return;
+        }
+
         /* If the linked list of lists exists */
         if ((*ht)->buckets)
         {
@@ -151,7 +196,7 @@ NRTAPI(void) nrt_HashTable_destruct(nrt_HashTable ** ht)
                             if (key)
                             {
                                 /* Free and NULL it */
-                                NRT_FREE(key);
+                                freeMemory(*ht, key);
                             }
                             /* If the adoption policy is to adopt...  */
                             if ((*ht)->adopt)
@@ -162,12 +207,12 @@ NRTAPI(void) nrt_HashTable_destruct(nrt_HashTable ** ht)
                                 if (data)
                                 {
                                     /* Free the data and NULL it */
-                                    NRT_FREE(data);
+                                    freeData(*ht, data);
                                 }
                             }
                             /* Finally, we know that we allocated the */
                             /* pair, so lets free it */
-                            NRT_FREE(pair);
+                            freeMemory(*ht, pair);
                         }
                     }
                     /* Now the list is empty, let's destroy it */
@@ -175,10 +220,10 @@ NRTAPI(void) nrt_HashTable_destruct(nrt_HashTable ** ht)
                 }
                 /* Now go on to the next bucket */
             }
-            NRT_FREE((*ht)->buckets);
+            freeMemory(*ht, (*ht)->buckets);
         }
 
-        NRT_FREE(*ht);
+        freeMemory(*ht, *ht);
         *ht = NULL;
     }
 }
@@ -223,10 +268,10 @@ NRTAPI(NRT_DATA *) nrt_HashTable_remove(nrt_HashTable * ht, const char *key)
             nrt_List_remove(l, &iter);
 
             /* Delete the key -- that's ours */
-            NRT_FREE(pair->key);
+            freeMemory(ht, pair->key);
 
             /* Free the pair */
-            NRT_FREE(pair);
+            freeMemory(ht, pair);
 
             /* Return the value -- that's yours */
             return data;
@@ -350,19 +395,24 @@ NRTAPI(NRT_BOOL) nrt_HashTable_insert(nrt_HashTable * ht, const char *key,
     int bucket = ht->hash(ht, key);
 
     /* Malloc the pair -- that's our container item */
-    nrt_Pair *p = (nrt_Pair *) NRT_MALLOC(sizeof(nrt_Pair));
+    size_t keyLength = strlen(key);
+    nrt_Pair *p = (nrt_Pair *) allocMemory(ht, sizeof(nrt_Pair), error);
     if (!p)
     {
-        /* There was a memory allocation error */
-        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
-                       NRT_ERR_MEMORY);
         /* Retreat! */
         return 0;
     }
 
     /* Initialize the new pair */
     /* This makes a copy of the key, but uses the data directly */
-    nrt_Pair_init(p, key, data);
+    p->key = (char *) allocMemory(ht, keyLength + 1, error);
+    if (!p->key)
+    {
+        freeMemory(ht, p);
+        return 0;
+    }
+    memcpy(p->key, key, keyLength + 1);
+    p->data = data;
 
     /* Push the pair back into the list */
     return nrt_List_pushBack(ht->buckets[bucket], p, error);
@@ -104,6 +104,63 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
     return NRT_FAILURE;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    ssize_t bytesRead = 0;      /* Number of bytes read during last read
+                                 * operation */
+    size_t totalBytesRead = 0;  /* Total bytes read thus far */
+    int i;                      /* iterator */
+
+    /* make sure the user actually wants data */
+    if (size <= 0)
+        return NRT_SUCCESS;
+
+    for (i = 1; i <= NRT_MAX_READ_ATTEMPTS; i++)
+    {
+        /* Make the next read, leaving the file position alone */
+        bytesRead = pread(handle,
+                          (nrt_Uint8*)buf + totalBytesRead,
+                          size - totalBytesRead,
+                          offset + (nrt_Off)totalBytesRead);
+
+        switch (bytesRead)
+        {
+        case -1:               /* Some type of error occured */
+            switch (errno)
+            {
+            case EINTR:
+            case EAGAIN:       /* A non-fatal error occured, keep trying */
+                break;
+
+            default:           /* We failed */
+                goto CATCH_ERROR;
+            }
+            break;
+
+        case 0:                /* EOF (unexpected) */
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+
+        default:               /* We made progress */
+            totalBytesRead += (size_t) bytesRead;
+            break;
+        }
+
+        if (totalBytesRead == size)
+        {
+            return NRT_SUCCESS;
+        }
+    }
+
+    CATCH_ERROR:
+
+    nrt_Error_init(error, strerror(errno), NRT_CTXT, NRT_ERR_READING_FROM_FILE);
+    return NRT_FAILURE;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
                                     size_t size, nrt_Error * error)
 {
@@ -96,6 +96,62 @@ NRTAPI(NRT_BOOL) nrt_IOHandle_read(nrt_IOHandle handle, void* buf, size_t size,
     return NRT_SUCCESS;
 }
 
+NRTAPI(NRT_BOOL) nrt_IOHandle_readAt(nrt_IOHandle handle, nrt_Off offset,
+                                     void* buf, size_t size,
+                                     nrt_Error * error)
+{
+    static const DWORD MAX_READ_SIZE = (DWORD)-1;
+    size_t bytesRead = 0;
+    size_t bytesRemaining = size;
+
+    while (bytesRead < size)
+    {
+        /* Determine how many bytes to read */
+        const DWORD bytesToRead = (bytesRemaining > MAX_READ_SIZE) ?
+            MAX_READ_SIZE : (DWORD)bytesRemaining;
+
+        /* The read position travels with the request, not the handle */
+        ULARGE_INTEGER position;
+        OVERLAPPED overlapped;
+        DWORD bytesThisRead = 0;
+
+        position.QuadPart = (ULONGLONG)offset + bytesRead;
+        memset(&overlapped, 0, sizeof(OVERLAPPED));
+        overlapped.Offset = position.LowPart;
+        overlapped.OffsetHigh = position.HighPart;
+
+        if (!ReadFile(handle,
+                      (nrt_Uint8*)buf + bytesRead,
+                      bytesToRead,
+                      &bytesThisRead,
+                      &overlapped))
+        {
+            if (GetLastError() == ERROR_HANDLE_EOF)
+            {
+                nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                               NRT_ERR_READING_FROM_FILE);
+            }
+            else
+            {
+                nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                               NRT_ERR_READING_FROM_FILE);
+            }
+            return NRT_FAILURE;
+        }
+        else if (bytesThisRead == 0)
+        {
+            nrt_Error_init(error, "Unexpected end of file", NRT_CTXT,
+                           NRT_ERR_READING_FROM_FILE);
+            return NRT_FAILURE;
+        }
+
+        bytesRead += bytesThisRead;
+        bytesRemaining -= bytesThisRead;
+    }
+
+    return NRT_SUCCESS;
+}
+
 NRTAPI(NRT_BOOL) nrt_IOHandle_write(nrt_IOHandle handle, const void *buf,
                                     size_t size, nrt_Error * error)
 {
@@ -23,6 +23,10 @@
 
 #include "nrt/IOInterface.h"
 
+#ifndef WIN32
+#include <sys/mman.h>
+#endif
+
 NRT_CXX_GUARD typedef struct _IOHandleControl
 {
     nrt_IOHandle handle;
@@ -44,6 +48,38 @@ NRTAPI(NRT_BOOL) nrt_IOInterface_read(nrt_IOInterface * io, void* buf,
     return io->iface->read(io->data, buf, size, error);
 }
 
+NRTAPI(NRT_BOOL) nrt_IOInterface_readAt(nrt_IOInterface * io, nrt_Off offset,
+                                        void* buf, size_t size,
+                                        nrt_Error * error)
+{
+    if (io->iface->readAt)
+    {
+        return io->iface->readAt(io->data, offset, buf, size, error);
+    }
+
+    if (!NRT_IO_SUCCESS(nrt_IOInterface_seek(io, offset, NRT_SEEK_SET, error)))
+    {
+        return NRT_FAILURE;
+    }
+    return io->iface->read(io->data, buf, size, error);
+}
+
+NRTAPI(NRT_BOOL) nrt_IOInterface_canReadAt(nrt_IOInterface * io)
+{
+    return io->iface->readAt != NULL;
+}
+
+NRTAPI(const void *) nrt_IOInterface_getBuffer(nrt_IOInterface * io,
+                                               nrt_Off offset, size_t size,
+                                               nrt_Error * error)
+{
+    if (!io->iface->getBuffer)
+    {
+        return NULL;
+    }
+    return io->iface->getBuffer(io->data, offset, size, error);
+}
+
 NRTAPI(NRT_BOOL) nrt_IOInterface_write(nrt_IOInterface * io, const void* buf,
                                        size_t size, nrt_Error * error)
 {
@@ -115,6 +151,14 @@ NRTPRIV(NRT_BOOL) IOHandleAdapter_read(NRT_DATA * data, void *buf, size_t size,
     return nrt_IOHandle_read(control->handle, buf, size, error);
 }
 
+NRTPRIV(NRT_BOOL) IOHandleAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                         void *buf, size_t size,
+                                         nrt_Error * error)
+{
+    IOHandleControl *control = (IOHandleControl *) data;
+    return nrt_IOHandle_readAt(control->handle, offset, buf, size, error);
+}
+
 NRTPRIV(NRT_BOOL) IOHandleAdapter_write(NRT_DATA * data, const void *buf,
                                         size_t size, nrt_Error * error)
 {
@@ -206,6 +250,43 @@ NRTPRIV(NRT_BOOL) BufferAdapter_read(NRT_DATA * data, void *buf, size_t size,
     return NRT_SUCCESS;
 }
 
+NRTPRIV(NRT_BOOL) BufferAdapter_readAt(NRT_DATA * data, nrt_Off offset,
+                                       void *buf, size_t size,
+                                       nrt_Error * error)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+
+    /* The mark is left alone */
+    if (offset < 0 || (size_t) offset > control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NRT_FAILURE;
+    }
+
+    if (size > 0)
+    {
+        memcpy(buf, control->buf + offset, size);
+    }
+    return NRT_SUCCESS;
+}
+
+NRTPRIV(const void *) BufferAdapter_getBuffer(NRT_DATA * data, nrt_Off offset,
+                                             size_t size, nrt_Error * error)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+
+    if (offset < 0 || (size_t) offset > control->size ||
+        size > control->size - (size_t) offset)
+    {
+        nrt_Error_init(error, "Invalid size requested - EOF", NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+    return control->buf + offset;
+}
+
 NRTPRIV(NRT_BOOL) BufferAdapter_write(NRT_DATA * data, const void *buf,
                                       size_t size, nrt_Error * error)
 {
@@ -323,7 +404,8 @@ NRTAPI(nrt_IOInterface *) nrt_IOHandleAdapter_construct(nrt_IOHandle handle,
         &IOHandleAdapter_getSize,
         &IOHandleAdapter_getMode,
         &IOHandleAdapter_close,
-        &IOHandleAdapter_destruct
+        &IOHandleAdapter_destruct,
+        &IOHandleAdapter_readAt
     };
     nrt_IOInterface *impl = NULL;
     IOHandleControl *control = NULL;
@@ -397,7 +479,12 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
         &BufferAdapter_getSize,
         &BufferAdapter_getMode,
         &BufferAdapter_close,
-        &BufferAdapter_destruct
+        &BufferAdapter_destruct,
+        &BufferAdapter_readAt,
+
+        /* The caller's buffer is only handed out in place by the memory
+         * map adapter, where the library owns the storage */
+        NULL
     };
     nrt_IOInterface *impl = NULL;
     BufferIOControl *control = NULL;
@@ -435,5 +522,170 @@ NRTAPI(nrt_IOInterface *) nrt_BufferAdapter_construct(char *buf, size_t size,
     }
 }
 
+/*
+ *  The memory map adapter reuses the buffer adapter for everything but
+ *  writing, reporting its mode, and releasing the mapping.  The mapping is
+ *  read-only, so a stray write through a pointer returned by getBuffer
+ *  faults instead of reaching the file or going unnoticed.
+ */
+NRTPRIV(NRT_BOOL) MMapAdapter_write(NRT_DATA * data, const void *buf,
+                                    size_t size, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)buf;
+    (void)size;
+
+    nrt_Error_init(error, "Memory mapped IO is read-only", NRT_CTXT,
+                   NRT_ERR_WRITING_TO_FILE);
+    return NRT_FAILURE;
+}
+
+NRTPRIV(int) MMapAdapter_getMode(NRT_DATA * data, nrt_Error * error)
+{
+    /* Silence compiler warnings about unused variables */
+    (void)data;
+    (void)error;
+
+    return NRT_ACCESS_READONLY;
+}
+
+NRTPRIV(void) MMapAdapter_destruct(NRT_DATA * data)
+{
+    BufferIOControl *control = (BufferIOControl *) data;
+    if (control && control->buf)
+    {
+#ifdef WIN32
+        UnmapViewOfFile(control->buf);
+#else
+        munmap(control->buf, control->size);
+#endif
+        control->buf = NULL;
+    }
+}
+
+NRTPRIV(char *) MMapAdapter_map(nrt_IOHandle handle, size_t size,
+                                nrt_Error * error)
+{
+#ifdef WIN32
+    HANDLE mapping;
+    void *buf;
+
+    mapping = CreateFileMapping(handle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mapping == NULL)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+
+    /* The view keeps its own reference to the mapping object */
+    buf = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, size);
+    CloseHandle(mapping);
+    if (buf == NULL)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+    return (char *) buf;
+#else
+    void *buf = mmap(NULL, size, PROT_READ, MAP_PRIVATE, handle, 0);
+    if (buf == MAP_FAILED)
+    {
+        nrt_Error_init(error, strerror(errno), NRT_CTXT,
+                       NRT_ERR_OPENING_FILE);
+        return NULL;
+    }
+    return (char *) buf;
+#endif
+}
+
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_construct(nrt_IOHandle handle,
+                                                    nrt_Error * error)
+{
+    static nrt_IIOInterface mmapInterface = {
+        &BufferAdapter_read,
+        &MMapAdapter_write,
+        &BufferAdapter_canSeek,
+        &BufferAdapter_seek,
+        &BufferAdapter_tell,
+        &BufferAdapter_getSize,
+        &MMapAdapter_getMode,
+        &BufferAdapter_close,
+        &MMapAdapter_destruct,
+        &BufferAdapter_readAt,
+        &BufferAdapter_getBuffer
+    };
+    nrt_IOInterface *impl = NULL;
+    BufferIOControl *control = NULL;
+    nrt_Off size;
+
+    size = nrt_IOHandle_getSize(handle, error);
+    if (!NRT_IO_SUCCESS(size))
+    {
+        return NULL;
+    }
+    if (size == 0 || (nrt_Uint64) size > (nrt_Uint64) ((size_t) -1))
+    {
+        nrt_Error_initf(error, NRT_CTXT, NRT_ERR_INVALID_PARAMETER,
+                        "Cannot map a file of %lld bytes", (long long) size);
+        return NULL;
+    }
+
+    impl = (nrt_IOInterface *) NRT_MALLOC(sizeof(nrt_IOInterface));
+    if (!impl)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(impl, 0, sizeof(nrt_IOInterface));
+
+    control = (BufferIOControl *) NRT_MALLOC(sizeof(BufferIOControl));
+    if (!control)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        goto CATCH_ERROR;
+    }
+    memset(control, 0, sizeof(BufferIOControl));
+    impl->data = (NRT_DATA *) control;
+    impl->iface = &mmapInterface;
+
+    control->buf = MMapAdapter_map(handle, (size_t) size, error);
+    if (!control->buf)
+    {
+        goto CATCH_ERROR;
+    }
+    control->size = (size_t) size;
+    control->bytesWritten = (size_t) size;
+    return impl;
+
+    CATCH_ERROR:
+    {
+        if (impl)
+            nrt_IOInterface_destruct(&impl);
+        return NULL;
+    }
+}
+
+NRTAPI(nrt_IOInterface *) nrt_MMapAdapter_open(const char *fname,
+                                               nrt_Error * error)
+{
+    nrt_IOInterface *impl = NULL;
+    nrt_IOHandle handle = nrt_IOHandle_create(fname, NRT_ACCESS_READONLY,
+                                              NRT_OPEN_EXISTING, error);
+    if (NRT_INVALID_HANDLE(handle))
+    {
+        return NULL;
+    }
+
+    /* The mapping outlives the handle */
+    impl = nrt_MMapAdapter_construct(handle, error);
+    nrt_IOHandle_close(handle);
+    return impl;
+}
+
 NRT_CXX_ENDGUARD
 
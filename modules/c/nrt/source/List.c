@@ -21,6 +21,38 @@
  */
 
 #include "nrt/List.h"
+#include "nrt/Arena.h"
+
+/*
+ *  A list built in an arena takes its nodes from that arena for as long as
+ *  it lives, and from the heap otherwise
+ */
+NRTPRIV(nrt_ListNode *) constructNode(nrt_List * list, nrt_ListNode * prev,
+                                      nrt_ListNode * next, NRT_DATA * data,
+                                      nrt_Error * error)
+{
+    nrt_ListNode *node;
+    if (!list->arena)
+        return nrt_ListNode_construct(prev, next, data, error);
+
+    node = (nrt_ListNode *) nrt_Arena_malloc(list->arena,
+                                             sizeof(nrt_ListNode), error);
+    if (node)
+    {
+        node->data = data;
+        node->next = next;
+        node->prev = prev;
+    }
+    return node;
+}
+
+NRTPRIV(void) destructNode(nrt_List * list, nrt_ListNode ** node)
+{
+    /* arena memory goes away with the arena */
+    if (!list->arena)
+        nrt_ListNode_destruct(node);
+    *node = NULL;
+}
 
 NRTAPI(nrt_ListNode *) nrt_ListNode_construct(nrt_ListNode * prev,
                                               nrt_ListNode * next,
@@ -69,7 +101,7 @@ NRTAPI(NRT_BOOL) nrt_List_pushFront(nrt_List * this_list, NRT_DATA * data,
                                     nrt_Error * error)
 {
     /* Construct a new node, with no surrounding context */
-    nrt_ListNode *node = nrt_ListNode_construct(NULL, NULL, data, error);
+    nrt_ListNode *node = constructNode(this_list, NULL, NULL, data, error);
     if (!node)
     {
         /* The node constructor inited the error, so let's go home */
@@ -103,7 +135,7 @@ NRTAPI(NRT_BOOL) nrt_List_pushBack(nrt_List * this_list, NRT_DATA * data,
 
     /* Create a new node with the data, to place on the back */
     nrt_ListNode *node =
-        nrt_ListNode_construct(this_list->last, NULL, data, error);
+        constructNode(this_list, this_list->last, NULL, data, error);
 
     if (!node)
     {
@@ -152,7 +184,7 @@ NRTAPI(NRT_DATA *) nrt_List_popFront(nrt_List * this_list)
         else
             this_list->first = this_list->last = NULL;
         data = popped->data;
-        nrt_ListNode_destruct(&popped);
+        destructNode(this_list, &popped);
     }
     /* Return the popped item.  Deletion is YOUR problem */
     return data;
@@ -182,7 +214,7 @@ NRTAPI(NRT_DATA *) nrt_List_popBack(nrt_List * this_list)
             this_list->first = this_list->last = NULL;
         }
         data = popped->data;
-        nrt_ListNode_destruct(&popped);
+        destructNode(this_list, &popped);
     }
     /* Return the popped node */
     return data;
@@ -190,18 +222,29 @@ NRTAPI(NRT_DATA *) nrt_List_popBack(nrt_List * this_list)
 
 NRTAPI(nrt_List *) nrt_List_construct(nrt_Error * error)
 {
-    /* New allocate a list */
+    /* New allocate a list, out of the current arena if there is one */
     nrt_List *l;
-    l = (nrt_List *) NRT_MALLOC(sizeof(nrt_List));
-    if (!l)
+    nrt_Arena *arena = nrt_Arena_getCurrent();
+    if (arena)
     {
-        /* Initialize the error and return NULL */
-        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
-                       NRT_ERR_MEMORY);
-        return NULL;
+        l = (nrt_List *) nrt_Arena_malloc(arena, sizeof(nrt_List), error);
+        if (!l)
+            return NULL;
+    }
+    else
+    {
+        l = (nrt_List *) NRT_MALLOC(sizeof(nrt_List));
+        if (!l)
+        {
+            /* Initialize the error and return NULL */
+            nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                           NRT_ERR_MEMORY);
+            return NULL;
+        }
     }
     /* Null-initialize the link pointers */
     l->first = l->last = NULL;
+    l->arena = arena;
     return l;
 }
 
@@ -259,11 +302,13 @@ NRTAPI(void) nrt_List_destruct(nrt_List ** this_list)
         {
             /* Pop one off the back and delete it */
             data = nrt_List_popBack(*this_list);
-            /* delete it */
-            if (data)
+            /* delete it, unless the arena owns it */
+            if (data && (!(*this_list)->arena ||
+                         !nrt_Arena_contains((*this_list)->arena, data)))
                 NRT_FREE(data);
         }
-        NRT_FREE(*this_list);
+        if (!(*this_list)->arena)
+            NRT_FREE(*this_list);
         *this_list = NULL;
     }
 
@@ -355,7 +400,7 @@ NRTAPI(NRT_DATA *) nrt_List_remove(nrt_List * list, nrt_ListIterator * where)
         where->current = new_current;
 
         /* Now, destruct the listNode, but not the data */
-        nrt_ListNode_destruct(&old);
+        destructNode(list, &old);
     }
     /* Return what we saved */
 
@@ -415,10 +460,11 @@ NRTAPI(NRT_BOOL) nrt_List_insert(nrt_List * list, nrt_ListIterator iter,
     {
 
         /* Construct a new node and insert it before the current */
-        nrt_ListNode *new_node = nrt_ListNode_construct(iter.current->prev,
-                                                        iter.current,
-                                                        data,
-                                                        error);
+        nrt_ListNode *new_node = constructNode(list,
+                                               iter.current->prev,
+                                               iter.current,
+                                               data,
+                                               error);
 
         /* If an error occurred, the list node captured it */
         if (!new_node)
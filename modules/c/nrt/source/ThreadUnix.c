@@ -0,0 +1,97 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Thread.h"
+
+NRT_CXX_GUARD
+#if !defined(WIN32)
+#include <pthread.h>
+#include <unistd.h>
+
+NRTPRIV(void *) nrt_Thread_start(void *thread)
+{
+    nrt_Thread *self = (nrt_Thread *) thread;
+    self->run(self->data);
+    return NULL;
+}
+
+NRTAPI(nrt_Thread *) nrt_Thread_construct(NRT_THREAD_RUN_FUNCTION run,
+                                          NRT_DATA * data,
+                                          nrt_Error * error)
+{
+    int rc;
+    nrt_Thread *thread = (nrt_Thread *) NRT_MALLOC(sizeof(nrt_Thread));
+    pthread_t *native = (pthread_t *) NRT_MALLOC(sizeof(pthread_t));
+    if (!thread || !native)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        NRT_FREE(thread);
+        NRT_FREE(native);
+        return NULL;
+    }
+    thread->run = run;
+    thread->data = data;
+    thread->native = native;
+
+    rc = pthread_create(native, NULL, nrt_Thread_start, thread);
+    if (rc != 0)
+    {
+        nrt_Error_init(error, NRT_STRERROR(rc), NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        NRT_FREE(native);
+        NRT_FREE(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+NRTAPI(NRT_BOOL) nrt_Thread_join(nrt_Thread * thread, nrt_Error * error)
+{
+    int rc = pthread_join(*(pthread_t *) thread->native, NULL);
+    if (rc != 0)
+    {
+        nrt_Error_init(error, NRT_STRERROR(rc), NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(void) nrt_Thread_destruct(nrt_Thread ** thread)
+{
+    if (*thread)
+    {
+        NRT_FREE((*thread)->native);
+        NRT_FREE(*thread);
+        *thread = NULL;
+    }
+}
+
+NRTAPI(nrt_Uint32) nrt_Thread_getNumCPUs(void)
+{
+    const long numCPUs = sysconf(_SC_NPROCESSORS_ONLN);
+    return numCPUs > 0 ? (nrt_Uint32) numCPUs : 1;
+}
+#endif
+
+NRT_CXX_ENDGUARD
@@ -0,0 +1,91 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "nrt/Thread.h"
+
+NRT_CXX_GUARD
+#if defined(WIN32)
+
+NRTPRIV(DWORD WINAPI) nrt_Thread_start(LPVOID thread)
+{
+    nrt_Thread *self = (nrt_Thread *) thread;
+    self->run(self->data);
+    return 0;
+}
+
+NRTAPI(nrt_Thread *) nrt_Thread_construct(NRT_THREAD_RUN_FUNCTION run,
+                                          NRT_DATA * data,
+                                          nrt_Error * error)
+{
+    nrt_Thread *thread = (nrt_Thread *) NRT_MALLOC(sizeof(nrt_Thread));
+    if (!thread)
+    {
+        nrt_Error_init(error, NRT_STRERROR(NRT_ERRNO), NRT_CTXT,
+                       NRT_ERR_MEMORY);
+        return NULL;
+    }
+    thread->run = run;
+    thread->data = data;
+    thread->native = (void *) CreateThread(NULL, 0, nrt_Thread_start,
+                                           thread, 0, NULL);
+    if (!thread->native)
+    {
+        nrt_Error_init(error, "Failed to create thread", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        NRT_FREE(thread);
+        return NULL;
+    }
+    return thread;
+}
+
+NRTAPI(NRT_BOOL) nrt_Thread_join(nrt_Thread * thread, nrt_Error * error)
+{
+    if (WaitForSingleObject((HANDLE) thread->native, INFINITE) !=
+        WAIT_OBJECT_0)
+    {
+        nrt_Error_init(error, "Failed to join thread", NRT_CTXT,
+                       NRT_ERR_INVALID_OBJECT);
+        return NRT_FAILURE;
+    }
+    return NRT_SUCCESS;
+}
+
+NRTAPI(void) nrt_Thread_destruct(nrt_Thread ** thread)
+{
+    if (*thread)
+    {
+        CloseHandle((HANDLE) (*thread)->native);
+        NRT_FREE(*thread);
+        *thread = NULL;
+    }
+}
+
+NRTAPI(nrt_Uint32) nrt_Thread_getNumCPUs(void)
+{
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwNumberOfProcessors > 0 ?
+        (nrt_Uint32) info.dwNumberOfProcessors : 1;
+}
+#endif
+
+NRT_CXX_ENDGUARD
@@ -0,0 +1,182 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2014, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+TEST_CASE(testAllocate)
+{
+    nrt_Error e;
+    char *a, *b, *big;
+    nrt_Arena *arena = nrt_Arena_construct(64, &e);
+    TEST_ASSERT(arena);
+    TEST_ASSERT_EQ_INT(0, (int) nrt_Arena_getBytesUsed(arena));
+
+    a = (char *) nrt_Arena_malloc(arena, 3, &e);
+    b = (char *) nrt_Arena_malloc(arena, 5, &e);
+    TEST_ASSERT(a);
+    TEST_ASSERT(b);
+    TEST_ASSERT(b > a);
+    TEST_ASSERT_EQ_INT(0, (int) (((size_t) b) % sizeof(double)));
+    memcpy(a, "ab", 3);
+    memcpy(b, "cdef", 5);
+    TEST_ASSERT_EQ_STR("ab", a);
+
+    /* too big for a chunk, gets its own */
+    big = (char *) nrt_Arena_malloc(arena, 1000, &e);
+    TEST_ASSERT(big);
+    memset(big, 'x', 1000);
+    TEST_ASSERT_EQ_STR("cdef", b);
+
+    TEST_ASSERT(nrt_Arena_contains(arena, a));
+    TEST_ASSERT(nrt_Arena_contains(arena, b + 4));
+    TEST_ASSERT(nrt_Arena_contains(arena, big + 999));
+    TEST_ASSERT(!nrt_Arena_contains(arena, &e));
+    TEST_ASSERT(!nrt_Arena_contains(arena, arena));
+    TEST_ASSERT(nrt_Arena_getBytesUsed(arena) >= 1008);
+    TEST_ASSERT(nrt_Arena_getBytesReserved(arena) >=
+                nrt_Arena_getBytesUsed(arena));
+
+    /* the oversized chunk did not cost the room left in the first one */
+    TEST_ASSERT(nrt_Arena_malloc(arena, 8, &e) < (void *) (a + 64));
+
+    nrt_Arena_destruct(&arena);
+    TEST_ASSERT_NULL(arena);
+}
+
+TEST_CASE(testManyChunks)
+{
+    nrt_Error e;
+    char *inArena[200];
+    char *onHeap[200];
+    int i;
+    nrt_Arena *arena = nrt_Arena_construct(4096, &e);
+    TEST_ASSERT(arena);
+
+    /* heap blocks interleaved with the chunks are never mistaken for them */
+    for (i = 0; i < 200; ++i)
+    {
+        inArena[i] = (char *) nrt_Arena_malloc(arena, 1000, &e);
+        onHeap[i] = (char *) NRT_MALLOC(1000);
+        TEST_ASSERT(inArena[i]);
+        TEST_ASSERT(onHeap[i]);
+    }
+    for (i = 0; i < 200; ++i)
+    {
+        TEST_ASSERT(nrt_Arena_contains(arena, inArena[i]));
+        TEST_ASSERT(nrt_Arena_contains(arena, inArena[i] + 999));
+        TEST_ASSERT(!nrt_Arena_contains(arena, onHeap[i]));
+        TEST_ASSERT(!nrt_Arena_contains(arena, onHeap[i] + 999));
+        NRT_FREE(onHeap[i]);
+    }
+    nrt_Arena_destruct(&arena);
+}
+
+TEST_CASE(testCurrent)
+{
+    nrt_Error e;
+    nrt_Arena *previous;
+    nrt_Arena *arena = nrt_Arena_construct(1024, &e);
+    TEST_ASSERT(arena);
+    TEST_ASSERT_NULL(nrt_Arena_getCurrent());
+
+    previous = nrt_Arena_setCurrent(arena);
+    TEST_ASSERT_NULL(previous);
+    TEST_ASSERT(nrt_Arena_getCurrent() == arena);
+    TEST_ASSERT(nrt_Arena_setCurrent(previous) == arena);
+    TEST_ASSERT_NULL(nrt_Arena_getCurrent());
+
+    nrt_Arena_destruct(&arena);
+}
+
+NRTPRIV(char *) newData(const char *s)
+{
+    char *data = (char *) NRT_MALLOC(strlen(s) + 1);
+    strcpy(data, s);
+    return data;
+}
+
+TEST_CASE(testContainers)
+{
+    nrt_Error e;
+    nrt_List *list;
+    nrt_HashTable *hash;
+    nrt_Pair *pair;
+    char *data;
+    nrt_Arena *arena = nrt_Arena_construct(1024, &e);
+    TEST_ASSERT(arena);
+
+    /* built while the arena is current, the containers live in it */
+    nrt_Arena_setCurrent(arena);
+    list = nrt_List_construct(&e);
+    hash = nrt_HashTable_construct(8, &e);
+    TEST_ASSERT(list);
+    TEST_ASSERT(hash);
+    TEST_ASSERT(nrt_List_pushBack(list, newData("a"), &e));
+    TEST_ASSERT(nrt_List_pushBack(list, newData("b"), &e));
+    TEST_ASSERT(nrt_HashTable_insert(hash, "one", newData("1"), &e));
+    nrt_Arena_setCurrent(NULL);
+
+    TEST_ASSERT(nrt_Arena_contains(arena, list));
+    TEST_ASSERT(nrt_Arena_contains(arena, list->first));
+    TEST_ASSERT(nrt_Arena_contains(arena, hash));
+    TEST_ASSERT(nrt_Arena_contains(arena, hash->buckets));
+    pair = nrt_HashTable_find(hash, "one");
+    TEST_ASSERT(pair);
+    TEST_ASSERT(nrt_Arena_contains(arena, pair));
+    TEST_ASSERT(nrt_Arena_contains(arena, pair->key));
+
+    /* later additions still come from the arena, but their heap data
+     * is freed with the containers */
+    TEST_ASSERT(nrt_List_pushBack(list, newData("c"), &e));
+    TEST_ASSERT(nrt_Arena_contains(arena, list->last));
+    TEST_ASSERT(!nrt_Arena_contains(arena, list->last->data));
+    TEST_ASSERT(nrt_HashTable_insert(hash, "two", newData("2"), &e));
+    pair = nrt_HashTable_find(hash, "two");
+    TEST_ASSERT(pair);
+    TEST_ASSERT(nrt_Arena_contains(arena, pair));
+    TEST_ASSERT(nrt_Arena_contains(arena, pair->key));
+
+    /* and either kind can be removed */
+    data = (char *) nrt_List_popFront(list);
+    TEST_ASSERT_EQ_STR("a", data);
+    NRT_FREE(data);
+    data = (char *) nrt_HashTable_remove(hash, "one");
+    TEST_ASSERT_EQ_STR("1", data);
+    NRT_FREE(data);
+    TEST_ASSERT_EQ_INT(2, (int) nrt_List_size(list));
+
+    nrt_List_destruct(&list);
+    nrt_HashTable_destruct(&hash);
+    TEST_ASSERT_NULL(list);
+    TEST_ASSERT_NULL(hash);
+    nrt_Arena_destruct(&arena);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testAllocate);
+    CHECK(testManyChunks);
+    CHECK(testCurrent);
+    CHECK(testContainers);
+    return 0;
+}
@@ -104,6 +104,67 @@ TEST_CASE(testWriteOutOfBounds)
     TEST_ASSERT(!success);
 }
 
+TEST_CASE(testReadAt)
+{
+    char buffer[TEST_BUF_SIZE];
+    char output[2];
+    nrt_Error error;
+    NRT_BOOL success;
+
+    memset(buffer, 0, 3);
+    memset(buffer + 3, 1, 5);
+    memset(buffer + 8, 2, 2);
+
+    nrt_IOInterface* reader = nrt_BufferAdapter_construct(
+        buffer, TEST_BUF_SIZE, 0, &error);
+    TEST_ASSERT(nrt_IOInterface_canReadAt(reader));
+
+    nrt_IOInterface_seek(reader, 1, NRT_SEEK_SET, &error);
+    success = nrt_IOInterface_readAt(reader, 8, output, sizeof(output), &error);
+    TEST_ASSERT(success);
+    TEST_ASSERT(output[0] == (char)2 && output[1] == (char)2);
+
+    /* The current position is left alone */
+    TEST_ASSERT(nrt_IOInterface_tell(reader, &error) == 1);
+
+    success = nrt_IOInterface_readAt(reader, 9, output, sizeof(output), &error);
+    TEST_ASSERT(!success);
+
+    nrt_IOInterface_destruct(&reader);
+}
+
+TEST_CASE(testReadAtFallback)
+{
+    char buffer[TEST_BUF_SIZE];
+    char output[2];
+    nrt_Error error;
+    NRT_BOOL success;
+    nrt_IIOInterface iface;
+    nrt_IIOInterface* savedIface;
+
+    memset(buffer, 0, 3);
+    memset(buffer + 3, 1, 5);
+    memset(buffer + 8, 2, 2);
+
+    nrt_IOInterface* reader = nrt_BufferAdapter_construct(
+        buffer, TEST_BUF_SIZE, 0, &error);
+
+    /* An interface without readAt seeks, then reads */
+    savedIface = reader->iface;
+    iface = *savedIface;
+    iface.readAt = NULL;
+    reader->iface = &iface;
+    TEST_ASSERT(!nrt_IOInterface_canReadAt(reader));
+
+    success = nrt_IOInterface_readAt(reader, 3, output, sizeof(output), &error);
+    TEST_ASSERT(success);
+    TEST_ASSERT(output[0] == (char)1 && output[1] == (char)1);
+    TEST_ASSERT(nrt_IOInterface_tell(reader, &error) == 5);
+
+    reader->iface = savedIface;
+    nrt_IOInterface_destruct(&reader);
+}
+
 int main(int argc, char **argv)
 {
     (void) argc;
@@ -112,5 +173,7 @@ int main(int argc, char **argv)
     CHECK(testReadPastEnd);
     CHECK(testReadOutOfBounds);
     CHECK(testWriteOutOfBounds);
+    CHECK(testReadAt);
+    CHECK(testReadAtFallback);
     return 0;
 }
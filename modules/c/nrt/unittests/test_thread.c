@@ -0,0 +1,83 @@
+/* =========================================================================
+ * This file is part of NITRO
+ * =========================================================================
+ *
+ * (C) Copyright 2004 - 2018, MDA Information Systems LLC
+ *
+ * NITRO is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with this program; if not, If not,
+ * see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <import/nrt.h>
+#include "Test.h"
+
+#define NUM_THREADS 4
+#define NUM_INCREMENTS 10000
+
+typedef struct _Counter
+{
+    nrt_Mutex mutex;
+    int count;
+} Counter;
+
+static void increment(NRT_DATA * data)
+{
+    Counter *counter = (Counter *) data;
+    int i;
+    for (i = 0; i < NUM_INCREMENTS; ++i)
+    {
+        nrt_Mutex_lock(&counter->mutex);
+        ++counter->count;
+        nrt_Mutex_unlock(&counter->mutex);
+    }
+}
+
+TEST_CASE(testJoin)
+{
+    nrt_Error e;
+    nrt_Thread *threads[NUM_THREADS];
+    Counter counter;
+    int i;
+
+    nrt_Mutex_init(&counter.mutex);
+    counter.count = 0;
+
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        threads[i] = nrt_Thread_construct(increment, &counter, &e);
+        TEST_ASSERT(threads[i]);
+    }
+    for (i = 0; i < NUM_THREADS; ++i)
+    {
+        TEST_ASSERT(nrt_Thread_join(threads[i], &e));
+        nrt_Thread_destruct(&threads[i]);
+        TEST_ASSERT_NULL(threads[i]);
+    }
+    TEST_ASSERT_EQ_INT(NUM_THREADS * NUM_INCREMENTS, counter.count);
+
+    nrt_Mutex_delete(&counter.mutex);
+}
+
+TEST_CASE(testNumCPUs)
+{
+    TEST_ASSERT(nrt_Thread_getNumCPUs() >= 1);
+}
+
+int main(int argc, char **argv)
+{
+    CHECK(testJoin);
+    CHECK(testNumCPUs);
+    return 0;
+}
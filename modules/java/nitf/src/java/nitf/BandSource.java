@@ -22,6 +22,7 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
 import java.util.Collections;
 import java.util.HashMap;
 import java.util.Map;
@@ -105,6 +106,56 @@ public abstract class BandSource extends DestructibleObject
      * @throws NITFException
      */
     public abstract void read(byte[] buf, int size) throws NITFException;
+
+    /**
+     * Reads size bytes from the BandSource into buf, starting at its current
+     * position, and advances the position by size. This is what the library
+     * calls when it pulls data from a user-extended BandSource.
+     * 
+     * The default goes through read(byte[], int); override it to fill the
+     * buffer directly and skip the intermediate array.
+     * 
+     * @param buf
+     *            The data buffer
+     * @param size
+     *            The number of bytes to read
+     * @throws NITFException
+     */
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        readArray(buf, size);
+    }
+
+    /**
+     * Reads straight from the underlying native source into a direct buffer,
+     * falling back to read(byte[], int) for heap buffers. Only meant for the
+     * built-in sources, whose data lives on the native side.
+     */
+    protected final void readNative(ByteBuffer buf, int size)
+            throws NITFException
+    {
+        if (!buf.isDirect())
+        {
+            readArray(buf, size);
+            return;
+        }
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        readDirect(buf, buf.position(), size);
+        buf.position(buf.position() + size);
+    }
+
+    private void readArray(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        byte[] tmp = new byte[size];
+        read(tmp, size);
+        buf.put(tmp, 0, size);
+    }
+
+    private native void readDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
     
     public abstract long getSize() throws NITFException;
     
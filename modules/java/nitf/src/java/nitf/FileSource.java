@@ -22,6 +22,8 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
+
 /**
  * <code>FileSource</code>
  * 
@@ -93,6 +95,17 @@ public final class FileSource extends BandSource
      * @see nitf.BandSource#read(byte[], int)
      */
     public native void read(byte[] buf, int size) throws NITFException;
+
+    /*
+     * (non-Javadoc)
+     * 
+     * @see nitf.BandSource#read(java.nio.ByteBuffer, int)
+     */
+    @Override
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        readNative(buf, size);
+    }
     
     @Override
     public native long getSize() throws NITFException;
@@ -21,6 +21,8 @@
  */
 package nitf;
 
+import java.nio.ByteBuffer;
+
 public abstract class IOInterface extends DestructibleObject
 {
 
@@ -90,6 +92,29 @@ public abstract class IOInterface extends DestructibleObject
         return buf;
     }
 
+    /**
+     * Reads size bytes into buf, starting at its current position, and
+     * advances the position by size. This is what the library calls when it
+     * reads from a user-extended IOInterface.
+     * 
+     * The default goes through read(byte[], int); override it to fill the
+     * buffer directly and skip the intermediate array.
+     * 
+     * @param buf
+     *            the buffer to store the data
+     * @param size
+     *            the number of bytes to read
+     * @throws NITFException
+     */
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        byte[] tmp = new byte[size];
+        read(tmp, size);
+        buf.put(tmp, 0, size);
+    }
+
     /**
      * Writes bytes to the IO handle at the current position
      * 
@@ -112,6 +137,29 @@ public abstract class IOInterface extends DestructibleObject
         if (buf != null && buf.length > 0)
             write(buf, buf.length);
     }
+
+    /**
+     * Writes size bytes from buf, starting at its current position, and
+     * advances the position by size. This is what the library calls when it
+     * writes to a user-extended IOInterface.
+     * 
+     * The default goes through write(byte[], int); override it to take the
+     * data straight from the buffer.
+     * 
+     * @param buf
+     *            the buffer containing the data
+     * @param size
+     *            the number of bytes to write
+     * @throws NITFException
+     */
+    public void write(ByteBuffer buf, int size) throws NITFException
+    {
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to write past buffer boundary.");
+        byte[] tmp = new byte[size];
+        buf.get(tmp, 0, size);
+        write(tmp, size);
+    }
     
     public abstract boolean canSeek();
 
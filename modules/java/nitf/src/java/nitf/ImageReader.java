@@ -22,6 +22,8 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
+
 /**
  * Class that has the functionality of reading an image
  */
@@ -64,6 +66,34 @@ public final class ImageReader extends DestructibleObject
     public native boolean read(SubWindow subWindow, byte[][] userBuf)
             throws NITFException;
 
+    /**
+     * Reads the data specified by the SubWindow straight into one direct
+     * ByteBuffer per band. Each band is written starting at its buffer's
+     * position, which is left unchanged.
+     * 
+     * @param subWindow
+     *            the window that defines data about the impending read
+     * @param userBuf
+     *            direct buffers to store the data
+     * @return true if the the data was padded
+     * @throws NITFException
+     */
+    public boolean read(SubWindow subWindow, ByteBuffer[] userBuf)
+            throws NITFException
+    {
+        int[] offsets = new int[userBuf.length];
+        for (int i = 0; i < userBuf.length; ++i)
+        {
+            if (!userBuf[i].isDirect())
+                throw new NITFException("Band buffers must be direct");
+            offsets[i] = userBuf[i].position();
+        }
+        return readDirect(subWindow, userBuf, offsets);
+    }
+
+    private native boolean readDirect(SubWindow subWindow,
+            ByteBuffer[] userBuf, int[] offsets) throws NITFException;
+
     @Override
     protected MemoryDestructor getDestructor()
     {
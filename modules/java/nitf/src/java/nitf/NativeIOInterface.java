@@ -21,6 +21,8 @@
  */
 package nitf;
 
+import java.nio.ByteBuffer;
+
 public class NativeIOInterface extends IOInterface
 {
     protected NativeIOInterface()
@@ -36,6 +38,48 @@ public class NativeIOInterface extends IOInterface
 
     public native void write(final byte[] buf, int size) throws NITFException;
 
+    /**
+     * Direct buffers are read into in place; heap buffers go through
+     * read(byte[], int)
+     */
+    @Override
+    public void read(ByteBuffer buf, int size) throws NITFException
+    {
+        if (!buf.isDirect())
+        {
+            super.read(buf, size);
+            return;
+        }
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to read past buffer boundary.");
+        readDirect(buf, buf.position(), size);
+        buf.position(buf.position() + size);
+    }
+
+    /**
+     * Direct buffers are written from in place; heap buffers go through
+     * write(byte[], int)
+     */
+    @Override
+    public void write(ByteBuffer buf, int size) throws NITFException
+    {
+        if (!buf.isDirect())
+        {
+            super.write(buf, size);
+            return;
+        }
+        if (size > buf.remaining())
+            throw new NITFException("Attempting to write past buffer boundary.");
+        writeDirect(buf, buf.position(), size);
+        buf.position(buf.position() + size);
+    }
+
+    private native void readDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
+
+    private native void writeDirect(ByteBuffer buf, int offset, int size)
+            throws NITFException;
+
     public native boolean canSeek();
     
     public native long seek(long offset, int whence) throws NITFException;
@@ -17,6 +17,14 @@ extern "C" {
 JNIEXPORT void JNICALL Java_nitf_BandSource_construct
   (JNIEnv *, jobject);
 
+/*
+ * Class:     nitf_BandSource
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_BandSource_readDirect
+  (JNIEnv *, jobject, jobject, jint, jint);
+
 #ifdef __cplusplus
 }
 #endif
@@ -33,6 +33,14 @@ JNIEXPORT jobject JNICALL Java_nitf_ImageReader_getBlockingInfo
 JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_read
   (JNIEnv *, jobject, jobject, jobjectArray);
 
+/*
+ * Class:     nitf_ImageReader
+ * Method:    readDirect
+ * Signature: (Lnitf/SubWindow;[Ljava/nio/ByteBuffer;[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_readDirect
+  (JNIEnv *, jobject, jobject, jobjectArray, jintArray);
+
 #ifdef __cplusplus
 }
 #endif
@@ -36,6 +36,9 @@ typedef struct _BandSourceImpl
 
 /*
  *  Private read implementation for file source.
+ *
+ *  The native buffer is handed to Java wrapped in a direct ByteBuffer, so
+ *  a source that overrides read(ByteBuffer, int) fills it in place.
  */
 NITFPRIV(NITF_BOOL) BandSource_read
     (NITF_DATA * data, char *buf, nitf_Off size, nitf_Error * error)
@@ -43,11 +46,11 @@ NITFPRIV(NITF_BOOL) BandSource_read
     jclass bandSourceClass = NULL;
     jmethodID methodID = NULL;
     BandSourceImpl *impl = NULL;
-    jbyteArray byteArray = NULL;
-    jbyte* temp;
+    jobject byteBuffer = NULL;
     JNIEnv *env = NULL;
     JavaVM *vm = NULL;
     int detach;
+    NITF_BOOL status = NITF_SUCCESS;
 
     /* cast it to the structure we know about */
     impl = (BandSourceImpl *) data;
@@ -57,37 +60,38 @@ NITFPRIV(NITF_BOOL) BandSource_read
     bandSourceClass = (*env)->GetObjectClass(env, impl->self);
     methodID =
         (*env)->GetMethodID(env, bandSourceClass, "read",
-                                  "([BI)V");
+                                  "(Ljava/nio/ByteBuffer;I)V");
 
-    /* create new array */
-    byteArray = (*env)->NewByteArray(env, (jsize) size);
+    /* wrap the caller's buffer */
+    byteBuffer = (*env)->NewDirectByteBuffer(env, buf, (jlong) size);
     
-    if (!byteArray)
+    if (!byteBuffer)
     {
         if (detach)
             (*vm)->DetachCurrentThread(vm);
-    	return NITF_FAILURE;
+        nitf_Error_init(error, "Unable to wrap buffer for BandSource read",
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
     }
 
     /* read the data */
     (*env)->CallVoidMethod(env, impl->self, methodID,
-                                 byteArray, size);
-
-    /* copy to the char buffer */
-    temp = (*env)->GetByteArrayElements(env, byteArray, 0);
-    if (!temp)
+                                 byteBuffer, (jint) size);
+    if ((*env)->ExceptionCheck(env))
     {
-        return NITF_FAILURE;
+        (*env)->ExceptionDescribe(env);
+        (*env)->ExceptionClear(env);
+        nitf_Error_init(error, "BandSource read threw an exception",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        status = NITF_FAILURE;
     }
-    memcpy(buf, (char*)temp, size);
     
     /* delete the local refs */ 
-    (*env)->ReleaseByteArrayElements(env, byteArray, temp, 0);
-    (*env)->DeleteLocalRef(env, byteArray);
+    (*env)->DeleteLocalRef(env, byteBuffer);
     
     if (detach)
         (*vm)->DetachCurrentThread(vm);
-    return NITF_SUCCESS;
+    return status;
 }
 
 
@@ -218,6 +222,32 @@ JNIEXPORT void JNICALL Java_nitf_BandSource_construct
         methodID, self);
 }
 
+/*
+ * Class:     nitf_BandSource
+ * Method:    readDirect
+ * Signature: (Ljava/nio/ByteBuffer;II)V
+ */
+JNIEXPORT void JNICALL Java_nitf_BandSource_readDirect
+    (JNIEnv * env, jobject self, jobject buf, jint offset, jint size)
+{
+    nitf_BandSource *source = _GetObj(env, self);
+    char *byteBuf;
+    nitf_Error error;
+
+    byteBuf = (char *) (*env)->GetDirectBufferAddress(env, buf);
+    if (!byteBuf)
+    {
+        _ThrowNITFException(env, "ERROR getting address of direct buffer");
+        return;
+    }
+
+    if (!source->iface->read(source->data, byteBuf + offset, size, &error))
+    {
+        _ThrowNITFException(env, error.message);
+        return;
+    }
+}
+
 JNIEXPORT jboolean JNICALL Java_nitf_BandSource_00024Destructor_destructMemory
     (JNIEnv * env, jobject self, jlong address)
 {
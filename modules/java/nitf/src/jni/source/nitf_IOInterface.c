@@ -48,24 +48,42 @@ NITFPRIV(NITF_BOOL) IOInterfaceImpl_read(NITF_DATA* data,
     JNIEnv *env = NULL;
     JavaVM *vm = NULL;
     int detach;
-    jbyteArray byteArray;
+    jobject byteBuffer;
+    NITF_BOOL status = NITF_SUCCESS;
 
     /* cast it to the structure we know about */
     impl = (IOInterfaceImpl *) data;
     detach = _GetJNIEnv(&vm, &env);
 
-    byteArray = (*env)->NewByteArray(env, size);
-    (*env)->SetByteArrayRegion(env, byteArray, 0, size, buf);
+    /* Let Java fill the caller's buffer in place */
+    byteBuffer = (*env)->NewDirectByteBuffer(env, buf, (jlong)size);
+    if (!byteBuffer)
+    {
+        if (detach)
+            (*vm)->DetachCurrentThread(vm);
+        nitf_Error_init(error, "Unable to wrap buffer for IOInterface read",
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
 
     ioClass = (*env)->GetObjectClass(env, impl->self);
-    methodID = (*env)->GetMethodID(env, ioClass, "read", "([BI)V");
-    (*env)->CallVoidMethod(env, impl->self, methodID, byteArray, (jint)size);
+    methodID = (*env)->GetMethodID(env, ioClass, "read",
+                                   "(Ljava/nio/ByteBuffer;I)V");
+    (*env)->CallVoidMethod(env, impl->self, methodID, byteBuffer, (jint)size);
+    if ((*env)->ExceptionCheck(env))
+    {
+        (*env)->ExceptionDescribe(env);
+        (*env)->ExceptionClear(env);
+        nitf_Error_init(error, "IOInterface read threw an exception",
+                        NITF_CTXT, NITF_ERR_READING_FROM_FILE);
+        status = NITF_FAILURE;
+    }
 
-    (*env)->ReleaseByteArrayElements(env, byteArray, buf, 0);
+    (*env)->DeleteLocalRef(env, byteBuffer);
 
     if (detach)
         (*vm)->DetachCurrentThread(vm);
-    return NITF_SUCCESS;
+    return status;
 }
 
 NITFPRIV(NITF_BOOL) IOInterfaceImpl_write(NITF_DATA* data,
@@ -79,24 +97,42 @@ NITFPRIV(NITF_BOOL) IOInterfaceImpl_write(NITF_DATA* data,
     JNIEnv *env = NULL;
     JavaVM *vm = NULL;
     int detach;
-    jbyteArray byteArray;
+    jobject byteBuffer;
+    NITF_BOOL status = NITF_SUCCESS;
 
     /* cast it to the structure we know about */
     impl = (IOInterfaceImpl *) data;
     detach = _GetJNIEnv(&vm, &env);
 
-    byteArray = (*env)->NewByteArray(env, size);
-    (*env)->SetByteArrayRegion(env, byteArray, 0, size, buf);
+    /* Java only reads from this, so handing it the const buffer is safe */
+    byteBuffer = (*env)->NewDirectByteBuffer(env, (void*)buf, (jlong)size);
+    if (!byteBuffer)
+    {
+        if (detach)
+            (*vm)->DetachCurrentThread(vm);
+        nitf_Error_init(error, "Unable to wrap buffer for IOInterface write",
+                        NITF_CTXT, NITF_ERR_MEMORY);
+        return NITF_FAILURE;
+    }
 
     ioClass = (*env)->GetObjectClass(env, impl->self);
-    methodID = (*env)->GetMethodID(env, ioClass, "write", "([BI)V");
-    (*env)->CallVoidMethod(env, impl->self, methodID, byteArray, (jint)size);
+    methodID = (*env)->GetMethodID(env, ioClass, "write",
+                                   "(Ljava/nio/ByteBuffer;I)V");
+    (*env)->CallVoidMethod(env, impl->self, methodID, byteBuffer, (jint)size);
+    if ((*env)->ExceptionCheck(env))
+    {
+        (*env)->ExceptionDescribe(env);
+        (*env)->ExceptionClear(env);
+        nitf_Error_init(error, "IOInterface write threw an exception",
+                        NITF_CTXT, NITF_ERR_WRITING_TO_FILE);
+        status = NITF_FAILURE;
+    }
 
-    /*(*env)->ReleaseByteArrayElements(env, byteArray, buf, JNI_COMMIT);*/
+    (*env)->DeleteLocalRef(env, byteBuffer);
 
     if (detach)
         (*vm)->DetachCurrentThread(vm);
-    return NITF_SUCCESS;
+    return status;
 }
 
 NITFPRIV(NITF_BOOL) IOInterfaceImpl_canSeek(NITF_DATA* data, nitf_Error* error)
@@ -143,3 +143,99 @@ JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_read(JNIEnv *env,
     return padded ? JNI_TRUE : JNI_FALSE;
 }
 
+
+/*
+ * Class:     nitf_ImageReader
+ * Method:    readDirect
+ * Signature: (Lnitf/SubWindow;[Ljava/nio/ByteBuffer;[I)Z
+ */
+JNIEXPORT jboolean JNICALL Java_nitf_ImageReader_readDirect(JNIEnv *env,
+                                                            jobject self,
+                                                            jobject subWindow,
+                                                            jobjectArray userBuf,
+                                                            jintArray offsets)
+{
+    nitf_ImageReader *imReader = _GetObj(env, self);
+    jclass subWindowClass = (*env)->FindClass(env, "nitf/SubWindow");
+    nitf_SubWindow *nitfSubWindow;
+    nitf_Error error;
+    nitf_Uint8 **data;
+    jobject byteBuffer;
+    jint *bufOffsets;
+    jlong capacity;
+    jlong bandSize;
+    jint padded;
+    jsize bands;
+    jint i;
+    int rowSkip, colSkip;
+
+    jmethodID methodID = (*env)->GetMethodID(env, subWindowClass, "getAddress",
+                                             "()J");
+    nitfSubWindow = (nitf_SubWindow *) (*env)->CallLongMethod(env, subWindow,
+                                                              methodID);
+
+    bands = (*env)->GetArrayLength(env, userBuf);
+    if (bands < (jsize) nitfSubWindow->numBands)
+    {
+        _ThrowNITFException(env, "Not enough band buffers for the window");
+        return JNI_FALSE;
+    }
+
+    rowSkip = nitfSubWindow->downsampler ?
+        nitfSubWindow->downsampler->rowSkip : 1;
+    colSkip = nitfSubWindow->downsampler ?
+        nitfSubWindow->downsampler->colSkip : 1;
+    bandSize = (jlong) (nitfSubWindow->numRows / rowSkip) *
+        (nitfSubWindow->numCols / colSkip) *
+        nitf_ImageIO_pixelSize(imReader->imageDeblocker);
+
+    data = (nitf_Uint8 **) malloc(bands * sizeof(nitf_Uint8*));
+    if (!data)
+    {
+        _ThrowNITFException(env, "Out of memory!");
+        return JNI_FALSE;
+    }
+
+    bufOffsets = (*env)->GetIntArrayElements(env, offsets, 0);
+    if (!bufOffsets)
+    {
+        free(data);
+        _ThrowNITFException(env, "Out of memory!");
+        return JNI_FALSE;
+    }
+
+    /* The pixels go straight into the buffers' native memory, so nothing
+       is pinned or copied on the Java heap */
+    for (i = 0; i < bands; ++i)
+    {
+        byteBuffer = (*env)->GetObjectArrayElement(env, userBuf, i);
+        data[i] = (nitf_Uint8 *) (*env)->GetDirectBufferAddress(env,
+                                                                 byteBuffer);
+        capacity = (*env)->GetDirectBufferCapacity(env, byteBuffer);
+        (*env)->DeleteLocalRef(env, byteBuffer);
+        if (!data[i] || capacity - bufOffsets[i] < bandSize)
+        {
+            const char *message = data[i] ?
+                "Band buffer is too small for the window" :
+                "Band buffers must be direct";
+            (*env)->ReleaseIntArrayElements(env, offsets, bufOffsets,
+                                            JNI_ABORT);
+            free(data);
+            _ThrowNITFException(env, message);
+            return JNI_FALSE;
+        }
+        data[i] += bufOffsets[i];
+    }
+    (*env)->ReleaseIntArrayElements(env, offsets, bufOffsets, JNI_ABORT);
+
+    if (!nitf_ImageReader_read(imReader, nitfSubWindow, data,
+                               &padded, &error))
+    {
+        free(data);
+        _ThrowNITFException(env, error.message);
+        return JNI_FALSE;
+    }
+
+    free(data);
+    return padded ? JNI_TRUE : JNI_FALSE;
+}
@@ -74,6 +74,48 @@ JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_write
     (*env)->ReleaseByteArrayElements(env, buf, array, 0);
 }
 
+JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_readDirect
+(JNIEnv *env, jobject self, jobject buf, jint offset, jint size)
+{
+    nitf_Error error;
+    char *address = NULL;
+    nitf_IOInterface *interface = _GetObj(env, self);
+
+    address = (char*)(*env)->GetDirectBufferAddress(env, buf);
+    if (!address)
+    {
+        _ThrowNITFException(env, "ERROR getting address of direct buffer");
+        return;
+    }
+
+    if (!(interface->iface->read(interface->data, address + offset, size,
+                                 &error)))
+    {
+        _ThrowNITFException(env, error.message);
+    }
+}
+
+JNIEXPORT void JNICALL Java_nitf_NativeIOInterface_writeDirect
+(JNIEnv *env, jobject self, jobject buf, jint offset, jint size)
+{
+    nitf_Error error;
+    char *address = NULL;
+    nitf_IOInterface *interface = _GetObj(env, self);
+
+    address = (char*)(*env)->GetDirectBufferAddress(env, buf);
+    if (!address)
+    {
+        _ThrowNITFException(env, "ERROR getting address of direct buffer");
+        return;
+    }
+
+    if (!(interface->iface->write(interface->data, address + offset, size,
+                                  &error)))
+    {
+        _ThrowNITFException(env, error.message);
+    }
+}
+
 JNIEXPORT jlong JNICALL Java_nitf_NativeIOInterface_seek
 (JNIEnv *env, jobject self, jlong offset, jint whence)
 {
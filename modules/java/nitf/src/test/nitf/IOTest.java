@@ -1,5 +1,7 @@
 package nitf;
 
+import java.nio.ByteBuffer;
+
 import junit.framework.TestCase;
 
 import org.apache.commons.lang.exception.ExceptionUtils;
@@ -29,4 +31,35 @@ public class IOTest extends TestCase
         }
     }
 
+    public void testMemoryIOByteBuffer()
+    {
+        try
+        {
+            IOInterface memIO = new MemoryIO(1024);
+            String val = "NITF";
+            ByteBuffer out = ByteBuffer.allocateDirect(val.length());
+            out.put(val.getBytes());
+            out.flip();
+            memIO.write(out, out.remaining());
+            assertEquals(0, out.remaining());
+            assertEquals(val.length(), memIO.tell());
+
+            memIO.seek(0, IOInterface.SEEK_SET);
+            ByteBuffer in = ByteBuffer.allocateDirect(val.length() + 2);
+            in.position(2);
+            memIO.read(in, val.length());
+            assertEquals(val.length() + 2, in.position());
+
+            byte[] buf = new byte[val.length()];
+            in.position(2);
+            in.get(buf);
+            assertEquals(val, new String(buf));
+            memIO.close();
+        }
+        catch (NITFException e)
+        {
+            fail(ExceptionUtils.getStackTrace(e));
+        }
+    }
+
 }
@@ -22,6 +22,8 @@
 
 package nitf;
 
+import java.nio.ByteBuffer;
+
 import junit.framework.TestCase;
 
 import org.apache.commons.lang.exception.ExceptionUtils;
@@ -77,4 +79,38 @@ public class ImageSourceTest extends TestCase
             fail(ExceptionUtils.getStackTrace(e));
         }
     }
+
+    public void testImageSourceDirectBuffer()
+    {
+        try
+        {
+            ImageSource imageSource = new ImageSource();
+            int size = TEST_BUF.length / TEST_BUF_NUM_BANDS;
+
+            for (int i = 0; i < TEST_BUF_NUM_BANDS; ++i)
+            {
+                MemorySource source = new MemorySource(TEST_BUF, size, i, 1,
+                        TEST_BUF_NUM_BANDS - 1);
+                assertTrue(imageSource.addBand(source));
+            }
+
+            // the built-in sources read straight into direct buffers
+            BandSource[] bandSources = imageSource.getBandSources();
+            for (int i = 0; i < bandSources.length; i++)
+            {
+                ByteBuffer buf = ByteBuffer.allocateDirect(size);
+                bandSources[i].read(buf, size);
+                assertEquals(size, buf.position());
+
+                byte[] bytes = new byte[size];
+                buf.flip();
+                buf.get(bytes);
+                assertEquals(TEST_BUF_BANDS[i], new String(bytes));
+            }
+        }
+        catch (NITFException e)
+        {
+            fail(ExceptionUtils.getStackTrace(e));
+        }
+    }
 }
\ No newline at end of file
@@ -52,8 +52,9 @@ def copyImage(reader, image, record):
     window.bandList = list(range(image.subheader.getBandCount()))
     bandData = reader.read(window)
     for ii in window.bandList:
-        imageSource.addBand(nitf.MemoryBandSource(bandData, bandData.shape[1],
-                                                  ii, 1, bandData.shape[0] - 1))
+        imageSource.addBand(nitf.MemoryBandSource(bandData[ii],
+                                                  bandData[ii].size, 0,
+                                                  bandData.itemsize, 0))
     print(segment.subheader.fieldMap['pixelvaluetype'])
     return imageSource
 
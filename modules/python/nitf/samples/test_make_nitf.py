@@ -173,7 +173,7 @@ class TestCreator(unittest.TestCase):
             nbpp = subheader['numBitsPerPixel'].intValue()
             bandData = imageReader.read(window)
             readData = []
-            for item in bandData[0]:
+            for item in bandData[0].flat:
                 readData.append(item)
             assert (readData == alldata).all()
 
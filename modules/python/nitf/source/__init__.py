@@ -216,19 +216,41 @@ class ImageReader:
 
     This is created by calling Reader.newImageReader()
     """
-    def __init__(self, ref, nbpp):
+    def __init__(self, ref, nbpp, pvtype='INT'):
         self.ref = ref
         self.error = Error()
         self.nbpp = nbpp
+        self.pvtype = pvtype
 
     def __del__(self):
         logging.debug('destruct ImageReader')
         if self.ref: nitropy.nitf_ImageReader_destruct(self.ref)
 
-    def read(self, window, downsampler=None):
+    def dtype(self):
+        """
+        Returns the numpy dtype that read() decodes pixels into
+        """
+        nbytes = (self.nbpp - 1) // 8 + 1
+        if self.pvtype == 'B':
+            return numpy.dtype(numpy.uint8)
+        if self.pvtype == 'SI':
+            return numpy.dtype('i%d' % nbytes)
+        if self.pvtype == 'R':
+            return numpy.dtype('f%d' % nbytes)
+        if self.pvtype == 'C':
+            return numpy.dtype('c%d' % nbytes)
+        return numpy.dtype('u%d' % nbytes)
+
+    def read(self, window, downsampler=None, out=None):
+        """
+        Reads the window into a (bands, rows, cols) array of dtype().  Pass
+        a C-contiguous array of that shape and type as out to reuse it.
+        The GIL is released while the pixels are read.
+        """
         win = nitropy.py_SubWindow_construct(window.startRow, window.startCol, window.numRows,
             window.numCols, window.bandList, downsampler, self.error)
-        dataBuf = nitropy.py_ImageReader_read(self.ref, win, self.nbpp, self.error)
+        dataBuf = nitropy.py_ImageReader_read(self.ref, win, self.dtype().num,
+            out, self.error)
         if self.error.level:
             raise Exception(self.error.message)
         return dataBuf
@@ -352,10 +374,12 @@ class Reader:
         return self.record
 
     def newImageReader(self, num, options = None):
-        nbpp = int(self.record.getImages()[num]['numBitsPerPixel'])
+        image = self.record.getImages()[num]
+        nbpp = int(image['numBitsPerPixel'])
+        pvtype = str(image['pixelValueType']).strip()
         reader = nitropy.nitf_Reader_newImageReader(self.ref, num, options, self.error)
         if not reader: raise Exception('Unable to get new ImageReader')
-        return ImageReader(reader, nbpp)
+        return ImageReader(reader, nbpp, pvtype)
 
     def newTextReader(self, num):
         reader = nitropy.nitf_Reader_newTextReader(self.ref, num, self.error)
@@ -3297,8 +3297,8 @@ def py_SubWindow_construct(startRow, startCol, numRows, numCols, bandList, downS
     return _nitropy.py_SubWindow_construct(startRow, startCol, numRows, numCols, bandList, downSampler, error)
 py_SubWindow_construct = _nitropy.py_SubWindow_construct
 
-def py_ImageReader_read(reader, window, nbpp, error):
-    return _nitropy.py_ImageReader_read(reader, window, nbpp, error)
+def py_ImageReader_read(reader, window, typeNum, out, error):
+    return _nitropy.py_ImageReader_read(reader, window, typeNum, out, error)
 py_ImageReader_read = _nitropy.py_ImageReader_read
 
 def py_Pair_getFieldData(pair):
@@ -4174,24 +4174,32 @@ SWIG_AsVal_long_SS_long (PyObject *obj, long long *val)
 
     /**
      * Helper function for ImageReader_read ... necessary
+     *
+     * Reads the window into a (bands, rows, cols) array of numpy type
+     * typeNum.  If out is an array it is filled in place, otherwise a new
+     * one is allocated.
      */
-    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int typeNum, PyObject* out, nitf_Error* error)
     {
-        /* TODO somehow get the NUMBITSPERPIXEL in the future */
         nitf_Uint8 **buf = NULL;
         nitf_Uint8 *pyArrayBuffer = NULL;
-        PyObject* result = Py_None;
+        PyObject* result = NULL;
+        NITF_BOOL success;
         int padded, rowSkip, colSkip;
-        nitf_Uint64 subimageSize;
+        nitf_Uint32 pixelSize;
+        nitf_Uint64 bandSize;
         nitf_Uint32 i;
-        types::RowCol<size_t> dims;
+        npy_intp dims[3];
 
         rowSkip = window->downsampler ? window->downsampler->rowSkip : 1;
         colSkip = window->downsampler ? window->downsampler->colSkip : 1;
-        subimageSize = static_cast<nitf_Uint64>(window->numRows/rowSkip) *
-                (window->numCols/colSkip) *
-                nitf_ImageIO_pixelSize(reader->imageDeblocker);
-        if (subimageSize > std::numeric_limits<size_t>::max())
+        pixelSize = nitf_ImageIO_pixelSize(reader->imageDeblocker);
+
+        dims[0] = window->numBands;
+        dims[1] = window->numRows / rowSkip;
+        dims[2] = window->numCols / colSkip;
+        bandSize = static_cast<nitf_Uint64>(dims[1]) * dims[2] * pixelSize;
+        if (bandSize * window->numBands > std::numeric_limits<size_t>::max())
         {
             nitf_Error_print(error, stderr,
                              "Image is too large for this system\n");
@@ -4199,62 +4207,87 @@ SWIG_AsVal_long_SS_long (PyObject *obj, long long *val)
             goto CATCH_ERROR;
         }
 
-        dims.row = window->numBands;
-        dims.col = subimageSize;
-
-        numpyutils::createOrVerify(result, NPY_UINT8, dims);
-
-        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * window->numBands);
-        if (!buf)
+        if (out && out != Py_None)
         {
-            PyErr_NoMemory();
-            goto CATCH_ERROR;
-        }
+            PyArrayObject* outArray;
 
-        memset(buf, 0, sizeof(nitf_Uint8*) * window->numBands);
-
-        for (i = 0; i < window->numBands; ++i)
-        {
-            buf[i] = (nitf_Uint8*) NITF_MALLOC(sizeof(nitf_Uint8) * subimageSize);
-            if (!buf[i])
+            if (!PyArray_Check(out))
+            {
+                PyErr_SetString(PyExc_TypeError, "out must be a numpy array");
+                goto CATCH_ERROR;
+            }
+            outArray = reinterpret_cast<PyArrayObject*>(out);
+            if (PyArray_TYPE(outArray) != typeNum ||
+                PyArray_NDIM(outArray) != 3 ||
+                PyArray_DIM(outArray, 0) != dims[0] ||
+                PyArray_DIM(outArray, 1) != dims[1] ||
+                PyArray_DIM(outArray, 2) != dims[2])
+            {
+                PyErr_SetString(PyExc_ValueError,
+                                "out does not match the window's type and "
+                                "(bands, rows, cols) shape");
+                goto CATCH_ERROR;
+            }
+            if (!PyArray_ISCARRAY(outArray))
             {
-                PyErr_NoMemory();
+                PyErr_SetString(PyExc_ValueError,
+                                "out must be C-contiguous, aligned and writeable");
                 goto CATCH_ERROR;
             }
+            Py_INCREF(out);
+            result = out;
+        }
+        else
+        {
+            result = PyArray_SimpleNew(3, dims, typeNum);
+            if (!result)
+                goto CATCH_ERROR;
         }
 
-        if (!nitf_ImageReader_read(reader, window,
-               buf, &padded, error))
+        /* The element type comes from the caller (it knows PVTYPE), but it
+           has to agree with what the deblocker is going to write */
+        if (static_cast<nitf_Uint32>(PyArray_ITEMSIZE(
+                reinterpret_cast<PyArrayObject*>(result))) != pixelSize)
         {
-            nitf_Error_print(error, stderr, "Read failed");
-            PyErr_SetString(PyExc_RuntimeError, "");
+            PyErr_Format(PyExc_ValueError,
+                         "Array element size %d does not match pixel size %u",
+                         (int) PyArray_ITEMSIZE(
+                             reinterpret_cast<PyArrayObject*>(result)),
+                         pixelSize);
             goto CATCH_ERROR;
         }
 
-        // Copy to output numpy array
-        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
-        for (i = 0; i < window->numBands; ++i)
+        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * window->numBands);
+        if (!buf)
         {
-            memcpy(pyArrayBuffer + i * subimageSize,
-                   buf[i], sizeof(nitf_Uint8) * subimageSize);
+            PyErr_NoMemory();
+            goto CATCH_ERROR;
         }
 
+        /* Each band is a contiguous plane of the array, so let the reader
+           decode straight into it */
+        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
         for (i = 0; i < window->numBands; ++i)
+            buf[i] = pyArrayBuffer + i * bandSize;
+
+        /* The read only touches the NITRO objects and the array's memory,
+           which we hold a reference to, so other threads can run */
+        Py_BEGIN_ALLOW_THREADS
+        success = nitf_ImageReader_read(reader, window, buf, &padded, error);
+        Py_END_ALLOW_THREADS
+
+        if (!success)
         {
-            NITF_FREE(buf[i]);
+            nitf_Error_print(error, stderr, "Read failed");
+            PyErr_SetString(PyExc_RuntimeError, "");
+            goto CATCH_ERROR;
         }
+
         NITF_FREE(buf);
         return result;
 
       CATCH_ERROR:
-        if (buf)
-        {
-            for (i = 0; i < window->numBands; ++i)
-            {
-                NITF_FREE(buf[i]);
-            }
-            NITF_FREE(buf);
-        }
+        if (buf) NITF_FREE(buf);
         if (result) Py_CLEAR(result);
         return NULL;
     }
@@ -32083,22 +32116,24 @@ SWIGINTERN PyObject *_wrap_py_ImageReader_read(PyObject *SWIGUNUSEDPARM(self), P
   nitf_ImageReader *arg1 = (nitf_ImageReader *) 0 ;
   nitf_SubWindow *arg2 = (nitf_SubWindow *) 0 ;
   int arg3 ;
-  nitf_Error *arg4 = (nitf_Error *) 0 ;
+  PyObject *arg4 = (PyObject *) 0 ;
+  nitf_Error *arg5 = (nitf_Error *) 0 ;
   void *argp1 = 0 ;
   int res1 = 0 ;
   void *argp2 = 0 ;
   int res2 = 0 ;
   int val3 ;
   int ecode3 = 0 ;
-  void *argp4 = 0 ;
-  int res4 = 0 ;
+  void *argp5 = 0 ;
+  int res5 = 0 ;
   PyObject * obj0 = 0 ;
   PyObject * obj1 = 0 ;
   PyObject * obj2 = 0 ;
   PyObject * obj3 = 0 ;
+  PyObject * obj4 = 0 ;
   PyObject *result = 0 ;
   
-  if (!PyArg_ParseTuple(args,(char *)"OOOO:py_ImageReader_read",&obj0,&obj1,&obj2,&obj3)) SWIG_fail;
+  if (!PyArg_ParseTuple(args,(char *)"OOOOO:py_ImageReader_read",&obj0,&obj1,&obj2,&obj3,&obj4)) SWIG_fail;
   res1 = SWIG_ConvertPtr(obj0, &argp1,SWIGTYPE_p__nitf_ImageReader, 0 |  0 );
   if (!SWIG_IsOK(res1)) {
     SWIG_exception_fail(SWIG_ArgError(res1), "in method '" "py_ImageReader_read" "', argument " "1"" of type '" "nitf_ImageReader *""'"); 
@@ -32114,12 +32149,13 @@ SWIGINTERN PyObject *_wrap_py_ImageReader_read(PyObject *SWIGUNUSEDPARM(self), P
     SWIG_exception_fail(SWIG_ArgError(ecode3), "in method '" "py_ImageReader_read" "', argument " "3"" of type '" "int""'");
   } 
   arg3 = static_cast< int >(val3);
-  res4 = SWIG_ConvertPtr(obj3, &argp4,SWIGTYPE_p__NRT_Error, 0 |  0 );
-  if (!SWIG_IsOK(res4)) {
-    SWIG_exception_fail(SWIG_ArgError(res4), "in method '" "py_ImageReader_read" "', argument " "4"" of type '" "nitf_Error *""'"); 
+  arg4 = obj3;
+  res5 = SWIG_ConvertPtr(obj4, &argp5,SWIGTYPE_p__NRT_Error, 0 |  0 );
+  if (!SWIG_IsOK(res5)) {
+    SWIG_exception_fail(SWIG_ArgError(res5), "in method '" "py_ImageReader_read" "', argument " "5"" of type '" "nitf_Error *""'"); 
   }
-  arg4 = reinterpret_cast< nitf_Error * >(argp4);
-  result = (PyObject *)py_ImageReader_read(arg1,arg2,arg3,arg4);
+  arg5 = reinterpret_cast< nitf_Error * >(argp5);
+  result = (PyObject *)py_ImageReader_read(arg1,arg2,arg3,arg4,arg5);
   resultobj = result;
   return resultobj;
 fail:
@@ -34612,6 +34648,10 @@ SWIG_init(void) {
   
   SWIG_InstallConstants(d,swig_const_table);
   
+  
+  /* The numpy C API table is per translation unit */
+  import_array();
+  
   SWIG_Python_SetConstant(d, "NRT_FILE",SWIG_FromCharPtr("/data1/u/jmeans/nitro/modules/c/nrt/include/nrt/Defines.h"));
   SWIG_Python_SetConstant(d, "NRT_LINE",SWIG_From_int(static_cast< int >(95)));
   SWIG_Python_SetConstant(d, "NRT_FUNC",SWIG_FromCharPtr("unknown function"));
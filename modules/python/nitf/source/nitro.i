@@ -29,6 +29,11 @@
 #include <limits>
 %}
 
+%init %{
+  /* The numpy C API table is per translation unit */
+  import_array();
+%}
+
 #define NITF_LIST_TO_PYTHON_LIST(_type) \
     nitf_Error _error; \
     nitf_ListIterator iter; \
@@ -590,24 +595,32 @@
 
     /**
      * Helper function for ImageReader_read ... necessary
+     *
+     * Reads the window into a (bands, rows, cols) array of numpy type
+     * typeNum.  If out is an array it is filled in place, otherwise a new
+     * one is allocated.
      */
-    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int nbpp, nitf_Error* error)
+    PyObject* py_ImageReader_read(nitf_ImageReader* reader, nitf_SubWindow* window, int typeNum, PyObject* out, nitf_Error* error)
     {
-        /* TODO somehow get the NUMBITSPERPIXEL in the future */
         nitf_Uint8 **buf = NULL;
         nitf_Uint8 *pyArrayBuffer = NULL;
-        PyObject* result = Py_None;
+        PyObject* result = NULL;
+        NITF_BOOL success;
         int padded, rowSkip, colSkip;
-        nitf_Uint64 subimageSize;
+        nitf_Uint32 pixelSize;
+        nitf_Uint64 bandSize;
         nitf_Uint32 i;
-        types::RowCol<size_t> dims;
+        npy_intp dims[3];
 
         rowSkip = window->downsampler ? window->downsampler->rowSkip : 1;
         colSkip = window->downsampler ? window->downsampler->colSkip : 1;
-        subimageSize = static_cast<nitf_Uint64>(window->numRows/rowSkip) *
-                (window->numCols/colSkip) *
-                nitf_ImageIO_pixelSize(reader->imageDeblocker);
-        if (subimageSize > std::numeric_limits<size_t>::max())
+        pixelSize = nitf_ImageIO_pixelSize(reader->imageDeblocker);
+
+        dims[0] = window->numBands;
+        dims[1] = window->numRows / rowSkip;
+        dims[2] = window->numCols / colSkip;
+        bandSize = static_cast<nitf_Uint64>(dims[1]) * dims[2] * pixelSize;
+        if (bandSize * window->numBands > std::numeric_limits<size_t>::max())
         {
             nitf_Error_print(error, stderr,
                              "Image is too large for this system\n");
@@ -615,62 +628,87 @@
             goto CATCH_ERROR;
         }
 
-        dims.row = window->numBands;
-        dims.col = subimageSize;
-
-        numpyutils::createOrVerify(result, NPY_UINT8, dims);
-
-        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * window->numBands);
-        if (!buf)
+        if (out && out != Py_None)
         {
-            PyErr_NoMemory();
-            goto CATCH_ERROR;
-        }
+            PyArrayObject* outArray;
 
-        memset(buf, 0, sizeof(nitf_Uint8*) * window->numBands);
-
-        for (i = 0; i < window->numBands; ++i)
-        {
-            buf[i] = (nitf_Uint8*) NITF_MALLOC(sizeof(nitf_Uint8) * subimageSize);
-            if (!buf[i])
+            if (!PyArray_Check(out))
+            {
+                PyErr_SetString(PyExc_TypeError, "out must be a numpy array");
+                goto CATCH_ERROR;
+            }
+            outArray = reinterpret_cast<PyArrayObject*>(out);
+            if (PyArray_TYPE(outArray) != typeNum ||
+                PyArray_NDIM(outArray) != 3 ||
+                PyArray_DIM(outArray, 0) != dims[0] ||
+                PyArray_DIM(outArray, 1) != dims[1] ||
+                PyArray_DIM(outArray, 2) != dims[2])
             {
-                PyErr_NoMemory();
+                PyErr_SetString(PyExc_ValueError,
+                                "out does not match the window's type and "
+                                "(bands, rows, cols) shape");
                 goto CATCH_ERROR;
             }
+            if (!PyArray_ISCARRAY(outArray))
+            {
+                PyErr_SetString(PyExc_ValueError,
+                                "out must be C-contiguous, aligned and writeable");
+                goto CATCH_ERROR;
+            }
+            Py_INCREF(out);
+            result = out;
+        }
+        else
+        {
+            result = PyArray_SimpleNew(3, dims, typeNum);
+            if (!result)
+                goto CATCH_ERROR;
         }
 
-        if (!nitf_ImageReader_read(reader, window,
-               buf, &padded, error))
+        /* The element type comes from the caller (it knows PVTYPE), but it
+           has to agree with what the deblocker is going to write */
+        if (static_cast<nitf_Uint32>(PyArray_ITEMSIZE(
+                reinterpret_cast<PyArrayObject*>(result))) != pixelSize)
         {
-            nitf_Error_print(error, stderr, "Read failed");
-            PyErr_SetString(PyExc_RuntimeError, "");
+            PyErr_Format(PyExc_ValueError,
+                         "Array element size %d does not match pixel size %u",
+                         (int) PyArray_ITEMSIZE(
+                             reinterpret_cast<PyArrayObject*>(result)),
+                         pixelSize);
             goto CATCH_ERROR;
         }
 
-        // Copy to output numpy array
-        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
-        for (i = 0; i < window->numBands; ++i)
+        buf = (nitf_Uint8**) NITF_MALLOC(sizeof(nitf_Uint8*) * window->numBands);
+        if (!buf)
         {
-            memcpy(pyArrayBuffer + i * subimageSize,
-                   buf[i], sizeof(nitf_Uint8) * subimageSize);
+            PyErr_NoMemory();
+            goto CATCH_ERROR;
         }
 
+        /* Each band is a contiguous plane of the array, so let the reader
+           decode straight into it */
+        pyArrayBuffer = numpyutils::getBuffer<nitf_Uint8>(result);
         for (i = 0; i < window->numBands; ++i)
+            buf[i] = pyArrayBuffer + i * bandSize;
+
+        /* The read only touches the NITRO objects and the array's memory,
+           which we hold a reference to, so other threads can run */
+        Py_BEGIN_ALLOW_THREADS
+        success = nitf_ImageReader_read(reader, window, buf, &padded, error);
+        Py_END_ALLOW_THREADS
+
+        if (!success)
         {
-            NITF_FREE(buf[i]);
+            nitf_Error_print(error, stderr, "Read failed");
+            PyErr_SetString(PyExc_RuntimeError, "");
+            goto CATCH_ERROR;
         }
+
         NITF_FREE(buf);
         return result;
 
       CATCH_ERROR:
-        if (buf)
-        {
-            for (i = 0; i < window->numBands; ++i)
-            {
-                NITF_FREE(buf[i]);
-            }
-            NITF_FREE(buf);
-        }
+        if (buf) NITF_FREE(buf);
         if (result) Py_CLEAR(result);
         return NULL;
     }